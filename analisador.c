@@ -36,6 +36,34 @@ static int is_keyword(const char* str) {
     return 0;
 }
 
+static OperatorKind operator_kind(const char* op) {
+    if (op[1] == '\0') {
+        switch (op[0]) {
+            case '+': return OP_PLUS;
+            case '-': return OP_MINUS;
+            case '*': return OP_STAR;
+            case '/': return OP_SLASH;
+            case '%': return OP_PERCENT;
+            case '=': return OP_ASSIGN;
+            case '!': return OP_NOT;
+            case '<': return OP_LESS;
+            case '>': return OP_GREATER;
+            case '&': return OP_AMPERSAND;
+            case '|': return OP_PIPE;
+        }
+        return OP_NONE;
+    }
+    switch (op[0]) {
+        case '=': return OP_EQUAL;
+        case '!': return OP_NOT_EQUAL;
+        case '<': return OP_LESS_EQUAL;
+        case '>': return OP_GREATER_EQUAL;
+        case '&': return OP_AND;
+        case '|': return OP_OR;
+    }
+    return OP_NONE;
+}
+
 // --- Função Principal do Módulo ---
 
 Token next_token(const char* src, int* index) {
@@ -133,6 +161,7 @@ Token next_token(const char* src, int* index) {
         }
         strcpy(token.lexeme, lexeme_buffer);
         token.type = TOKEN_OPERATOR;
+        token.op = operator_kind(lexeme_buffer);
     } else if (strchr(delimiters, src[*index])) {
         lexeme_buffer[i++] = src[(*index)++];
         update_position(lexeme_buffer[i - 1]);
@@ -162,4 +191,49 @@ const char* token_type_to_string(TokenType type) {
         case TOKEN_COMMENT: return "TOKEN_COMMENT";
         default: return "TOKEN_UNKNOWN";
     }
-}
\ No newline at end of file
+}
+// --- Modo Somente Léxico ---
+
+// As linhas do dump são formatadas em um buffer próprio e escritas em blocos,
+// evitando uma chamada de stdio por token em entradas grandes.
+#define TOKEN_DUMP_BUFFER_SIZE (64 * 1024)
+#define TOKEN_DUMP_MAX_LINE 256
+
+static char token_dump_buffer[TOKEN_DUMP_BUFFER_SIZE];
+static size_t token_dump_used = 0;
+
+static void flush_token_dump(FILE* out) {
+    fwrite(token_dump_buffer, 1, token_dump_used, out);
+    token_dump_used = 0;
+}
+
+static void write_token_line(FILE* out, const Token* token) {
+    if (token_dump_used + TOKEN_DUMP_MAX_LINE > TOKEN_DUMP_BUFFER_SIZE) {
+        flush_token_dump(out);
+    }
+    int written = snprintf(token_dump_buffer + token_dump_used, TOKEN_DUMP_MAX_LINE,
+                           "Token: %-30s | Tipo: %-15s | Linha: %-4d | Coluna: %-4d\n",
+                           token->lexeme, token_type_to_string(token->type), token->line, token->column);
+    if (written >= TOKEN_DUMP_MAX_LINE) written = TOKEN_DUMP_MAX_LINE - 1;
+    token_dump_used += written;
+}
+
+int tokenize_source(const char* src, FILE* out) {
+    int index = 0;
+    int count = 0;
+    Token token;
+
+    current_pos.line = 1;
+    current_pos.column = 1;
+    do {
+        token = next_token(src, &index);
+        count++;
+        if (out) write_token_line(out, &token);
+    } while (token.type != TOKEN_EOF);
+
+    if (out) {
+        flush_token_dump(out);
+        fflush(out);
+    }
+    return count;
+}
@@ -15,8 +15,20 @@ typedef enum {
     TOKEN_COMMENT, TOKEN_UNKNOWN
 } TokenType;
 
+// Subtipo dos tokens TOKEN_OPERATOR (OP_NONE nos demais tokens), usado pelo parser
+// para indexar a tabela de precedência em vez de comparar lexemas
+typedef enum {
+    OP_NONE,
+    OP_PLUS, OP_MINUS, OP_STAR, OP_SLASH, OP_PERCENT,
+    OP_ASSIGN, OP_NOT, OP_AMPERSAND, OP_PIPE,
+    OP_EQUAL, OP_NOT_EQUAL, OP_LESS, OP_GREATER, OP_LESS_EQUAL, OP_GREATER_EQUAL,
+    OP_AND, OP_OR,
+    OP_KIND_COUNT
+} OperatorKind;
+
 typedef struct {
     TokenType type;
+    OperatorKind op;
     char lexeme[100];
     int line;
     int column;
@@ -32,4 +44,13 @@ extern Position current_pos;
 Token next_token(const char* src, int* index);
 const char* token_type_to_string(TokenType type);
 
+/**
+ * @brief Percorre todo o código-fonte só com o analisador léxico.
+ * @param src Código-fonte terminado em '\0'.
+ * @param out Se não for NULL, recebe cada token no formato de saida.txt
+ * ("Token: ... | Tipo: ... | Linha: ... | Coluna: ..."), por meio de um buffer.
+ * @return Número de tokens lidos, incluindo o EOF.
+ */
+int tokenize_source(const char* src, FILE* out);
+
 #endif // ANALISADOR_H
\ No newline at end of file
@@ -1,13 +1,15 @@
 #include "analisador_semantico.h"
 #include "tabela_simbolos.h"
+#include "diagnosticos.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 // --- Variáveis e Funções de Controlo de Erro ---
 static int semantic_error_count = 0;
 
 static void semantic_error(const char* message, int line, int column) {
-    fprintf(stderr, "Erro Semântico (Linha %d, Coluna %d): %s\n", line, column, message);
+    report_error("Erro Semântico (Linha %d, Coluna %d): %s\n", line, column, message);
     semantic_error_count++;
 }
 
@@ -16,36 +18,46 @@ int get_semantic_error_count() {
 }
 
 // --- Protótipos de Funções Estáticas ---
-static void visit_node(ASTNode* node);
 static DataType get_expression_type(ASTNode* node);
+static DataType binary_result_type(ASTNode* node, DataType left_type);
 
 // --- Implementação ---
+//
+// A análise é um passe do gerenciador de passes: as declarações e os escopos são
+// tratados na pré-ordem e a verificação de tipos na pós-ordem, quando os operandos
+// já foram visitados e anotados. O percurso é iterativo, então a profundidade da
+// árvore (por exemplo, a espinha esquerda de 'a + a + ... + a') não esgota a pilha.
 
 void analyze_semantics(ASTNode* root) {
+    const Pass* passes[] = { &semantic_pass };
+    walk_passes(root, passes, 1);
+}
+
+static void semantic_begin(ASTNode* root) {
+    (void)root;
     init_symbol_table();
     semantic_error_count = 0;
-    visit_node(root);
 }
 
-static void visit_node(ASTNode* node) {
-    if (!node) return;
+// Tipo de um operando já visitado: uma operação binária recebeu o tipo na própria
+// pós-ordem (mesmo que desconhecido) e não é percorrida de novo.
+static DataType operand_type(ASTNode* node) {
+    if (node && node->type == NODE_BINARY_OP) return node->value_type;
+    return get_expression_type(node);
+}
 
+static int semantic_pre(const PassVisit* visit) {
+    ASTNode* node = *visit->slot;
     switch (node->type) {
-        // (outros casos permanecem os mesmos)
         case NODE_PROGRAM:
+        case NODE_BLOCK:
             enter_scope();
-            for (ASTNodeList* l = node->data.program.declarations; l; l = l->next) visit_node(l->node);
-            exit_scope();
             break;
-        case NODE_MAIN_DEF:
-            visit_node(node->data.main_def.body);
-            break;
-        case NODE_BLOCK:
+        case NODE_FOR:
+            // A variável declarada no init só é visível dentro do laço
             enter_scope();
-            for (ASTNodeList* l = node->data.block.statements; l; l = l->next) visit_node(l->node);
-            exit_scope();
             break;
-        case NODE_VAR_DECL: {
+        case NODE_VAR_DECL:
             if (lookup_symbol_in_current_scope(node->data.var_decl.var_name)) {
                 char msg[256];
                 sprintf(msg, "Redeclaração do identificador '%s'.", node->data.var_decl.var_name);
@@ -54,15 +66,7 @@ static void visit_node(ASTNode* node) {
                 DataType type = string_to_datatype(node->data.var_decl.type_name);
                 add_symbol(node->data.var_decl.var_name, type, node);
             }
-            if (node->data.var_decl.initial_value) {
-                DataType lvalue_type = string_to_datatype(node->data.var_decl.type_name);
-                DataType rvalue_type = get_expression_type(node->data.var_decl.initial_value);
-                if (lvalue_type != rvalue_type && rvalue_type != TYPE_UNKNOWN) {
-                    semantic_error("Tipos incompatíveis na inicialização.", node->pos.line, node->pos.column);
-                }
-            }
             break;
-        }
         case NODE_FUNC_DEF:
             if (lookup_symbol_in_current_scope(node->data.func_def.func_name)) {
                  semantic_error("Redeclaração da função.", node->pos.line, node->pos.column);
@@ -70,50 +74,32 @@ static void visit_node(ASTNode* node) {
                  add_symbol(node->data.func_def.func_name, TYPE_FUNCTION, node);
             }
             enter_scope();
-            for (ASTNodeList* l = node->data.func_def.params; l; l = l->next) visit_node(l->node);
-            visit_node(node->data.func_def.body);
-            exit_scope();
             break;
         case NODE_PARAM: {
              DataType param_type = string_to_datatype(node->data.param.type_name);
              add_symbol(node->data.param.param_name, param_type, node);
              break;
         }
-        case NODE_ASSIGN: {
+        case NODE_ASSIGN:
+            // Com o lado esquerdo inválido, o lado direito não é verificado
             if (node->data.assign_expr.lvalue->type != NODE_IDENTIFIER) {
                 semantic_error("O lado esquerdo de uma atribuição deve ser uma variável.", node->pos.line, node->pos.column);
-            } else {
-                const char* var_name = node->data.assign_expr.lvalue->data.identifier_name;
-                Symbol* symbol = lookup_symbol(var_name);
-                if (!symbol) {
-                    char msg[256];
-                    sprintf(msg, "Variável '%s' não declarada.", var_name);
-                    semantic_error(msg, node->data.assign_expr.lvalue->pos.line, node->data.assign_expr.lvalue->pos.column);
-                } else {
-                    DataType lvalue_type = symbol->type;
-                    DataType rvalue_type = get_expression_type(node->data.assign_expr.rvalue);
-                    if (lvalue_type != rvalue_type && rvalue_type != TYPE_UNKNOWN) {
-                        semantic_error("Tipos incompatíveis na atribuição.", node->pos.line, node->pos.column);
-                    }
-                }
+                return 0;
+            }
+            if (!lookup_symbol(node->data.assign_expr.lvalue->data.identifier_name)) {
+                char msg[256];
+                sprintf(msg, "Variável '%s' não declarada.", node->data.assign_expr.lvalue->data.identifier_name);
+                semantic_error(msg, node->data.assign_expr.lvalue->pos.line, node->data.assign_expr.lvalue->pos.column);
+                return 0;
             }
             break;
-        }
         case NODE_IDENTIFIER:
             if (!lookup_symbol(node->data.identifier_name)) {
                 char msg[256];
                 sprintf(msg, "Identificador '%s' não declarado.", node->data.identifier_name);
                 semantic_error(msg, node->pos.line, node->pos.column);
             }
-            break;
-        case NODE_BINARY_OP:
-            visit_node(node->data.binary_op.left);
-            visit_node(node->data.binary_op.right);
-            DataType left_type = get_expression_type(node->data.binary_op.left);
-            DataType right_type = get_expression_type(node->data.binary_op.right);
-            if (left_type != TYPE_UNKNOWN && right_type != TYPE_UNKNOWN && left_type != right_type) {
-                semantic_error("Tipos incompatíveis em operação binária.", node->pos.line, node->pos.column);
-            }
+            get_expression_type(node);
             break;
         case NODE_FUNC_CALL: {
             Symbol* func_symbol = lookup_symbol(node->data.func_call.func_name);
@@ -135,42 +121,136 @@ static void visit_node(ASTNode* node) {
                     }
                 }
             }
-            for (ASTNodeList* l = node->data.func_call.args; l; l = l->next) visit_node(l->node);
             break;
         }
-        case NODE_IF:
-            visit_node(node->data.if_stmt.condition);
-            visit_node(node->data.if_stmt.if_body);
-            if (node->data.if_stmt.else_body) visit_node(node->data.if_stmt.else_body);
+        default:
             break;
-        case NODE_RETURN:
-            if (node->data.return_stmt.return_value) visit_node(node->data.return_stmt.return_value);
+    }
+    return 1;
+}
+
+static void semantic_post(const PassVisit* visit) {
+    ASTNode* node = *visit->slot;
+    switch (node->type) {
+        case NODE_PROGRAM:
+        case NODE_BLOCK:
+        case NODE_FOR:
+        case NODE_FUNC_DEF:
+            exit_scope();
+            break;
+        case NODE_VAR_DECL:
+            if (node->data.var_decl.initial_value) {
+                DataType lvalue_type = string_to_datatype(node->data.var_decl.type_name);
+                DataType rvalue_type = get_expression_type(node->data.var_decl.initial_value);
+                if (lvalue_type != rvalue_type && rvalue_type != TYPE_UNKNOWN) {
+                    semantic_error("Tipos incompatíveis na inicialização.", node->pos.line, node->pos.column);
+                }
+            }
             break;
+        case NODE_ASSIGN: {
+            // Os erros do lado esquerdo já foram relatados na pré-ordem
+            if (node->data.assign_expr.lvalue->type != NODE_IDENTIFIER) break;
+            Symbol* symbol = lookup_symbol(node->data.assign_expr.lvalue->data.identifier_name);
+            if (!symbol) break;
+            DataType lvalue_type = symbol->type;
+            DataType rvalue_type = get_expression_type(node->data.assign_expr.rvalue);
+            if (lvalue_type != rvalue_type && rvalue_type != TYPE_UNKNOWN) {
+                semantic_error("Tipos incompatíveis na atribuição.", node->pos.line, node->pos.column);
+            }
+            break;
+        }
+        case NODE_BINARY_OP: {
+            DataType left_type = operand_type(node->data.binary_op.left);
+            DataType right_type = operand_type(node->data.binary_op.right);
+            if (left_type != TYPE_UNKNOWN && right_type != TYPE_UNKNOWN && left_type != right_type) {
+                semantic_error("Tipos incompatíveis em operação binária.", node->pos.line, node->pos.column);
+            }
+            if (node->value_type == TYPE_UNKNOWN) node->value_type = binary_result_type(node, left_type);
+            break;
+        }
+        case NODE_INT_LITERAL:
+        case NODE_FLOAT_LITERAL:
+        case NODE_CHAR_LITERAL:
+        case NODE_STRING_LITERAL:
+        case NODE_FUNC_CALL:
         case NODE_UNARY_OP:
-            visit_node(node->data.unary_op.operand);
+            get_expression_type(node);
             break;
         default:
             break;
     }
 }
 
+const Pass semantic_pass = {
+    .name = "sema",
+    .begin = semantic_begin,
+    .pre = semantic_pre,
+    .post = semantic_post,
+};
+
+// Operadores cujo resultado é sempre um inteiro (0 ou 1), independentemente dos operandos.
+static int is_boolean_operator(const char* op) {
+    return strcmp(op, "==") == 0 || strcmp(op, "!=") == 0 ||
+           strcmp(op, "<") == 0 || strcmp(op, ">") == 0 ||
+           strcmp(op, "<=") == 0 || strcmp(op, ">=") == 0 ||
+           strcmp(op, "&&") == 0 || strcmp(op, "||") == 0 || strcmp(op, "!") == 0;
+}
+
+static DataType binary_result_type(ASTNode* node, DataType left_type) {
+    return is_boolean_operator(node->data.binary_op.op) ? TYPE_INT : left_type;
+}
+
+// Calcula o tipo da expressão e o anota no próprio nó (campo value_type),
+// para que as fases seguintes (otimização e geração) possam consultá-lo.
 static DataType get_expression_type(ASTNode* node) {
     if (!node) return TYPE_UNKNOWN;
+    if (node->value_type != TYPE_UNKNOWN) return node->value_type;
+
+    DataType type;
     switch (node->type) {
-        case NODE_INT_LITERAL: return TYPE_INT;
-        case NODE_FLOAT_LITERAL: return TYPE_FLOAT;
-        case NODE_CHAR_LITERAL: return TYPE_CHAR;
+        case NODE_INT_LITERAL: type = TYPE_INT; break;
+        case NODE_FLOAT_LITERAL: type = TYPE_FLOAT; break;
+        case NODE_CHAR_LITERAL: type = TYPE_CHAR; break;
         // <<< MODIFICAÇÃO: Adicionado suporte para strings >>>
-        case NODE_STRING_LITERAL: return TYPE_STRING;
+        case NODE_STRING_LITERAL: type = TYPE_STRING; break;
         case NODE_IDENTIFIER: {
             Symbol* symbol = lookup_symbol(node->data.identifier_name);
-            return symbol ? symbol->type : TYPE_UNKNOWN;
+            type = symbol ? symbol->type : TYPE_UNKNOWN;
+            break;
         }
-        case NODE_BINARY_OP:
-            return get_expression_type(node->data.binary_op.left);
+        case NODE_BINARY_OP: {
+            // Espinha esquerda em laço, da operação mais interna ainda sem tipo até 'node'
+            ASTStack spine = {0};
+            ASTNode* leftmost = node;
+            while (leftmost->type == NODE_BINARY_OP && leftmost->value_type == TYPE_UNKNOWN) {
+                ast_stack_push(&spine, leftmost);
+                leftmost = leftmost->data.binary_op.left;
+            }
+            type = get_expression_type(leftmost);
+            for (int i = spine.count - 1; i >= 0; i--) {
+                get_expression_type(spine.items[i]->data.binary_op.right);
+                type = binary_result_type(spine.items[i], type);
+                if (i > 0) spine.items[i]->value_type = type;
+            }
+            ast_stack_free(&spine);
+            break;
+        }
+        case NODE_UNARY_OP: {
+            DataType operand_type = get_expression_type(node->data.unary_op.operand);
+            type = is_boolean_operator(node->data.unary_op.op) ? TYPE_INT : operand_type;
+            break;
+        }
+        case NODE_ASSIGN:
+            get_expression_type(node->data.assign_expr.rvalue);
+            type = get_expression_type(node->data.assign_expr.lvalue);
+            break;
         case NODE_FUNC_CALL:
-            return TYPE_INT;
+            type = TYPE_INT;
+            break;
         default:
-            return TYPE_UNKNOWN;
+            type = TYPE_UNKNOWN;
+            break;
     }
+    node->value_type = type;
+    return type;
 }
@@ -2,6 +2,7 @@
 #define ANALISADOR_SEMANTICO_H
 
 #include "ast.h"
+#include "gerenciador_passes.h"
 
 /**
  * @brief Inicia o processo de análise semântica na AST.
@@ -14,4 +15,10 @@ void analyze_semantics(ASTNode* root);
  */
 int get_semantic_error_count();
 
+/**
+ * @brief A análise semântica como passe do gerenciador ("sema"): declarações e escopos
+ * na pré-ordem, verificação e anotação de tipos na pós-ordem.
+ */
+extern const Pass semantic_pass;
+
 #endif // ANALISADOR_SEMANTICO_H
@@ -13,6 +13,7 @@ typedef enum {
     NODE_BLOCK,
     NODE_IF,
     NODE_FOR,
+    NODE_WHILE,
     NODE_RETURN,
     NODE_ASSIGN,
     NODE_BINARY_OP,
@@ -25,6 +26,11 @@ typedef enum {
     NODE_CHAR_LITERAL
 } NodeType;
 
+// Tipos de dados da linguagem (usados pela Tabela de Símbolos e para anotar expressões)
+typedef enum {
+    TYPE_INT, TYPE_FLOAT, TYPE_CHAR, TYPE_STRING, TYPE_VOID, TYPE_FUNCTION, TYPE_UNKNOWN
+} DataType;
+
 // Estrutura para uma lista de nós (usada para parâmetros, argumentos, statements)
 typedef struct ASTNodeList {
     struct ASTNode* node;
@@ -35,6 +41,7 @@ typedef struct ASTNodeList {
 typedef struct ASTNode {
     NodeType type;
     Position pos; // Linha e coluna para relatórios de erro
+    DataType value_type; // Tipo da expressão, anotado pela análise semântica (TYPE_UNKNOWN até lá)
 
     union {
         // Programa: lista de declarações globais, funções, e o main
@@ -70,13 +77,19 @@ typedef struct ASTNode {
             struct ASTNode* else_body; // Pode ser NULL
         } if_stmt;
         
-        // Comando for: for(init; cond; inc) { corpo }
+        // Comando for: for(init; cond; inc) { corpo } (init, cond e inc podem ser NULL)
         struct {
             struct ASTNode* init;
             struct ASTNode* condition;
             struct ASTNode* increment;
             struct ASTNode* body;
         } for_stmt;
+
+        // Comando while: while(cond) { corpo }
+        struct {
+            struct ASTNode* condition;
+            struct ASTNode* body;
+        } while_stmt;
         
         // Comando return: return expressao;
         struct { struct ASTNode* return_value; } return_stmt;
@@ -109,7 +122,7 @@ typedef struct ASTNode {
         // Literais e identificadores
         char* identifier_name;
         int int_literal;
-        float float_literal;
+        double float_literal; // Precisão dupla, como o float do Python que o executa
         char* string_literal;
         char char_literal;
     } data;
@@ -122,5 +135,57 @@ ASTNodeList* create_node_list(ASTNode* node);
 ASTNodeList* append_node_list(ASTNodeList* list, ASTNode* node);
 void free_ast(ASTNode* node);
 void print_ast(ASTNode* node, int indent);
+ASTNode* clone_ast(ASTNode* node);
+int ast_equal(ASTNode* a, ASTNode* b);
+int count_ast_nodes(ASTNode* node);
+
+// --- Percursos Iterativos ---
+//
+// Os percursos genéricos da AST (liberação, cópia, contagem, impressão e serialização)
+// usam uma pilha no heap em vez da pilha de chamadas, de modo que a profundidade da
+// árvore (por exemplo, a espinha esquerda de 'a + a + ... + a') não é limitada pela
+// pilha do processo.
+
+// Posições dos filhos e das strings de cada tipo de nó: até quatro filhos diretos,
+// uma lista de filhos e até duas strings, na ordem em que aparecem na sintaxe.
+typedef struct {
+    ASTNode** child[4];
+    int child_count;
+    ASTNodeList** list;
+    char** str[2];
+    int str_count;
+} ASTLayout;
+
+// Pilha de nós alocada no heap
+typedef struct {
+    ASTNode** items;
+    int count;
+    int capacity;
+} ASTStack;
+
+ASTLayout ast_layout(ASTNode* node);
+void ast_stack_push(ASTStack* stack, ASTNode* node);
+void ast_stack_free(ASTStack* stack);
+
+/**
+ * @brief Desce pela espinha esquerda de operações binárias a partir de 'node'.
+ * @param spine Recebe as operações binárias, da raiz (primeira) até a mais interna.
+ * @return O operando mais à esquerda (o próprio 'node' se ele não for binário).
+ */
+ASTNode* ast_left_spine(ASTNode* node, ASTStack* spine);
+
+/**
+ * @brief Profundidade da subárvore (1 para uma folha, 0 para NULL).
+ */
+int ast_depth(ASTNode* node);
+
+/**
+ * @brief Se a expressão certamente vale um inteiro no output.py: literais inteiros,
+ * variáveis anotadas como int e operações inteiras sobre eles, comparações, '!' e
+ * operadores lógicos (0 ou 1; um bool do Python conta como inteiro). Uma chamada não
+ * conta, já que as funções não declaram o tipo de retorno e a análise semântica a anota
+ * como int mesmo quando devolve um float.
+ */
+int ast_is_integer(ASTNode* node);
 
 #endif // AST_H
@@ -0,0 +1,124 @@
+#!/usr/bin/env python3
+"""Harness de benchmark: gera programas sintéticos de vários tamanhos e formas,
+executa o compilador com --time-report=json e resume o tempo de cada fase.
+
+Cada combinação (forma, tamanho) é executada uma vez para aquecimento e depois
+--repeticoes vezes. Para cada fase são reportados mediana, mínimo e desvio padrão
+do tempo real; a vazão (MB/s, tokens/s e nós/s) usa a mediana. A saída padrão do
+compilador (logs das fases e a AST) é descartada para não pesar na medição.
+
+Uso: executar.py [--compilador ./compilador] [--formas misto,funcoes]
+                 [--tamanhos 250,1000,4000] [--repeticoes 5] [--json resultado.json]
+"""
+
+import argparse
+import json
+import os
+import statistics
+import subprocess
+import sys
+import tempfile
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import gerar_programa  # noqa: E402
+
+FASES = ["read", "parse", "sema", "print_ast", "opt", "codegen"]
+
+
+def executar_compilador(compilador, fonte, diretorio):
+    """Executa uma compilação e retorna o relatório JSON (o compilador escreve output.py no diretório)."""
+    resultado = subprocess.run(
+        [compilador, "--time-report=json", fonte],
+        cwd=diretorio,
+        stdout=subprocess.DEVNULL,
+        stderr=subprocess.PIPE,
+        text=True,
+    )
+    if resultado.returncode != 0:
+        raise RuntimeError(f"o compilador falhou para {fonte}:\n{resultado.stderr}")
+    linhas = [l for l in resultado.stderr.splitlines() if l.startswith("{")]
+    return json.loads(linhas[-1])
+
+
+def resumir(relatorios):
+    """Agrega as repetições: estatísticas de tempo por fase e vazão baseada na mediana."""
+    base = relatorios[0]
+    fases = {}
+    for fase in FASES:
+        tempos = [next((p["wall_ms"] for p in r["phases"] if p["name"] == fase), 0.0) for r in relatorios]
+        fases[fase] = {
+            "mediana_ms": statistics.median(tempos),
+            "minimo_ms": min(tempos),
+            "desvio_ms": statistics.stdev(tempos) if len(tempos) > 1 else 0.0,
+        }
+    total = [sum(p["wall_ms"] for p in r["phases"]) for r in relatorios]
+
+    def por_segundo(quantidade, ms):
+        return quantidade * 1000.0 / ms if ms > 0 else 0.0
+
+    parse_ms = fases["parse"]["mediana_ms"]
+    nos = base["ast_nodes"]["parsed"]
+    return {
+        "bytes": base["source_bytes"],
+        "tokens": base["tokens"],
+        "nos": nos,
+        "nos_otimizados": base["ast_nodes"]["optimized"],
+        "pico_rss_kb": max(r["peak_rss_kb"] for r in relatorios),
+        "fases": fases,
+        "total_mediana_ms": statistics.median(total),
+        "mb_por_s": por_segundo(base["source_bytes"], parse_ms) / (1024.0 * 1024.0),
+        "tokens_por_s": por_segundo(base["tokens"], parse_ms),
+        "nos_por_s": {fase: por_segundo(nos, fases[fase]["mediana_ms"]) for fase in ("sema", "opt", "codegen")},
+    }
+
+
+def imprimir_resumo(forma, tamanho, r):
+    print(f"\n== {forma}, tamanho {tamanho}: {r['bytes']} bytes, {r['tokens']} tokens, "
+          f"{r['nos']} nós ({r['nos_otimizados']} após otimizar), pico RSS {r['pico_rss_kb']} KB")
+    print(f"   {'fase':<10} {'mediana ms':>12} {'mínimo ms':>12} {'desvio ms':>12}")
+    for fase in FASES:
+        f = r["fases"][fase]
+        print(f"   {fase:<10} {f['mediana_ms']:>12.3f} {f['minimo_ms']:>12.3f} {f['desvio_ms']:>12.3f}")
+    print(f"   {'total':<10} {r['total_mediana_ms']:>12.3f}")
+    print(f"   vazão: {r['mb_por_s']:.2f} MB/s e {r['tokens_por_s']:.0f} tokens/s no parsing; nós/s: "
+          + ", ".join(f"{fase} {v:.0f}" for fase, v in r["nos_por_s"].items()))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Mede cada fase do compilador em programas sintéticos.")
+    parser.add_argument("--compilador", default="./compilador")
+    parser.add_argument("--formas", default=",".join(gerar_programa.FORMAS))
+    parser.add_argument("--tamanhos", default="250,1000,4000")
+    parser.add_argument("--repeticoes", type=int, default=5)
+    parser.add_argument("--semente", type=int, default=1)
+    parser.add_argument("--json", help="grava os resultados agregados neste arquivo")
+    args = parser.parse_args()
+
+    compilador = os.path.abspath(args.compilador)
+    formas = [f for f in args.formas.split(",") if f]
+    tamanhos = [int(t) for t in args.tamanhos.split(",") if t]
+    for forma in formas:
+        if forma not in gerar_programa.FORMAS:
+            parser.error(f"forma desconhecida: {forma}")
+
+    resultados = []
+    with tempfile.TemporaryDirectory(prefix="bench_compilador_") as diretorio:
+        for forma in formas:
+            for tamanho in tamanhos:
+                fonte = os.path.join(diretorio, f"{forma}_{tamanho}.txt")
+                with open(fonte, "w") as f:
+                    f.write(gerar_programa.gerar(forma, tamanho, args.semente))
+                executar_compilador(compilador, fonte, diretorio)  # Aquecimento
+                relatorios = [executar_compilador(compilador, fonte, diretorio) for _ in range(args.repeticoes)]
+                resumo = resumir(relatorios)
+                imprimir_resumo(forma, tamanho, resumo)
+                resultados.append({"forma": forma, "tamanho": tamanho, **resumo})
+
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump({"repeticoes": args.repeticoes, "semente": args.semente, "resultados": resultados}, f, indent=2)
+        print(f"\nResultados gravados em {args.json}")
+
+
+if __name__ == "__main__":
+    main()
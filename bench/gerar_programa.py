@@ -0,0 +1,169 @@
+#!/usr/bin/env python3
+"""Gerador de programas sintéticos para os benchmarks do compilador.
+
+Cada "forma" estressa uma parte diferente do compilador; o tamanho controla
+quantas repetições do padrão são emitidas. A saída é determinística para uma
+mesma semente.
+
+Formas disponíveis:
+  globais     muitas variáveis globais, todas lidas no main
+  funcoes     milhares de definições 'fun', chamadas em cadeia pelo main
+  expressoes  expressões profundamente aninhadas (profundidade = tamanho)
+  main_longo  um bloco main muito longo (atribuições, ifs e laços)
+  strings     strings longas e comentários extensos entre os comandos
+  misto       combinação proporcional de todas as formas anteriores
+
+Uso: gerar_programa.py --forma funcoes --tamanho 2000 [--semente 1] [-o arquivo]
+"""
+
+import argparse
+import random
+import sys
+
+FORMAS = ["globais", "funcoes", "expressoes", "main_longo", "strings", "misto"]
+
+# O analisador léxico guarda cada lexema em um buffer de 100 bytes
+MAX_STRING = 90
+
+
+def gerar_globais(n, rng, out):
+    for i in range(n):
+        out.append(f"int g{i} = {rng.randint(0, 1000)};\n")
+    out.append("main {\n    int soma = 0;\n")
+    for i in range(n):
+        out.append(f"    soma = soma + g{i};\n")
+    out.append("    print(soma);\n}\n")
+
+
+def gerar_funcoes(n, rng, out):
+    for i in range(n):
+        k = rng.randint(2, 9)
+        if i == 0:
+            out.append(f"fun f{i}(int a, int b) {{\n    int t = a * {k} + b;\n    return t;\n}}\n")
+        else:
+            # Cada função chama a anterior, de modo que nenhuma é removida por falta de uso
+            out.append(
+                f"fun f{i}(int a, int b) {{\n"
+                f"    int t = a * {k} + b;\n"
+                f"    if (t > {rng.randint(100, 10000)}) {{\n"
+                f"        t = t - a;\n"
+                f"    }}\n"
+                f"    return f{i - 1}(t, b);\n"
+                f"}}\n"
+            )
+    out.append("main {\n    int r = 0;\n")
+    step = max(1, n // 50)
+    for i in range(0, n, step):
+        out.append(f"    r = r + f{i}({rng.randint(0, 9)}, {rng.randint(0, 9)});\n")
+    out.append("    print(r);\n}\n")
+
+
+def expressao_aninhada(profundidade, rng):
+    # Multiplicações aparecem só dentro dos operandos, para que o valor não cresça
+    # exponencialmente quando o programa gerado é executado
+    expr = "x"
+    for _ in range(profundidade):
+        op = rng.choice(["+", "-"])
+        operando = rng.choice(["x", "y", str(rng.randint(1, 9)), f"(y * {rng.randint(2, 9)})"])
+        expr = f"({expr} {op} {operando})"
+    return expr
+
+
+def gerar_expressoes(n, rng, out):
+    out.append("main {\n    int x = 3;\n    int y = 7;\n    int z = 0;\n")
+    for _ in range(8):
+        out.append(f"    z = z + {expressao_aninhada(n, rng)};\n")
+        out.append("    x = z - x;\n")
+    out.append("    print(z);\n}\n")
+
+
+def gerar_main_longo(n, rng, out):
+    variaveis = 16
+    out.append("main {\n")
+    for v in range(variaveis):
+        out.append(f"    int v{v} = {rng.randint(0, 100)};\n")
+    for i in range(n):
+        a, b, c = (rng.randrange(variaveis) for _ in range(3))
+        escolha = i % 10
+        if escolha < 6:
+            out.append(f"    v{a} = v{b} * {rng.randint(1, 9)} + v{c} - {rng.randint(0, 50)};\n")
+        elif escolha < 8:
+            out.append(f"    if (v{a} > v{b}) {{\n        v{c} = v{c} + 1;\n    }} else {{\n        v{c} = v{c} - 1;\n    }}\n")
+        elif escolha < 9:
+            out.append(f"    while (v{a} > 1000) {{\n        v{a} = v{a} / 2;\n    }}\n")
+        else:
+            out.append(f"    for (int i = 0; i < {rng.randint(2, 6)}; i = i + 1) {{\n        v{a} = v{a} + i * v{b};\n    }}\n")
+    for v in range(variaveis):
+        out.append(f"    print(v{v});\n")
+    out.append("}\n")
+
+
+def gerar_strings(n, rng, out):
+    palavras = ["compilador", "analisador", "token", "arvore", "simbolo", "escopo", "laco", "funcao"]
+    out.append("main {\n")
+    for i in range(n):
+        comentario = " ".join(rng.choice(palavras) for _ in range(40))
+        out.append(f"    /* {comentario} */\n")
+        texto = " ".join(rng.choice(palavras) for _ in range(20))[:MAX_STRING]
+        out.append(f"    print(\"{texto}\"); // linha {i}\n")
+    out.append("}\n")
+
+
+def gerar_misto(n, rng, out):
+    # Globais e funções precisam vir antes do main: gera cada parte e junta os corpos
+    partes = []
+    for gerador, escala in ((gerar_globais, 4), (gerar_funcoes, 8), (gerar_main_longo, 2)):
+        buffer = []
+        gerador(max(1, n // escala), rng, buffer)
+        partes.append("".join(buffer))
+    globais, funcoes, principal = partes
+    declaracoes_globais, main_globais = globais.split("main {\n", 1)
+    declaracoes_funcoes, main_funcoes = funcoes.split("main {\n", 1)
+    _, main_longo = principal.split("main {\n", 1)
+    out.append(declaracoes_globais)
+    out.append(declaracoes_funcoes)
+    # Junta os três corpos de main em blocos aninhados, para manter os escopos separados
+    out.append("main {\n")
+    for corpo in (main_globais, main_funcoes, main_longo):
+        out.append("    {\n")
+        out.append(corpo.rsplit("}", 1)[0])
+        out.append("    }\n")
+    out.append("}\n")
+
+
+GERADORES = {
+    "globais": gerar_globais,
+    "funcoes": gerar_funcoes,
+    "expressoes": gerar_expressoes,
+    "main_longo": gerar_main_longo,
+    "strings": gerar_strings,
+    "misto": gerar_misto,
+}
+
+
+def gerar(forma, tamanho, semente=1):
+    """Retorna o código-fonte do programa sintético como string."""
+    rng = random.Random(f"{forma}:{tamanho}:{semente}")
+    out = [f"// Programa sintético: forma={forma} tamanho={tamanho} semente={semente}\n"]
+    GERADORES[forma](tamanho, rng, out)
+    return "".join(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Gera programas sintéticos para benchmark.")
+    parser.add_argument("--forma", choices=FORMAS, default="misto")
+    parser.add_argument("--tamanho", type=int, default=1000)
+    parser.add_argument("--semente", type=int, default=1)
+    parser.add_argument("-o", "--saida", help="arquivo de saída (padrão: stdout)")
+    args = parser.parse_args()
+
+    codigo = gerar(args.forma, args.tamanho, args.semente)
+    if args.saida:
+        with open(args.saida, "w") as f:
+            f.write(codigo)
+    else:
+        sys.stdout.write(codigo)
+
+
+if __name__ == "__main__":
+    main()
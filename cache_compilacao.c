@@ -0,0 +1,301 @@
+// Define _DEFAULT_SOURCE para habilitar opendir, mkdir e utime
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <utime.h>
+#include <sys/stat.h>
+#include "cache_compilacao.h"
+
+// --- Cache de Compilação ---
+//
+// Cada entrada é um arquivo "<chave>.cache" no diretório do cache: uma linha de
+// cabeçalho (formato, chave e tamanho do código-fonte, usados para descartar
+// colisões) seguida do código gerado. O horário de modificação de uma entrada é
+// atualizado a cada acerto, e a remoção por tamanho apaga as mais antigas.
+
+#define CACHE_FORMAT "CACHE1"
+#define CACHE_STATS_FILE "estatisticas.txt"
+#define CACHE_COPY_BUFFER (64 * 1024)
+#define CACHE_PATH_SIZE 1024
+
+static char cache_dir[512];
+static long long cache_max_bytes = 0;
+static int cache_is_open = 0;
+static CacheStats stats;
+static int pending_stores = 0; // Entradas gravadas desde a abertura
+
+static void entry_path(char* path, size_t size, unsigned long long key) {
+    snprintf(path, size, "%s/%016llx.cache", cache_dir, key);
+}
+
+static void load_stats() {
+    char path[CACHE_PATH_SIZE];
+    snprintf(path, sizeof(path), "%s/%s", cache_dir, CACHE_STATS_FILE);
+    FILE* f = fopen(path, "r");
+    if (!f) return;
+    if (fscanf(f, "acertos %llu\nfalhas %llu\narmazenamentos %llu\nremocoes %llu\n",
+               &stats.hits, &stats.misses, &stats.stores, &stats.evictions) != 4) {
+        stats.hits = stats.misses = stats.stores = stats.evictions = 0;
+    }
+    fclose(f);
+}
+
+static void save_stats() {
+    char path[CACHE_PATH_SIZE];
+    snprintf(path, sizeof(path), "%s/%s", cache_dir, CACHE_STATS_FILE);
+    FILE* f = fopen(path, "w");
+    if (!f) return;
+    fprintf(f, "acertos %llu\nfalhas %llu\narmazenamentos %llu\nremocoes %llu\n",
+            stats.hits, stats.misses, stats.stores, stats.evictions);
+    fclose(f);
+}
+
+// Copia o restante de 'in' para 'out'. Retorna 0 em caso de erro de escrita.
+static int copy_stream(FILE* in, FILE* out) {
+    char buffer[CACHE_COPY_BUFFER];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), in)) > 0) {
+        if (fwrite(buffer, 1, n, out) != n) return 0;
+    }
+    return !ferror(in);
+}
+
+int cache_open(const char* dir, long long max_bytes) {
+    if (strlen(dir) >= sizeof(cache_dir)) {
+        fprintf(stderr, "Aviso: caminho do cache muito longo; compilando sem cache.\n");
+        return 0;
+    }
+    if (mkdir(dir, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "Aviso: não foi possível criar o diretório de cache '%s'; compilando sem cache.\n", dir);
+        return 0;
+    }
+    strcpy(cache_dir, dir);
+    cache_max_bytes = max_bytes;
+    memset(&stats, 0, sizeof(stats));
+    load_stats();
+    cache_is_open = 1;
+    return 1;
+}
+
+unsigned long long cache_key(const char* source, long length, const char* options) {
+    unsigned long long hash = 1469598103934665603ULL; // FNV-1a de 64 bits
+    const char* parts[] = { COMPILER_VERSION, options };
+    for (int p = 0; p < 2; p++) {
+        for (const unsigned char* c = (const unsigned char*)parts[p]; *c; c++) {
+            hash = (hash ^ *c) * 1099511628211ULL;
+        }
+        hash = (hash ^ 0xFF) * 1099511628211ULL; // Separador entre as partes
+    }
+    for (long i = 0; i < length; i++) {
+        hash = (hash ^ (unsigned char)source[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Abre a entrada e valida o cabeçalho, deixando o arquivo posicionado no conteúdo.
+// Devolve NULL se a entrada não existe ou pertence a outra chave.
+static FILE* open_entry(unsigned long long key, char* path, size_t path_size, long* stored_length) {
+    entry_path(path, path_size, key);
+    FILE* entry = fopen(path, "rb");
+    if (!entry) return NULL;
+    char format[16];
+    unsigned long long stored_key;
+    if (fscanf(entry, "%15s %llx %ld", format, &stored_key, stored_length) != 3 || fgetc(entry) != '\n' ||
+        strcmp(format, CACHE_FORMAT) != 0 || stored_key != key || *stored_length < 0) {
+        fclose(entry);
+        return NULL;
+    }
+    return entry;
+}
+
+int cache_fetch(unsigned long long key, long source_length, const char* output_path) {
+    if (!cache_is_open) return 0;
+    char path[CACHE_PATH_SIZE];
+    long stored_length;
+    FILE* entry = open_entry(key, path, sizeof(path), &stored_length);
+    if (!entry || stored_length != source_length) {
+        if (entry) fclose(entry);
+        stats.misses++;
+        return 0;
+    }
+
+    FILE* out = fopen(output_path, "wb");
+    if (!out) {
+        perror("Não foi possível abrir o arquivo de saída para geração de código");
+        fclose(entry);
+        stats.misses++;
+        return 0;
+    }
+    int ok = copy_stream(entry, out);
+    fclose(entry);
+    if (fclose(out) != 0) ok = 0;
+    if (!ok) {
+        stats.misses++;
+        return 0;
+    }
+    utime(path, NULL); // Marca a entrada como usada recentemente
+    stats.hits++;
+    return 1;
+}
+
+char* cache_fetch_text(unsigned long long key, long* length) {
+    if (!cache_is_open) return NULL;
+    char path[CACHE_PATH_SIZE];
+    long stored_length;
+    FILE* entry = open_entry(key, path, sizeof(path), &stored_length);
+    char* text = entry ? malloc(stored_length + 1) : NULL;
+    if (!text || fread(text, 1, stored_length, entry) != (size_t)stored_length || fgetc(entry) != EOF) {
+        if (entry) fclose(entry);
+        free(text);
+        stats.misses++;
+        return NULL;
+    }
+    fclose(entry);
+    text[stored_length] = '\0';
+    *length = stored_length;
+    utime(path, NULL);
+    stats.hits++;
+    return text;
+}
+
+// --- Limite de Tamanho ---
+
+typedef struct {
+    char name[64];
+    time_t mtime;
+    long long size;
+} CacheEntry;
+
+static int compare_by_age(const void* a, const void* b) {
+    const CacheEntry* x = a;
+    const CacheEntry* y = b;
+    if (x->mtime != y->mtime) return x->mtime < y->mtime ? -1 : 1;
+    return strcmp(x->name, y->name);
+}
+
+// Lista as entradas do diretório. O vetor retornado deve ser liberado com free.
+static CacheEntry* list_entries(int* count, long long* total) {
+    *count = 0;
+    *total = 0;
+    DIR* dir = opendir(cache_dir);
+    if (!dir) return NULL;
+
+    int capacity = 64;
+    CacheEntry* entries = malloc(capacity * sizeof(CacheEntry));
+    struct dirent* d;
+    while (entries && (d = readdir(dir)) != NULL) {
+        size_t len = strlen(d->d_name);
+        if (len < 6 || len >= sizeof(entries[0].name) || strcmp(d->d_name + len - 6, ".cache") != 0) continue;
+        char path[CACHE_PATH_SIZE];
+        struct stat st;
+        snprintf(path, sizeof(path), "%s/%s", cache_dir, d->d_name);
+        if (stat(path, &st) != 0) continue;
+        if (*count == capacity) {
+            capacity *= 2;
+            CacheEntry* grown = realloc(entries, capacity * sizeof(CacheEntry));
+            if (!grown) break;
+            entries = grown;
+        }
+        strcpy(entries[*count].name, d->d_name);
+        entries[*count].mtime = st.st_mtime;
+        entries[*count].size = st.st_size;
+        *total += st.st_size;
+        (*count)++;
+    }
+    closedir(dir);
+    return entries;
+}
+
+static void enforce_size_limit() {
+    int count;
+    long long total;
+    CacheEntry* entries = list_entries(&count, &total);
+    if (!entries) return;
+    if (total > cache_max_bytes) {
+        qsort(entries, count, sizeof(CacheEntry), compare_by_age);
+        for (int i = 0; i < count && total > cache_max_bytes; i++) {
+            char path[CACHE_PATH_SIZE];
+            snprintf(path, sizeof(path), "%s/%s", cache_dir, entries[i].name);
+            if (unlink(path) == 0) {
+                total -= entries[i].size;
+                stats.evictions++;
+            }
+        }
+    }
+    free(entries);
+}
+
+// Entradas são escritas em um arquivo temporário e renomeadas, para que uma
+// compilação concorrente nunca leia uma entrada pela metade
+static FILE* begin_entry(unsigned long long key, long length, char* path, char* temp_path, size_t size) {
+    entry_path(path, size, key);
+    snprintf(temp_path, size, "%s.%ld.tmp", path, (long)getpid());
+    FILE* entry = fopen(temp_path, "wb");
+    if (entry) fprintf(entry, "%s %016llx %ld\n", CACHE_FORMAT, key, length);
+    return entry;
+}
+
+static void commit_entry(FILE* entry, int ok, const char* path, const char* temp_path) {
+    if (fclose(entry) != 0) ok = 0;
+    if (!ok || rename(temp_path, path) != 0) {
+        unlink(temp_path);
+        return;
+    }
+    stats.stores++;
+    pending_stores++;
+}
+
+void cache_store(unsigned long long key, long source_length, const char* output_path) {
+    if (!cache_is_open) return;
+    FILE* in = fopen(output_path, "rb");
+    if (!in) return;
+    char path[CACHE_PATH_SIZE], temp_path[CACHE_PATH_SIZE];
+    FILE* entry = begin_entry(key, source_length, path, temp_path, sizeof(path));
+    if (!entry) {
+        fclose(in);
+        return;
+    }
+    int ok = copy_stream(in, entry);
+    fclose(in);
+    commit_entry(entry, ok, path, temp_path);
+}
+
+void cache_store_text(unsigned long long key, const char* text, long length) {
+    if (!cache_is_open) return;
+    char path[CACHE_PATH_SIZE], temp_path[CACHE_PATH_SIZE];
+    FILE* entry = begin_entry(key, length, path, temp_path, sizeof(path));
+    if (!entry) return;
+    int ok = fwrite(text, 1, length, entry) == (size_t)length;
+    commit_entry(entry, ok, path, temp_path);
+}
+
+void cache_close() {
+    if (!cache_is_open) return;
+    // O limite de tamanho é aplicado uma vez por execução, depois de todas as gravações
+    if (pending_stores > 0) enforce_size_limit();
+    pending_stores = 0;
+    save_stats();
+    cache_is_open = 0;
+}
+
+CacheStats cache_get_stats() {
+    CacheStats current = stats;
+    CacheEntry* entries = list_entries(&current.entries, &current.bytes);
+    free(entries);
+    return current;
+}
+
+void cache_print_stats(FILE* out) {
+    CacheStats s = cache_get_stats();
+    unsigned long long lookups = s.hits + s.misses;
+    fprintf(out, "Cache de compilação em '%s':\n", cache_dir);
+    fprintf(out, "  Entradas: %d (%lld bytes, limite de %lld bytes)\n", s.entries, s.bytes, cache_max_bytes);
+    fprintf(out, "  Acertos: %llu, falhas: %llu (taxa de acerto de %.1f%%)\n",
+            s.hits, s.misses, lookups ? 100.0 * s.hits / lookups : 0.0);
+    fprintf(out, "  Armazenamentos: %llu, remoções por tamanho: %llu\n", s.stores, s.evictions);
+}
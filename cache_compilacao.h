@@ -0,0 +1,70 @@
+#ifndef CACHE_COMPILACAO_H
+#define CACHE_COMPILACAO_H
+
+#include <stdio.h>
+
+// Versão do compilador que entra na chave do cache. O Makefile a define como a soma de
+// todos os fontes e recompila este módulo quando algum deles muda, de modo que um
+// binário alterado nunca reaproveita resultados de outro. Fora do Makefile, o padrão é
+// o instante em que este arquivo foi compilado, que só muda quando ele é recompilado.
+#ifndef COMPILER_VERSION
+#define COMPILER_VERSION __DATE__ " " __TIME__
+#endif
+
+#define CACHE_DEFAULT_DIR ".cache_compilador"
+#define CACHE_DEFAULT_MAX_MB 64
+
+// Estatísticas acumuladas do cache (persistidas no próprio diretório do cache)
+typedef struct {
+    unsigned long long hits;
+    unsigned long long misses;
+    unsigned long long stores;
+    unsigned long long evictions;
+    int entries;      // Entradas presentes no diretório
+    long long bytes;  // Tamanho total das entradas
+} CacheStats;
+
+/**
+ * @brief Abre (criando, se preciso) o diretório do cache e carrega as estatísticas.
+ * @param dir Diretório do cache.
+ * @param max_bytes Tamanho máximo das entradas; as menos usadas recentemente são removidas além disso.
+ * @return 1 se o cache pôde ser aberto, 0 caso contrário (a compilação segue sem cache).
+ */
+int cache_open(const char* dir, long long max_bytes);
+
+/**
+ * @brief Calcula a chave (FNV-1a de 64 bits) do código-fonte, da versão do
+ * compilador e das opções que afetam o código gerado.
+ */
+unsigned long long cache_key(const char* source, long length, const char* options);
+
+/**
+ * @brief Procura a chave no cache e, se encontrada, copia o código gerado para output_path.
+ * @return 1 em caso de acerto, 0 em caso de falha (contabilizados nas estatísticas).
+ */
+int cache_fetch(unsigned long long key, long source_length, const char* output_path);
+
+/**
+ * @brief Guarda o arquivo gerado em output_path sob a chave. O limite de tamanho
+ * é aplicado em cache_close.
+ */
+void cache_store(unsigned long long key, long source_length, const char* output_path);
+
+/**
+ * @brief Variantes para textos em memória (o código gerado para cada declaração,
+ * na compilação incremental).
+ * @return Em caso de acerto, o texto terminado em '\0' (liberado com free) e seu
+ * tamanho em 'length'; NULL em caso de falha.
+ */
+char* cache_fetch_text(unsigned long long key, long* length);
+void cache_store_text(unsigned long long key, const char* text, long length);
+
+/**
+ * @brief Remove as entradas excedentes, grava as estatísticas acumuladas e fecha o cache.
+ */
+void cache_close();
+
+CacheStats cache_get_stats();
+void cache_print_stats(FILE* out);
+
+#endif // CACHE_COMPILACAO_H
@@ -0,0 +1,338 @@
+// Define _DEFAULT_SOURCE para habilitar open_memstream
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "compilacao_incremental.h"
+#include "analisador_semantico.h"
+#include "otimizador.h"
+#include "gerador_codigo.h"
+#include "cache_compilacao.h"
+#include "serializador_ast.h"
+#include "estatisticas.h"
+
+// Declaração de topo e as declarações anteriores que ela referencia
+typedef struct {
+    ASTNode* decl;
+    const char* name;        // NULL para o main
+    unsigned long long key;
+    int* deps;
+    int dep_count;
+    int dep_capacity;
+    int mark;                // Usado na busca das dependências transitivas
+} Unit;
+
+// Tabela hash de nomes de topo -> índice da declaração (endereçamento aberto)
+typedef struct {
+    int* slots;
+    int capacity;
+    Unit* units;
+} NameIndex;
+
+static void* checked_malloc(size_t size) {
+    void* p = malloc(size);
+    if (!p) {
+        fprintf(stderr, "Erro de Memória: falha na compilação incremental.\n");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+static unsigned long name_hash(const char* name) {
+    unsigned long hash = 5381;
+    for (; *name; name++) hash = ((hash << 5) + hash) + (unsigned char)*name;
+    return hash;
+}
+
+static int name_lookup(const NameIndex* index, const char* name) {
+    int slot = name_hash(name) & (index->capacity - 1);
+    while (index->slots[slot] >= 0) {
+        if (strcmp(index->units[index->slots[slot]].name, name) == 0) return index->slots[slot];
+        slot = (slot + 1) & (index->capacity - 1);
+    }
+    return -1;
+}
+
+// Insere o nome; devolve 0 se ele já existia
+static int name_insert(NameIndex* index, int unit) {
+    const char* name = index->units[unit].name;
+    int slot = name_hash(name) & (index->capacity - 1);
+    while (index->slots[slot] >= 0) {
+        if (strcmp(index->units[index->slots[slot]].name, name) == 0) return 0;
+        slot = (slot + 1) & (index->capacity - 1);
+    }
+    index->slots[slot] = unit;
+    return 1;
+}
+
+static const char* declaration_name(ASTNode* decl) {
+    if (decl->type == NODE_VAR_DECL) return decl->data.var_decl.var_name;
+    if (decl->type == NODE_FUNC_DEF) return decl->data.func_def.func_name;
+    return NULL;
+}
+
+// --- Dependências ---
+
+static void add_dependency(Unit* units, int self, const NameIndex* index, const char* name) {
+    int target = name_lookup(index, name);
+    // Só declarações anteriores são visíveis; uma referência a uma posterior é um
+    // erro semântico (ou um nome local), e não é uma dependência
+    if (target < 0 || target >= self) return;
+    Unit* u = &units[self];
+    for (int i = 0; i < u->dep_count; i++) {
+        if (u->deps[i] == target) return;
+    }
+    if (u->dep_count == u->dep_capacity) {
+        u->dep_capacity = u->dep_capacity ? u->dep_capacity * 2 : 8;
+        int* grown = realloc(u->deps, u->dep_capacity * sizeof(int));
+        if (!grown) {
+            fprintf(stderr, "Erro de Memória: falha na compilação incremental.\n");
+            exit(EXIT_FAILURE);
+        }
+        u->deps = grown;
+    }
+    u->deps[u->dep_count++] = target;
+}
+
+static void collect_dependencies(ASTNode* node, Unit* units, int self, const NameIndex* index) {
+    if (!node) return;
+    switch (node->type) {
+        case NODE_VAR_DECL:
+            collect_dependencies(node->data.var_decl.initial_value, units, self, index);
+            break;
+        case NODE_FUNC_DEF:
+            collect_dependencies(node->data.func_def.body, units, self, index);
+            break;
+        case NODE_MAIN_DEF:
+            collect_dependencies(node->data.main_def.body, units, self, index);
+            break;
+        case NODE_BLOCK:
+            for (ASTNodeList* l = node->data.block.statements; l; l = l->next) {
+                collect_dependencies(l->node, units, self, index);
+            }
+            break;
+        case NODE_IF:
+            collect_dependencies(node->data.if_stmt.condition, units, self, index);
+            collect_dependencies(node->data.if_stmt.if_body, units, self, index);
+            collect_dependencies(node->data.if_stmt.else_body, units, self, index);
+            break;
+        case NODE_FOR:
+            collect_dependencies(node->data.for_stmt.init, units, self, index);
+            collect_dependencies(node->data.for_stmt.condition, units, self, index);
+            collect_dependencies(node->data.for_stmt.increment, units, self, index);
+            collect_dependencies(node->data.for_stmt.body, units, self, index);
+            break;
+        case NODE_WHILE:
+            collect_dependencies(node->data.while_stmt.condition, units, self, index);
+            collect_dependencies(node->data.while_stmt.body, units, self, index);
+            break;
+        case NODE_RETURN:
+            collect_dependencies(node->data.return_stmt.return_value, units, self, index);
+            break;
+        case NODE_ASSIGN:
+            collect_dependencies(node->data.assign_expr.lvalue, units, self, index);
+            collect_dependencies(node->data.assign_expr.rvalue, units, self, index);
+            break;
+        case NODE_BINARY_OP: {
+            // Espinha esquerda em laço, na mesma ordem de uma visita recursiva
+            ASTStack spine = {0};
+            collect_dependencies(ast_left_spine(node, &spine), units, self, index);
+            for (int i = spine.count - 1; i >= 0; i--) {
+                collect_dependencies(spine.items[i]->data.binary_op.right, units, self, index);
+            }
+            ast_stack_free(&spine);
+            break;
+        }
+        case NODE_UNARY_OP:
+            collect_dependencies(node->data.unary_op.operand, units, self, index);
+            break;
+        case NODE_FUNC_CALL:
+            add_dependency(units, self, index, node->data.func_call.func_name);
+            for (ASTNodeList* l = node->data.func_call.args; l; l = l->next) {
+                collect_dependencies(l->node, units, self, index);
+            }
+            break;
+        case NODE_IDENTIFIER:
+            add_dependency(units, self, index, node->data.identifier_name);
+            break;
+        default:
+            break;
+    }
+}
+
+// Chave da declaração: hash estrutural + assinaturas das globais + chaves das funções usadas
+static unsigned long long unit_key(Unit* units, int self) {
+    Unit* u = &units[self];
+    int count = 2 + u->dep_count;
+    unsigned long long* parts = checked_malloc(count * sizeof(unsigned long long));
+    parts[0] = ast_fingerprint(u->decl);
+    parts[1] = (unsigned long long)u->decl->type;
+    for (int i = 0; i < u->dep_count; i++) {
+        ASTNode* dep = units[u->deps[i]].decl;
+        if (dep->type == NODE_VAR_DECL) {
+            const char* type = dep->data.var_decl.type_name;
+            const char* name = dep->data.var_decl.var_name;
+            unsigned long long signature = cache_key(type, (long)strlen(type), name);
+            parts[2 + i] = signature;
+        } else {
+            parts[2 + i] = units[u->deps[i]].key;
+        }
+    }
+    unsigned long long key = cache_key((const char*)parts, (long)(count * sizeof(unsigned long long)), "declaracao");
+    free(parts);
+    return key;
+}
+
+// --- Compilação de uma Declaração ---
+
+static int compare_ints(const void* a, const void* b) {
+    return *(const int*)a - *(const int*)b;
+}
+
+// Gera o código da declaração 'self' em um programa parcial com as suas dependências
+// transitivas (na ordem original). Devolve NULL se houver erros semânticos.
+static char* compile_unit(Unit* units, int unit_count, int self, long* length, int stamp) {
+    int* closure = checked_malloc(unit_count * sizeof(int));
+    int* stack = checked_malloc(unit_count * sizeof(int));
+    int closure_count = 0, top = 0;
+    stack[top++] = self;
+    units[self].mark = stamp;
+    while (top > 0) {
+        int current = stack[--top];
+        closure[closure_count++] = current;
+        for (int i = 0; i < units[current].dep_count; i++) {
+            int dep = units[current].deps[i];
+            if (units[dep].mark != stamp) {
+                units[dep].mark = stamp;
+                stack[top++] = dep;
+            }
+        }
+    }
+    free(stack);
+    qsort(closure, closure_count, sizeof(int), compare_ints);
+
+    ASTNode* partial = create_node(NODE_PROGRAM, units[self].decl->pos);
+    ASTNodeList** tail = &partial->data.program.declarations;
+    for (int i = 0; i < closure_count; i++) {
+        *tail = create_node_list(clone_ast(units[closure[i]].decl));
+        tail = &(*tail)->next;
+    }
+    free(closure);
+
+    stats_phase_begin(PHASE_SEMA);
+    analyze_semantics(partial);
+    stats_phase_end(PHASE_SEMA);
+    if (get_semantic_error_count() > 0) {
+        free_ast(partial);
+        return NULL;
+    }
+
+    stats_phase_begin(PHASE_OPT);
+    optimize_ast_partial(partial);
+    stats_phase_end(PHASE_OPT);
+
+    // A declaração compilada é a última do programa parcial
+    ASTNodeList* last = partial->data.program.declarations;
+    while (last->next) last = last->next;
+
+    char* text = NULL;
+    size_t size = 0;
+    stats_phase_begin(PHASE_CODEGEN);
+    FILE* buffer = open_memstream(&text, &size);
+    if (!buffer) {
+        fprintf(stderr, "Erro de Memória: falha na compilação incremental.\n");
+        exit(EXIT_FAILURE);
+    }
+    generate_declaration(last->node, buffer);
+    fclose(buffer);
+    stats_phase_end(PHASE_CODEGEN);
+
+    free_ast(partial);
+    *length = (long)size;
+    return text;
+}
+
+// --- Implementação ---
+
+int compile_incremental(ASTNode* program, const char* output_filename, IncrementalStats* stats) {
+    memset(stats, 0, sizeof(*stats));
+    int unit_count = 0;
+    for (ASTNodeList* l = program->data.program.declarations; l; l = l->next) unit_count++;
+    if (unit_count == 0) return 0;
+
+    Unit* units = checked_malloc(unit_count * sizeof(Unit));
+    memset(units, 0, unit_count * sizeof(Unit));
+    NameIndex index;
+    index.capacity = 16;
+    while (index.capacity < unit_count * 2) index.capacity *= 2;
+    index.slots = checked_malloc(index.capacity * sizeof(int));
+    memset(index.slots, 0xFF, index.capacity * sizeof(int)); // -1 = vazio
+    index.units = units;
+
+    int status = 1;
+    int i = 0;
+    for (ASTNodeList* l = program->data.program.declarations; l; l = l->next, i++) {
+        units[i].decl = l->node;
+        units[i].name = declaration_name(l->node);
+        // Nomes de topo repetidos são erros: a análise do programa inteiro os relata
+        if (units[i].name && !name_insert(&index, i)) status = 0;
+    }
+    for (i = 0; status == 1 && i < unit_count; i++) {
+        collect_dependencies(units[i].decl, units, i, &index);
+        units[i].key = unit_key(units, i);
+    }
+
+    // O arquivo de saída só é aberto quando todas as declarações têm código, para
+    // que uma compilação com erros não deixe um output.py truncado
+    char** texts = checked_malloc(unit_count * sizeof(char*));
+    long* lengths = checked_malloc(unit_count * sizeof(long));
+    memset(texts, 0, unit_count * sizeof(char*));
+    for (i = 0; status == 1 && i < unit_count; i++) {
+        stats_phase_begin(PHASE_CACHE);
+        texts[i] = cache_fetch_text(units[i].key, &lengths[i]);
+        stats_phase_end(PHASE_CACHE);
+        if (texts[i]) {
+            stats->reused++;
+            continue;
+        }
+        texts[i] = compile_unit(units, unit_count, i, &lengths[i], i + 1);
+        if (!texts[i]) {
+            status = -1;
+            break;
+        }
+        stats_phase_begin(PHASE_CACHE);
+        cache_store_text(units[i].key, texts[i], lengths[i]);
+        stats_phase_end(PHASE_CACHE);
+        stats->recompiled++;
+    }
+    stats->declarations = unit_count;
+
+    if (status == 1) {
+        FILE* out = fopen(output_filename, "w");
+        if (!out) {
+            perror("Não foi possível abrir o arquivo de saída para geração de código");
+            status = 0;
+        } else {
+            generate_code_header(out);
+            // O main é emitido por último, como em generate_code
+            for (i = 0; i < unit_count; i++) {
+                if (units[i].decl->type != NODE_MAIN_DEF) fwrite(texts[i], 1, lengths[i], out);
+            }
+            for (i = 0; i < unit_count; i++) {
+                if (units[i].decl->type == NODE_MAIN_DEF) fwrite(texts[i], 1, lengths[i], out);
+            }
+            if (fclose(out) != 0) status = 0;
+        }
+    }
+
+    for (i = 0; i < unit_count; i++) {
+        free(texts[i]);
+        free(units[i].deps);
+    }
+    free(texts);
+    free(lengths);
+    free(units);
+    free(index.slots);
+    return status;
+}
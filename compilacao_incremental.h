@@ -0,0 +1,36 @@
+#ifndef COMPILACAO_INCREMENTAL_H
+#define COMPILACAO_INCREMENTAL_H
+
+#include "ast.h"
+
+// Resultado da última compilação incremental
+typedef struct {
+    int declarations; // Declarações de topo do programa
+    int reused;       // Declarações cujo código veio do cache
+    int recompiled;   // Declarações analisadas, otimizadas e geradas nesta execução
+} IncrementalStats;
+
+/**
+ * @brief Gera o código do programa declaração por declaração, reaproveitando do
+ * cache de compilação (que deve estar aberto) o código das declarações inalteradas.
+ *
+ * Cada declaração de topo recebe uma chave formada pelo seu hash estrutural e pelas
+ * declarações anteriores que ela referencia: das variáveis globais entra apenas a
+ * assinatura (tipo e nome); das funções entra a chave completa, já que o corpo de
+ * uma função chamada pode ser expandido inline. Assim, alterar uma função invalida
+ * apenas ela e as funções que dependem dela, direta ou indiretamente.
+ *
+ * Uma declaração sem código no cache é compilada em um programa parcial, formado por
+ * ela e pelas declarações de que depende, com optimize_ast_partial. As remoções que
+ * exigem o programa inteiro (globais nunca lidas, funções totalmente expandidas
+ * inline) não são feitas nesse modo.
+ *
+ * @param program A AST do programa inteiro (não é modificada).
+ * @param output_filename Arquivo de saída (ex: "output.py").
+ * @return 1 se o arquivo foi gerado; -1 se uma declaração tem erros semânticos (já
+ * relatados); 0 se o programa precisa ser compilado da forma tradicional (nomes de
+ * topo repetidos, que então são relatados pela análise do programa inteiro).
+ */
+int compile_incremental(ASTNode* program, const char* output_filename, IncrementalStats* stats);
+
+#endif // COMPILACAO_INCREMENTAL_H
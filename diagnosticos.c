@@ -0,0 +1,48 @@
+#include <stdarg.h>
+#include <stdlib.h>
+#include "diagnosticos.h"
+
+// --- Destino das Mensagens ---
+static FILE* error_stream = NULL; // NULL até a primeira chamada: stderr não é constante
+static FILE* info_stream = NULL;
+static int streams_set = 0;
+static jmp_buf* fatal_recovery = NULL;
+
+void set_report_streams(FILE* errors, FILE* info) {
+    error_stream = errors;
+    info_stream = info;
+    streams_set = 1;
+}
+
+static void ensure_default_streams() {
+    if (!streams_set) set_report_streams(stderr, stdout);
+}
+
+void report_error(const char* format, ...) {
+    ensure_default_streams();
+    if (!error_stream) return;
+    va_list args;
+    va_start(args, format);
+    vfprintf(error_stream, format, args);
+    va_end(args);
+}
+
+void report_info(const char* format, ...) {
+    ensure_default_streams();
+    if (!info_stream) return;
+    va_list args;
+    va_start(args, format);
+    vfprintf(info_stream, format, args);
+    va_end(args);
+}
+
+// --- Erros Irrecuperáveis ---
+
+void set_fatal_recovery(jmp_buf* recovery) {
+    fatal_recovery = recovery;
+}
+
+void fatal_error() {
+    if (fatal_recovery) longjmp(*fatal_recovery, 1);
+    exit(EXIT_FAILURE);
+}
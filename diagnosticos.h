@@ -0,0 +1,38 @@
+#ifndef DIAGNOSTICOS_H
+#define DIAGNOSTICOS_H
+
+#include <stdio.h>
+#include <setjmp.h>
+
+/**
+ * @brief Escreve uma mensagem de erro (léxico, sintático, semântico ou de memória).
+ * Por padrão vai para stderr.
+ */
+void report_error(const char* format, ...);
+
+/**
+ * @brief Escreve uma mensagem de progresso das fases (ex: "Otimização: ...").
+ * Por padrão vai para stdout.
+ */
+void report_info(const char* format, ...);
+
+/**
+ * @brief Redireciona as mensagens das fases. Um destino NULL descarta as mensagens;
+ * set_report_streams(stderr, stdout) restaura o padrão.
+ */
+void set_report_streams(FILE* errors, FILE* info);
+
+/**
+ * @brief Interrompe a compilação após um erro irrecuperável (erro sintático ou falta
+ * de memória), já relatado com report_error. Se houver um ponto de retomada
+ * registrado, volta a ele com longjmp; caso contrário, encerra o processo com
+ * exit(EXIT_FAILURE), como o driver sempre fez.
+ */
+void fatal_error();
+
+/**
+ * @brief Registra (ou remove, com NULL) o ponto de retomada usado por fatal_error.
+ */
+void set_fatal_recovery(jmp_buf* recovery);
+
+#endif // DIAGNOSTICOS_H
@@ -0,0 +1,219 @@
+// Define _DEFAULT_SOURCE para habilitar clock_gettime e getrusage
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+#include "estatisticas.h"
+#include "gerenciador_passes.h"
+
+// --- Contagem de Alocações ---
+//
+// Na glibc, malloc/calloc/realloc podem ser substituídas pelo programa: as versões
+// abaixo apenas contam a chamada e repassam para o alocador da própria glibc. Como
+// a substituição vale para toda a libc, alocações internas (strdup, fopen) também
+// são contadas. Com sanitizadores (que já interceptam o malloc) ou fora da glibc a
+// contagem fica desligada e o relatório mostra "n/d".
+
+static unsigned long long alloc_count = 0;
+static unsigned long long alloc_bytes = 0;
+
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__) && !defined(__SANITIZE_THREAD__)
+#define ALLOCATION_COUNTING 1
+
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t count, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+
+void* malloc(size_t size) {
+    alloc_count++;
+    alloc_bytes += size;
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    alloc_count++;
+    alloc_bytes += count * size;
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    alloc_count++;
+    alloc_bytes += size;
+    return __libc_realloc(ptr, size);
+}
+#else
+#define ALLOCATION_COUNTING 0
+#endif
+
+// --- Medição por Fase ---
+
+typedef struct {
+    double wall_ms;
+    double cpu_ms;
+    unsigned long long allocations;
+    unsigned long long bytes;
+    long peak_rss_kb;  // Pico de memória residente do processo ao fim da fase
+    int measured;
+
+    // Valores no início da medição em andamento
+    double wall_start;
+    double cpu_start;
+    unsigned long long allocations_start;
+    unsigned long long bytes_start;
+} PhaseStats;
+
+static PhaseStats phases[PHASE_COUNT];
+
+static const char* phase_keys[PHASE_COUNT] = { "read", "cache", "lex", "parse", "sema", "print_ast", "opt", "codegen" };
+static const char* phase_names[PHASE_COUNT] = {
+    "Leitura", "Cache", "Léxica", "Léxica/Sintática", "Semântica", "Impressão da AST", "Otimização", "Geração de Código"
+};
+
+static double clock_ms(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1.0e6;
+}
+
+static long peak_rss_kb() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+    return usage.ru_maxrss; // Em KB no Linux
+}
+
+void stats_phase_begin(CompilerPhase phase) {
+    PhaseStats* p = &phases[phase];
+    p->wall_start = clock_ms(CLOCK_MONOTONIC);
+    p->cpu_start = clock_ms(CLOCK_PROCESS_CPUTIME_ID);
+    p->allocations_start = alloc_count;
+    p->bytes_start = alloc_bytes;
+}
+
+void stats_phase_end(CompilerPhase phase) {
+    PhaseStats* p = &phases[phase];
+    p->wall_ms += clock_ms(CLOCK_MONOTONIC) - p->wall_start;
+    p->cpu_ms += clock_ms(CLOCK_PROCESS_CPUTIME_ID) - p->cpu_start;
+    p->allocations += alloc_count - p->allocations_start;
+    p->bytes += alloc_bytes - p->bytes_start;
+    p->peak_rss_kb = peak_rss_kb();
+    p->measured = 1;
+}
+
+// --- Relatório ---
+
+static double per_second(double amount, double ms) {
+    return ms > 0.0 ? amount * 1000.0 / ms : 0.0;
+}
+
+// Escreve 'text' alinhado à esquerda em 'width' colunas (o printf conta bytes, não caracteres UTF-8).
+static void print_column(FILE* out, const char* text, int width) {
+    int columns = 0;
+    for (const unsigned char* c = (const unsigned char*)text; *c; c++) {
+        if ((*c & 0xC0) != 0x80) columns++;
+    }
+    fprintf(out, "%s%*s", text, width > columns ? width - columns : 0, "");
+}
+
+static void print_table(FILE* out, const CompilationCounters* counters) {
+    double total_wall = 0.0, total_cpu = 0.0;
+    unsigned long long total_allocations = 0, total_bytes = 0;
+
+    fprintf(out, "\n--- Relatório de Tempo e Memória ---\n");
+    print_column(out, "Fase", 20);
+    fprintf(out, " %12s %12s ", "Real (ms)", "CPU (ms)");
+    print_column(out, "   Alocações", 12);
+    fprintf(out, " %14s %14s\n", "Bytes", "Pico RSS (KB)");
+    for (int i = 0; i < PHASE_COUNT; i++) {
+        PhaseStats* p = &phases[i];
+        if (!p->measured) continue;
+        total_wall += p->wall_ms;
+        total_cpu += p->cpu_ms;
+        total_allocations += p->allocations;
+        total_bytes += p->bytes;
+        print_column(out, phase_names[i], 20);
+        if (ALLOCATION_COUNTING) {
+            fprintf(out, " %12.3f %12.3f %12llu %14llu %14ld\n",
+                    p->wall_ms, p->cpu_ms, p->allocations, p->bytes, p->peak_rss_kb);
+        } else {
+            fprintf(out, " %12.3f %12.3f %12s %14s %14ld\n", p->wall_ms, p->cpu_ms, "n/d", "n/d", p->peak_rss_kb);
+        }
+    }
+    print_column(out, "Total", 20);
+    if (ALLOCATION_COUNTING) {
+        fprintf(out, " %12.3f %12.3f %12llu %14llu %14ld\n",
+                total_wall, total_cpu, total_allocations, total_bytes, peak_rss_kb());
+    } else {
+        fprintf(out, " %12.3f %12.3f %12s %14s %14ld\n", total_wall, total_cpu, "n/d", "n/d", peak_rss_kb());
+    }
+
+    // Percursos do gerenciador de passes: os passes fundidos dividem um só percurso
+    int pass_count;
+    const PassTiming* passes = get_pass_timings(&pass_count);
+    if (pass_count > 0) {
+        fprintf(out, "\n");
+        print_column(out, "Passes", 32);
+        fprintf(out, " %10s ", "Percursos");
+        print_column(out, "         Nós", 12);
+        fprintf(out, " %12s\n", "Real (ms)");
+        for (int i = 0; i < pass_count; i++) {
+            print_column(out, passes[i].name, 32);
+            fprintf(out, " %10d %12ld %12.3f\n", passes[i].runs, passes[i].nodes, passes[i].wall_ms);
+        }
+    }
+
+    // Com --stop-after=lex a vazão é medida sobre a passada somente léxica
+    int lex_only = !phases[PHASE_PARSE].measured;
+    double parse_ms = lex_only ? phases[PHASE_LEX].wall_ms : phases[PHASE_PARSE].wall_ms;
+    if (lex_only && !phases[PHASE_LEX].measured) {
+        // Resultado servido pelo cache: nenhuma fase de análise foi executada
+        fprintf(out, "\nCódigo-fonte: %ld bytes\n", counters->source_bytes);
+        return;
+    }
+    fprintf(out, "\nCódigo-fonte: %ld bytes (%.2f MB/s na análise %s)\n",
+            counters->source_bytes, per_second(counters->source_bytes, parse_ms) / (1024.0 * 1024.0),
+            lex_only ? "léxica" : "sintática");
+    fprintf(out, "Tokens: %d (%.0f tokens/s)\n", counters->tokens, per_second(counters->tokens, parse_ms));
+    fprintf(out, "Nós da AST: %d após a análise sintática, %d após a otimização\n",
+            counters->ast_nodes_parsed, counters->ast_nodes_optimized);
+    fprintf(out, "Tabela de símbolos: %d símbolos, pico de %d de %d buckets usados, cadeia máxima de %d\n",
+            counters->symbols.symbols_added, counters->symbols.peak_buckets_used,
+            counters->symbols.table_size, counters->symbols.max_chain_length);
+}
+
+static void print_json(FILE* out, const CompilationCounters* counters) {
+    fprintf(out, "{\"source_bytes\": %ld, \"tokens\": %d, ", counters->source_bytes, counters->tokens);
+    fprintf(out, "\"ast_nodes\": {\"parsed\": %d, \"optimized\": %d}, ",
+            counters->ast_nodes_parsed, counters->ast_nodes_optimized);
+    fprintf(out, "\"symbol_table\": {\"size\": %d, \"symbols\": %d, \"peak_buckets_used\": %d, \"max_chain_length\": %d}, ",
+            counters->symbols.table_size, counters->symbols.symbols_added,
+            counters->symbols.peak_buckets_used, counters->symbols.max_chain_length);
+    fprintf(out, "\"allocation_counting\": %s, \"peak_rss_kb\": %ld, \"phases\": [",
+            ALLOCATION_COUNTING ? "true" : "false", peak_rss_kb());
+    int first = 1;
+    for (int i = 0; i < PHASE_COUNT; i++) {
+        PhaseStats* p = &phases[i];
+        if (!p->measured) continue;
+        fprintf(out, "%s{\"name\": \"%s\", \"wall_ms\": %.3f, \"cpu_ms\": %.3f, \"allocations\": %llu, \"bytes\": %llu, \"peak_rss_kb\": %ld}",
+                first ? "" : ", ", phase_keys[i], p->wall_ms, p->cpu_ms, p->allocations, p->bytes, p->peak_rss_kb);
+        first = 0;
+    }
+    fprintf(out, "], \"passes\": [");
+    int pass_count;
+    const PassTiming* passes = get_pass_timings(&pass_count);
+    for (int i = 0; i < pass_count; i++) {
+        fprintf(out, "%s{\"name\": \"%s\", \"runs\": %d, \"nodes\": %ld, \"wall_ms\": %.3f}",
+                i ? ", " : "", passes[i].name, passes[i].runs, passes[i].nodes, passes[i].wall_ms);
+    }
+    fprintf(out, "]}\n");
+}
+
+void stats_print_report(FILE* out, int json, const CompilationCounters* counters) {
+    if (json) {
+        print_json(out, counters);
+    } else {
+        print_table(out, counters);
+    }
+}
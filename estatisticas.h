@@ -0,0 +1,45 @@
+#ifndef ESTATISTICAS_H
+#define ESTATISTICAS_H
+
+#include <stdio.h>
+#include "tabela_simbolos.h"
+
+// Fases medidas pelo relatório de tempo (--time-report)
+typedef enum {
+    PHASE_READ,      // Leitura do arquivo-fonte
+    PHASE_CACHE,     // Consulta e gravação do cache de compilação (--cache)
+    PHASE_LEX,       // Passada somente léxica (--stop-after=lex ou --dump-tokens)
+    PHASE_PARSE,     // Análise léxica e sintática (o léxico é chamado sob demanda pelo parser)
+    PHASE_SEMA,      // Análise semântica
+    PHASE_PRINT_AST, // Impressão da AST antes e depois da otimização
+    PHASE_OPT,       // Otimização
+    PHASE_CODEGEN,   // Geração de código
+    PHASE_COUNT
+} CompilerPhase;
+
+// Contadores da compilação, preenchidos pelo driver (main.c)
+typedef struct {
+    long source_bytes;
+    int tokens;
+    int ast_nodes_parsed;
+    int ast_nodes_optimized;
+    SymbolTableStats symbols;
+} CompilationCounters;
+
+/**
+ * @brief Marca o início de uma fase. Tempo real, tempo de CPU e alocações
+ * são acumulados até a chamada correspondente de stats_phase_end (uma fase
+ * pode ser medida várias vezes).
+ */
+void stats_phase_begin(CompilerPhase phase);
+void stats_phase_end(CompilerPhase phase);
+
+/**
+ * @brief Escreve o relatório de tempo e memória por fase.
+ * @param out Destino do relatório (o driver usa stderr).
+ * @param json Se diferente de zero, escreve um objeto JSON em vez da tabela.
+ * @param counters Contadores de tokens, nós da AST e tabela de símbolos.
+ */
+void stats_print_report(FILE* out, int json, const CompilationCounters* counters);
+
+#endif // ESTATISTICAS_H
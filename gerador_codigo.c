@@ -1,28 +1,594 @@
+// Define _DEFAULT_SOURCE para habilitar posix_spawnp e waitpid
+#define _DEFAULT_SOURCE
+
 #include "gerador_codigo.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include "diagnosticos.h"
+#include "perfil_execucao.h"
+
+extern char** environ;
 
 // --- Variáveis de Estado do Gerador ---
 static FILE* outfile;
 static int indent_level = 0;
 
+// Instrumentação (--instrument): perfil gravado pelo programa ao terminar (NULL: desligada)
+static const char* instrument_profile = NULL;
+static unsigned long long instrument_source_hash = 0;
+
 // --- Protótipos de Funções Estáticas ---
 static void gen_node(ASTNode* node);
+static void gen_main(ASTNode* main_node);
+static void gen_function(const char* name, ASTNodeList* params, ASTNode* scope, ASTNode* body);
 static void gen_expression(ASTNode* node);
+static void gen_condition(ASTNode* node);
+static void gen_expression_in(ASTNode* node, int truth_only);
 static void print_indent();
+static const char* python_operator(const char* op);
+static int is_logical_operator(const char* op);
+static int is_integer_division(ASTNode* node);
+static int gen_chain_call(const ASTStack* spine, ASTNode* leftmost);
+static int assignment_state(ASTNode* stmt, const char* name);
+static int spine_parenthesized(const ASTStack* spine, int i);
+static void gen_print(ASTNode* call);
+static void gen_profile_runtime(ASTNode* root);
+static void gen_profile_count(const char* kind, ASTNode* node);
 
 // --- Implementação ---
 
 void generate_code(ASTNode* root, const char* output_filename) {
-    outfile = fopen(output_filename, "w");
-    if (!outfile) {
-        perror("Não foi possível abrir o arquivo de saída para geração de código");
-        exit(EXIT_FAILURE);
+    FILE* out = fopen(output_filename, "w");
+    if (!out) {
+        report_error("Não foi possível abrir o arquivo de saída para geração de código: %s\n", strerror(errno));
+        fatal_error();
+        return;
     }
-    fprintf(outfile, "# --- Código Gerado pelo Compilador ---\n\n");
+    generate_code_to_stream(root, out);
+    fclose(out);
+}
+
+void generate_code_to_stream(ASTNode* root, FILE* out) {
+    outfile = out;
+    indent_level = 0;
+    generate_code_header(outfile);
+    if (instrument_profile) gen_profile_runtime(root);
     gen_node(root);
-    fclose(outfile);
+}
+
+void set_code_instrumentation(const char* profile_filename, unsigned long long source_hash) {
+    instrument_profile = profile_filename;
+    instrument_source_hash = source_hash;
+}
+
+// Runtime emitido no início de todo programa. A saída de 'print' vai para um buffer de
+// 64 KB sobre o descritor da saída padrão, esvaziado quando enche e no fim do programa,
+// em vez de passar pelo 'print' do Python (que formata cada argumento de forma genérica
+// e, num terminal, faz uma escrita por linha). Se a saída padrão não tiver descritor
+// (por exemplo, redirecionada para um objeto em memória), ela é usada diretamente.
+// '__cadeia' aplica da esquerda para a direita as operações de uma cadeia longa demais
+// para o compilador do Python (ver GEN_MAX_CHAIN); um operando que é uma função é
+// avaliado na sua vez.
+static const char* const python_runtime =
+    "import atexit as __atexit, io as __io, sys as __sys\n"
+    "\n"
+    "try:\n"
+    "    __saida = __io.TextIOWrapper(__io.BufferedWriter(__io.FileIO(__sys.stdout.fileno(), \"w\", closefd=False), 1 << 16),\n"
+    "                                 encoding=\"utf-8\", newline=\"\\n\")\n"
+    "    __atexit.register(__saida.flush)\n"
+    "except (AttributeError, OSError, ValueError):\n"
+    "    __saida = __sys.stdout\n"
+    "__escreve = __saida.write\n"
+    "\n"
+    "import operator as __op\n"
+    "\n"
+    "def __divint(a, b):\n"
+    "    return int(a / b)\n"
+    "\n"
+    "def __cadeia(valor, *resto):\n"
+    "    for i in range(0, len(resto), 2):\n"
+    "        operando = resto[i + 1]\n"
+    "        valor = resto[i](valor, operando() if callable(operando) else operando)\n"
+    "    return valor\n"
+    "\n";
+
+// O bytecode é gerado pelo próprio interpretador que vai executá-lo: o formato do .pyc
+// muda a cada versão do CPython. O nome gravado no código (dfile) é o do .py, para que
+// os tracebacks mostrem as linhas do código-fonte gerado.
+static const char* const python_compile_script =
+    "import py_compile, sys\n"
+    "py_compile.compile(sys.argv[1], cfile=sys.argv[2], dfile=sys.argv[1], doraise=True)\n";
+
+// Executa o python3 do PATH e espera o fim. Devolve o código de saída, ou -1 (após
+// mostrar o erro) se ele não puder ser executado ou terminar por um sinal.
+static int run_python3(char* const argv[]) {
+    pid_t pid;
+    int error = posix_spawnp(&pid, "python3", NULL, NULL, argv, environ);
+    if (error != 0) {
+        report_error("Não foi possível executar python3: %s\n", strerror(error));
+        return -1;
+    }
+    int status;
+    while (waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR) {
+            report_error("Falha ao aguardar o python3: %s\n", strerror(errno));
+            return -1;
+        }
+    }
+    if (!WIFEXITED(status)) {
+        report_error("python3 terminou de forma anormal.\n");
+        return -1;
+    }
+    return WEXITSTATUS(status);
+}
+
+int generate_bytecode(const char* source_filename, const char* bytecode_filename) {
+    char* const argv[] = { "python3", "-c", (char*)python_compile_script, (char*)source_filename,
+                           (char*)bytecode_filename, NULL };
+    if (run_python3(argv) != 0) {
+        report_error("python3 não conseguiu gerar o bytecode '%s'.\n", bytecode_filename);
+        return 0;
+    }
+    return 1;
+}
+
+int run_python_program(const char* filename) {
+    char* const argv[] = { "python3", (char*)filename, NULL };
+    fflush(stdout);
+    int status = run_python3(argv);
+    return status < 0 ? 1 : status;
+}
+
+void generate_code_header(FILE* out) {
+    fprintf(out, "# --- Código Gerado pelo Compilador ---\n\n");
+    fputs(python_runtime, out);
+}
+
+void generate_declaration(ASTNode* decl, FILE* out) {
+    outfile = out;
+    indent_level = 0;
+    if (decl->type == NODE_MAIN_DEF) {
+        gen_main(decl);
+    } else {
+        gen_node(decl);
+    }
+}
+
+// O bloco main vira uma função chamada quando o script é executado diretamente: no
+// nível do módulo, as variáveis dele seriam globais, acessadas por busca em dicionário
+static void gen_main(ASTNode* main_node) {
+    fprintf(outfile, "\n");
+    gen_function("main", NULL, main_node, main_node->data.main_def.body);
+    fprintf(outfile, "\n\nif __name__ == \"__main__\":\n");
+    fprintf(outfile, "    main()\n");
+}
+
+// --- Nomes de Cada Função ---
+//
+// Em Python, um nome atribuído em qualquer ponto de uma função é local à função inteira,
+// a menos que seja declarado 'global'; já a linguagem tem escopo de bloco. Antes de
+// emitir uma função, os nomes dela são resolvidos com os mesmos escopos da análise
+// semântica: um nome sem declaração visível é uma variável global do programa (a análise
+// exige que todo nome seja declarado antes do uso), e as escritas nele pedem 'global'.
+// Uma declaração local que esconde outra declaração visível, ou cujo nome a função também
+// usa como global, é emitida com outro nome. Basta olhar a própria função, o que mantém o
+// código de cada declaração independente das demais (compilação incremental).
+
+#define NAME_TABLE_SIZE 211
+
+// Resultados de assignment_state
+#define NAME_UNTOUCHED 0
+#define NAME_ASSIGNED 1
+#define NAME_READ 2
+
+// Operações na espinha esquerda de uma expressão acima das quais ela é emitida como uma
+// chamada a '__cadeia': o compilador do Python percorre 'a + b + ... + z' recursivamente
+// e desiste com alguns milhares de níveis
+#define GEN_MAX_CHAIN 1000
+
+struct FunctionName;
+
+typedef struct Declaration {
+    ASTNode* node;                // NODE_VAR_DECL ou NODE_PARAM
+    struct FunctionName* name;
+    struct Declaration* outer;    // Declaração do mesmo nome que esta esconde
+    char* python_name;            // Nome emitido no lugar do original (ou NULL)
+    struct Declaration* next;     // Próxima declaração da função, na ordem do código
+} Declaration;
+
+typedef struct FunctionName {
+    const char* name;             // Aponta para a string do nó: a árvore não muda na geração
+    Declaration* visible;         // Declaração visível no ponto atual do percurso
+    int declared;                 // Declarado em algum ponto da função
+    int global;                   // Usado como variável global
+    int global_write;             // Atribuído como variável global
+    int called;                   // Função chamada (ou builtin usado pelo código gerado)
+    struct FunctionName* next;    // Próximo no mesmo balde
+    struct FunctionName* order;   // Próximo na ordem em que os nomes apareceram
+} FunctionName;
+
+// Identificador e a declaração a que ele se refere (NULL se for uma global)
+typedef struct {
+    ASTNode* node;
+    Declaration* declaration;
+} NameReference;
+
+typedef struct {
+    FunctionName* buckets[NAME_TABLE_SIZE];
+    FunctionName* first;
+    FunctionName* last;
+    Declaration* first_declaration;
+    Declaration* last_declaration;
+    Declaration** scope_declarations; // Declarações dos escopos abertos, da mais antiga à mais nova
+    int scope_count;
+    int scope_capacity;
+    int* scope_marks;                 // Início de cada escopo aberto em scope_declarations
+    int mark_count;
+    int mark_capacity;
+    NameReference* references;
+    int reference_count;
+    int reference_capacity;
+} FunctionNames;
+
+// Nomes trocados da função em emissão, indexados pelo nó (declaração ou identificador)
+typedef struct {
+    ASTNode* node;
+    const char* name;
+} RenamedNode;
+
+static RenamedNode* renamed_nodes = NULL;
+static int renamed_capacity = 0; // Potência de dois; 0 quando nenhum nome foi trocado
+
+// Nomes do módulo e builtins do Python usados com frequência pelo código gerado (a
+// escrita do runtime, por trás de 'print', e a conversão da divisão inteira). Recebidos
+// como valores padrão de parâmetros, são lidos como variáveis locais, e não buscados a
+// cada uso nos dicionários do módulo e dos builtins.
+static const char* const hot_builtins[] = { "__escreve", "int" };
+
+static void* checked_grow(void* items, int* capacity, size_t item_size) {
+    int grown_capacity = *capacity ? *capacity * 2 : 64;
+    void* grown = realloc(items, grown_capacity * item_size);
+    if (!grown) {
+        report_error("Erro de Memória: falha ao alocar memória na geração de código.\n");
+        fatal_error();
+    }
+    *capacity = grown_capacity;
+    return grown;
+}
+
+static FunctionName* function_name(FunctionNames* names, const char* name, int create) {
+    unsigned long hash = 5381;
+    for (const char* c = name; *c; c++) hash = ((hash << 5) + hash) + (unsigned char)*c;
+    hash %= NAME_TABLE_SIZE;
+    for (FunctionName* n = names->buckets[hash]; n; n = n->next) {
+        if (strcmp(n->name, name) == 0) return n;
+    }
+    if (!create) return NULL;
+    FunctionName* n = (FunctionName*)calloc(1, sizeof(FunctionName));
+    if (!n) {
+        report_error("Erro de Memória: falha ao alocar memória na geração de código.\n");
+        fatal_error();
+    }
+    n->name = name;
+    n->next = names->buckets[hash];
+    names->buckets[hash] = n;
+    if (names->last) {
+        names->last->order = n;
+    } else {
+        names->first = n;
+    }
+    names->last = n;
+    return n;
+}
+
+static void enter_function_scope(FunctionNames* names) {
+    if (names->mark_count == names->mark_capacity) {
+        names->scope_marks = (int*)checked_grow(names->scope_marks, &names->mark_capacity, sizeof(int));
+    }
+    names->scope_marks[names->mark_count++] = names->scope_count;
+}
+
+static void exit_function_scope(FunctionNames* names) {
+    int mark = names->scope_marks[--names->mark_count];
+    while (names->scope_count > mark) {
+        Declaration* d = names->scope_declarations[--names->scope_count];
+        d->name->visible = d->outer;
+    }
+}
+
+static void declare_name(FunctionNames* names, ASTNode* node, const char* name) {
+    Declaration* d = (Declaration*)calloc(1, sizeof(Declaration));
+    if (!d) {
+        report_error("Erro de Memória: falha ao alocar memória na geração de código.\n");
+        fatal_error();
+    }
+    d->node = node;
+    d->name = function_name(names, name, 1);
+    d->outer = d->name->visible;
+    d->name->visible = d;
+    d->name->declared = 1;
+    if (names->last_declaration) {
+        names->last_declaration->next = d;
+    } else {
+        names->first_declaration = d;
+    }
+    names->last_declaration = d;
+    if (names->scope_count == names->scope_capacity) {
+        names->scope_declarations = (Declaration**)checked_grow(names->scope_declarations, &names->scope_capacity,
+                                                                sizeof(Declaration*));
+    }
+    names->scope_declarations[names->scope_count++] = d;
+}
+
+static void reference_name(FunctionNames* names, ASTNode* identifier, int write) {
+    FunctionName* n = function_name(names, identifier->data.identifier_name, 1);
+    if (!n->visible) {
+        n->global = 1;
+        if (write) n->global_write = 1;
+    }
+    if (names->reference_count == names->reference_capacity) {
+        names->references = (NameReference*)checked_grow(names->references, &names->reference_capacity,
+                                                         sizeof(NameReference));
+    }
+    names->references[names->reference_count++] = (NameReference){ identifier, n->visible };
+}
+
+// Percorre a função na ordem da análise semântica (a lista de filhos antes dos filhos
+// diretos). Um NULL na pilha marca o fim de um escopo.
+static void resolve_function_names(ASTNode* scope, FunctionNames* names) {
+    ASTStack stack = {0};
+    ast_stack_push(&stack, scope);
+    while (stack.count > 0) {
+        ASTNode* node = stack.items[--stack.count];
+        if (!node) {
+            exit_function_scope(names);
+            continue;
+        }
+        switch (node->type) {
+            case NODE_FUNC_DEF:
+            case NODE_BLOCK:
+            case NODE_FOR:
+                enter_function_scope(names);
+                ast_stack_push(&stack, NULL);
+                break;
+            case NODE_PARAM:
+                declare_name(names, node, node->data.param.param_name);
+                break;
+            case NODE_VAR_DECL:
+                // Como na análise semântica, o nome já é visível no valor inicial
+                declare_name(names, node, node->data.var_decl.var_name);
+                break;
+            case NODE_IDENTIFIER:
+                reference_name(names, node, 0);
+                break;
+            case NODE_ASSIGN:
+                reference_name(names, node->data.assign_expr.lvalue, 1);
+                if (node->data.assign_expr.rvalue) ast_stack_push(&stack, node->data.assign_expr.rvalue);
+                continue;
+            case NODE_FUNC_CALL:
+                function_name(names, node->data.func_call.func_name, 1)->called = 1;
+                if (strcmp(node->data.func_call.func_name, "print") == 0) {
+                    function_name(names, "__escreve", 1)->called = 1;
+                }
+                break;
+            case NODE_BINARY_OP:
+                if (is_integer_division(node)) function_name(names, "int", 1)->called = 1;
+                break;
+            default:
+                break;
+        }
+        ASTLayout layout = ast_layout(node);
+        for (int i = layout.child_count - 1; i >= 0; i--) {
+            if (*layout.child[i]) ast_stack_push(&stack, *layout.child[i]);
+        }
+        if (layout.list) {
+            int first = stack.count;
+            for (ASTNodeList* l = *layout.list; l; l = l->next) {
+                if (l->node) ast_stack_push(&stack, l->node);
+            }
+            for (int i = first, j = stack.count - 1; i < j; i++, j--) {
+                ASTNode* tmp = stack.items[i];
+                stack.items[i] = stack.items[j];
+                stack.items[j] = tmp;
+            }
+        }
+    }
+    ast_stack_free(&stack);
+}
+
+static void add_renamed_node(ASTNode* node, const char* name) {
+    unsigned long index = ((unsigned long)(size_t)node >> 4) & (renamed_capacity - 1);
+    while (renamed_nodes[index].node) index = (index + 1) & (renamed_capacity - 1);
+    renamed_nodes[index].node = node;
+    renamed_nodes[index].name = name;
+}
+
+// Escolhe um nome livre na função para cada declaração que precisa ser trocada e
+// registra o novo nome para a declaração e para os identificadores que se referem a ela.
+static void rename_declarations(FunctionNames* names) {
+    int count = 0;
+    for (Declaration* d = names->first_declaration; d; d = d->next) {
+        if (!d->outer && !d->name->global) continue;
+        size_t size = strlen(d->name->name) + 16;
+        d->python_name = (char*)malloc(size);
+        if (!d->python_name) {
+            report_error("Erro de Memória: falha ao alocar memória na geração de código.\n");
+            fatal_error();
+        }
+        for (int k = 1; ; k++) {
+            snprintf(d->python_name, size, "%s__%d", d->name->name, k);
+            if (!function_name(names, d->python_name, 0)) break;
+        }
+        function_name(names, d->python_name, 1)->declared = 1;
+        count++;
+    }
+    if (count == 0) return;
+    for (int i = 0; i < names->reference_count; i++) {
+        if (names->references[i].declaration && names->references[i].declaration->python_name) count++;
+    }
+    renamed_capacity = 16;
+    while (renamed_capacity < count * 2) renamed_capacity *= 2;
+    renamed_nodes = (RenamedNode*)calloc(renamed_capacity, sizeof(RenamedNode));
+    if (!renamed_nodes) {
+        report_error("Erro de Memória: falha ao alocar memória na geração de código.\n");
+        fatal_error();
+    }
+    for (Declaration* d = names->first_declaration; d; d = d->next) {
+        if (d->python_name) add_renamed_node(d->node, d->python_name);
+    }
+    for (int i = 0; i < names->reference_count; i++) {
+        Declaration* d = names->references[i].declaration;
+        if (d && d->python_name) add_renamed_node(names->references[i].node, d->python_name);
+    }
+}
+
+// Nome emitido para uma declaração ou identificador da função em emissão
+static const char* python_name(ASTNode* node, const char* name) {
+    if (renamed_capacity == 0) return name;
+    unsigned long index = ((unsigned long)(size_t)node >> 4) & (renamed_capacity - 1);
+    while (renamed_nodes[index].node) {
+        if (renamed_nodes[index].node == node) return renamed_nodes[index].name;
+        index = (index + 1) & (renamed_capacity - 1);
+    }
+    return name;
+}
+
+static void free_function_names(FunctionNames* names) {
+    FunctionName* n = names->first;
+    while (n) {
+        FunctionName* next = n->order;
+        free(n);
+        n = next;
+    }
+    Declaration* d = names->first_declaration;
+    while (d) {
+        Declaration* next = d->next;
+        free(d->python_name);
+        free(d);
+        d = next;
+    }
+    free(names->scope_declarations);
+    free(names->scope_marks);
+    free(names->references);
+    free(renamed_nodes);
+    renamed_nodes = NULL;
+    renamed_capacity = 0;
+}
+
+// Emite o 'def', com os builtins ligados a locais, as declarações 'global' e o corpo.
+// 'scope' é o nó cujos nomes pertencem à função (a definição, com os parâmetros).
+static void gen_function(const char* name, ASTNodeList* params, ASTNode* scope, ASTNode* body) {
+    FunctionNames names;
+    memset(&names, 0, sizeof(names));
+    resolve_function_names(scope, &names);
+    rename_declarations(&names);
+
+    print_indent();
+    fprintf(outfile, "def %s(", name);
+    const char* separator = "";
+    for (ASTNodeList* l = params; l; l = l->next) {
+        fprintf(outfile, "%s%s", separator, python_name(l->node, l->node->data.param.param_name));
+        separator = ", ";
+    }
+    for (size_t i = 0; i < sizeof(hot_builtins) / sizeof(hot_builtins[0]); i++) {
+        FunctionName* n = function_name(&names, hot_builtins[i], 0);
+        if (n && n->called && !n->declared && !n->global) {
+            fprintf(outfile, "%s%s=%s", separator, n->name, n->name);
+            separator = ", ";
+        }
+    }
+    fprintf(outfile, "):\n");
+    indent_level++;
+
+    int globals = 0;
+    for (FunctionName* n = names.first; n; n = n->order) {
+        if (!n->global_write) continue;
+        if (globals++ == 0) {
+            print_indent();
+            fprintf(outfile, "global %s", n->name);
+        } else {
+            fprintf(outfile, ", %s", n->name);
+        }
+    }
+    if (globals > 0) fprintf(outfile, "\n");
+    if (instrument_profile && scope->type == NODE_FUNC_DEF) gen_profile_count(PROFILE_CALLS, scope);
+
+    gen_node(body);
+    indent_level--;
+    free_function_names(&names);
+}
+
+// --- Instrumentação ---
+//
+// Os contadores ficam em um dicionário indexado pelos mesmos textos das linhas do
+// perfil ("chamadas f", "entao 12 5"), criado já com todos os locais do programa, para
+// que os nunca executados apareçam no perfil com zero.
+
+static void gen_profile_key(const char* kind, ASTNode* node) {
+    if (node->type == NODE_FUNC_DEF) {
+        fprintf(outfile, "\"%s %s\"", kind, node->data.func_def.func_name);
+    } else {
+        fprintf(outfile, "\"%s %d %d\"", kind, node->pos.line, node->pos.column);
+    }
+}
+
+static void gen_profile_count(const char* kind, ASTNode* node) {
+    print_indent();
+    fprintf(outfile, "__perfil[");
+    gen_profile_key(kind, node);
+    fprintf(outfile, "] += 1\n");
+}
+
+static void gen_python_string(const char* text) {
+    fputc('"', outfile);
+    for (const char* c = text; *c; c++) {
+        if (*c == '"' || *c == '\\') fputc('\\', outfile);
+        fputc(*c, outfile);
+    }
+    fputc('"', outfile);
+}
+
+static void gen_profile_runtime(ASTNode* root) {
+    fprintf(outfile, "__perfil = dict.fromkeys((\n");
+    ASTStack stack = {0};
+    ast_stack_push(&stack, root);
+    while (stack.count > 0) {
+        ASTNode* node = stack.items[--stack.count];
+        if (node->type == NODE_FUNC_DEF) {
+            fprintf(outfile, "    ");
+            gen_profile_key(PROFILE_CALLS, node);
+            fprintf(outfile, ",\n");
+        } else if (node->type == NODE_IF) {
+            const char* kinds[] = { PROFILE_THEN, PROFILE_ELSE };
+            for (int i = 0; i < 2; i++) {
+                fprintf(outfile, "    ");
+                gen_profile_key(kinds[i], node);
+                fprintf(outfile, ",\n");
+            }
+        }
+        ASTLayout layout = ast_layout(node);
+        for (int i = layout.child_count - 1; i >= 0; i--) {
+            if (*layout.child[i]) ast_stack_push(&stack, *layout.child[i]);
+        }
+        if (layout.list) {
+            for (ASTNodeList* l = *layout.list; l; l = l->next) ast_stack_push(&stack, l->node);
+        }
+    }
+    ast_stack_free(&stack);
+    fprintf(outfile, "), 0)\n\n\n");
+    // Registrado depois do esvaziamento da saída, roda antes dele (atexit é LIFO)
+    fprintf(outfile, "def __grava_perfil():\n");
+    fprintf(outfile, "    with open(");
+    gen_python_string(instrument_profile);
+    fprintf(outfile, ", \"w\", encoding=\"utf-8\") as __arquivo:\n");
+    fprintf(outfile, "        __arquivo.write(\"%s\\nfonte %016llx\\n\")\n", PROFILE_HEADER, instrument_source_hash);
+    fprintf(outfile, "        __arquivo.writelines(\"%%s %%d\\n\" %% __contagem for __contagem in __perfil.items())\n");
+    fprintf(outfile, "\n\n__atexit.register(__grava_perfil)\n\n");
 }
 
 static void print_indent() {
@@ -43,17 +609,12 @@ static void gen_node(ASTNode* node) {
                     gen_node(l->node);
                 }
             }
-            if (main_node) {
-                fprintf(outfile, "\n\nif __name__ == \"__main__\":\n");
-                indent_level++;
-                gen_node(main_node->data.main_def.body);
-                indent_level--;
-            }
+            if (main_node) gen_main(main_node);
             break;
         }
         case NODE_VAR_DECL:
             print_indent();
-            fprintf(outfile, "%s", node->data.var_decl.var_name);
+            fprintf(outfile, "%s", python_name(node, node->data.var_decl.var_name));
             if (node->data.var_decl.initial_value) {
                 fprintf(outfile, " = ");
                 gen_expression(node->data.var_decl.initial_value);
@@ -64,16 +625,7 @@ static void gen_node(ASTNode* node) {
             break;
         case NODE_FUNC_DEF:
             fprintf(outfile, "\n");
-            print_indent();
-            fprintf(outfile, "def %s(", node->data.func_def.func_name);
-            for (ASTNodeList* l = node->data.func_def.params; l; l = l->next) {
-                fprintf(outfile, "%s", l->node->data.param.param_name);
-                if (l->next) fprintf(outfile, ", ");
-            }
-            fprintf(outfile, "):\n");
-            indent_level++;
-            gen_node(node->data.func_def.body);
-            indent_level--;
+            gen_function(node->data.func_def.func_name, node->data.func_def.params, node, node->data.func_def.body);
             break;
         case NODE_BLOCK:
             if (node->data.block.statements == NULL) {
@@ -81,26 +633,63 @@ static void gen_node(ASTNode* node) {
                 fprintf(outfile, "pass\n");
             } else {
                 for (ASTNodeList* l = node->data.block.statements; l; l = l->next) {
-                    gen_node(l->node);
+                    ASTNode* stmt = l->node;
+                    // 'int x;' seguido de um comando que atribui x em todo caminho antes de
+                    // lê-lo (como a variável de resultado de uma expansão inline) não
+                    // precisa do 'x = None'
+                    if (stmt && stmt->type == NODE_VAR_DECL && !stmt->data.var_decl.initial_value &&
+                        l->next && l->next->node &&
+                        assignment_state(l->next->node, stmt->data.var_decl.var_name) == NAME_ASSIGNED) {
+                        continue;
+                    }
+                    gen_node(stmt);
                 }
             }
             break;
         case NODE_IF:
             print_indent();
             fprintf(outfile, "if ");
-            gen_expression(node->data.if_stmt.condition);
+            gen_condition(node->data.if_stmt.condition);
             fprintf(outfile, ":\n");
             indent_level++;
+            if (instrument_profile) gen_profile_count(PROFILE_THEN, node);
             gen_node(node->data.if_stmt.if_body);
             indent_level--;
-            if (node->data.if_stmt.else_body) {
+            if (node->data.if_stmt.else_body || instrument_profile) {
                 print_indent();
                 fprintf(outfile, "else:\n");
                 indent_level++;
+                if (instrument_profile) gen_profile_count(PROFILE_ELSE, node);
                 gen_node(node->data.if_stmt.else_body);
                 indent_level--;
             }
             break;
+        case NODE_FOR:
+            // for(init; cond; inc) corpo  =>  init; while cond: corpo; inc
+            // (a linguagem não tem 'continue', então o incremento no fim do corpo é equivalente)
+            gen_node(node->data.for_stmt.init);
+            print_indent();
+            fprintf(outfile, "while ");
+            if (node->data.for_stmt.condition) {
+                gen_condition(node->data.for_stmt.condition);
+            } else {
+                fprintf(outfile, "True");
+            }
+            fprintf(outfile, ":\n");
+            indent_level++;
+            gen_node(node->data.for_stmt.body);
+            gen_node(node->data.for_stmt.increment);
+            indent_level--;
+            break;
+        case NODE_WHILE:
+            print_indent();
+            fprintf(outfile, "while ");
+            gen_condition(node->data.while_stmt.condition);
+            fprintf(outfile, ":\n");
+            indent_level++;
+            gen_node(node->data.while_stmt.body);
+            indent_level--;
+            break;
         case NODE_RETURN:
             print_indent();
             fprintf(outfile, "return ");
@@ -118,29 +707,241 @@ static void gen_node(ASTNode* node) {
 }
 
 static void gen_expression(ASTNode* node) {
+    gen_expression_in(node, 0);
+}
+
+// Condição de 'if', 'while' e 'for': só o valor-verdade importa, então '&&' e '||' saem
+// como 'and' e 'or' sem a conversão para 0 ou 1
+static void gen_condition(ASTNode* node) {
+    gen_expression_in(node, 1);
+}
+
+// Se o i-ésimo nó da espinha (ou o operando mais à esquerda, com i == spine->count) só
+// tem o valor-verdade usado: a raiz herda o contexto, os demais são o operando esquerdo
+// do nó acima.
+static int spine_truth_only(const ASTStack* spine, int i, int truth_only) {
+    return i == 0 ? truth_only : is_logical_operator(spine->items[i - 1]->data.binary_op.op);
+}
+
+// Emite o float com a menor quantidade de dígitos que o Python lê de volta como o mesmo
+// double, sempre com '.' ou expoente para que não vire um int. Um infinito (de um
+// literal como 1e400) sai como 1e999, que o Python também lê como infinito.
+static void gen_float_literal(double value) {
+    if (isinf(value)) {
+        fprintf(outfile, value > 0 ? "1e999" : "(-1e999)");
+        return;
+    }
+    char text[32];
+    for (int precision = 1; precision <= 17; precision++) {
+        snprintf(text, sizeof(text), "%.*g", precision, value);
+        if (strtod(text, NULL) == value) break;
+    }
+    fprintf(outfile, strpbrk(text, ".en") ? "%s" : "%s.0", text);
+}
+
+// Precedência no Python dos operadores aritméticos emitidos sem conversão (0 para os
+// demais: comparações, que o Python encadeia, e operadores lógicos)
+static int arithmetic_precedence(ASTNode* op) {
+    const char* name = op->data.binary_op.op;
+    if (is_integer_division(op)) return 0;
+    if (strcmp(name, "*") == 0 || strcmp(name, "/") == 0) return 3;
+    if (strcmp(name, "+") == 0 || strcmp(name, "-") == 0) return 2;
+    if (strcmp(name, "<<") == 0) return 1;
+    return 0;
+}
+
+// Os parênteses da operação 'i' da espinha só são omitidos quando ela é o operando
+// esquerdo de uma operação aritmética de precedência igual ou menor: 'a + b + c' e
+// 'a * b + c' saem sem aninhar parênteses, que o Python limita a 200 níveis. A raiz
+// da espinha mantém os seus.
+static int spine_parenthesized(const ASTStack* spine, int i) {
+    if (i == 0) return 1;
+    int precedence = arithmetic_precedence(spine->items[i]);
+    int parent = arithmetic_precedence(spine->items[i - 1]);
+    return precedence == 0 || parent == 0 || precedence < parent;
+}
+
+// Função do módulo operator que faz a operação, ou NULL para '&&' e '||', que não
+// avaliam o operando direito sempre
+static const char* operator_function(ASTNode* op) {
+    static const char* const names[][2] = {
+        { "+", "__op.add" }, { "-", "__op.sub" }, { "*", "__op.mul" }, { "/", "__op.truediv" },
+        { "<<", "__op.lshift" }, { "==", "__op.eq" }, { "!=", "__op.ne" }, { "<", "__op.lt" },
+        { ">", "__op.gt" }, { "<=", "__op.le" }, { ">=", "__op.ge" },
+    };
+    if (is_integer_division(op)) return "__divint";
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        if (strcmp(op->data.binary_op.op, names[i][0]) == 0) return names[i][1];
+    }
+    return NULL;
+}
+
+static int contains_call(ASTNode* node) {
+    ASTStack pending = {0};
+    int found = 0;
+    ast_stack_push(&pending, node);
+    while (!found && pending.count > 0) {
+        ASTNode* n = pending.items[--pending.count];
+        if (!n) continue;
+        if (n->type == NODE_FUNC_CALL) found = 1;
+        else if (n->type == NODE_BINARY_OP) {
+            ast_stack_push(&pending, n->data.binary_op.left);
+            ast_stack_push(&pending, n->data.binary_op.right);
+        } else if (n->type == NODE_UNARY_OP) {
+            ast_stack_push(&pending, n->data.unary_op.operand);
+        }
+    }
+    ast_stack_free(&pending);
+    return found;
+}
+
+// Emite uma espinha longa como '__cadeia(x0, op1, x1, ...)'. Para manter a ordem de
+// avaliação (e de erros) da expressão aninhada, um operando que pode falhar ou chamar
+// uma função vai como 'lambda: ...', avaliado só na vez da sua operação; literais, e
+// variáveis quando a cadeia não tem chamadas, são passados direto. Devolve 0, sem
+// emitir nada, se a espinha tem '&&' ou '||'.
+static int gen_chain_call(const ASTStack* spine, ASTNode* leftmost) {
+    for (int i = 0; i < spine->count; i++) {
+        if (!operator_function(spine->items[i])) return 0;
+    }
+    int calls = contains_call(spine->items[0]);
+    fprintf(outfile, "__cadeia(");
+    gen_expression(leftmost);
+    for (int i = spine->count - 1; i >= 0; i--) {
+        ASTNode* right = spine->items[i]->data.binary_op.right;
+        int direct = right->type == NODE_INT_LITERAL || right->type == NODE_FLOAT_LITERAL ||
+                     right->type == NODE_STRING_LITERAL || (right->type == NODE_IDENTIFIER && !calls);
+        fprintf(outfile, ", %s, %s", operator_function(spine->items[i]), direct ? "" : "lambda: ");
+        gen_expression(right);
+    }
+    fprintf(outfile, ")");
+    return 1;
+}
+
+// O nome aparece na subárvore (lido, atribuído ou declarado de novo)
+static int mentions_name(ASTNode* node, const char* name) {
+    ASTStack pending = {0};
+    int found = 0;
+    ast_stack_push(&pending, node);
+    while (!found && pending.count > 0) {
+        ASTNode* n = pending.items[--pending.count];
+        if (n->type == NODE_IDENTIFIER) found = strcmp(n->data.identifier_name, name) == 0;
+        else if (n->type == NODE_VAR_DECL) found = strcmp(n->data.var_decl.var_name, name) == 0;
+        ASTLayout layout = ast_layout(n);
+        for (int i = 0; i < layout.child_count; i++) {
+            if (*layout.child[i]) ast_stack_push(&pending, *layout.child[i]);
+        }
+        if (layout.list) {
+            for (ASTNodeList* l = *layout.list; l; l = l->next) {
+                if (l->node) ast_stack_push(&pending, l->node);
+            }
+        }
+    }
+    ast_stack_free(&pending);
+    return found;
+}
+
+// O que o comando faz com a variável 'name' antes de qualquer leitura: nada
+// (NAME_UNTOUCHED), uma atribuição em todo caminho (NAME_ASSIGNED), ou algo que pode
+// lê-la (NAME_READ; na dúvida, como em laços, é o resultado).
+static int assignment_state(ASTNode* stmt, const char* name) {
+    switch (stmt->type) {
+        case NODE_ASSIGN:
+            if (strcmp(stmt->data.assign_expr.lvalue->data.identifier_name, name) != 0) break;
+            return mentions_name(stmt->data.assign_expr.rvalue, name) ? NAME_READ : NAME_ASSIGNED;
+        case NODE_BLOCK:
+            for (ASTNodeList* l = stmt->data.block.statements; l; l = l->next) {
+                int state = l->node ? assignment_state(l->node, name) : NAME_UNTOUCHED;
+                if (state != NAME_UNTOUCHED) return state;
+            }
+            return NAME_UNTOUCHED;
+        case NODE_IF: {
+            if (mentions_name(stmt->data.if_stmt.condition, name)) return NAME_READ;
+            int then_state = assignment_state(stmt->data.if_stmt.if_body, name);
+            int else_state = stmt->data.if_stmt.else_body ? assignment_state(stmt->data.if_stmt.else_body, name)
+                                                          : NAME_UNTOUCHED;
+            if (then_state == else_state) return then_state;
+            return NAME_READ;
+        }
+        default:
+            break;
+    }
+    return mentions_name(stmt, name) ? NAME_READ : NAME_UNTOUCHED;
+}
+
+// 'truth_only': o valor da expressão só é usado como valor-verdade.
+static void gen_expression_in(ASTNode* node, int truth_only) {
     if (!node) return;
     switch (node->type) {
         case NODE_INT_LITERAL: fprintf(outfile, "%d", node->data.int_literal); break;
-        case NODE_FLOAT_LITERAL: fprintf(outfile, "%f", node->data.float_literal); break;
+        case NODE_FLOAT_LITERAL: gen_float_literal(node->data.float_literal); break;
         // <<< MODIFICAÇÃO: Adicionado suporte para strings >>>
         case NODE_STRING_LITERAL:
             // Imprime a string entre aspas, que é uma sintaxe válida em Python
             fprintf(outfile, "\"%s\"", node->data.string_literal);
             break;
-        case NODE_IDENTIFIER: fprintf(outfile, "%s", node->data.identifier_name); break;
+        case NODE_IDENTIFIER: fprintf(outfile, "%s", python_name(node, node->data.identifier_name)); break;
         case NODE_ASSIGN:
             gen_expression(node->data.assign_expr.lvalue);
             fprintf(outfile, " = ");
             gen_expression(node->data.assign_expr.rvalue);
             break;
-        case NODE_BINARY_OP:
-            fprintf(outfile, "(");
-            gen_expression(node->data.binary_op.left);
-            fprintf(outfile, " %s ", node->data.binary_op.op);
-            gen_expression(node->data.binary_op.right);
+        case NODE_BINARY_OP: {
+            // A espinha esquerda ('a + a + ... + a') é emitida em laço: primeiro as
+            // aberturas de todas as operações, da raiz para a base, depois o operando
+            // mais à esquerda e, da base para a raiz, cada operador e operando direito.
+            //
+            // Na linguagem, '&&' e '||' valem 0 ou 1 (como no otimizador), enquanto 'and' e
+            // 'or' do Python devolvem um dos operandos: fora de uma condição, o resultado
+            // é convertido com '(1 if (a and b) else 0)'. Os operandos de um operador
+            // lógico só são usados pelo valor-verdade.
+            ASTStack spine = {0};
+            ASTNode* leftmost = ast_left_spine(node, &spine);
+            if (spine.count > GEN_MAX_CHAIN && gen_chain_call(&spine, leftmost)) {
+                ast_stack_free(&spine);
+                break;
+            }
+            for (int i = 0; i < spine.count; i++) {
+                ASTNode* op = spine.items[i];
+                if (is_logical_operator(op->data.binary_op.op) && !spine_truth_only(&spine, i, truth_only)) {
+                    fprintf(outfile, "(1 if (");
+                } else if (is_integer_division(op)) {
+                    // Divisão inteira da linguagem trunca em direção a zero, como em C (e no otimizador)
+                    fprintf(outfile, "int(");
+                } else if (spine_parenthesized(&spine, i)) {
+                    fprintf(outfile, "(");
+                }
+            }
+            gen_expression_in(leftmost, spine_truth_only(&spine, spine.count, truth_only));
+            for (int i = spine.count - 1; i >= 0; i--) {
+                ASTNode* op = spine.items[i];
+                int logical = is_logical_operator(op->data.binary_op.op);
+                fprintf(outfile, " %s ", python_operator(op->data.binary_op.op));
+                gen_expression_in(op->data.binary_op.right, logical);
+                if (logical && !spine_truth_only(&spine, i, truth_only)) {
+                    fprintf(outfile, ") else 0)");
+                } else if (is_integer_division(op) || spine_parenthesized(&spine, i)) {
+                    fprintf(outfile, ")");
+                }
+            }
+            ast_stack_free(&spine);
+            break;
+        }
+        case NODE_UNARY_OP:
+            if (strcmp(node->data.unary_op.op, "!") == 0) {
+                fprintf(outfile, "(not ");
+                gen_expression_in(node->data.unary_op.operand, 1);
+            } else {
+                fprintf(outfile, "(%s", node->data.unary_op.op);
+                gen_expression(node->data.unary_op.operand);
+            }
             fprintf(outfile, ")");
             break;
         case NODE_FUNC_CALL:
+            if (strcmp(node->data.func_call.func_name, "print") == 0) {
+                gen_print(node);
+                break;
+            }
             fprintf(outfile, "%s(", node->data.func_call.func_name);
             for (ASTNodeList* l = node->data.func_call.args; l; l = l->next) {
                 gen_expression(l->node);
@@ -152,3 +953,43 @@ static void gen_expression(ASTNode* node) {
             break;
     }
 }
+
+// 'print' escreve direto no buffer do runtime: uma string literal já sai com a quebra
+// de linha, e uma expressão que certamente é inteira (ast_is_integer) é formatada com
+// %d, sem o caminho genérico do 'print'. O tipo anotado sozinho não basta: %d trunca um
+// float que tenha chegado a uma expressão anotada como int.
+static void gen_print(ASTNode* call) {
+    ASTNodeList* args = call->data.func_call.args;
+    if (!args) {
+        fprintf(outfile, "__escreve(\"\\n\")");
+    } else if (args->next) {
+        // Mais de um argumento: separados por espaço, como no 'print' do Python
+        fprintf(outfile, "print(");
+        for (ASTNodeList* l = args; l; l = l->next) {
+            gen_expression(l->node);
+            fprintf(outfile, ", ");
+        }
+        fprintf(outfile, "file=__saida)");
+    } else if (args->node->type == NODE_STRING_LITERAL) {
+        fprintf(outfile, "__escreve(\"%s\\n\")", args->node->data.string_literal);
+    } else {
+        fprintf(outfile, ast_is_integer(args->node) ? "__escreve(\"%%d\\n\" %% (" : "__escreve(\"%%s\\n\" %% (");
+        gen_expression(args->node);
+        fprintf(outfile, ",))");
+    }
+}
+
+static int is_integer_division(ASTNode* node) {
+    return strcmp(node->data.binary_op.op, "/") == 0 && node->value_type == TYPE_INT;
+}
+
+static int is_logical_operator(const char* op) {
+    return strcmp(op, "&&") == 0 || strcmp(op, "||") == 0;
+}
+
+// Traduz os operadores lógicos da linguagem para as palavras-chave do Python.
+static const char* python_operator(const char* op) {
+    if (strcmp(op, "&&") == 0) return "and";
+    if (strcmp(op, "||") == 0) return "or";
+    return op;
+}
@@ -1,6 +1,7 @@
 #ifndef GERADOR_CODIGO_H
 #define GERADOR_CODIGO_H
 
+#include <stdio.h>
 #include "ast.h"
 
 /**
@@ -15,4 +16,41 @@
  */
 void generate_code(ASTNode* root, const char* output_filename);
 
+/**
+ * @brief Igual a generate_code, mas escreve em um stream já aberto (por exemplo,
+ * um buffer em memória criado com open_memstream).
+ */
+void generate_code_to_stream(ASTNode* root, FILE* out);
+
+/**
+ * @brief Liga (ou, com NULL, desliga) a instrumentação do código gerado: contadores de
+ * chamadas por função e de ramos por 'if', gravados em 'profile_filename' quando o
+ * programa termina (formato descrito em perfil_execucao.h).
+ * @param source_hash Hash do código-fonte gravado no perfil (0 se desconhecido).
+ */
+void set_code_instrumentation(const char* profile_filename, unsigned long long source_hash);
+
+/**
+ * @brief Compila o código Python gerado para bytecode (.pyc) com o py_compile do python3
+ * do PATH, para que o programa rode sem a análise e a compilação do Python na partida
+ * (python3 output.pyc). O .py continua sendo a referência dos tracebacks.
+ * @return 0 (após mostrar o erro) se o python3 não puder ser executado ou falhar.
+ */
+int generate_bytecode(const char* source_filename, const char* bytecode_filename);
+
+/**
+ * @brief Executa um programa gerado com o python3 do PATH (usado quando o JIT não pode
+ * executar o programa) e espera o fim.
+ * @return O código de saída do python3, ou 1 se ele não puder ser executado.
+ */
+int run_python_program(const char* filename);
+
+/**
+ * @brief Partes de generate_code usadas pela compilação incremental, que monta o
+ * arquivo de saída a partir do código de cada declaração: o cabeçalho do arquivo
+ * e o código de uma única declaração de topo (o main deve ser emitido por último).
+ */
+void generate_code_header(FILE* out);
+void generate_declaration(ASTNode* decl, FILE* out);
+
 #endif // GERADOR_CODIGO_H
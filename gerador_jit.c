@@ -0,0 +1,1421 @@
+// Define _DEFAULT_SOURCE para habilitar mmap com MAP_ANONYMOUS
+#define _DEFAULT_SOURCE
+
+#include "gerador_jit.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <setjmp.h>
+#include <math.h>
+#include "diagnosticos.h"
+
+#if defined(__x86_64__) && defined(__linux__)
+
+#include <sys/mman.h>
+
+// A tradução é recursiva: árvores mais profundas que isso ficam com o Python
+#define JIT_MAX_DEPTH 10000
+// Profundidade de chamadas a partir da qual a execução é abandonada: o Python encerra
+// com RecursionError perto de 1000 quadros, e é ele quem decide o que acontece
+#define JIT_MAX_CALL_DEPTH 900
+#define NAME_BUCKETS 1024
+
+typedef enum { JT_UNKNOWN, JT_INT, JT_FLOAT, JT_NONE } JitType;
+
+// Registradores usados pelo código gerado: rax/xmm0 guardam o resultado da expressão,
+// rcx/xmm1 o operando direito, rdx o indicador de None devolvido pelas funções, rbx a
+// pilha antes de chamar as funções em C, r14 a profundidade de chamadas e r15 a base
+// das variáveis globais
+enum { REG_RAX = 0, REG_RCX = 1, REG_RDX = 2, REG_RBX = 3, REG_RBP = 5, REG_R14 = 14, REG_R15 = 15 };
+
+// Condições dos saltos (jcc) e de setcc
+enum {
+    CC_O = 0x0, CC_AE = 0x3, CC_E = 0x4, CC_NE = 0x5, CC_A = 0x7, CC_P = 0xA, CC_NP = 0xB,
+    CC_L = 0xC, CC_GE = 0xD, CC_LE = 0xE, CC_G = 0xF, CC_ALWAYS = -1
+};
+
+typedef enum {
+    TRAP_OVERFLOW, TRAP_DIVISION, TRAP_PRECISION, TRAP_UNDEFINED, TRAP_NONE, TRAP_DEPTH, TRAP_COUNT
+} TrapReason;
+
+static const char* const trap_messages[TRAP_COUNT] = {
+    [TRAP_OVERFLOW] = "resultado inteiro fora dos 64 bits",
+    [TRAP_DIVISION] = "divisão por zero",
+    [TRAP_PRECISION] = "inteiro grande demais para a divisão ou comparação em ponto flutuante",
+    [TRAP_UNDEFINED] = "variável lida antes de receber um valor (None em Python)",
+    [TRAP_NONE] = "resultado de função sem 'return' com valor usado em uma expressão",
+    [TRAP_DEPTH] = "recursão profunda demais",
+};
+
+typedef struct JitVar {
+    JitType type;         // Inferido dos valores atribuídos (JT_UNKNOWN até lá)
+    JitType declared;     // Tipo da declaração, usado se nenhum valor tiver tipo conhecido
+    int base;             // REG_RBP (parâmetros e locais) ou REG_R15 (globais)
+    int32_t disp;
+    int32_t flag_disp;    // Indicador de valor atribuído (só com has_flag)
+    int has_flag;         // Pode valer None: local declarada sem valor inicial, ou global
+    int may_bool;         // Pode guardar um bool do Python (resultado de comparação)
+    int in_initializer;   // Em resolução do próprio valor inicial
+    struct JitVar* next;
+} JitVar;
+
+typedef struct JitFunction {
+    ASTNode* node;        // NODE_FUNC_DEF ou NODE_MAIN_DEF
+    JitVar** params;
+    int param_count;
+    int slot_count;       // Posições de 8 bytes no quadro (locais e indicadores)
+    JitType return_type;  // Inferido dos 'return' (JT_NONE se nenhum tem valor)
+    int has_value;        // Algum 'return' tem valor
+    int returns_bool;
+    size_t offset;        // Início do código da função
+    struct JitFunction* next;
+} JitFunction;
+
+// Nome visível; as entradas formam uma pilha, desfeita ao sair de cada escopo
+typedef struct {
+    const char* name;
+    JitVar* var;
+    JitFunction* function;
+    int next;             // Entrada anterior no mesmo balde (-1 no fim)
+} ScopeEntry;
+
+typedef struct {
+    ASTNode* key;
+    void* value;
+} NodeSlot;
+
+// Texto de um print de string literal, com a quebra de linha
+typedef struct JitText {
+    struct JitText* next;
+    size_t length;
+    char text[];
+} JitText;
+
+typedef struct {
+    unsigned char* code;
+    size_t size;
+    size_t capacity;
+    size_t traps[TRAP_COUNT];
+    ScopeEntry* entries;
+    int entry_count;
+    int entry_capacity;
+    int buckets[NAME_BUCKETS];
+    int* marks;
+    int mark_count;
+    int mark_capacity;
+    NodeSlot* nodes;      // Identificador ou declaração -> JitVar; chamada -> JitFunction
+    size_t node_count;
+    size_t node_capacity;
+    JitVar* vars;
+    JitFunction* functions;
+    JitFunction* last_function;
+    JitFunction* current; // Função em resolução ou compilação (NULL: inicialização das globais)
+    int global_count;
+    JitText* texts;
+    char* reason;
+    size_t reason_size;
+    jmp_buf abort;
+} JitCompiler;
+
+static void unsupported(JitCompiler* c, ASTNode* node, const char* format, ...) {
+    int used = node ? snprintf(c->reason, c->reason_size, "linha %d: ", node->pos.line) : 0;
+    if (used < 0 || (size_t)used >= c->reason_size) used = 0;
+    va_list args;
+    va_start(args, format);
+    vsnprintf(c->reason + used, c->reason_size - used, format, args);
+    va_end(args);
+    longjmp(c->abort, 1);
+}
+
+static void* jit_alloc(size_t size) {
+    void* memory = calloc(1, size);
+    if (!memory) {
+        report_error("Erro de Memória: falha ao alocar memória no JIT.\n");
+        fatal_error();
+    }
+    return memory;
+}
+
+static void* jit_grow(void* items, size_t* capacity, size_t item_size) {
+    size_t grown_capacity = *capacity ? *capacity * 2 : 64;
+    void* grown = realloc(items, grown_capacity * item_size);
+    if (!grown) {
+        report_error("Erro de Memória: falha ao alocar memória no JIT.\n");
+        fatal_error();
+    }
+    *capacity = grown_capacity;
+    return grown;
+}
+
+// --- Tabela de Nós ---
+
+static size_t node_hash(ASTNode* node, size_t capacity) {
+    return ((size_t)node >> 4) * 2654435761u & (capacity - 1);
+}
+
+static void map_node(JitCompiler* c, ASTNode* node, void* value) {
+    if ((c->node_count + 1) * 2 > c->node_capacity) {
+        size_t old_capacity = c->node_capacity;
+        NodeSlot* old = c->nodes;
+        c->node_capacity = old_capacity ? old_capacity * 2 : 256;
+        c->nodes = (NodeSlot*)jit_alloc(c->node_capacity * sizeof(NodeSlot));
+        for (size_t i = 0; i < old_capacity; i++) {
+            if (!old[i].key) continue;
+            size_t index = node_hash(old[i].key, c->node_capacity);
+            while (c->nodes[index].key) index = (index + 1) & (c->node_capacity - 1);
+            c->nodes[index] = old[i];
+        }
+        free(old);
+    }
+    size_t index = node_hash(node, c->node_capacity);
+    while (c->nodes[index].key && c->nodes[index].key != node) index = (index + 1) & (c->node_capacity - 1);
+    if (!c->nodes[index].key) c->node_count++;
+    c->nodes[index].key = node;
+    c->nodes[index].value = value;
+}
+
+static void* node_value(JitCompiler* c, ASTNode* node) {
+    if (c->node_capacity == 0) return NULL;
+    size_t index = node_hash(node, c->node_capacity);
+    while (c->nodes[index].key) {
+        if (c->nodes[index].key == node) return c->nodes[index].value;
+        index = (index + 1) & (c->node_capacity - 1);
+    }
+    return NULL;
+}
+
+// --- Escopos ---
+//
+// Os nomes são resolvidos com os mesmos escopos da análise semântica (programa, função,
+// bloco e 'for'), e cada declaração recebe a sua própria posição. Isso equivale aos
+// nomes do output.py, onde o gerador troca o nome das locais que escondem outras.
+
+static unsigned name_bucket(const char* name) {
+    unsigned long hash = 5381;
+    for (const char* p = name; *p; p++) hash = ((hash << 5) + hash) + (unsigned char)*p;
+    return (unsigned)(hash % NAME_BUCKETS);
+}
+
+static void add_name(JitCompiler* c, const char* name, JitVar* var, JitFunction* function) {
+    if (c->entry_count == c->entry_capacity) {
+        size_t capacity = c->entry_capacity;
+        c->entries = (ScopeEntry*)jit_grow(c->entries, &capacity, sizeof(ScopeEntry));
+        c->entry_capacity = (int)capacity;
+    }
+    unsigned bucket = name_bucket(name);
+    c->entries[c->entry_count] = (ScopeEntry){ name, var, function, c->buckets[bucket] };
+    c->buckets[bucket] = c->entry_count++;
+}
+
+static ScopeEntry* find_name(JitCompiler* c, const char* name) {
+    for (int i = c->buckets[name_bucket(name)]; i >= 0; i = c->entries[i].next) {
+        if (strcmp(c->entries[i].name, name) == 0) return &c->entries[i];
+    }
+    return NULL;
+}
+
+static void enter_scope(JitCompiler* c) {
+    if (c->mark_count == c->mark_capacity) {
+        size_t capacity = c->mark_capacity;
+        c->marks = (int*)jit_grow(c->marks, &capacity, sizeof(int));
+        c->mark_capacity = (int)capacity;
+    }
+    c->marks[c->mark_count++] = c->entry_count;
+}
+
+static void exit_scope(JitCompiler* c) {
+    int mark = c->marks[--c->mark_count];
+    while (c->entry_count > mark) {
+        ScopeEntry* entry = &c->entries[--c->entry_count];
+        c->buckets[name_bucket(entry->name)] = entry->next;
+    }
+}
+
+// --- Resolução ---
+
+static JitType declared_type(JitCompiler* c, ASTNode* node, const char* type_name) {
+    if (strcmp(type_name, "int") == 0) return JT_INT;
+    if (strcmp(type_name, "float") == 0) return JT_FLOAT;
+    unsupported(c, node, "variáveis do tipo '%s'", type_name);
+    return JT_UNKNOWN;
+}
+
+static JitVar* new_var(JitCompiler* c, ASTNode* node, JitType declared) {
+    JitVar* var = (JitVar*)jit_alloc(sizeof(JitVar));
+    var->declared = declared;
+    var->next = c->vars;
+    c->vars = var;
+    map_node(c, node, var);
+    return var;
+}
+
+static JitFunction* new_function(JitCompiler* c, ASTNode* node) {
+    JitFunction* function = (JitFunction*)jit_alloc(sizeof(JitFunction));
+    function->node = node;
+    if (c->last_function) {
+        c->last_function->next = function;
+    } else {
+        c->functions = function;
+    }
+    c->last_function = function;
+    return function;
+}
+
+static void resolve_node(JitCompiler* c, ASTNode* node);
+
+static void resolve_identifier(JitCompiler* c, ASTNode* node) {
+    ScopeEntry* entry = find_name(c, node->data.identifier_name);
+    if (!entry || !entry->var) unsupported(c, node, "identificador '%s'", node->data.identifier_name);
+    if (entry->var->in_initializer) {
+        unsupported(c, node, "'%s' lido no próprio valor inicial", node->data.identifier_name);
+    }
+    map_node(c, node, entry->var);
+}
+
+static void resolve_declaration(JitCompiler* c, ASTNode* node) {
+    JitVar* var = new_var(c, node, declared_type(c, node, node->data.var_decl.type_name));
+    JitFunction* function = c->current;
+    if (function) {
+        var->base = REG_RBP;
+        var->disp = -8 * ++function->slot_count;
+        if (!node->data.var_decl.initial_value) {
+            var->has_flag = 1;
+            var->flag_disp = -8 * ++function->slot_count;
+        }
+    } else {
+        // Uma global pode ser lida por uma função chamada antes da sua inicialização
+        var->base = REG_R15;
+        var->disp = 16 * c->global_count;
+        var->flag_disp = 16 * c->global_count + 8;
+        var->has_flag = 1;
+        c->global_count++;
+    }
+    add_name(c, node->data.var_decl.var_name, var, NULL);
+    if (node->data.var_decl.initial_value) {
+        var->in_initializer = 1;
+        resolve_node(c, node->data.var_decl.initial_value);
+        var->in_initializer = 0;
+    }
+}
+
+static void resolve_function(JitCompiler* c, ASTNode* node) {
+    JitFunction* function = new_function(c, node);
+    c->current = function;
+    if (node->type == NODE_FUNC_DEF) {
+        add_name(c, node->data.func_def.func_name, NULL, function);
+        for (ASTNodeList* l = node->data.func_def.params; l; l = l->next) function->param_count++;
+        function->params = (JitVar**)jit_alloc((function->param_count + 1) * sizeof(JitVar*));
+        enter_scope(c);
+        int i = 0;
+        for (ASTNodeList* l = node->data.func_def.params; l; l = l->next, i++) {
+            ASTNode* param = l->node;
+            JitVar* var = new_var(c, param, declared_type(c, param, param->data.param.type_name));
+            // Os argumentos são empilhados na ordem: o primeiro fica mais longe do quadro
+            var->base = REG_RBP;
+            var->disp = 16 + 8 * (function->param_count - 1 - i);
+            function->params[i] = var;
+            add_name(c, param->data.param.param_name, var, NULL);
+        }
+        resolve_node(c, node->data.func_def.body);
+        exit_scope(c);
+    } else {
+        resolve_node(c, node->data.main_def.body);
+    }
+    c->current = NULL;
+}
+
+static void resolve_node(JitCompiler* c, ASTNode* node) {
+    if (!node) return;
+    switch (node->type) {
+        case NODE_PROGRAM:
+            enter_scope(c);
+            for (ASTNodeList* l = node->data.program.declarations; l; l = l->next) {
+                if (l->node->type == NODE_VAR_DECL) {
+                    resolve_declaration(c, l->node);
+                } else {
+                    resolve_function(c, l->node);
+                }
+            }
+            exit_scope(c);
+            break;
+        case NODE_VAR_DECL:
+            resolve_declaration(c, node);
+            break;
+        case NODE_BLOCK:
+            enter_scope(c);
+            for (ASTNodeList* l = node->data.block.statements; l; l = l->next) resolve_node(c, l->node);
+            exit_scope(c);
+            break;
+        case NODE_FOR:
+            enter_scope(c);
+            resolve_node(c, node->data.for_stmt.init);
+            resolve_node(c, node->data.for_stmt.condition);
+            resolve_node(c, node->data.for_stmt.increment);
+            resolve_node(c, node->data.for_stmt.body);
+            exit_scope(c);
+            break;
+        case NODE_IF:
+            resolve_node(c, node->data.if_stmt.condition);
+            resolve_node(c, node->data.if_stmt.if_body);
+            resolve_node(c, node->data.if_stmt.else_body);
+            break;
+        case NODE_WHILE:
+            resolve_node(c, node->data.while_stmt.condition);
+            resolve_node(c, node->data.while_stmt.body);
+            break;
+        case NODE_RETURN:
+            if (!c->current) unsupported(c, node, "'return' fora de função");
+            if (node->data.return_stmt.return_value) c->current->has_value = 1;
+            resolve_node(c, node->data.return_stmt.return_value);
+            break;
+        case NODE_ASSIGN:
+            if (node->data.assign_expr.lvalue->type != NODE_IDENTIFIER) unsupported(c, node, "atribuição");
+            resolve_identifier(c, node->data.assign_expr.lvalue);
+            resolve_node(c, node->data.assign_expr.rvalue);
+            break;
+        case NODE_IDENTIFIER:
+            resolve_identifier(c, node);
+            break;
+        case NODE_FUNC_CALL: {
+            int arg_count = 0;
+            for (ASTNodeList* l = node->data.func_call.args; l; l = l->next) {
+                resolve_node(c, l->node);
+                arg_count++;
+            }
+            if (strcmp(node->data.func_call.func_name, "print") == 0) break;
+            ScopeEntry* entry = find_name(c, node->data.func_call.func_name);
+            if (!entry || !entry->function) unsupported(c, node, "chamada a '%s'", node->data.func_call.func_name);
+            if (entry->function->param_count != arg_count) {
+                unsupported(c, node, "chamada a '%s' com %d argumento(s)", node->data.func_call.func_name, arg_count);
+            }
+            map_node(c, node, entry->function);
+            break;
+        }
+        case NODE_BINARY_OP:
+            resolve_node(c, node->data.binary_op.left);
+            resolve_node(c, node->data.binary_op.right);
+            break;
+        case NODE_UNARY_OP:
+            resolve_node(c, node->data.unary_op.operand);
+            break;
+        case NODE_INT_LITERAL:
+        case NODE_FLOAT_LITERAL:
+        case NODE_STRING_LITERAL:
+            break;
+        default:
+            unsupported(c, node, "construção sem tradução no JIT");
+    }
+}
+
+// --- Tipos ---
+//
+// Os tipos são os que os valores terão no output.py, e não os anotados: as funções não
+// declaram o tipo de retorno, então a análise semântica anota as chamadas como int, e
+// uma variável int pode receber o float devolvido por uma. O tipo de cada variável, parâmetro
+// e retorno é inferido dos valores que ele recebe no programa inteiro, até um ponto fixo;
+// a declaração só vale para o que não recebe nenhum valor de tipo conhecido.
+
+static int is_comparison(const char* op) {
+    return strcmp(op, "==") == 0 || strcmp(op, "!=") == 0 || strcmp(op, "<") == 0 ||
+           strcmp(op, ">") == 0 || strcmp(op, "<=") == 0 || strcmp(op, ">=") == 0;
+}
+
+static int is_logical(const char* op) {
+    return strcmp(op, "&&") == 0 || strcmp(op, "||") == 0;
+}
+
+// A divisão anotada como inteira vira int(a / b) no output.py; as demais, a / b
+static int is_integer_division(ASTNode* node) {
+    return strcmp(node->data.binary_op.op, "/") == 0 && node->value_type == TYPE_INT;
+}
+
+static JitType expression_type(JitCompiler* c, ASTNode* node) {
+    switch (node->type) {
+        case NODE_INT_LITERAL:
+            return JT_INT;
+        case NODE_FLOAT_LITERAL:
+            return JT_FLOAT;
+        case NODE_IDENTIFIER:
+            return ((JitVar*)node_value(c, node))->type;
+        case NODE_FUNC_CALL: {
+            JitFunction* callee = (JitFunction*)node_value(c, node);
+            return callee && callee->has_value ? callee->return_type : JT_NONE;
+        }
+        case NODE_UNARY_OP:
+            if (strcmp(node->data.unary_op.op, "!") == 0) return JT_INT;
+            return expression_type(c, node->data.unary_op.operand);
+        case NODE_BINARY_OP: {
+            const char* op = node->data.binary_op.op;
+            if (is_comparison(op) || is_logical(op) || is_integer_division(node) || strcmp(op, "<<") == 0) return JT_INT;
+            JitType left = expression_type(c, node->data.binary_op.left);
+            JitType right = expression_type(c, node->data.binary_op.right);
+            if (strcmp(op, "/") == 0) return JT_FLOAT;
+            if (left == JT_UNKNOWN || right == JT_UNKNOWN) return JT_UNKNOWN;
+            return left == JT_FLOAT || right == JT_FLOAT ? JT_FLOAT : JT_INT;
+        }
+        default:
+            return JT_UNKNOWN;
+    }
+}
+
+// Pode produzir um bool do Python? Só importa ao imprimir com %s (True em vez de 1)
+static int may_be_bool(JitCompiler* c, ASTNode* node) {
+    switch (node->type) {
+        case NODE_IDENTIFIER:
+            return ((JitVar*)node_value(c, node))->may_bool;
+        case NODE_FUNC_CALL: {
+            JitFunction* callee = (JitFunction*)node_value(c, node);
+            return callee && callee->returns_bool;
+        }
+        case NODE_UNARY_OP:
+            return strcmp(node->data.unary_op.op, "!") == 0;
+        case NODE_BINARY_OP:
+            return is_comparison(node->data.binary_op.op);
+        default:
+            return 0;
+    }
+}
+
+static int mark_flag(int* flag, int value) {
+    if (!value || *flag) return 0;
+    *flag = 1;
+    return 1;
+}
+
+// Um valor chega a uma variável, parâmetro ou retorno: junta o tipo e a possibilidade
+// de ser um bool. Devolve 1 se algo mudou.
+static int flow_value(JitCompiler* c, ASTNode* value, JitType* type, int* may_bool) {
+    int changed = mark_flag(may_bool, may_be_bool(c, value));
+    JitType value_type = expression_type(c, value);
+    if (value_type == JT_UNKNOWN || value_type == JT_NONE || value_type == *type) return changed;
+    if (*type != JT_UNKNOWN) unsupported(c, value, "variável ou retorno que recebe int e float");
+    *type = value_type;
+    return 1;
+}
+
+// Uma passada do ponto fixo sobre as atribuições, argumentos e retornos
+static int propagate_types(JitCompiler* c, ASTNode* node, JitFunction* function) {
+    if (!node) return 0;
+    int changed = 0;
+    switch (node->type) {
+        case NODE_PROGRAM:
+            for (ASTNodeList* l = node->data.program.declarations; l; l = l->next) {
+                JitFunction* owner = NULL;
+                if (l->node->type != NODE_VAR_DECL) {
+                    for (owner = c->functions; owner->node != l->node; owner = owner->next) {}
+                }
+                changed |= propagate_types(c, l->node, owner);
+            }
+            break;
+        case NODE_FUNC_DEF:
+            changed |= propagate_types(c, node->data.func_def.body, function);
+            break;
+        case NODE_MAIN_DEF:
+            changed |= propagate_types(c, node->data.main_def.body, function);
+            break;
+        case NODE_VAR_DECL:
+            if (node->data.var_decl.initial_value) {
+                JitVar* var = (JitVar*)node_value(c, node);
+                changed |= flow_value(c, node->data.var_decl.initial_value, &var->type, &var->may_bool);
+                changed |= propagate_types(c, node->data.var_decl.initial_value, function);
+            }
+            break;
+        case NODE_ASSIGN: {
+            JitVar* var = (JitVar*)node_value(c, node->data.assign_expr.lvalue);
+            changed |= flow_value(c, node->data.assign_expr.rvalue, &var->type, &var->may_bool);
+            changed |= propagate_types(c, node->data.assign_expr.rvalue, function);
+            break;
+        }
+        case NODE_RETURN:
+            if (node->data.return_stmt.return_value) {
+                changed |= flow_value(c, node->data.return_stmt.return_value, &function->return_type,
+                                      &function->returns_bool);
+                changed |= propagate_types(c, node->data.return_stmt.return_value, function);
+            }
+            break;
+        case NODE_FUNC_CALL: {
+            JitFunction* callee = (JitFunction*)node_value(c, node);
+            int i = 0;
+            for (ASTNodeList* l = node->data.func_call.args; l; l = l->next, i++) {
+                if (callee) changed |= flow_value(c, l->node, &callee->params[i]->type, &callee->params[i]->may_bool);
+                changed |= propagate_types(c, l->node, function);
+            }
+            break;
+        }
+        default: {
+            ASTLayout layout = ast_layout(node);
+            if (layout.list) {
+                for (ASTNodeList* l = *layout.list; l; l = l->next) changed |= propagate_types(c, l->node, function);
+            }
+            for (int i = 0; i < layout.child_count; i++) changed |= propagate_types(c, *layout.child[i], function);
+            break;
+        }
+    }
+    return changed;
+}
+
+static void infer_types(JitCompiler* c, ASTNode* program) {
+    while (propagate_types(c, program, NULL)) {}
+    // O que só recebe valores de tipo desconhecido (por exemplo, uma recursão que nunca
+    // termina com um valor) fica com o tipo declarado, ou int nos retornos
+    for (JitVar* var = c->vars; var; var = var->next) {
+        if (var->type == JT_UNKNOWN) var->type = var->declared;
+    }
+    for (JitFunction* function = c->functions; function; function = function->next) {
+        if (!function->has_value) {
+            function->return_type = JT_NONE;
+        } else if (function->return_type == JT_UNKNOWN) {
+            function->return_type = JT_INT;
+        }
+    }
+    while (propagate_types(c, program, NULL)) {}
+}
+
+// --- Emissão de Código de Máquina ---
+
+static void emit_bytes(JitCompiler* c, const unsigned char* bytes, size_t count) {
+    while (c->size + count > c->capacity) c->code = (unsigned char*)jit_grow(c->code, &c->capacity, 1);
+    memcpy(c->code + c->size, bytes, count);
+    c->size += count;
+}
+
+#define EMIT(c, ...) do { \
+    static const unsigned char emit_bytes_[] = { __VA_ARGS__ }; \
+    emit_bytes((c), emit_bytes_, sizeof(emit_bytes_)); \
+} while (0)
+
+static void emit_byte(JitCompiler* c, unsigned char byte) {
+    emit_bytes(c, &byte, 1);
+}
+
+static void emit_u32(JitCompiler* c, uint32_t value) {
+    unsigned char bytes[4];
+    for (int i = 0; i < 4; i++) bytes[i] = (unsigned char)(value >> (8 * i));
+    emit_bytes(c, bytes, 4);
+}
+
+static void emit_u64(JitCompiler* c, uint64_t value) {
+    unsigned char bytes[8];
+    for (int i = 0; i < 8; i++) bytes[i] = (unsigned char)(value >> (8 * i));
+    emit_bytes(c, bytes, 8);
+}
+
+// Instrução com operando [base + disp32]: prefixo (0x66 ou 0xF2, ou 0), REX.W, opcode
+// (precedido de 0x0F se 'two_byte') e o registrador (ou extensão do opcode) do campo reg
+static void emit_memory(JitCompiler* c, int prefix, int wide, int two_byte, int opcode, int reg, int base,
+                        int32_t disp) {
+    if (prefix) emit_byte(c, (unsigned char)prefix);
+    int rex = 0x40 | (wide ? 8 : 0) | (reg & 8 ? 4 : 0) | (base & 8 ? 1 : 0);
+    if (rex != 0x40) emit_byte(c, (unsigned char)rex);
+    if (two_byte) emit_byte(c, 0x0F);
+    emit_byte(c, (unsigned char)opcode);
+    emit_byte(c, (unsigned char)(0x80 | (reg & 7) << 3 | (base & 7)));
+    emit_u32(c, (uint32_t)disp);
+}
+
+// Salto (condicional, ou incondicional com CC_ALWAYS) a ser ajustado com patch_jump
+static size_t emit_jump(JitCompiler* c, int condition) {
+    if (condition == CC_ALWAYS) {
+        emit_byte(c, 0xE9);
+    } else {
+        emit_byte(c, 0x0F);
+        emit_byte(c, (unsigned char)(0x80 | condition));
+    }
+    size_t at = c->size;
+    emit_u32(c, 0);
+    return at;
+}
+
+static void patch_jump_to(JitCompiler* c, size_t at, size_t target) {
+    int32_t rel = (int32_t)((int64_t)target - (int64_t)(at + 4));
+    for (int i = 0; i < 4; i++) c->code[at + i] = (unsigned char)((uint32_t)rel >> (8 * i));
+}
+
+static void patch_jump(JitCompiler* c, size_t at) {
+    patch_jump_to(c, at, c->size);
+}
+
+static void emit_jump_to(JitCompiler* c, int condition, size_t target) {
+    patch_jump_to(c, emit_jump(c, condition), target);
+}
+
+// call rel32 para o início de uma função já compilada
+static void emit_call_to(JitCompiler* c, size_t target) {
+    emit_byte(c, 0xE8);
+    size_t at = c->size;
+    emit_u32(c, 0);
+    patch_jump_to(c, at, target);
+}
+
+static void emit_trap_if(JitCompiler* c, int condition, TrapReason reason) {
+    emit_jump_to(c, condition, c->traps[reason]);
+}
+
+// Chama uma função em C com a pilha alinhada em 16 bytes (rbx guarda a original)
+static void emit_c_call(JitCompiler* c, void* function) {
+    EMIT(c, 0x48, 0x89, 0xE3);                 // mov rbx, rsp
+    EMIT(c, 0x48, 0x83, 0xE4, 0xF0);           // and rsp, -16
+    EMIT(c, 0x48, 0xB8);                       // mov rax, imm64
+    emit_u64(c, (uint64_t)(uintptr_t)function);
+    EMIT(c, 0xFF, 0xD0);                       // call rax
+    EMIT(c, 0x48, 0x89, 0xDC);                 // mov rsp, rbx
+}
+
+static void emit_load(JitCompiler* c, JitVar* var, int reg) {
+    if (var->has_flag) {
+        emit_memory(c, 0, 1, 0, 0x83, 7, var->base, var->flag_disp); // cmp qword [flag], 0
+        emit_byte(c, 0);
+        emit_trap_if(c, CC_E, TRAP_UNDEFINED);
+    }
+    if (var->type == JT_FLOAT) {
+        emit_memory(c, 0xF2, 0, 1, 0x10, reg, var->base, var->disp); // movsd xmm, [var]
+    } else {
+        emit_memory(c, 0, 1, 0, 0x8B, reg, var->base, var->disp);    // mov reg, [var]
+    }
+}
+
+// Guarda rax (int) ou xmm0 (float) na variável e marca que ela tem valor
+static void emit_store(JitCompiler* c, JitVar* var) {
+    if (var->type == JT_FLOAT) {
+        emit_memory(c, 0xF2, 0, 1, 0x11, 0, var->base, var->disp);
+    } else {
+        emit_memory(c, 0, 1, 0, 0x89, REG_RAX, var->base, var->disp);
+    }
+    if (var->has_flag) {
+        emit_memory(c, 0, 1, 0, 0xC7, 0, var->base, var->flag_disp); // mov qword [flag], 1
+        emit_u32(c, 1);
+    }
+}
+
+static void emit_float_constant(JitCompiler* c, double value, int xmm) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    EMIT(c, 0x48, 0xB8);                       // mov rax, imm64
+    emit_u64(c, bits);
+    if (xmm == 0) {
+        EMIT(c, 0x66, 0x48, 0x0F, 0x6E, 0xC0); // movq xmm0, rax
+    } else {
+        EMIT(c, 0x66, 0x48, 0x0F, 0x6E, 0xC8); // movq xmm1, rax
+    }
+}
+
+// Abandona se o inteiro do registrador (rax ou rcx) tiver |x| > 2^bits: com bits = 53 ele
+// cabe exatamente em um double, como nas divisões e comparações que o Python faz sem
+// arredondar
+static void emit_precision_check(JitCompiler* c, int reg, int bits) {
+    if (reg == REG_RAX) {
+        EMIT(c, 0x48, 0x89, 0xC2);             // mov rdx, rax
+    } else {
+        EMIT(c, 0x48, 0x89, 0xCA);             // mov rdx, rcx
+    }
+    EMIT(c, 0x48, 0xC1, 0xFA);                 // sar rdx, bits
+    emit_byte(c, (unsigned char)bits);
+    EMIT(c, 0x48, 0xFF, 0xC2);                 // inc rdx
+    EMIT(c, 0x48, 0x83, 0xFA, 0x01);           // cmp rdx, 1
+    emit_trap_if(c, CC_A, TRAP_PRECISION);
+}
+
+// Valor de verdade do Python em eax (0 ou 1): NaN é verdadeiro
+static void emit_truth_value(JitCompiler* c, JitType type) {
+    if (type == JT_FLOAT) {
+        EMIT(c, 0x66, 0x0F, 0x57, 0xC9);       // xorpd xmm1, xmm1
+        EMIT(c, 0x66, 0x0F, 0x2E, 0xC1);       // ucomisd xmm0, xmm1
+        EMIT(c, 0x0F, 0x95, 0xC0);             // setne al
+        EMIT(c, 0x0F, 0x9A, 0xC1);             // setp cl
+        EMIT(c, 0x08, 0xC8);                   // or al, cl
+    } else {
+        EMIT(c, 0x48, 0x85, 0xC0);             // test rax, rax
+        EMIT(c, 0x0F, 0x95, 0xC0);             // setne al
+    }
+    EMIT(c, 0x0F, 0xB6, 0xC0);                 // movzx eax, al
+}
+
+static JitType compile_expression(JitCompiler* c, ASTNode* node);
+
+// Empilha os argumentos, chama a função e devolve o valor em rax e o indicador de None em rdx
+static JitFunction* compile_call(JitCompiler* c, ASTNode* node) {
+    JitFunction* callee = (JitFunction*)node_value(c, node);
+    int i = 0;
+    for (ASTNodeList* l = node->data.func_call.args; l; l = l->next, i++) {
+        JitType type = compile_expression(c, l->node);
+        if (type != callee->params[i]->type) {
+            unsupported(c, l->node, "argumento de tipo diferente do parâmetro");
+        }
+        if (type == JT_FLOAT) EMIT(c, 0x66, 0x48, 0x0F, 0x7E, 0xC0); // movq rax, xmm0
+        EMIT(c, 0x50);                                               // push rax
+    }
+    emit_call_to(c, callee->offset);
+    if (callee->param_count > 0) {
+        EMIT(c, 0x48, 0x81, 0xC4);                                   // add rsp, imm32
+        emit_u32(c, (uint32_t)(8 * callee->param_count));
+    }
+    return callee;
+}
+
+// Carrega em rcx/xmm1 um operando direito que não precisa da pilha
+static int compile_simple_operand(JitCompiler* c, ASTNode* node, JitType* type) {
+    switch (node->type) {
+        case NODE_INT_LITERAL:
+            EMIT(c, 0x48, 0xC7, 0xC1);                               // mov rcx, imm32
+            emit_u32(c, (uint32_t)node->data.int_literal);
+            *type = JT_INT;
+            return 1;
+        case NODE_IDENTIFIER: {
+            JitVar* var = (JitVar*)node_value(c, node);
+            emit_load(c, var, REG_RCX);
+            *type = var->type;
+            return 1;
+        }
+        default:
+            return 0;
+    }
+}
+
+static void compile_float_comparison(JitCompiler* c, const char* op) {
+    if (strcmp(op, "==") == 0 || strcmp(op, "!=") == 0 || strcmp(op, ">") == 0 || strcmp(op, ">=") == 0) {
+        EMIT(c, 0x66, 0x0F, 0x2E, 0xC1);                             // ucomisd xmm0, xmm1
+    } else {
+        EMIT(c, 0x66, 0x0F, 0x2E, 0xC8);                             // ucomisd xmm1, xmm0
+    }
+    if (strcmp(op, "==") == 0) {
+        EMIT(c, 0x0F, 0x94, 0xC0, 0x0F, 0x9B, 0xC1, 0x20, 0xC8);     // sete al; setnp cl; and al, cl
+    } else if (strcmp(op, "!=") == 0) {
+        EMIT(c, 0x0F, 0x95, 0xC0, 0x0F, 0x9A, 0xC1, 0x08, 0xC8);     // setne al; setp cl; or al, cl
+    } else if (strcmp(op, "<") == 0 || strcmp(op, ">") == 0) {
+        EMIT(c, 0x0F, 0x97, 0xC0);                                   // seta al
+    } else {
+        EMIT(c, 0x0F, 0x93, 0xC0);                                   // setae al
+    }
+    EMIT(c, 0x0F, 0xB6, 0xC0);                                       // movzx eax, al
+}
+
+static int int_condition(const char* op) {
+    if (strcmp(op, "==") == 0) return CC_E;
+    if (strcmp(op, "!=") == 0) return CC_NE;
+    if (strcmp(op, "<") == 0) return CC_L;
+    if (strcmp(op, "<=") == 0) return CC_LE;
+    if (strcmp(op, ">") == 0) return CC_G;
+    return CC_GE;
+}
+
+// 'a && b' e 'a || b' devolvem um dos operandos, como 'and' e 'or' do Python
+// '&&' e '||' valem 0 ou 1, como no output.py; o operando direito só é avaliado se
+// o esquerdo não decidir o resultado
+static JitType compile_logical(JitCompiler* c, ASTNode* node) {
+    int is_and = strcmp(node->data.binary_op.op, "&&") == 0;
+    emit_truth_value(c, compile_expression(c, node->data.binary_op.left));
+    EMIT(c, 0x85, 0xC0);                                             // test eax, eax
+    size_t skip = emit_jump(c, is_and ? CC_E : CC_NE);
+    emit_truth_value(c, compile_expression(c, node->data.binary_op.right));
+    patch_jump(c, skip);
+    return JT_INT;
+}
+
+static JitType compile_binary(JitCompiler* c, ASTNode* node) {
+    const char* op = node->data.binary_op.op;
+    if (is_logical(op)) return compile_logical(c, node);
+
+    JitType left = compile_expression(c, node->data.binary_op.left);
+    JitType right;
+    if (strcmp(op, "<<") == 0) {
+        ASTNode* count = node->data.binary_op.right;
+        if (left != JT_INT || count->type != NODE_INT_LITERAL || count->data.int_literal < 0 ||
+            count->data.int_literal > 62) {
+            unsupported(c, node, "deslocamento que não vem da redução de força");
+        }
+        unsigned char shift = (unsigned char)count->data.int_literal;
+        EMIT(c, 0x48, 0x89, 0xC2);                                   // mov rdx, rax
+        EMIT(c, 0x48, 0xC1, 0xE0); emit_byte(c, shift);              // shl rax, k
+        EMIT(c, 0x48, 0x89, 0xC1);                                   // mov rcx, rax
+        EMIT(c, 0x48, 0xC1, 0xF9); emit_byte(c, shift);              // sar rcx, k
+        EMIT(c, 0x48, 0x39, 0xD1);                                   // cmp rcx, rdx
+        emit_trap_if(c, CC_NE, TRAP_OVERFLOW);
+        return JT_INT;
+    }
+    if (!compile_simple_operand(c, node->data.binary_op.right, &right)) {
+        if (left == JT_FLOAT) EMIT(c, 0x66, 0x48, 0x0F, 0x7E, 0xC0); // movq rax, xmm0
+        EMIT(c, 0x50);                                               // push rax
+        right = compile_expression(c, node->data.binary_op.right);
+        if (right == JT_FLOAT) {
+            EMIT(c, 0x66, 0x0F, 0x28, 0xC8);                         // movapd xmm1, xmm0
+        } else {
+            EMIT(c, 0x48, 0x89, 0xC1);                               // mov rcx, rax
+        }
+        EMIT(c, 0x58);                                               // pop rax
+        if (left == JT_FLOAT) EMIT(c, 0x66, 0x48, 0x0F, 0x6E, 0xC0); // movq xmm0, rax
+    }
+
+    if (left == JT_INT && right == JT_INT) {
+        if (is_comparison(op)) {
+            EMIT(c, 0x48, 0x39, 0xC8);                               // cmp rax, rcx
+            emit_byte(c, 0x0F);
+            emit_byte(c, (unsigned char)(0x90 | int_condition(op))); // setcc al
+            emit_byte(c, 0xC0);
+            EMIT(c, 0x0F, 0xB6, 0xC0);                               // movzx eax, al
+            return JT_INT;
+        }
+        if (strcmp(op, "+") == 0) {
+            EMIT(c, 0x48, 0x01, 0xC8);                               // add rax, rcx
+        } else if (strcmp(op, "-") == 0) {
+            EMIT(c, 0x48, 0x29, 0xC8);                               // sub rax, rcx
+        } else if (strcmp(op, "*") == 0) {
+            EMIT(c, 0x48, 0x0F, 0xAF, 0xC1);                         // imul rax, rcx
+        } else if (strcmp(op, "/") == 0) {
+            EMIT(c, 0x48, 0x85, 0xC9);                               // test rcx, rcx
+            emit_trap_if(c, CC_E, TRAP_DIVISION);
+            if (is_integer_division(node)) {
+                // Com |a| <= 2^52, o quociente arredondado do Python não cruza um inteiro,
+                // e int(a / b) é a divisão truncada
+                emit_precision_check(c, REG_RAX, 52);
+                EMIT(c, 0x48, 0x99);                                 // cqo
+                EMIT(c, 0x48, 0xF7, 0xF9);                           // idiv rcx
+                return JT_INT;
+            }
+            emit_precision_check(c, REG_RAX, 53);
+            emit_precision_check(c, REG_RCX, 53);
+            EMIT(c, 0xF2, 0x48, 0x0F, 0x2A, 0xC0);                   // cvtsi2sd xmm0, rax
+            EMIT(c, 0xF2, 0x48, 0x0F, 0x2A, 0xC9);                   // cvtsi2sd xmm1, rcx
+            EMIT(c, 0xF2, 0x0F, 0x5E, 0xC1);                         // divsd xmm0, xmm1
+            return JT_FLOAT;
+        } else {
+            unsupported(c, node, "operador '%s'", op);
+        }
+        emit_trap_if(c, CC_O, TRAP_OVERFLOW);
+        return JT_INT;
+    }
+
+    // Pelo menos um float: o inteiro é convertido como no Python (arredondado ao mais
+    // próximo), mas nas comparações o Python compara o valor exato
+    if (left == JT_INT) {
+        if (is_comparison(op)) emit_precision_check(c, REG_RAX, 53);
+        EMIT(c, 0xF2, 0x48, 0x0F, 0x2A, 0xC0);                       // cvtsi2sd xmm0, rax
+    }
+    if (right == JT_INT) {
+        if (is_comparison(op)) emit_precision_check(c, REG_RCX, 53);
+        EMIT(c, 0xF2, 0x48, 0x0F, 0x2A, 0xC9);                       // cvtsi2sd xmm1, rcx
+    }
+    if (is_comparison(op)) {
+        compile_float_comparison(c, op);
+        return JT_INT;
+    }
+    if (strcmp(op, "+") == 0) {
+        EMIT(c, 0xF2, 0x0F, 0x58, 0xC1);                             // addsd xmm0, xmm1
+    } else if (strcmp(op, "-") == 0) {
+        EMIT(c, 0xF2, 0x0F, 0x5C, 0xC1);                             // subsd xmm0, xmm1
+    } else if (strcmp(op, "*") == 0) {
+        EMIT(c, 0xF2, 0x0F, 0x59, 0xC1);                             // mulsd xmm0, xmm1
+    } else if (strcmp(op, "/") == 0) {
+        EMIT(c, 0x66, 0x0F, 0x57, 0xD2);                             // xorpd xmm2, xmm2
+        EMIT(c, 0x66, 0x0F, 0x2E, 0xCA);                             // ucomisd xmm1, xmm2
+        emit_trap_if(c, CC_E, TRAP_DIVISION);                        // (também com NaN)
+        EMIT(c, 0xF2, 0x0F, 0x5E, 0xC1);                             // divsd xmm0, xmm1
+        if (is_integer_division(node)) {
+            EMIT(c, 0xF2, 0x48, 0x0F, 0x2C, 0xC0);                   // cvttsd2si rax, xmm0
+            EMIT(c, 0x48, 0xB9);                                     // mov rcx, imm64
+            emit_u64(c, 0x8000000000000000ull);
+            EMIT(c, 0x48, 0x39, 0xC8);                               // cmp rax, rcx
+            emit_trap_if(c, CC_E, TRAP_PRECISION);
+            return JT_INT;
+        }
+    } else {
+        unsupported(c, node, "operador '%s' com float", op);
+    }
+    return JT_FLOAT;
+}
+
+static JitType compile_expression(JitCompiler* c, ASTNode* node) {
+    switch (node->type) {
+        case NODE_INT_LITERAL:
+            EMIT(c, 0x48, 0xC7, 0xC0);                               // mov rax, imm32
+            emit_u32(c, (uint32_t)node->data.int_literal);
+            return JT_INT;
+        case NODE_FLOAT_LITERAL:
+            emit_float_constant(c, node->data.float_literal, 0); // O gerador emite o mesmo double
+            return JT_FLOAT;
+        case NODE_IDENTIFIER: {
+            JitVar* var = (JitVar*)node_value(c, node);
+            emit_load(c, var, 0);
+            return var->type;
+        }
+        case NODE_FUNC_CALL: {
+            if (!node_value(c, node)) unsupported(c, node, "'print' usado como valor");
+            JitFunction* callee = compile_call(c, node);
+            EMIT(c, 0x48, 0x85, 0xD2);                               // test rdx, rdx
+            emit_trap_if(c, CC_NE, TRAP_NONE);
+            if (callee->return_type == JT_FLOAT) EMIT(c, 0x66, 0x48, 0x0F, 0x6E, 0xC0); // movq xmm0, rax
+            return callee->return_type == JT_FLOAT ? JT_FLOAT : JT_INT;
+        }
+        case NODE_UNARY_OP: {
+            JitType type = compile_expression(c, node->data.unary_op.operand);
+            if (strcmp(node->data.unary_op.op, "!") == 0) {
+                emit_truth_value(c, type);
+                EMIT(c, 0x83, 0xF0, 0x01);                           // xor eax, 1
+                return JT_INT;
+            }
+            if (type == JT_FLOAT) {
+                EMIT(c, 0x66, 0x48, 0x0F, 0x7E, 0xC0);               // movq rax, xmm0
+                EMIT(c, 0x48, 0x0F, 0xBA, 0xF8, 0x3F);               // btc rax, 63
+                EMIT(c, 0x66, 0x48, 0x0F, 0x6E, 0xC0);               // movq xmm0, rax
+            } else {
+                EMIT(c, 0x48, 0xF7, 0xD8);                           // neg rax
+                emit_trap_if(c, CC_O, TRAP_OVERFLOW);
+            }
+            return type;
+        }
+        case NODE_BINARY_OP:
+            return compile_binary(c, node);
+        default:
+            unsupported(c, node, node->type == NODE_ASSIGN ? "atribuição dentro de expressão"
+                                                           : "string fora de 'print'");
+            return JT_UNKNOWN;
+    }
+}
+
+// Avalia a condição e emite o salto tomado quando ela é falsa
+static size_t compile_condition(JitCompiler* c, ASTNode* node) {
+    if (node->type == NODE_BINARY_OP && is_comparison(node->data.binary_op.op) &&
+        expression_type(c, node->data.binary_op.left) == JT_INT &&
+        expression_type(c, node->data.binary_op.right) == JT_INT) {
+        compile_expression(c, node->data.binary_op.left);
+        JitType right;
+        if (!compile_simple_operand(c, node->data.binary_op.right, &right)) {
+            EMIT(c, 0x50);                                           // push rax
+            compile_expression(c, node->data.binary_op.right);
+            EMIT(c, 0x48, 0x89, 0xC1);                               // mov rcx, rax
+            EMIT(c, 0x58);                                           // pop rax
+        }
+        EMIT(c, 0x48, 0x39, 0xC8);                                   // cmp rax, rcx
+        return emit_jump(c, int_condition(node->data.binary_op.op) ^ 1);
+    }
+    emit_truth_value(c, compile_expression(c, node));
+    EMIT(c, 0x85, 0xC0);                                             // test eax, eax
+    return emit_jump(c, CC_E);
+}
+
+static JitText* new_text(JitCompiler* c, const char* text, size_t length) {
+    JitText* entry = (JitText*)jit_alloc(sizeof(JitText) + length + 1);
+    memcpy(entry->text, text, length);
+    entry->length = length;
+    entry->next = c->texts;
+    c->texts = entry;
+    return entry;
+}
+
+// --- Runtime ---
+
+static char* output_text = NULL;
+static size_t output_size = 0;
+static size_t output_capacity = 0;
+static jmp_buf run_env;
+
+static void output_append(const char* text, size_t length) {
+    while (output_size + length > output_capacity) {
+        output_text = (char*)jit_grow(output_text, &output_capacity, 1);
+    }
+    memcpy(output_text + output_size, text, length);
+    output_size += length;
+}
+
+static void jit_print_text(const char* text, size_t length) {
+    output_append(text, length);
+}
+
+static void jit_print_int(int64_t value) {
+    char text[32];
+    int length = snprintf(text, sizeof(text), "%lld\n", (long long)value);
+    output_append(text, (size_t)length);
+}
+
+// repr() de um float no Python: o menor número de dígitos que volta ao mesmo valor, em
+// notação fixa quando o expoente decimal fica entre -4 e 15
+static void jit_print_float(double value) {
+    char text[64];
+    if (isnan(value)) {
+        output_append("nan\n", 4);
+        return;
+    }
+    if (isinf(value)) {
+        output_append(value > 0 ? "inf\n" : "-inf\n", value > 0 ? 4 : 5);
+        return;
+    }
+    char scientific[40];
+    for (int precision = 1; precision <= 17; precision++) {
+        snprintf(scientific, sizeof(scientific), "%.*e", precision - 1, value);
+        if (strtod(scientific, NULL) == value) break;
+    }
+    char digits[24];
+    int digit_count = 0;
+    const char* p = scientific;
+    int negative = *p == '-';
+    if (negative) p++;
+    for (; *p != 'e'; p++) {
+        if (*p != '.') digits[digit_count++] = *p;
+    }
+    int exponent = atoi(p + 1);
+    while (digit_count > 1 && digits[digit_count - 1] == '0') digit_count--;
+
+    int length = 0;
+    if (negative) text[length++] = '-';
+    if (exponent >= -4 && exponent < 16) {
+        int point = exponent + 1; // Dígitos antes da vírgula
+        if (point <= 0) {
+            text[length++] = '0';
+            text[length++] = '.';
+            for (int i = 0; i < -point; i++) text[length++] = '0';
+            for (int i = 0; i < digit_count; i++) text[length++] = digits[i];
+        } else {
+            for (int i = 0; i < point; i++) text[length++] = i < digit_count ? digits[i] : '0';
+            text[length++] = '.';
+            if (point >= digit_count) text[length++] = '0';
+            for (int i = point; i < digit_count; i++) text[length++] = digits[i];
+        }
+    } else {
+        text[length++] = digits[0];
+        if (digit_count > 1) {
+            text[length++] = '.';
+            for (int i = 1; i < digit_count; i++) text[length++] = digits[i];
+        }
+        length += snprintf(text + length, sizeof(text) - length, "e%c%02d", exponent < 0 ? '-' : '+', abs(exponent));
+    }
+    text[length++] = '\n';
+    output_append(text, (size_t)length);
+}
+
+static void jit_trap(int reason) {
+    longjmp(run_env, reason + 1);
+}
+
+// --- Comandos ---
+
+static void compile_statement(JitCompiler* c, ASTNode* node);
+
+static void emit_return(JitCompiler* c) {
+    EMIT(c, 0x49, 0xFF, 0xCE);                                       // dec r14
+    EMIT(c, 0x48, 0x89, 0xEC);                                       // mov rsp, rbp
+    EMIT(c, 0x5D);                                                   // pop rbp
+    EMIT(c, 0xC3);                                                   // ret
+}
+
+static void emit_return_none(JitCompiler* c) {
+    EMIT(c, 0x31, 0xC0);                                             // xor eax, eax
+    EMIT(c, 0xBA, 0x01, 0x00, 0x00, 0x00);                           // mov edx, 1
+    emit_return(c);
+}
+
+// print(x) segue o output.py: %d nas expressões inteiras e %s (str) nas chamadas
+static void compile_print(JitCompiler* c, ASTNode* node) {
+    ASTNodeList* args = node->data.func_call.args;
+    if (!args) {
+        JitText* text = new_text(c, "\n", 1);
+        EMIT(c, 0x48, 0xBF);                                         // mov rdi, imm64
+        emit_u64(c, (uint64_t)(uintptr_t)text->text);
+        EMIT(c, 0x48, 0xC7, 0xC6);                                   // mov rsi, imm32
+        emit_u32(c, (uint32_t)text->length);
+        emit_c_call(c, (void*)jit_print_text);
+        return;
+    }
+    if (args->next) unsupported(c, node, "'print' com mais de um argumento");
+    ASTNode* value = args->node;
+    if (value->type == NODE_STRING_LITERAL) {
+        // O Python interpretaria as sequências de escape do literal
+        if (strchr(value->data.string_literal, '\\')) unsupported(c, value, "string com '\\'");
+        size_t length = strlen(value->data.string_literal);
+        JitText* text = new_text(c, value->data.string_literal, length + 1);
+        text->text[length] = '\n';
+        EMIT(c, 0x48, 0xBF);                                         // mov rdi, imm64
+        emit_u64(c, (uint64_t)(uintptr_t)text->text);
+        EMIT(c, 0x48, 0xC7, 0xC6);                                   // mov rsi, imm32
+        emit_u32(c, (uint32_t)text->length);
+        emit_c_call(c, (void*)jit_print_text);
+        return;
+    }
+    if (value->type != NODE_FUNC_CALL) {
+        int integer = ast_is_integer(value); // A mesma escolha de gen_print: %d ou %s
+        if (!integer && may_be_bool(c, value)) unsupported(c, value, "'print' de um bool");
+        JitType type = compile_expression(c, value);
+        if (integer && type == JT_FLOAT) {
+            // "%d" % x trunca o float; infinito e NaN são erros no Python
+            EMIT(c, 0xF2, 0x48, 0x0F, 0x2C, 0xC0);                   // cvttsd2si rax, xmm0
+            EMIT(c, 0x48, 0xB9);                                     // mov rcx, imm64
+            emit_u64(c, 0x8000000000000000ull);
+            EMIT(c, 0x48, 0x39, 0xC8);                               // cmp rax, rcx
+            emit_trap_if(c, CC_E, TRAP_PRECISION);
+            type = JT_INT;
+        }
+        if (type == JT_FLOAT) {
+            emit_c_call(c, (void*)jit_print_float);
+        } else {
+            EMIT(c, 0x48, 0x89, 0xC7);                               // mov rdi, rax
+            emit_c_call(c, (void*)jit_print_int);
+        }
+        return;
+    }
+    if (!node_value(c, value)) unsupported(c, value, "'print' de 'print'");
+    JitFunction* callee = compile_call(c, value);
+    if (callee->return_type == JT_INT && callee->returns_bool) unsupported(c, value, "'print' de um bool");
+    EMIT(c, 0x48, 0x85, 0xD2);                                       // test rdx, rdx
+    size_t has_value = emit_jump(c, CC_E);
+    JitText* none = new_text(c, "None\n", 5);
+    EMIT(c, 0x48, 0xBF);                                             // mov rdi, imm64
+    emit_u64(c, (uint64_t)(uintptr_t)none->text);
+    EMIT(c, 0x48, 0xC7, 0xC6);                                       // mov rsi, imm32
+    emit_u32(c, (uint32_t)none->length);
+    emit_c_call(c, (void*)jit_print_text);
+    size_t done = emit_jump(c, CC_ALWAYS);
+    patch_jump(c, has_value);
+    if (callee->return_type == JT_FLOAT) {
+        EMIT(c, 0x66, 0x48, 0x0F, 0x6E, 0xC0);                       // movq xmm0, rax
+        emit_c_call(c, (void*)jit_print_float);
+    } else {
+        EMIT(c, 0x48, 0x89, 0xC7);                                   // mov rdi, rax
+        emit_c_call(c, (void*)jit_print_int);
+    }
+    patch_jump(c, done);
+}
+
+static void compile_assignment(JitCompiler* c, ASTNode* node, JitVar* var, ASTNode* value) {
+    JitType type = compile_expression(c, value);
+    if (type != var->type) unsupported(c, node, "valor de tipo diferente da variável");
+    emit_store(c, var);
+}
+
+static void compile_statement(JitCompiler* c, ASTNode* node) {
+    if (!node) return;
+    switch (node->type) {
+        case NODE_VAR_DECL: {
+            JitVar* var = (JitVar*)node_value(c, node);
+            if (node->data.var_decl.initial_value) {
+                compile_assignment(c, node, var, node->data.var_decl.initial_value);
+            } else if (var->has_flag) {
+                emit_memory(c, 0, 1, 0, 0xC7, 0, var->base, var->flag_disp); // mov qword [flag], 0
+                emit_u32(c, 0);
+            }
+            break;
+        }
+        case NODE_ASSIGN:
+            compile_assignment(c, node, (JitVar*)node_value(c, node->data.assign_expr.lvalue),
+                               node->data.assign_expr.rvalue);
+            break;
+        case NODE_BLOCK:
+            for (ASTNodeList* l = node->data.block.statements; l; l = l->next) compile_statement(c, l->node);
+            break;
+        case NODE_IF: {
+            size_t otherwise = compile_condition(c, node->data.if_stmt.condition);
+            compile_statement(c, node->data.if_stmt.if_body);
+            if (node->data.if_stmt.else_body) {
+                size_t done = emit_jump(c, CC_ALWAYS);
+                patch_jump(c, otherwise);
+                compile_statement(c, node->data.if_stmt.else_body);
+                patch_jump(c, done);
+            } else {
+                patch_jump(c, otherwise);
+            }
+            break;
+        }
+        case NODE_WHILE: {
+            size_t top = c->size;
+            size_t exit = compile_condition(c, node->data.while_stmt.condition);
+            compile_statement(c, node->data.while_stmt.body);
+            emit_jump_to(c, CC_ALWAYS, top);
+            patch_jump(c, exit);
+            break;
+        }
+        case NODE_FOR: {
+            compile_statement(c, node->data.for_stmt.init);
+            size_t top = c->size;
+            size_t exit = 0;
+            if (node->data.for_stmt.condition) exit = compile_condition(c, node->data.for_stmt.condition);
+            compile_statement(c, node->data.for_stmt.body);
+            compile_statement(c, node->data.for_stmt.increment);
+            emit_jump_to(c, CC_ALWAYS, top);
+            if (node->data.for_stmt.condition) patch_jump(c, exit);
+            break;
+        }
+        case NODE_RETURN:
+            if (!c->current) unsupported(c, node, "'return' fora de função");
+            if (!node->data.return_stmt.return_value) {
+                emit_return_none(c);
+                break;
+            }
+            if (compile_expression(c, node->data.return_stmt.return_value) == JT_FLOAT) {
+                EMIT(c, 0x66, 0x48, 0x0F, 0x7E, 0xC0);               // movq rax, xmm0
+            }
+            EMIT(c, 0x31, 0xD2);                                     // xor edx, edx
+            emit_return(c);
+            break;
+        case NODE_FUNC_CALL:
+            if (!node_value(c, node)) {
+                compile_print(c, node);
+            } else {
+                compile_call(c, node);
+            }
+            break;
+        case NODE_IDENTIFIER:
+        case NODE_INT_LITERAL:
+        case NODE_FLOAT_LITERAL:
+        case NODE_STRING_LITERAL:
+            // Sem efeito, mesmo com a variável valendo None (como o resultado de uma
+            // chamada expandida inline a uma função sem 'return' com valor)
+            break;
+        default:
+            // Expressão usada como comando: avaliada e descartada
+            compile_expression(c, node);
+            break;
+    }
+}
+
+static void compile_function(JitCompiler* c, JitFunction* function) {
+    c->current = function;
+    function->offset = c->size;
+    EMIT(c, 0x55);                                                   // push rbp
+    EMIT(c, 0x48, 0x89, 0xE5);                                       // mov rbp, rsp
+    EMIT(c, 0x48, 0x81, 0xEC);                                       // sub rsp, imm32
+    emit_u32(c, (uint32_t)(8 * function->slot_count));
+    EMIT(c, 0x49, 0xFF, 0xC6);                                       // inc r14
+    EMIT(c, 0x49, 0x81, 0xFE);                                       // cmp r14, imm32
+    emit_u32(c, JIT_MAX_CALL_DEPTH);
+    emit_trap_if(c, CC_G, TRAP_DEPTH);
+    ASTNode* body = function->node->type == NODE_FUNC_DEF ? function->node->data.func_def.body
+                                                          : function->node->data.main_def.body;
+    compile_statement(c, body);
+    emit_return_none(c);
+    c->current = NULL;
+}
+
+// Ponto de entrada, chamado do C com a base das globais: inicializa as globais na ordem
+// do programa e chama o main
+static size_t compile_entry(JitCompiler* c, ASTNode* program, JitFunction* main_function) {
+    size_t entry = c->size;
+    EMIT(c, 0x55);                                                   // push rbp
+    EMIT(c, 0x48, 0x89, 0xE5);                                       // mov rbp, rsp
+    EMIT(c, 0x53);                                                   // push rbx
+    EMIT(c, 0x41, 0x56);                                             // push r14
+    EMIT(c, 0x41, 0x57);                                             // push r15
+    EMIT(c, 0x48, 0x83, 0xEC, 0x08);                                 // sub rsp, 8
+    EMIT(c, 0x49, 0x89, 0xFF);                                       // mov r15, rdi
+    EMIT(c, 0x41, 0xBE, 0x01, 0x00, 0x00, 0x00);                     // mov r14d, 1 (o módulo)
+    for (ASTNodeList* l = program->data.program.declarations; l; l = l->next) {
+        if (l->node->type == NODE_VAR_DECL) compile_statement(c, l->node);
+    }
+    if (main_function) emit_call_to(c, main_function->offset);
+    EMIT(c, 0x48, 0x83, 0xC4, 0x08);                                 // add rsp, 8
+    EMIT(c, 0x41, 0x5F);                                             // pop r15
+    EMIT(c, 0x41, 0x5E);                                             // pop r14
+    EMIT(c, 0x5B);                                                   // pop rbx
+    EMIT(c, 0x5D);                                                   // pop rbp
+    EMIT(c, 0xC3);                                                   // ret
+    return entry;
+}
+
+static void compile_traps(JitCompiler* c) {
+    for (int reason = 0; reason < TRAP_COUNT; reason++) {
+        c->traps[reason] = c->size;
+        EMIT(c, 0xBF);                                               // mov edi, imm32
+        emit_u32(c, (uint32_t)reason);
+        EMIT(c, 0x48, 0x83, 0xE4, 0xF0);                             // and rsp, -16
+        EMIT(c, 0x48, 0xB8);                                         // mov rax, imm64
+        emit_u64(c, (uint64_t)(uintptr_t)jit_trap);
+        EMIT(c, 0xFF, 0xD0);                                         // call rax
+    }
+}
+
+// Executa o código; devolve 0, ou o motivo do abandono mais 1
+static int execute(void (*entry)(int64_t*), int64_t* globals) {
+    int trap = setjmp(run_env);
+    if (trap == 0) entry(globals);
+    return trap;
+}
+
+static void free_compiler(JitCompiler* c) {
+    free(c->code);
+    free(c->entries);
+    free(c->marks);
+    free(c->nodes);
+    while (c->vars) {
+        JitVar* next = c->vars->next;
+        free(c->vars);
+        c->vars = next;
+    }
+    while (c->functions) {
+        JitFunction* next = c->functions->next;
+        free(c->functions->params);
+        free(c->functions);
+        c->functions = next;
+    }
+    while (c->texts) {
+        JitText* next = c->texts->next;
+        free(c->texts);
+        c->texts = next;
+    }
+}
+
+JitStatus run_jit(ASTNode* program, char* reason, size_t reason_size) {
+    if (ast_depth(program) > JIT_MAX_DEPTH) {
+        snprintf(reason, reason_size, "AST com mais de %d níveis", JIT_MAX_DEPTH);
+        return JIT_UNSUPPORTED;
+    }
+    JitCompiler* c = (JitCompiler*)jit_alloc(sizeof(JitCompiler));
+    memset(c->buckets, 0xFF, sizeof(c->buckets)); // -1 = vazio
+    c->reason = reason;
+    c->reason_size = reason_size;
+    if (setjmp(c->abort)) {
+        free_compiler(c);
+        free(c);
+        return JIT_UNSUPPORTED;
+    }
+
+    resolve_node(c, program);
+    JitFunction* main_function = NULL;
+    for (JitFunction* f = c->functions; f; f = f->next) {
+        if (f->node->type == NODE_MAIN_DEF) main_function = f;
+    }
+    infer_types(c, program);
+
+    compile_traps(c);
+    for (JitFunction* f = c->functions; f; f = f->next) compile_function(c, f);
+    size_t entry_offset = compile_entry(c, program, main_function);
+
+    void* pages = mmap(NULL, c->size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (pages == MAP_FAILED || (memcpy(pages, c->code, c->size), mprotect(pages, c->size, PROT_READ | PROT_EXEC)) != 0) {
+        snprintf(reason, reason_size, "não foi possível obter memória executável");
+        if (pages != MAP_FAILED) munmap(pages, c->size);
+        free_compiler(c);
+        free(c);
+        return JIT_UNSUPPORTED;
+    }
+    int64_t* globals = (int64_t*)jit_alloc((size_t)(c->global_count + 1) * 16);
+    void (*entry)(int64_t*);
+    void* entry_address = (unsigned char*)pages + entry_offset;
+    memcpy(&entry, &entry_address, sizeof(entry));
+    output_size = 0;
+    int trap = execute(entry, globals);
+
+    JitStatus status = JIT_EXECUTED;
+    if (trap) {
+        snprintf(reason, reason_size, "execução abandonada: %s", trap_messages[trap - 1]);
+        status = JIT_ABANDONED;
+    } else {
+        fwrite(output_text, 1, output_size, stdout);
+        fflush(stdout);
+    }
+    free(output_text);
+    output_text = NULL;
+    output_size = output_capacity = 0;
+    free(globals);
+    munmap(pages, c->size);
+    free_compiler(c);
+    free(c);
+    return status;
+}
+
+#else
+
+JitStatus run_jit(ASTNode* program, char* reason, size_t reason_size) {
+    (void)program;
+    snprintf(reason, reason_size, "o JIT só gera código para x86-64 Linux");
+    return JIT_UNSUPPORTED;
+}
+
+#endif
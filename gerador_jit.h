@@ -0,0 +1,30 @@
+#ifndef GERADOR_JIT_H
+#define GERADOR_JIT_H
+
+#include <stddef.h>
+#include "ast.h"
+
+// --- Compilador JIT (x86-64 Linux) ---
+//
+// Traduz a AST analisada e otimizada direto para código de máquina, em páginas
+// executáveis obtidas com mmap, e executa o programa em seguida, sem ferramentas
+// externas. O resultado deve ser o mesmo do output.py: os inteiros são de 64 bits, e as
+// operações em que o Python se comportaria de outro modo (estouro, divisão por zero,
+// inteiros grandes demais para a divisão em ponto flutuante, variável ainda None,
+// recursão profunda) abandonam a execução. A saída fica em memória até o fim, então uma
+// execução abandonada não escreve nada, e o programa pode ser executado pelo Python.
+
+typedef enum {
+    JIT_EXECUTED,    // O programa rodou até o fim e a saída foi escrita
+    JIT_UNSUPPORTED, // O programa usa algo que o JIT não traduz: nada foi executado
+    JIT_ABANDONED    // A execução foi interrompida e a saída, descartada
+} JitStatus;
+
+/**
+ * @brief Compila o programa para código de máquina e o executa (inicialização das
+ * globais e main). A saída de 'print' vai para a saída padrão.
+ * @param reason Recebe o motivo quando o resultado não é JIT_EXECUTED.
+ */
+JitStatus run_jit(ASTNode* program, char* reason, size_t reason_size);
+
+#endif // GERADOR_JIT_H
@@ -0,0 +1,264 @@
+// Define _DEFAULT_SOURCE para habilitar clock_gettime
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "gerenciador_passes.h"
+#include "analisador_semantico.h"
+#include "otimizador.h"
+#include "diagnosticos.h"
+
+// Passes fundidos em um percurso: um bit por passe na máscara 'active' de cada nó
+#define MAX_FUSED_PASSES 32
+#define MAX_PASS_TIMINGS 16
+
+static void print_ast_run(ASTNode* root) {
+    print_ast(root, 0);
+}
+
+// A impressão é de árvore inteira: fundida a outros passes, as mensagens deles
+// ficariam misturadas às linhas da árvore
+static const Pass print_ast_pass = {
+    .name = "print_ast",
+    .optional = 1,
+    .run = print_ast_run,
+};
+
+static const Pass* const registry[PASS_COUNT] = {
+    [PASS_SEMA] = &semantic_pass,
+    [PASS_PRINT_AST] = &print_ast_pass,
+    [PASS_FOLD] = &fold_pass,
+    [PASS_PRUNE] = &prune_pass,
+    [PASS_OPTIMIZE] = &optimize_pass,
+};
+
+// --- Opções e Tempos ---
+
+static unsigned disabled_passes = 0;
+static int fusion_enabled = 1;
+
+static PassTiming timings[MAX_PASS_TIMINGS];
+static int timing_count = 0;
+
+static double now_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1.0e6;
+}
+
+static void record_timing(unsigned passes, long nodes, double wall_ms) {
+    PassTiming* timing = NULL;
+    for (int i = 0; i < timing_count; i++) {
+        if (timings[i].passes == passes) timing = &timings[i];
+    }
+    if (!timing) {
+        if (timing_count == MAX_PASS_TIMINGS) return;
+        timing = &timings[timing_count++];
+        memset(timing, 0, sizeof(*timing));
+        timing->passes = passes;
+        for (int id = 0; id < PASS_COUNT; id++) {
+            if (!(passes & PASS_BIT(id))) continue;
+            size_t used = strlen(timing->name);
+            snprintf(timing->name + used, sizeof(timing->name) - used, "%s%s", used ? "+" : "", registry[id]->name);
+        }
+    }
+    timing->runs++;
+    timing->nodes += nodes;
+    timing->wall_ms += wall_ms;
+}
+
+int find_pass(const char* name) {
+    for (int id = 0; id < PASS_COUNT; id++) {
+        if (strcmp(registry[id]->name, name) == 0) return id;
+    }
+    return -1;
+}
+
+const char* pass_name(PassId id) {
+    return registry[id]->name;
+}
+
+int disable_pass(PassId id) {
+    if (!registry[id]->optional) return 0;
+    disabled_passes |= PASS_BIT(id);
+    // Os dependentes também saem, até que nenhum outro dependa de um passe desativado
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+        for (int other = 0; other < PASS_COUNT; other++) {
+            if (!(disabled_passes & PASS_BIT(other)) && (registry[other]->requires & disabled_passes)) {
+                disabled_passes |= PASS_BIT(other);
+                changed = 1;
+            }
+        }
+    }
+    return 1;
+}
+
+int is_pass_enabled(PassId id) {
+    return !(disabled_passes & PASS_BIT(id));
+}
+
+void set_pass_fusion(int enabled) {
+    fusion_enabled = enabled;
+}
+
+const PassTiming* get_pass_timings(int* count) {
+    *count = timing_count;
+    return timings;
+}
+
+// --- Percurso ---
+
+typedef struct {
+    ASTNode** slot;
+    ASTNode* parent;
+    unsigned active;  // Passes (índices no percurso) que visitam este nó
+    int depth;
+    int height;       // Maior altura entre os filhos já concluídos
+    int parent_frame; // Índice do quadro do pai (-1 na raiz)
+    int expanded;     // Pré-ordem já executada e filhos empilhados
+} WalkFrame;
+
+typedef struct {
+    WalkFrame* items;
+    int count;
+    int capacity;
+} WalkStack;
+
+static void push_frame(WalkStack* stack, WalkFrame frame) {
+    if (stack->count == stack->capacity) {
+        int capacity = stack->capacity ? stack->capacity * 2 : 64;
+        WalkFrame* grown = (WalkFrame*)realloc(stack->items, capacity * sizeof(WalkFrame));
+        if (!grown) {
+            report_error("Erro de Memória: falha ao alocar a pilha do gerenciador de passes.\n");
+            fatal_error();
+        }
+        stack->items = grown;
+        stack->capacity = capacity;
+    }
+    stack->items[stack->count++] = frame;
+}
+
+// Empilha os filhos não nulos do nó do quadro 'parent_index' para que sejam visitados na
+// ordem da sintaxe: primeiro a lista, depois os filhos diretos (como em print_ast).
+static void push_child_frames(WalkStack* stack, int parent_index, unsigned active) {
+    ASTNode* node = *stack->items[parent_index].slot;
+    WalkFrame child = { NULL, node, active, stack->items[parent_index].depth + 1, 0, parent_index, 0 };
+    ASTLayout layout = ast_layout(node);
+    for (int i = layout.child_count - 1; i >= 0; i--) {
+        if (!*layout.child[i]) continue;
+        child.slot = layout.child[i];
+        push_frame(stack, child);
+    }
+    if (layout.list) {
+        int first = stack->count;
+        for (ASTNodeList* l = *layout.list; l; l = l->next) {
+            if (!l->node) continue;
+            child.slot = &l->node;
+            push_frame(stack, child);
+        }
+        for (int i = first, j = stack->count - 1; i < j; i++, j--) {
+            WalkFrame tmp = stack->items[i];
+            stack->items[i] = stack->items[j];
+            stack->items[j] = tmp;
+        }
+    }
+}
+
+long walk_passes(ASTNode* root, const Pass* const* passes, int count) {
+    if (!root || count <= 0) return 0;
+    for (int i = 0; i < count; i++) {
+        if (passes[i]->begin) passes[i]->begin(root);
+    }
+
+    // A raiz fica numa variável local: os ganchos não a substituem
+    ASTNode* root_slot = root;
+    unsigned all = count >= MAX_FUSED_PASSES ? ~0u : (1u << count) - 1;
+    long visited = 0;
+    WalkStack stack = {0};
+    push_frame(&stack, (WalkFrame){ &root_slot, NULL, all, 0, 0, -1, 0 });
+    while (stack.count > 0) {
+        int index = stack.count - 1;
+        WalkFrame* frame = &stack.items[index];
+        ASTNode* node = *frame->slot;
+        PassVisit visit = { frame->slot, frame->parent, frame->depth, 0 };
+
+        if (!frame->expanded) {
+            frame->expanded = 1;
+            visited++;
+            unsigned descend = 0;
+            for (int i = 0; i < count; i++) {
+                if (!(frame->active & (1u << i))) continue;
+                if (!passes[i]->pre || passes[i]->pre(&visit)) descend |= 1u << i;
+            }
+            if (descend) push_child_frames(&stack, index, descend);
+            continue;
+        }
+
+        visit.height = frame->height + 1;
+        for (int i = 0; i < count && *frame->slot == node; i++) {
+            if ((frame->active & (1u << i)) && passes[i]->post) passes[i]->post(&visit);
+        }
+        if (frame->parent_frame >= 0 && stack.items[frame->parent_frame].height < visit.height) {
+            stack.items[frame->parent_frame].height = visit.height;
+        }
+        stack.count--;
+    }
+    free(stack.items);
+
+    for (int i = 0; i < count; i++) {
+        if (passes[i]->end) passes[i]->end(root);
+    }
+    return visited;
+}
+
+// --- Pipeline ---
+
+void run_passes(ASTNode* root, const PassId* passes, int count, unsigned* completed) {
+    unsigned done = completed ? *completed : 0;
+    int next = 0;
+    while (next < count) {
+        // Próximo grupo: um passe de árvore inteira, ou passes consecutivos com ganchos
+        const Pass* group[MAX_FUSED_PASSES];
+        unsigned group_mask = 0;
+        int group_size = 0;
+        while (next < count) {
+            PassId id = passes[next];
+            const Pass* pass = registry[id];
+            if (disabled_passes & PASS_BIT(id)) {
+                next++;
+                continue;
+            }
+            if (group_size > 0 && (pass->run || !fusion_enabled || group_size == MAX_FUSED_PASSES)) break;
+            next++;
+            unsigned missing = pass->requires & ~(done | group_mask);
+            if (missing) {
+                for (int other = 0; other < PASS_COUNT; other++) {
+                    if (missing & PASS_BIT(other)) {
+                        report_info("Passe '%s' não executado: depende de '%s'.\n", pass->name, registry[other]->name);
+                        break;
+                    }
+                }
+                continue;
+            }
+            group[group_size++] = pass;
+            group_mask |= PASS_BIT(id);
+            if (pass->run) break;
+        }
+        if (group_size == 0) continue;
+
+        double start = now_ms();
+        long nodes = 0;
+        if (group[0]->run) {
+            group[0]->run(root);
+        } else {
+            nodes = walk_passes(root, group, group_size);
+        }
+        record_timing(group_mask, nodes, now_ms() - start);
+        done |= group_mask;
+    }
+    if (completed) *completed = done;
+}
@@ -0,0 +1,103 @@
+#ifndef GERENCIADOR_PASSES_H
+#define GERENCIADOR_PASSES_H
+
+#include <stdio.h>
+#include "ast.h"
+
+// --- Gerenciador de Passes ---
+//
+// Um passe declara ganchos por nó (pré-ordem e pós-ordem) ou, quando precisa ver a
+// árvore inteira de uma vez, uma função 'run'. Passes consecutivos com ganchos por nó
+// são fundidos em um único percurso iterativo: em cada nó os ganchos de pré-ordem rodam
+// na ordem do pipeline antes dos filhos, e os de pós-ordem, na mesma ordem, depois
+// deles. Um passe que depende de outro do mesmo percurso vê, portanto, o resultado dele
+// em toda a subárvore do nó atual (mas não no resto da árvore).
+
+// Passes registrados
+typedef enum {
+    PASS_SEMA,      // "sema": análise semântica e anotação de tipos
+    PASS_PRINT_AST, // "print_ast": impressão da AST
+    PASS_FOLD,      // "fold": dobramento de constantes e simplificação algébrica
+    PASS_PRUNE,     // "prune": poda de ramos mortos (if e laços com condição constante)
+    PASS_OPTIMIZE,  // "opt": demais etapas do otimizador (inline, código morto, laços e CSE)
+    PASS_COUNT
+} PassId;
+
+#define PASS_BIT(id) (1u << (id))
+
+// Nó em visita, como os ganchos o recebem
+typedef struct {
+    ASTNode** slot;  // Onde o nó está guardado: campo do pai, célula de lista ou a raiz
+    ASTNode* parent; // NULL na raiz do percurso
+    int depth;       // Distância até a raiz do percurso
+    int height;      // Altura da subárvore visitada (só na pós-ordem; 1 numa folha)
+} PassVisit;
+
+typedef struct {
+    const char* name;     // Nome usado em --disable-pass e no relatório de tempo
+    unsigned requires;    // Passes (PASS_BIT) que precisam ter rodado antes deste
+    int optional;         // Diferente de zero se o passe pode ser desativado
+    void (*begin)(ASTNode* root);
+    int (*pre)(const PassVisit* visit);   // Devolve 0 para não visitar os filhos do nó neste passe
+    void (*post)(const PassVisit* visit); // Pode trocar o nó em *visit->slot (exceto na raiz);
+                                          // a troca encerra a pós-ordem do nó nos passes seguintes
+    void (*end)(ASTNode* root);
+    void (*run)(ASTNode* root);           // Passe de árvore inteira: nunca é fundido
+} Pass;
+
+// Tempo acumulado de um percurso (ou passe de árvore inteira) executado por run_passes
+typedef struct {
+    char name[64];   // Passes do percurso, separados por '+'
+    unsigned passes;
+    int runs;
+    long nodes;      // Nós visitados (0 nos passes de árvore inteira)
+    double wall_ms;
+} PassTiming;
+
+/**
+ * @brief Percorre a árvore uma única vez aplicando os ganchos dos passes dados, na
+ * ordem, sem consultar as opções do gerenciador. As fases usam esta função nos seus
+ * próprios percursos (a análise semântica isolada, o dobramento após a expansão inline).
+ * @return O número de nós visitados.
+ */
+long walk_passes(ASTNode* root, const Pass* const* passes, int count);
+
+/**
+ * @brief Executa os passes na ordem dada. Passes desativados são ignorados, e os passes
+ * consecutivos com ganchos por nó são fundidos em um só percurso (a menos que a fusão
+ * tenha sido desligada). Um passe cujas dependências não rodaram é ignorado com aviso.
+ * @param completed Entrada e saída: passes já executados sobre a árvore (PASS_BIT).
+ * Pode ser NULL quando a árvore ainda não passou por nenhum.
+ */
+void run_passes(ASTNode* root, const PassId* passes, int count, unsigned* completed);
+
+/**
+ * @brief Procura um passe pelo nome.
+ * @return O identificador, ou -1 se não houver passe com esse nome.
+ */
+int find_pass(const char* name);
+
+const char* pass_name(PassId id);
+
+/**
+ * @brief Desativa um passe opcional e, com ele, os passes que dependem dele.
+ * @return 0 se o passe não puder ser desativado.
+ */
+int disable_pass(PassId id);
+
+int is_pass_enabled(PassId id);
+
+/**
+ * @brief Liga ou desliga a fusão: desligada, cada passe faz o seu próprio percurso
+ * (útil para medir o custo de cada um e para comparar as duas execuções).
+ */
+void set_pass_fusion(int enabled);
+
+/**
+ * @brief Tempos acumulados dos percursos executados por run_passes, na ordem da
+ * primeira execução.
+ * @param count Recebe o número de entradas.
+ */
+const PassTiming* get_pass_timings(int* count);
+
+#endif // GERENCIADOR_PASSES_H
@@ -0,0 +1,125 @@
+// Define _DEFAULT_SOURCE para habilitar open_memstream e clock_gettime
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+#include <time.h>
+#include "libcompilador.h"
+#include "parser.h"
+#include "analisador_semantico.h"
+#include "otimizador.h"
+#include "gerador_codigo.h"
+#include "diagnosticos.h"
+
+static double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1.0e9;
+}
+
+// Fecha o stream em memória e, se ele não existir, devolve uma string vazia
+static char* close_buffer(FILE* stream, char** data, size_t* size) {
+    if (stream) fclose(stream);
+    if (!*data) {
+        *data = calloc(1, 1);
+        *size = 0;
+    }
+    return *data;
+}
+
+CompilerOptions compiler_default_options() {
+    CompilerOptions options;
+    options.optimize = 1;
+    options.capture_log = 0;
+    options.max_nesting = 0;
+    return options;
+}
+
+CompileStatus compile_source(const char* source, size_t length, const CompilerOptions* options,
+                             CompileResult* result) {
+    CompilerOptions defaults = compiler_default_options();
+    if (!options) options = &defaults;
+    memset(result, 0, sizeof(*result));
+
+    // O parser espera o código-fonte terminado em '\0'
+    char* buffer = malloc(length + 1);
+    FILE* code = open_memstream(&result->code, &result->code_length);
+    FILE* diagnostics = open_memstream(&result->diagnostics, &result->diagnostics_length);
+    FILE* log = options->capture_log ? open_memstream(&result->log, &result->log_length) : NULL;
+    if (!buffer || !code || !diagnostics || (options->capture_log && !log)) {
+        free(buffer);
+        close_buffer(code, &result->code, &result->code_length);
+        close_buffer(diagnostics, &result->diagnostics, &result->diagnostics_length);
+        if (log) close_buffer(log, &result->log, &result->log_length);
+        result->status = COMPILE_ABORTED;
+        return result->status;
+    }
+    memcpy(buffer, source, length);
+    buffer[length] = '\0';
+
+    // Alterados depois de setjmp: precisam ser volatile para valer após o longjmp
+    ASTNode* volatile ast_root = NULL;
+    volatile CompileStatus status = COMPILE_ERRORS;
+    jmp_buf recovery;
+
+    set_report_streams(diagnostics, log);
+    if (setjmp(recovery) == 0) {
+        set_fatal_recovery(&recovery);
+        CompilerStats* stats = &result->stats;
+
+        double start = now_seconds();
+        set_max_nesting_depth(options->max_nesting);
+        ast_root = parse_program(buffer);
+        stats->parse_seconds = now_seconds() - start;
+        stats->tokens = get_token_count();
+        stats->ast_nodes_parsed = count_ast_nodes(ast_root);
+
+        start = now_seconds();
+        analyze_semantics(ast_root);
+        stats->sema_seconds = now_seconds() - start;
+        stats->semantic_errors = get_semantic_error_count();
+        if (stats->semantic_errors > 0) {
+            report_error("\nCompilação falhou com %d erro(s) semântico(s).\n", stats->semantic_errors);
+        } else {
+            if (options->optimize) {
+                start = now_seconds();
+                optimize_ast(ast_root);
+                stats->opt_seconds = now_seconds() - start;
+            }
+            stats->ast_nodes_optimized = count_ast_nodes(ast_root);
+
+            start = now_seconds();
+            generate_code_to_stream(ast_root, code);
+            stats->codegen_seconds = now_seconds() - start;
+            status = COMPILE_OK;
+        }
+    } else {
+        // fatal_error: erro sintático (a árvore parcial é liberada aqui) ou falta de memória
+        discard_partial_parse();
+        status = ast_root ? COMPILE_ABORTED : COMPILE_ERRORS;
+    }
+    set_fatal_recovery(NULL);
+    set_report_streams(stderr, stdout);
+
+    if (ast_root) free_ast(ast_root);
+    free(buffer);
+    close_buffer(code, &result->code, &result->code_length);
+    close_buffer(diagnostics, &result->diagnostics, &result->diagnostics_length);
+    if (log) close_buffer(log, &result->log, &result->log_length);
+    if (status != COMPILE_OK) {
+        free(result->code);
+        result->code = NULL;
+        result->code_length = 0;
+    }
+    result->status = status;
+    return result->status;
+}
+
+void compile_result_free(CompileResult* result) {
+    free(result->code);
+    free(result->diagnostics);
+    free(result->log);
+    memset(result, 0, sizeof(*result));
+}
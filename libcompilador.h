@@ -0,0 +1,70 @@
+#ifndef LIBCOMPILADOR_H
+#define LIBCOMPILADOR_H
+
+#include <stddef.h>
+
+// --- Interface de Biblioteca do Compilador (libcompilador.a) ---
+//
+// Compila um código-fonte em memória, sem arquivos temporários e sem encerrar o
+// processo em caso de erro. As fases guardam estado em variáveis estáticas, que são
+// reiniciadas a cada chamada: a biblioteca atende uma compilação por vez por processo
+// (quem a usa a partir de várias threads deve serializar as chamadas).
+
+// Opções da compilação
+typedef struct {
+    int optimize;     // Diferente de zero executa a Fase 4 (otimização)
+    int capture_log;  // Diferente de zero guarda as mensagens de progresso em 'log'
+    int max_nesting;  // Níveis de aninhamento aceitos pelo parser (0: o limite padrão)
+} CompilerOptions;
+
+// Estatísticas da compilação
+typedef struct {
+    int tokens;
+    int ast_nodes_parsed;
+    int ast_nodes_optimized;
+    int semantic_errors;
+    double parse_seconds;
+    double sema_seconds;
+    double opt_seconds;
+    double codegen_seconds;
+} CompilerStats;
+
+typedef enum {
+    COMPILE_OK = 0,
+    COMPILE_ERRORS = 1,  // Erros léxicos, sintáticos ou semânticos (em 'diagnostics')
+    COMPILE_ABORTED = 2  // Falta de memória ou falha ao criar os buffers de saída
+} CompileStatus;
+
+// Resultado de compile_source; os buffers terminam em '\0' e são liberados por
+// compile_result_free
+typedef struct {
+    CompileStatus status;
+    char* code;             // Código Python gerado (NULL se status != COMPILE_OK)
+    size_t code_length;
+    char* diagnostics;      // Mensagens de erro, no mesmo formato do compilador de linha de comando
+    size_t diagnostics_length;
+    char* log;              // Mensagens de progresso das fases (NULL sem capture_log)
+    size_t log_length;
+    CompilerStats stats;
+} CompileResult;
+
+/**
+ * @brief Opções padrão: otimização ativada, mensagens de progresso descartadas e o
+ * limite de aninhamento padrão do parser.
+ */
+CompilerOptions compiler_default_options();
+
+/**
+ * @brief Executa as fases de 1 a 5 sobre o código-fonte.
+ * @param source Código-fonte (não precisa terminar em '\0').
+ * @param length Tamanho do código-fonte em bytes.
+ * @param options Opções da compilação, ou NULL para as opções padrão.
+ * @param result Recebe o código gerado, os diagnósticos e as estatísticas.
+ * @return O mesmo valor de result->status.
+ */
+CompileStatus compile_source(const char* source, size_t length, const CompilerOptions* options,
+                             CompileResult* result);
+
+void compile_result_free(CompileResult* result);
+
+#endif // LIBCOMPILADOR_H
@@ -1,20 +1,481 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <limits.h>
 #include "analisador.h"
 #include "parser.h"
 #include "analisador_semantico.h"
 #include "otimizador.h"
 #include "gerador_codigo.h"
+#include "gerador_jit.h"
 #include "ast.h"
+#include "estatisticas.h"
+#include "cache_compilacao.h"
+#include "serializador_ast.h"
+#include "compilacao_incremental.h"
+#include "servidor_compilacao.h"
+#include "gerenciador_passes.h"
+#include "perfil_execucao.h"
 
-int main(int argc, char *argv[]) {
-    if (argc < 2) {
-        fprintf(stderr, "Uso: %s <arquivo_fonte>\n", argv[0]);
+// Última fase executada pelo driver (--stop-after)
+typedef enum {
+    STOP_AFTER_LEX,
+    STOP_AFTER_PARSE,
+    STOP_AFTER_SEMA,
+    STOP_AFTER_OPT,
+    STOP_AFTER_CODEGEN // Padrão: pipeline completo
+} StopAfter;
+
+// Opções da linha de comando
+typedef struct {
+    const char* filename;
+    int time_report;              // --time-report: tabela de tempo e memória por fase em stderr
+    int time_report_json;         // --time-report=json: o mesmo relatório em JSON
+    StopAfter stop_after;
+    const char* dump_tokens_file; // --dump-tokens[=arquivo]: tokens no formato de saida.txt
+    const char* cache_dir;        // --cache[=diretório]: reaproveita compilações de fontes inalterados
+    long cache_max_mb;
+    int cache_stats;              // --cache-stats: só mostra as estatísticas do cache
+    const char* emit_ast_file;    // --emit-ast=arquivo: grava a AST binária após a última fase
+    int from_ast;                 // --from-ast: a entrada é uma AST binária, não código-fonte
+    int incremental;              // --incremental: recompila só as declarações alteradas
+    long max_nesting;             // --max-nesting=N: níveis de aninhamento aceitos pelo parser
+    int no_fuse_passes;           // --no-fuse-passes: um percurso da AST por passe
+    int emit_pyc;                 // --emit-pyc: compila também o output.py para output.pyc
+    int jit;                      // --jit: executa o programa com o JIT (ou com o python3)
+    const char* instrument_file;  // --instrument[=arquivo]: o programa grava um perfil de execução
+    const char* profile_file;     // --profile-use[=arquivo]: otimiza com um perfil de execução
+    const char* server_socket;    // --servidor=socket: atende lotes de compilação até ser encerrado
+    long server_workers;          // --servidor-workers=N: compilações simultâneas (padrão: nº de CPUs)
+    long long server_max_bytes;   // --servidor-max-bytes=N: limite da soma dos códigos-fonte de um lote
+    const char* client_socket;    // --conectar=socket: compila os arquivos dados por um servidor
+    char** inputs;                // Arquivos da linha de comando (vários só com --conectar)
+    int input_count;
+} DriverOptions;
+
+static void print_usage(const char* program) {
+    fprintf(stderr, "Uso: %s [--time-report[=json]] [--stop-after=lex|parse|sema|opt] "
+                    "[--dump-tokens[=arquivo]]\n          [--cache[=diretório]] [--cache-max-mb=N] [--cache-stats] "
+                    "[--emit-ast=arquivo] [--from-ast] [--incremental]\n          [--max-nesting=N] "
+                    "[--disable-pass=nome[,nome]] [--no-fuse-passes] [--emit-pyc] [--jit]\n          [--instrument[=arquivo]] [--profile-use[=arquivo]] <arquivo_fonte>\n", program);
+    fprintf(stderr, "       %s --servidor=socket|- [--servidor-workers=N] [--servidor-max-bytes=N] [--cache-max-mb=N]\n", program);
+    fprintf(stderr, "       %s --conectar=socket <arquivo_fonte>...\n", program);
+}
+
+static int parse_stop_after(const char* value, StopAfter* stop_after) {
+    if (strcmp(value, "lex") == 0) *stop_after = STOP_AFTER_LEX;
+    else if (strcmp(value, "parse") == 0) *stop_after = STOP_AFTER_PARSE;
+    else if (strcmp(value, "sema") == 0) *stop_after = STOP_AFTER_SEMA;
+    else if (strcmp(value, "opt") == 0) *stop_after = STOP_AFTER_OPT;
+    else return 0;
+    return 1;
+}
+
+// Máscara (PASS_BIT) dos passes ativos
+static unsigned enabled_passes() {
+    unsigned mask = 0;
+    for (int id = 0; id < PASS_COUNT; id++) {
+        if (is_pass_enabled((PassId)id)) mask |= PASS_BIT(id);
+    }
+    return mask;
+}
+
+// Desativa os passes de uma lista separada por vírgulas (--disable-pass). Devolve 0 se
+// algum nome não for de um passe opcional.
+static int parse_disabled_passes(const char* list) {
+    char name[64];
+    while (*list) {
+        size_t length = strcspn(list, ",");
+        snprintf(name, sizeof(name), "%.*s", (int)length, list);
+        list += length + (list[length] == ',');
+        int id = find_pass(name);
+        if (id >= 0 && !is_pass_enabled((PassId)id)) continue; // Já desativado como dependente
+        unsigned before = enabled_passes();
+        if (id < 0 || !disable_pass((PassId)id)) {
+            fprintf(stderr, "Passe desconhecido ou obrigatório: '%s' (opcionais: print_ast, fold, prune, opt)\n", name);
+            return 0;
+        }
+        unsigned dependents = before & ~enabled_passes() & ~PASS_BIT(id);
+        for (int other = 0; other < PASS_COUNT; other++) {
+            if (dependents & PASS_BIT(other)) {
+                printf("Passe '%s' desativado: depende de '%s'.\n", pass_name((PassId)other), name);
+            }
+        }
+    }
+    return 1;
+}
+
+// Lê as opções; devolve 0 (após mostrar o erro) se a linha de comando for inválida
+static int parse_options(int argc, char* argv[], DriverOptions* opts) {
+    memset(opts, 0, sizeof(*opts));
+    opts->stop_after = STOP_AFTER_CODEGEN;
+    opts->cache_max_mb = CACHE_DEFAULT_MAX_MB;
+    opts->server_max_bytes = SERVER_DEFAULT_MAX_BYTES;
+    opts->inputs = argv + argc; // Preenchido abaixo com os argumentos que não são opções
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--time-report") == 0) {
+            opts->time_report = 1;
+        } else if (strcmp(argv[i], "--time-report=json") == 0) {
+            opts->time_report = 1;
+            opts->time_report_json = 1;
+        } else if (strncmp(argv[i], "--stop-after=", 13) == 0) {
+            if (!parse_stop_after(argv[i] + 13, &opts->stop_after)) {
+                fprintf(stderr, "Fase inválida em %s (use lex, parse, sema ou opt)\n", argv[i]);
+                print_usage(argv[0]);
+                return 0;
+            }
+        } else if (strcmp(argv[i], "--dump-tokens") == 0) {
+            opts->dump_tokens_file = "saida.txt";
+        } else if (strncmp(argv[i], "--dump-tokens=", 14) == 0 && argv[i][14] != '\0') {
+            opts->dump_tokens_file = argv[i] + 14;
+        } else if (strcmp(argv[i], "--cache") == 0) {
+            opts->cache_dir = CACHE_DEFAULT_DIR;
+        } else if (strncmp(argv[i], "--cache=", 8) == 0 && argv[i][8] != '\0') {
+            opts->cache_dir = argv[i] + 8;
+        } else if (strncmp(argv[i], "--cache-max-mb=", 15) == 0) {
+            char* end;
+            opts->cache_max_mb = strtol(argv[i] + 15, &end, 10);
+            if (*end != '\0' || opts->cache_max_mb <= 0) {
+                fprintf(stderr, "Tamanho inválido em %s\n", argv[i]);
+                print_usage(argv[0]);
+                return 0;
+            }
+        } else if (strcmp(argv[i], "--cache-stats") == 0) {
+            opts->cache_stats = 1;
+        } else if (strncmp(argv[i], "--emit-ast=", 11) == 0 && argv[i][11] != '\0') {
+            opts->emit_ast_file = argv[i] + 11;
+        } else if (strcmp(argv[i], "--from-ast") == 0) {
+            opts->from_ast = 1;
+        } else if (strcmp(argv[i], "--incremental") == 0) {
+            opts->incremental = 1;
+        } else if (strncmp(argv[i], "--max-nesting=", 14) == 0) {
+            char* end;
+            opts->max_nesting = strtol(argv[i] + 14, &end, 10);
+            if (*end != '\0' || opts->max_nesting <= 0 || opts->max_nesting > INT_MAX) {
+                fprintf(stderr, "Limite de aninhamento inválido em %s\n", argv[i]);
+                print_usage(argv[0]);
+                return 0;
+            }
+        } else if (strncmp(argv[i], "--disable-pass=", 15) == 0) {
+            if (!parse_disabled_passes(argv[i] + 15)) {
+                print_usage(argv[0]);
+                return 0;
+            }
+        } else if (strcmp(argv[i], "--emit-pyc") == 0) {
+            opts->emit_pyc = 1;
+        } else if (strcmp(argv[i], "--jit") == 0) {
+            opts->jit = 1;
+        } else if (strcmp(argv[i], "--instrument") == 0) {
+            opts->instrument_file = PROFILE_DEFAULT_FILE;
+        } else if (strncmp(argv[i], "--instrument=", 13) == 0 && argv[i][13] != '\0') {
+            opts->instrument_file = argv[i] + 13;
+        } else if (strcmp(argv[i], "--profile-use") == 0) {
+            opts->profile_file = PROFILE_DEFAULT_FILE;
+        } else if (strncmp(argv[i], "--profile-use=", 14) == 0 && argv[i][14] != '\0') {
+            opts->profile_file = argv[i] + 14;
+        } else if (strcmp(argv[i], "--no-fuse-passes") == 0) {
+            opts->no_fuse_passes = 1;
+        } else if (strncmp(argv[i], "--servidor=", 11) == 0 && argv[i][11] != '\0') {
+            opts->server_socket = argv[i] + 11;
+        } else if (strncmp(argv[i], "--servidor-workers=", 19) == 0) {
+            char* end;
+            opts->server_workers = strtol(argv[i] + 19, &end, 10);
+            if (*end != '\0' || opts->server_workers <= 0) {
+                fprintf(stderr, "Número de compilações simultâneas inválido em %s\n", argv[i]);
+                print_usage(argv[0]);
+                return 0;
+            }
+        } else if (strncmp(argv[i], "--servidor-max-bytes=", 21) == 0) {
+            char* end;
+            opts->server_max_bytes = strtoll(argv[i] + 21, &end, 10);
+            if (*end != '\0' || opts->server_max_bytes <= 0) {
+                fprintf(stderr, "Tamanho inválido em %s\n", argv[i]);
+                print_usage(argv[0]);
+                return 0;
+            }
+        } else if (strncmp(argv[i], "--conectar=", 11) == 0 && argv[i][11] != '\0') {
+            opts->client_socket = argv[i] + 11;
+        } else if (strncmp(argv[i], "--", 2) == 0) {
+            fprintf(stderr, "Opção desconhecida: %s\n", argv[i]);
+            print_usage(argv[0]);
+            return 0;
+        } else {
+            // Os argumentos restantes são reunidos no fim de argv, na ordem original
+            if (opts->input_count == 0) opts->inputs = argv + i;
+            opts->inputs[opts->input_count++] = argv[i];
+        }
+    }
+    if (opts->input_count > 0) opts->filename = opts->inputs[0];
+    if (opts->server_socket) return 1;
+    if (opts->input_count > 1 && !opts->client_socket) {
+        print_usage(argv[0]);
+        return 0;
+    }
+    if (!opts->filename && !opts->cache_stats) {
+        print_usage(argv[0]);
+        return 0;
+    }
+    if (opts->from_ast && (opts->dump_tokens_file || opts->stop_after == STOP_AFTER_LEX)) {
+        fprintf(stderr, "Com --from-ast não há tokens: --dump-tokens e --stop-after=lex não se aplicam.\n");
+        return 0;
+    }
+    if (opts->incremental && (opts->from_ast || opts->emit_ast_file || opts->dump_tokens_file ||
+                              opts->stop_after != STOP_AFTER_CODEGEN)) {
+        fprintf(stderr, "--incremental só se aplica à compilação completa de um código-fonte.\n");
+        return 0;
+    }
+    if (opts->incremental && (enabled_passes() | PASS_BIT(PASS_PRINT_AST)) != PASS_BIT(PASS_COUNT) - 1) {
+        fprintf(stderr, "--incremental otimiza cada declaração por completo: não se aplica com --disable-pass.\n");
+        return 0;
+    }
+    // O código de cada declaração fica no cache de compilação
+    if (opts->incremental && !opts->cache_dir) opts->cache_dir = CACHE_DEFAULT_DIR;
+    if (opts->emit_pyc && (opts->stop_after != STOP_AFTER_CODEGEN || opts->dump_tokens_file)) {
+        fprintf(stderr, "--emit-pyc só se aplica à compilação completa (o bytecode vem do output.py).\n");
+        return 0;
+    }
+    if (opts->jit && (opts->incremental || opts->stop_after != STOP_AFTER_CODEGEN || opts->dump_tokens_file)) {
+        fprintf(stderr, "--jit executa a AST otimizada: só se aplica à compilação completa, sem --incremental.\n");
+        return 0;
+    }
+    if (opts->instrument_file && opts->jit) {
+        fprintf(stderr, "--instrument conta as execuções no output.py: não se aplica com --jit.\n");
+        return 0;
+    }
+    if ((opts->instrument_file || opts->profile_file) && opts->incremental) {
+        fprintf(stderr, "--instrument e --profile-use precisam do programa inteiro: não se aplicam com --incremental.\n");
+        return 0;
+    }
+    if (opts->emit_ast_file && opts->stop_after == STOP_AFTER_LEX) {
+        fprintf(stderr, "--emit-ast exige ao menos a análise sintática (--stop-after=parse ou posterior).\n");
+        return 0;
+    }
+    return 1;
+}
+
+// Perfil de execução carregado com --profile-use
+static ExecutionProfile loaded_profile;
+static int profile_loaded = 0;
+
+// Escreve o relatório (se pedido), libera a AST e o código-fonte e devolve o código de saída
+static int finish(int status, const DriverOptions* opts, const CompilationCounters* counters,
+                  ASTNode* ast_root, char* source_code) {
+    if (opts->time_report) stats_print_report(stderr, opts->time_report_json, counters);
+    cache_close();
+    if (profile_loaded) {
+        set_optimizer_profile(NULL);
+        profile_free(&loaded_profile);
+        profile_loaded = 0;
+    }
+    if (ast_root) free_ast(ast_root);
+    free(source_code);
+    return status;
+}
+
+// Liga a instrumentação (--instrument) e carrega o perfil (--profile-use). source_hash é
+// 0 quando o código-fonte não está disponível (--from-ast), e então o perfil não é
+// conferido. Devolve 0 se o perfil não puder ser lido.
+static int setup_profiling(const DriverOptions* opts, unsigned long long source_hash) {
+    if (opts->instrument_file) set_code_instrumentation(opts->instrument_file, source_hash);
+    if (!opts->profile_file) return 1;
+    if (!profile_load(opts->profile_file, &loaded_profile)) return 0;
+    profile_loaded = 1;
+    if (source_hash && loaded_profile.source_hash && loaded_profile.source_hash != source_hash) {
+        fprintf(stderr, "Aviso: o perfil '%s' foi medido com outra versão do código-fonte; compilando sem ele.\n",
+                opts->profile_file);
         return 1;
     }
+    set_optimizer_profile(&loaded_profile);
+    printf("Perfil de execução '%s': %lld chamada(s) a %d função(ões), %d 'if'.\n\n", opts->profile_file,
+           loaded_profile.total_calls, loaded_profile.functions, loaded_profile.branches);
+    return 1;
+}
+
+// Grava a AST binária, se pedido (--emit-ast). Devolve 0 se a gravação falhar.
+static int emit_ast(const DriverOptions* opts, ASTNode* ast_root, AstStage stage) {
+    if (!opts->emit_ast_file) return 1;
+    if (!write_ast_binary(ast_root, stage, opts->emit_ast_file)) return 0;
+    printf("AST binária gravada em '%s'.\n", opts->emit_ast_file);
+    return 1;
+}
+
+// Compila o output.py para output.pyc, se pedido (--emit-pyc). Devolve 0 se falhar.
+static int emit_bytecode(const DriverOptions* opts) {
+    if (!opts->emit_pyc) return 1;
+    stats_phase_begin(PHASE_CODEGEN);
+    int ok = generate_bytecode("output.py", "output.pyc");
+    stats_phase_end(PHASE_CODEGEN);
+    if (ok) printf("Bytecode gravado em 'output.pyc'.\n");
+    return ok;
+}
+
+// Executa o programa compilado, se pedido (--jit): com o JIT quando ele traduz o
+// programa inteiro, e com o python3 (output.py) quando não traduz ou abandona a execução.
+// Devolve o código de saída do programa.
+static int run_program(const DriverOptions* opts, ASTNode* ast_root) {
+    if (!opts->jit) return 0;
+    char reason[256];
+    printf("\n");
+    fflush(stdout);
+    JitStatus status = run_jit(ast_root, reason, sizeof(reason));
+    if (status == JIT_EXECUTED) return 0;
+    printf("JIT: %s; executando output.py com o python3.\n", reason);
+    return run_python_program("output.py");
+}
+
+// Encerra o pipeline depois da fase atual (--stop-after)
+static int stop_here(const DriverOptions* opts, const CompilationCounters* counters,
+                     ASTNode* ast_root, AstStage stage, char* source_code) {
+    int status = emit_ast(opts, ast_root, stage) ? 0 : 1;
+    return finish(status, opts, counters, ast_root, source_code);
+}
+
+/**
+ * @brief Executa as fases seguintes a 'stage' sobre uma AST já construída
+ * (pelo parser ou carregada de uma AST binária).
+ * @param use_cache Se diferente de zero, guarda o código gerado no cache sob cache_entry.
+ */
+static int compile_tree(ASTNode* ast_root, AstStage stage, char* source_code, const DriverOptions* opts,
+                        CompilationCounters* counters, int use_cache, unsigned long long cache_entry) {
+    if (opts->stop_after == STOP_AFTER_PARSE) {
+        return stop_here(opts, counters, ast_root, stage, source_code);
+    }
 
-    const char* filename = argv[1];
-    FILE* file = fopen(filename, "r");
+    // A árvore otimizada não é reotimizada (nem reanalisada: as temporárias criadas
+    // pelo otimizador podem repetir declarações no mesmo bloco)
+    int optimize = opts->stop_after >= STOP_AFTER_OPT && stage < AST_STAGE_OPTIMIZED;
+    unsigned completed = stage >= AST_STAGE_ANALYZED ? PASS_BIT(PASS_SEMA) : 0;
+    const PassId print_pass[] = { PASS_PRINT_AST };
+
+    // A árvore não depende dos tipos: é impressa antes do percurso que analisa e dobra
+    if (optimize && is_pass_enabled(PASS_PRINT_AST)) {
+        printf("--- Árvore ANTES da otimização ---\n");
+        stats_phase_begin(PHASE_PRINT_AST);
+        run_passes(ast_root, print_pass, 1, &completed);
+        stats_phase_end(PHASE_PRINT_AST);
+    }
+
+    if (stage < AST_STAGE_ANALYZED) {
+        // Com otimização, o dobramento e a poda são fundidos ao percurso da análise
+        const PassId analysis[] = { PASS_SEMA, PASS_FOLD, PASS_PRUNE };
+        printf("Iniciando Fase 3: Análise Semântica%s...\n",
+               optimize ? " (com dobramento de constantes e poda de ramos mortos)" : "");
+        stats_phase_begin(PHASE_SEMA);
+        run_passes(ast_root, analysis, optimize ? 3 : 1, &completed);
+        stats_phase_end(PHASE_SEMA);
+        counters->symbols = get_symbol_table_stats();
+
+        int error_count = get_semantic_error_count();
+        if (error_count > 0) {
+            fprintf(stderr, "\nCompilação falhou com %d erro(s) semântico(s).\n", error_count);
+            return finish(1, opts, counters, ast_root, source_code);
+        }
+        printf("Análise Semântica concluída com sucesso.\n\n");
+        stage = AST_STAGE_ANALYZED;
+    }
+    if (opts->stop_after == STOP_AFTER_SEMA) {
+        return stop_here(opts, counters, ast_root, stage, source_code);
+    }
+
+    if (optimize) {
+        // Uma AST carregada após a análise ainda não passou pelo dobramento e pela poda
+        const PassId local[] = { PASS_FOLD, PASS_PRUNE, PASS_OPTIMIZE };
+        int first = (completed & PASS_BIT(PASS_FOLD)) ? 2 : 0;
+        printf("Iniciando Fase 4: Otimização (Constant Folding e Código Morto)...\n");
+        stats_phase_begin(PHASE_OPT);
+        run_passes(ast_root, local + first, 3 - first, &completed);
+        stats_phase_end(PHASE_OPT);
+        counters->ast_nodes_optimized = count_ast_nodes(ast_root);
+        printf("Otimização concluída.\n\n");
+        if (is_pass_enabled(PASS_PRINT_AST)) {
+            printf("\n--- Árvore DEPOIS da otimização ---\n");
+            stats_phase_begin(PHASE_PRINT_AST);
+            run_passes(ast_root, print_pass, 1, &completed);
+            stats_phase_end(PHASE_PRINT_AST);
+        }
+        stage = AST_STAGE_OPTIMIZED;
+    }
+    if (opts->stop_after == STOP_AFTER_OPT) {
+        return stop_here(opts, counters, ast_root, stage, source_code);
+    }
+    // No pipeline completo a AST gravada é a otimizada, que é a entrada do gerador
+    if (!emit_ast(opts, ast_root, stage)) {
+        return finish(1, opts, counters, ast_root, source_code);
+    }
+
+    // <<< CORREÇÃO: Alterado o nome do ficheiro de saída e a mensagem >>>
+    printf("Iniciando Fase 5: Geração de Código (Transpilando para Python)...\n");
+    stats_phase_begin(PHASE_CODEGEN);
+    generate_code(ast_root, "output.py");
+    stats_phase_end(PHASE_CODEGEN);
+    if (use_cache) {
+        stats_phase_begin(PHASE_CACHE);
+        cache_store(cache_entry, counters->source_bytes, "output.py");
+        stats_phase_end(PHASE_CACHE);
+    }
+    if (!emit_bytecode(opts)) {
+        return finish(1, opts, counters, ast_root, source_code);
+    }
+
+    if (opts->instrument_file) {
+        printf("Código instrumentado: o perfil de execução será gravado em '%s'.\n", opts->instrument_file);
+    }
+
+    printf("\nCompilação concluída com sucesso!\n");
+    return finish(run_program(opts, ast_root), opts, counters, ast_root, source_code);
+}
+
+// --from-ast: a AST gravada por outra execução é mapeada em memória e reconstruída
+static int compile_from_ast(const DriverOptions* opts) {
+    CompilationCounters counters = {0};
+    AstImage image;
+    ASTNode* ast_root = NULL;
+    AstStage stage = AST_STAGE_PARSED;
+
+    printf("Carregando a AST binária de '%s'...\n", opts->filename);
+    stats_phase_begin(PHASE_READ);
+    int loaded = ast_image_open(opts->filename, &image);
+    if (loaded) {
+        counters.source_bytes = (long)image.mapping_size;
+        stage = (AstStage)image.header->stage;
+        ast_root = ast_image_to_tree(&image);
+        ast_image_close(&image);
+    }
+    stats_phase_end(PHASE_READ);
+    if (!loaded || !setup_profiling(opts, 0)) return finish(1, opts, &counters, ast_root, NULL);
+
+    counters.ast_nodes_parsed = count_ast_nodes(ast_root);
+    printf("AST carregada: %d nós (gravada após a fase '%s').\n\n", counters.ast_nodes_parsed,
+           stage == AST_STAGE_OPTIMIZED ? "opt" : stage == AST_STAGE_ANALYZED ? "sema" : "parse");
+    if (stage == AST_STAGE_OPTIMIZED) counters.ast_nodes_optimized = counters.ast_nodes_parsed;
+    return compile_tree(ast_root, stage, NULL, opts, &counters, 0, 0);
+}
+
+int main(int argc, char *argv[]) {
+    DriverOptions opts;
+    if (!parse_options(argc, argv, &opts)) return 1;
+    set_max_nesting_depth((int)opts.max_nesting);
+    set_pass_fusion(!opts.no_fuse_passes);
+
+    if (opts.cache_stats) {
+        if (!cache_open(opts.cache_dir ? opts.cache_dir : CACHE_DEFAULT_DIR, opts.cache_max_mb * 1024LL * 1024LL)) {
+            return 1;
+        }
+        cache_print_stats(stdout);
+        cache_close();
+        return 0;
+    }
+    if (opts.server_socket) {
+        return run_compile_server(opts.server_socket, (int)opts.server_workers, opts.cache_max_mb * 1024LL * 1024LL,
+                                  opts.server_max_bytes);
+    }
+    if (opts.client_socket) return run_compile_client(opts.client_socket, opts.inputs, opts.input_count);
+    if (opts.from_ast) return compile_from_ast(&opts);
+
+    CompilationCounters counters = {0};
+    stats_phase_begin(PHASE_READ);
+    FILE* file = fopen(opts.filename, "r");
     if (!file) {
         perror("Erro ao abrir o arquivo");
         return 1;
@@ -32,39 +493,103 @@ int main(int argc, char *argv[]) {
     fread(source_code, 1, length, file);
     source_code[length] = '\0';
     fclose(file);
+    stats_phase_end(PHASE_READ);
+    counters.source_bytes = length;
+    if (!setup_profiling(&opts, profile_source_hash(source_code, length))) {
+        return finish(1, &opts, &counters, NULL, source_code);
+    }
+
+    // O cache só vale para compilações completas: a chave cobre o código-fonte, a
+    // versão do compilador e as opções que mudam o código gerado. Com --jit o programa
+    // é executado a partir da AST, que o cache não guarda.
+    unsigned long long cache_entry = 0;
+    int use_cache = opts.cache_dir && opts.stop_after == STOP_AFTER_CODEGEN && !opts.dump_tokens_file &&
+                    !opts.emit_ast_file && !opts.jit && cache_open(opts.cache_dir, opts.cache_max_mb * 1024LL * 1024LL);
+    if (use_cache) {
+        stats_phase_begin(PHASE_CACHE);
+        // Passes desativados (exceto a impressão), a instrumentação e o perfil usado
+        // mudam o código gerado; o limite de aninhamento decide se o programa é aceito
+        char key_options[1280];
+        int used = snprintf(key_options, sizeof(key_options), "alvo=python%s", opts.incremental ? ";incremental" : "");
+        if (opts.max_nesting && opts.max_nesting != DEFAULT_MAX_NESTING_DEPTH) {
+            used += snprintf(key_options + used, sizeof(key_options) - used, ";aninhamento=%ld", opts.max_nesting);
+        }
+        if (opts.instrument_file) {
+            used += snprintf(key_options + used, sizeof(key_options) - used, ";instrumentado=%.1024s", opts.instrument_file);
+        }
+        if (profile_loaded) {
+            used += snprintf(key_options + used, sizeof(key_options) - used, ";perfil=%016llx",
+                             loaded_profile.content_hash);
+        }
+        for (int id = 0; id < PASS_COUNT; id++) {
+            if (id != PASS_PRINT_AST && !is_pass_enabled((PassId)id)) {
+                used += snprintf(key_options + used, sizeof(key_options) - used, ";sem-%s", pass_name((PassId)id));
+            }
+        }
+        cache_entry = cache_key(source_code, length, key_options);
+        int hit = cache_fetch(cache_entry, length, "output.py");
+        stats_phase_end(PHASE_CACHE);
+        if (hit) {
+            printf("Código-fonte inalterado: 'output.py' reaproveitado do cache (%016llx).\n", cache_entry);
+            // O .pyc não fica no cache: o formato dele depende do python3 instalado
+            return finish(emit_bytecode(&opts) ? 0 : 1, &opts, &counters, NULL, source_code);
+        }
+    }
+
+    // Passada somente léxica: dump de tokens e/ou medição isolada do analisador léxico
+    if (opts.dump_tokens_file || opts.stop_after == STOP_AFTER_LEX) {
+        FILE* dump = NULL;
+        if (opts.dump_tokens_file) {
+            dump = fopen(opts.dump_tokens_file, "w");
+            if (!dump) {
+                perror("Erro ao criar o arquivo de tokens");
+                return finish(1, &opts, &counters, NULL, source_code);
+            }
+        }
+        printf("Iniciando Fase 1: Análise Léxica...\n");
+        stats_phase_begin(PHASE_LEX);
+        counters.tokens = tokenize_source(source_code, dump);
+        stats_phase_end(PHASE_LEX);
+        if (dump) {
+            fclose(dump);
+            printf("%d tokens escritos em '%s'.\n", counters.tokens, opts.dump_tokens_file);
+        } else {
+            printf("Análise Léxica concluída: %d tokens.\n", counters.tokens);
+        }
+        if (opts.stop_after == STOP_AFTER_LEX) {
+            return finish(0, &opts, &counters, NULL, source_code);
+        }
+        printf("\n");
+    }
 
     printf("Iniciando Fase 1 e 2: Análise Léxica e Sintática...\n");
+    stats_phase_begin(PHASE_PARSE);
     ASTNode* ast_root = parse_program(source_code);
+    stats_phase_end(PHASE_PARSE);
+    counters.tokens = get_token_count();
+    counters.ast_nodes_parsed = count_ast_nodes(ast_root);
     printf("Análise Sintática concluída. AST construída.\n\n");
-    
-    printf("Iniciando Fase 3: Análise Semântica...\n");
-    analyze_semantics(ast_root);
-    
-    int error_count = get_semantic_error_count();
-    if (error_count > 0) {
-        fprintf(stderr, "\nCompilação falhou com %d erro(s) semântico(s).\n", error_count);
-        free_ast(ast_root);
-        free(source_code);
-        return 1;
-    }
-    printf("Análise Semântica concluída com sucesso.\n\n");
-    printf("--- Árvore ANTES da otimização ---\n");
-    print_ast(ast_root, 0);
-    
-    printf("Iniciando Fase 4: Otimização (Constant Folding)...\n");
-    optimize_ast(ast_root);
-    printf("Otimização concluída.\n\n");
-    printf("\n--- Árvore DEPOIS da otimização ---\n");
-    print_ast(ast_root, 0);
 
-    // <<< CORREÇÃO: Alterado o nome do ficheiro de saída e a mensagem >>>
-    printf("Iniciando Fase 5: Geração de Código (Transpilando para Python)...\n");
-    generate_code(ast_root, "output.py");
-    
-    printf("\nCompilação concluída com sucesso!\n");
-
-    free_ast(ast_root);
-    free(source_code);
+    if (use_cache && opts.incremental) {
+        IncrementalStats incremental;
+        printf("Iniciando Fases 3 a 5 por declaração (compilação incremental)...\n");
+        int result = compile_incremental(ast_root, "output.py", &incremental);
+        if (result < 0) {
+            fprintf(stderr, "\nCompilação falhou com %d erro(s) semântico(s).\n", get_semantic_error_count());
+            return finish(1, &opts, &counters, ast_root, source_code);
+        }
+        if (result > 0) {
+            stats_phase_begin(PHASE_CACHE);
+            cache_store(cache_entry, counters.source_bytes, "output.py");
+            stats_phase_end(PHASE_CACHE);
+            printf("Compilação incremental: %d de %d declarações reaproveitadas do cache, %d recompiladas.\n",
+                   incremental.reused, incremental.declarations, incremental.recompiled);
+            if (!emit_bytecode(&opts)) return finish(1, &opts, &counters, ast_root, source_code);
+            printf("\nCompilação concluída com sucesso!\n");
+            return finish(0, &opts, &counters, ast_root, source_code);
+        }
+        printf("Compilação incremental indisponível para este programa; compilando o programa inteiro.\n\n");
+    }
 
-    return 0;
+    return compile_tree(ast_root, AST_STAGE_PARSED, source_code, &opts, &counters, use_cache, cache_entry);
 }
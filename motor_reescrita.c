@@ -0,0 +1,333 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "motor_reescrita.h"
+#include "diagnosticos.h"
+
+#define NODE_TYPE_COUNT (NODE_CHAR_LITERAL + 1)
+
+// Um nó indexado. As entradas de nós que saíram da árvore ficam marcadas como mortas e
+// nunca mais leem o nó, que pode ter sido liberado.
+typedef struct {
+    ASTNode* node;
+    ASTNode** slot;
+    int parent;       // Entrada do pai (-1 na raiz)
+    int first_child;  // Filhos indexados, para descartar a subárvore quando ela muda
+    int next_sibling;
+    unsigned char queued;
+    unsigned char dead;
+} RewriteEntry;
+
+typedef struct {
+    ASTNode** slot;
+    int parent;
+} IndexFrame;
+
+struct RewriteEngine {
+    ASTNode* root;
+    const RewriteRule* rules;
+    int rule_first[NODE_TYPE_COUNT + 1]; // Regras do tipo t: rule_order[rule_first[t] .. rule_first[t + 1] - 1]
+    int* rule_order;
+
+    RewriteEntry* entries;
+    int entry_count;
+    int entry_capacity;
+
+    // Lista de trabalho: fila circular de entradas
+    int* queue;
+    int queue_head;
+    int queue_count;
+    int queue_capacity;
+
+    // Endereço do nó -> entrada mais recente (endereçamento aberto)
+    ASTNode** map_keys;
+    int* map_values;
+    int map_count;
+    int map_capacity;
+
+    // Pilhas reaproveitadas entre as reindexações
+    IndexFrame* frames;
+    int frame_capacity;
+    int* order;
+    int order_capacity;
+};
+
+static void* grow_array(void* items, int* capacity, size_t item_size) {
+    int grown_capacity = *capacity ? *capacity * 2 : 64;
+    void* grown = realloc(items, (size_t)grown_capacity * item_size);
+    if (!grown) {
+        report_error("Erro de Memória: falha ao alocar as estruturas do motor de reescrita.\n");
+        fatal_error();
+    }
+    *capacity = grown_capacity;
+    return grown;
+}
+
+// --- Índice de Nós ---
+
+static size_t pointer_hash(ASTNode* node) {
+    return (size_t)(((uintptr_t)node >> 4) * 2654435761u);
+}
+
+static int map_find(const RewriteEngine* engine, ASTNode* node) {
+    if (engine->map_capacity == 0) return -1;
+    size_t mask = (size_t)engine->map_capacity - 1;
+    for (size_t i = pointer_hash(node) & mask; engine->map_keys[i]; i = (i + 1) & mask) {
+        if (engine->map_keys[i] == node) return engine->map_values[i];
+    }
+    return -1;
+}
+
+static void map_insert(ASTNode** keys, int* values, int capacity, ASTNode* node, int entry, int* count) {
+    size_t mask = (size_t)capacity - 1;
+    size_t i = pointer_hash(node) & mask;
+    while (keys[i] && keys[i] != node) i = (i + 1) & mask;
+    if (!keys[i]) {
+        keys[i] = node;
+        (*count)++;
+    }
+    values[i] = entry;
+}
+
+static void map_store(RewriteEngine* engine, ASTNode* node, int entry) {
+    if ((engine->map_count + 1) * 2 > engine->map_capacity) {
+        int capacity = engine->map_capacity ? engine->map_capacity * 2 : 1024;
+        ASTNode** keys = (ASTNode**)calloc(capacity, sizeof(ASTNode*));
+        int* values = (int*)malloc(capacity * sizeof(int));
+        if (!keys || !values) {
+            report_error("Erro de Memória: falha ao alocar o índice do motor de reescrita.\n");
+            fatal_error();
+        }
+        int count = 0;
+        for (int i = 0; i < engine->map_capacity; i++) {
+            if (engine->map_keys[i]) map_insert(keys, values, capacity, engine->map_keys[i], engine->map_values[i], &count);
+        }
+        free(engine->map_keys);
+        free(engine->map_values);
+        engine->map_keys = keys;
+        engine->map_values = values;
+        engine->map_capacity = capacity;
+        engine->map_count = count;
+    }
+    map_insert(engine->map_keys, engine->map_values, engine->map_capacity, node, entry, &engine->map_count);
+}
+
+// --- Lista de Trabalho ---
+
+static void enqueue(RewriteEngine* engine, int id) {
+    if (id < 0 || engine->entries[id].queued || engine->entries[id].dead) return;
+    if (engine->queue_count == engine->queue_capacity) {
+        // A fila é desenrolada no começo do vetor novo
+        int capacity = engine->queue_capacity ? engine->queue_capacity * 2 : 64;
+        int* items = (int*)malloc(capacity * sizeof(int));
+        if (!items) {
+            report_error("Erro de Memória: falha ao alocar a lista de trabalho do motor de reescrita.\n");
+            fatal_error();
+        }
+        for (int i = 0; i < engine->queue_count; i++) {
+            items[i] = engine->queue[(engine->queue_head + i) % engine->queue_capacity];
+        }
+        free(engine->queue);
+        engine->queue = items;
+        engine->queue_capacity = capacity;
+        engine->queue_head = 0;
+    }
+    engine->queue[(engine->queue_head + engine->queue_count) % engine->queue_capacity] = id;
+    engine->queue_count++;
+    engine->entries[id].queued = 1;
+}
+
+static int dequeue(RewriteEngine* engine) {
+    int id = engine->queue[engine->queue_head];
+    engine->queue_head = (engine->queue_head + 1) % engine->queue_capacity;
+    engine->queue_count--;
+    engine->entries[id].queued = 0;
+    return id;
+}
+
+// --- Indexação ---
+
+// Marca como mortas a entrada 'id' e as dos seus descendentes, sem ler os nós.
+static void kill_subtree(RewriteEngine* engine, int id) {
+    int count = 0;
+    if (engine->order_capacity == 0) engine->order = (int*)grow_array(engine->order, &engine->order_capacity, sizeof(int));
+    engine->order[count++] = id;
+    while (count > 0) {
+        RewriteEntry* entry = &engine->entries[engine->order[--count]];
+        // Os descendentes de uma entrada morta já foram marcados junto com ela
+        if (entry->dead) continue;
+        entry->dead = 1;
+        for (int child = entry->first_child; child >= 0; child = engine->entries[child].next_sibling) {
+            if (count == engine->order_capacity) {
+                engine->order = (int*)grow_array(engine->order, &engine->order_capacity, sizeof(int));
+            }
+            engine->order[count++] = child;
+        }
+    }
+}
+
+// Indexa a subárvore em 'slot', filha da entrada 'parent'. Um nó que continua no mesmo
+// endereço, na mesma posição e sob o mesmo pai reaproveita a sua entrada e não volta para
+// a lista (as regras já o deixaram estável); os demais entram na lista em pós-ordem.
+// Retorna a entrada da raiz da subárvore.
+static int index_subtree(RewriteEngine* engine, ASTNode** slot, int parent) {
+    int frame_count = 0;
+    int order_count = 0;
+    int root_id = -1;
+    if (engine->frame_capacity == 0) engine->frames = (IndexFrame*)grow_array(engine->frames, &engine->frame_capacity, sizeof(IndexFrame));
+    engine->frames[frame_count++] = (IndexFrame){ slot, parent };
+
+    while (frame_count > 0) {
+        IndexFrame frame = engine->frames[--frame_count];
+        ASTNode* node = *frame.slot;
+        int id = map_find(engine, node);
+        int fresh = !(id >= 0 && engine->entries[id].dead &&
+                      engine->entries[id].slot == frame.slot && engine->entries[id].parent == frame.parent);
+        if (fresh) {
+            if (engine->entry_count == engine->entry_capacity) {
+                engine->entries = (RewriteEntry*)grow_array(engine->entries, &engine->entry_capacity, sizeof(RewriteEntry));
+            }
+            id = engine->entry_count++;
+            engine->entries[id] = (RewriteEntry){ node, frame.slot, frame.parent, -1, -1, 0, 0 };
+            map_store(engine, node, id);
+        } else {
+            engine->entries[id].dead = 0;
+            engine->entries[id].first_child = -1;
+        }
+        // Uma raiz reaproveitada já está na lista de filhos do pai
+        if (frame.parent >= 0 && (fresh || root_id >= 0)) {
+            engine->entries[id].next_sibling = engine->entries[frame.parent].first_child;
+            engine->entries[frame.parent].first_child = id;
+        }
+        if (root_id < 0) root_id = id;
+
+        if (order_count == engine->order_capacity) {
+            engine->order = (int*)grow_array(engine->order, &engine->order_capacity, sizeof(int));
+        }
+        engine->order[order_count++] = id * 2 + fresh;
+
+        ASTLayout layout = ast_layout(node);
+        if (layout.list) {
+            for (ASTNodeList* l = *layout.list; l; l = l->next) {
+                if (!l->node) continue;
+                if (frame_count == engine->frame_capacity) {
+                    engine->frames = (IndexFrame*)grow_array(engine->frames, &engine->frame_capacity, sizeof(IndexFrame));
+                }
+                engine->frames[frame_count++] = (IndexFrame){ &l->node, id };
+            }
+        }
+        for (int i = 0; i < layout.child_count; i++) {
+            if (!*layout.child[i]) continue;
+            if (frame_count == engine->frame_capacity) {
+                engine->frames = (IndexFrame*)grow_array(engine->frames, &engine->frame_capacity, sizeof(IndexFrame));
+            }
+            engine->frames[frame_count++] = (IndexFrame){ layout.child[i], id };
+        }
+    }
+
+    // Os filhos foram empilhados na ordem da sintaxe, então a ordem de visita é a pré-ordem
+    // da direita para a esquerda: invertida, é a pós-ordem da esquerda para a direita
+    for (int i = order_count - 1; i >= 0; i--) {
+        if (engine->order[i] & 1) enqueue(engine, engine->order[i] / 2);
+    }
+    return root_id;
+}
+
+// Reindexa a subárvore da entrada 'id' depois de uma alteração e devolve a nova entrada
+// da sua raiz (-1 se a posição ficou vazia).
+static int reindex(RewriteEngine* engine, int id) {
+    ASTNode** slot = engine->entries[id].slot;
+    int parent = engine->entries[id].parent;
+    kill_subtree(engine, id);
+    if (!*slot) return -1;
+    return index_subtree(engine, slot, parent);
+}
+
+static int is_statement_container(ASTNode* node) {
+    return node->type == NODE_BLOCK || node->type == NODE_IF ||
+           node->type == NODE_FOR || node->type == NODE_WHILE;
+}
+
+// Devolve à lista o pai e, depois de alterar um comando, os comandos que o contêm: a
+// poda de um bloco depende de os comandos internos sempre retornarem ou estarem vazios.
+static void enqueue_ancestors(RewriteEngine* engine, int parent, int statement_changed) {
+    enqueue(engine, parent);
+    if (!statement_changed) return;
+    while (parent >= 0 && is_statement_container(engine->entries[parent].node)) {
+        parent = engine->entries[parent].parent;
+        enqueue(engine, parent);
+    }
+}
+
+static void refresh(RewriteEngine* engine, int id, int statement_changed) {
+    int parent = engine->entries[id].parent;
+    enqueue(engine, reindex(engine, id));
+    enqueue_ancestors(engine, parent, statement_changed);
+}
+
+// --- Interface ---
+
+RewriteEngine* rewrite_engine_create(ASTNode* root, const RewriteRule* rules, int count) {
+    RewriteEngine* engine = (RewriteEngine*)calloc(1, sizeof(RewriteEngine));
+    int* rule_order = (int*)malloc((count > 0 ? count : 1) * sizeof(int));
+    if (!engine || !rule_order) {
+        report_error("Erro de Memória: falha ao alocar o motor de reescrita.\n");
+        fatal_error();
+    }
+    engine->root = root;
+    engine->rules = rules;
+    engine->rule_order = rule_order;
+
+    // Regras agrupadas por tipo de nó, mantendo a ordem da tabela dentro de cada tipo
+    int next = 0;
+    for (int type = 0; type < NODE_TYPE_COUNT; type++) {
+        engine->rule_first[type] = next;
+        for (int i = 0; i < count; i++) {
+            if ((int)rules[i].type == type) rule_order[next++] = i;
+        }
+    }
+    engine->rule_first[NODE_TYPE_COUNT] = next;
+
+    if (root) index_subtree(engine, &engine->root, -1);
+    return engine;
+}
+
+int rewrite_engine_run(RewriteEngine* engine) {
+    int rewrites = 0;
+    while (engine->queue_count > 0) {
+        int id = dequeue(engine);
+        if (engine->entries[id].dead) continue;
+        ASTNode* node = engine->entries[id].node;
+        int parent = engine->entries[id].parent;
+        RewriteSite site = { engine->entries[id].slot, parent >= 0 ? engine->entries[parent].node : NULL };
+        NodeType type = node->type;
+        for (int r = engine->rule_first[type]; r < engine->rule_first[type + 1]; r++) {
+            if (!engine->rules[engine->rule_order[r]].apply(&site)) continue;
+            rewrites++;
+            refresh(engine, id, type != NODE_BINARY_OP && type != NODE_UNARY_OP);
+            break;
+        }
+    }
+    return rewrites;
+}
+
+void rewrite_engine_removed(RewriteEngine* engine, ASTNode* node) {
+    int id = map_find(engine, node);
+    if (id < 0 || engine->entries[id].dead) return;
+    int parent = engine->entries[id].parent;
+    kill_subtree(engine, id);
+    enqueue_ancestors(engine, parent, 1);
+}
+
+void rewrite_engine_free(RewriteEngine* engine) {
+    if (!engine) return;
+    free(engine->rule_order);
+    free(engine->entries);
+    free(engine->queue);
+    free(engine->map_keys);
+    free(engine->map_values);
+    free(engine->frames);
+    free(engine->order);
+    free(engine);
+}
@@ -0,0 +1,54 @@
+#ifndef MOTOR_REESCRITA_H
+#define MOTOR_REESCRITA_H
+
+#include "ast.h"
+
+// --- Motor de Reescrita ---
+//
+// Aplica regras locais até um ponto fixo usando uma lista de trabalho. Todos os nós da
+// árvore entram na lista em pós-ordem. Quando uma regra altera a subárvore de um nó, a
+// subárvore nova é reindexada e voltam para a lista o próprio nó, os nós que surgiram
+// na reescrita e o pai. Se o nó alterado for um comando, voltam também os comandos que o
+// contêm, até a função. Assim, uma reescrita que abre espaço para outra mais acima (uma
+// condição dobrada que torna um 'if' podável, que por sua vez encerra um bloco com
+// 'return') é aproveitada sem percorrer a árvore de novo.
+
+// Nó ao qual a regra é aplicada
+typedef struct {
+    ASTNode** slot;  // Onde o nó está guardado: campo do pai, célula de lista ou a raiz
+    ASTNode* parent; // NULL na raiz
+} RewriteSite;
+
+// Regra associada a um tipo de nó. A regra pode alterar o nó e a sua subárvore e trocar
+// *slot (inclusive por NULL, fora da raiz), mas nada fora dela.
+typedef struct {
+    NodeType type;
+    int (*apply)(const RewriteSite* site); // Devolve diferente de zero se alterou a subárvore
+} RewriteRule;
+
+typedef struct RewriteEngine RewriteEngine;
+
+/**
+ * @brief Indexa a árvore e põe todos os seus nós na lista de trabalho. As regras são
+ * tentadas na ordem da tabela, entre as do tipo do nó; a primeira que alterar o nó
+ * encerra a visita a ele.
+ */
+RewriteEngine* rewrite_engine_create(ASTNode* root, const RewriteRule* rules, int count);
+
+/**
+ * @brief Aplica as regras até que a lista de trabalho se esvazie.
+ * @return O número de reescritas feitas.
+ */
+int rewrite_engine_run(RewriteEngine* engine);
+
+/**
+ * @brief Informa que 'node' foi retirado da árvore fora das regras (por exemplo, um
+ * comando morto removido de um bloco). Deve ser chamada antes de o nó ser liberado: a
+ * subárvore deixa de ser visitada, e o nó que a continha volta para a lista, com os
+ * comandos que o contêm.
+ */
+void rewrite_engine_removed(RewriteEngine* engine, ASTNode* node);
+
+void rewrite_engine_free(RewriteEngine* engine);
+
+#endif // MOTOR_REESCRITA_H
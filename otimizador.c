@@ -1,97 +1,3438 @@
+// Define _DEFAULT_SOURCE para habilitar funções de extensão POSIX como strdup
+#define _DEFAULT_SOURCE
+
 #include "otimizador.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
+#include <math.h>
 #include "ast.h" // Incluído para free_ast
+#include "tabela_simbolos.h" // Para datatype_to_string
+#include "diagnosticos.h"
+#include "motor_reescrita.h"
+#include "perfil_execucao.h"
+
+// --- Protótipos de Funções Estáticas ---
+static void fold_constants(ASTNode* node);
+static void optimize_whole_program(ASTNode* node);
+static void run_whole_program_passes(ASTNode* node);
+static int fold_binary_op(ASTNode* node);
+static int fold_unary_op(ASTNode* node);
+static void simplify_node(ASTNode* node);
+static void eliminate_dead_code(ASTNode* program);
+static void inline_functions(ASTNode* program);
+static void eliminate_common_subexpressions(ASTNode* program);
+static void move_loop_invariants(ASTNode* program);
+static int unroll_loops(ASTNode* program);
+static void reduce_induction_variables(ASTNode* program);
+static void eliminate_tail_calls(ASTNode* program);
+static void order_branches(ASTNode* program);
+static void substitute_name(ASTNode* node, const char* name, ASTNode* replacement);
+
+// --- Estado da Otimização ---
+
+// Contadores usados nos nomes das variáveis criadas pelo otimizador. São zerados a
+// cada otimização, para que os nomes gerados dependam apenas do programa otimizado.
+static int inline_counter = 0;
+static int cse_counter = 0;
+static int licm_counter = 0;
+static int iv_counter = 0;
+static int tail_counter = 0;
+
+// Zero em optimize_ast_partial: desliga as remoções que exigem o programa inteiro
+static int whole_program = 1;
+
+// Perfil de execução (--profile-use), ou NULL
+static const ExecutionProfile* active_profile = NULL;
+
+// As etapas percorrem a árvore recursivamente. Uma declaração mais profunda que isto (em
+// geral pela espinha esquerda de uma expressão com dezenas de milhares de termos) segue
+// para a geração de código sem otimização, com um aviso, em vez de esgotar a pilha de
+// chamadas; as demais declarações do programa são otimizadas normalmente.
+#define OPTIMIZER_MAX_DEPTH 10000
+
+// --- Funções Auxiliares ---
+
+static int is_constant(ASTNode* node) {
+    return node && (node->type == NODE_INT_LITERAL || node->type == NODE_FLOAT_LITERAL);
+}
+
+static double constant_value(ASTNode* node) {
+    return node->type == NODE_INT_LITERAL ? (double)node->data.int_literal : (double)node->data.float_literal;
+}
+
+static int is_truthy(ASTNode* node) {
+    return constant_value(node) != 0.0;
+}
+
+// Divisão ou resto por algo que não é uma constante não nula: pode levantar
+// ZeroDivisionError, então não pode ser removida nem ter o resultado descartado.
+static int may_divide_by_zero(ASTNode* node) {
+    const char* op = node->data.binary_op.op;
+    if (strcmp(op, "/") != 0 && strcmp(op, "%") != 0) return 0;
+    ASTNode* divisor = node->data.binary_op.right;
+    return !is_constant(divisor) || constant_value(divisor) == 0.0;
+}
+
+// Uma expressão tem efeitos colaterais se contém chamadas de função, atribuições ou
+// divisões que podem falhar. Percorre a expressão com uma pilha no heap: a poda de
+// ramos mortos a consulta em condições de qualquer profundidade.
+static int has_side_effects(ASTNode* node) {
+    if (!node || (node->type != NODE_BINARY_OP && node->type != NODE_UNARY_OP)) {
+        return node && (node->type == NODE_FUNC_CALL || node->type == NODE_ASSIGN);
+    }
+    ASTStack pending = {0};
+    int found = 0;
+    ast_stack_push(&pending, node);
+    while (!found && pending.count > 0) {
+        node = pending.items[--pending.count];
+        switch (node->type) {
+            case NODE_FUNC_CALL:
+            case NODE_ASSIGN:
+                found = 1;
+                break;
+            case NODE_BINARY_OP:
+                if (may_divide_by_zero(node)) {
+                    found = 1;
+                    break;
+                }
+                if (node->data.binary_op.right) ast_stack_push(&pending, node->data.binary_op.right);
+                if (node->data.binary_op.left) ast_stack_push(&pending, node->data.binary_op.left);
+                break;
+            case NODE_UNARY_OP:
+                if (node->data.unary_op.operand) ast_stack_push(&pending, node->data.unary_op.operand);
+                break;
+            default:
+                break;
+        }
+    }
+    ast_stack_free(&pending);
+    return found;
+}
+
+// Verifica se a expressão já produz 0 ou 1 (comparações, operadores lógicos e '!').
+static int is_boolean_valued(ASTNode* node) {
+    if (node->type == NODE_UNARY_OP) return strcmp(node->data.unary_op.op, "!") == 0;
+    if (node->type != NODE_BINARY_OP) return 0;
+    const char* op = node->data.binary_op.op;
+    return strcmp(op, "==") == 0 || strcmp(op, "!=") == 0 ||
+           strcmp(op, "<") == 0 || strcmp(op, ">") == 0 ||
+           strcmp(op, "<=") == 0 || strcmp(op, ">=") == 0 ||
+           strcmp(op, "&&") == 0 || strcmp(op, "||") == 0;
+}
+
+// Libera os dados próprios do nó (operador e filhos), deixando apenas a casca.
+static void release_node_contents(ASTNode* node) {
+    if (node->type == NODE_BINARY_OP) {
+        free(node->data.binary_op.op);
+        free_ast(node->data.binary_op.left);
+        free_ast(node->data.binary_op.right);
+    } else if (node->type == NODE_UNARY_OP) {
+        free(node->data.unary_op.op);
+        free_ast(node->data.unary_op.operand);
+    }
+}
+
+static ASTNode* new_int_literal(int value, Position pos) {
+    ASTNode* node = create_node(NODE_INT_LITERAL, pos);
+    node->value_type = TYPE_INT;
+    node->data.int_literal = value;
+    return node;
+}
+
+static void make_int_literal(ASTNode* node, int value) {
+    release_node_contents(node);
+    node->type = NODE_INT_LITERAL;
+    node->value_type = TYPE_INT;
+    node->data.int_literal = value;
+}
+
+static void make_float_literal(ASTNode* node, double value) {
+    release_node_contents(node);
+    node->type = NODE_FLOAT_LITERAL;
+    node->value_type = TYPE_FLOAT;
+    node->data.float_literal = value;
+}
+
+// Substitui o nó pelo seu filho 'child', liberando os demais filhos.
+static void replace_with_child(ASTNode* node, ASTNode* child) {
+    if (node->type == NODE_BINARY_OP) {
+        if (node->data.binary_op.left == child) node->data.binary_op.left = NULL;
+        if (node->data.binary_op.right == child) node->data.binary_op.right = NULL;
+    } else if (node->type == NODE_UNARY_OP && node->data.unary_op.operand == child) {
+        node->data.unary_op.operand = NULL;
+    }
+    release_node_contents(node);
+    *node = *child;
+    free(child);
+}
+
+// Transforma 'node' em 'expr != 0', preservando apenas o valor-verdade de 'expr'.
+static void make_truth_test(ASTNode* node, ASTNode* expr) {
+    if (is_boolean_valued(expr)) {
+        replace_with_child(node, expr);
+        return;
+    }
+    ASTNode* zero = new_int_literal(0, expr->pos);
+    node->value_type = TYPE_INT;
+    free(node->data.binary_op.op);
+    node->data.binary_op.op = strdup("!=");
+    node->data.binary_op.left = expr;
+    node->data.binary_op.right = zero;
+}
+
+// --- Implementação ---
+
+void optimize_ast(ASTNode* node) {
+    if (!node) {
+        return;
+    }
+    const Pass* local_passes[] = { &fold_pass, &prune_pass };
+    walk_passes(node, local_passes, 2);
+    optimize_whole_program(node);
+}
+
+// --- Declarações Fundas Demais ---
+
+// Uma função (ou o main) é retirada da lista de declarações; uma global fica na lista,
+// para que o seu nome continue reservado, e só o valor inicial é retirado
+typedef struct {
+    ASTNodeList* cell;        // Célula retirada da lista, ou NULL para uma global
+    ASTNodeList* predecessor; // Célula que a precedia (NULL se era a primeira)
+    ASTNode* decl;
+    ASTNode* initial_value;
+} DeepDeclaration;
+
+typedef struct {
+    DeepDeclaration* items;
+    int count;
+    int capacity;
+} DeepDeclarations;
+
+static void deep_declarations_push(DeepDeclarations* deep, DeepDeclaration item) {
+    if (deep->count == deep->capacity) {
+        int capacity = deep->capacity ? deep->capacity * 2 : 4;
+        DeepDeclaration* items = (DeepDeclaration*)realloc(deep->items, capacity * sizeof(DeepDeclaration));
+        if (!items) {
+            report_error("Erro de Memória: falha ao alocar a lista de declarações não otimizadas.\n");
+            fatal_error();
+        }
+        deep->items = items;
+        deep->capacity = capacity;
+    }
+    deep->items[deep->count++] = item;
+}
+
+static void detach_deep_declarations(ASTNode* program, DeepDeclarations* deep) {
+    ASTNodeList* predecessor = NULL;
+    ASTNodeList** link = &program->data.program.declarations;
+    while (*link) {
+        ASTNodeList* cell = *link;
+        ASTNode* decl = cell->node;
+        int depth = ast_depth(decl);
+        if (depth <= OPTIMIZER_MAX_DEPTH) {
+            predecessor = cell;
+            link = &cell->next;
+            continue;
+        }
+        // Vai para o destino dos erros: o programa compila, mas quem o compilou precisa
+        // saber que parte do código gerado não foi otimizada
+        if (decl->type == NODE_VAR_DECL) {
+            report_error("Aviso: global '%s' com profundidade %d (limite %d); o valor inicial foi gerado sem otimização.\n",
+                         decl->data.var_decl.var_name, depth, OPTIMIZER_MAX_DEPTH);
+            deep_declarations_push(deep, (DeepDeclaration){ NULL, NULL, decl, decl->data.var_decl.initial_value });
+            decl->data.var_decl.initial_value = NULL;
+            predecessor = cell;
+            link = &cell->next;
+            continue;
+        }
+        report_error("Aviso: '%s' com profundidade %d (limite %d); foi gerada sem otimização.\n",
+                     decl->type == NODE_FUNC_DEF ? decl->data.func_def.func_name : "main", depth, OPTIMIZER_MAX_DEPTH);
+        deep_declarations_push(deep, (DeepDeclaration){ cell, predecessor, decl, NULL });
+        *link = cell->next;
+    }
+}
+
+// Devolve as declarações aos seus lugares. Sem o programa inteiro, as etapas não removem
+// declarações, então as células que precediam as retiradas continuam na lista; as
+// retiradas em sequência têm o mesmo predecessor e são reinseridas da última à primeira.
+static void restore_deep_declarations(ASTNode* program, DeepDeclarations* deep) {
+    for (int i = deep->count - 1; i >= 0; i--) {
+        DeepDeclaration* item = &deep->items[i];
+        if (!item->cell) {
+            item->decl->data.var_decl.initial_value = item->initial_value;
+            continue;
+        }
+        ASTNodeList** link = item->predecessor ? &item->predecessor->next : &program->data.program.declarations;
+        item->cell->next = *link;
+        *link = item->cell;
+    }
+    free(deep->items);
+}
+
+// Etapas que precisam ver o programa inteiro (passe "opt"). O dobramento e a poda já
+// foram feitos pelos passes "fold" e "prune", em geral no percurso da análise semântica.
+static void optimize_whole_program(ASTNode* node) {
+    if (node->type != NODE_PROGRAM) return;
+    DeepDeclarations deep = {0};
+    detach_deep_declarations(node, &deep);
+    // Com uma declaração de fora, as etapas não veem o programa inteiro: nenhuma função
+    // ou global é removida
+    int saved_whole_program = whole_program;
+    if (deep.count > 0) whole_program = 0;
+    run_whole_program_passes(node);
+    whole_program = saved_whole_program;
+    restore_deep_declarations(node, &deep);
+}
+
+static void run_whole_program_passes(ASTNode* node) {
+    inline_counter = cse_counter = licm_counter = iv_counter = tail_counter = 0;
+    eliminate_tail_calls(node);
+    inline_functions(node);
+    eliminate_dead_code(node); // Inclui o dobramento das expressões expandidas inline
+    if (unroll_loops(node) > 0) {
+        eliminate_dead_code(node); // As cópias desenroladas costumam ter condições constantes
+    }
+    reduce_induction_variables(node);
+    move_loop_invariants(node);
+    eliminate_common_subexpressions(node);
+    order_branches(node);
+}
+
+const Pass optimize_pass = {
+    .name = "opt",
+    .requires = PASS_BIT(PASS_SEMA),
+    .optional = 1,
+    .run = optimize_whole_program,
+};
+
+void set_optimizer_profile(const ExecutionProfile* profile) {
+    active_profile = profile;
+}
+
+void optimize_ast_partial(ASTNode* program) {
+    whole_program = 0;
+    optimize_ast(program);
+    whole_program = 1;
+}
+
+// --- Constant Folding ---
+
+// Pós-ordem: os operandos já foram dobrados quando o nó é simplificado.
+static void fold_post(const PassVisit* visit) {
+    ASTNode* node = *visit->slot;
+    if (node->type != NODE_BINARY_OP && node->type != NODE_UNARY_OP) return;
+    // As regras inspecionam os operandos inteiros ('x - x'); numa subárvore mais alta que
+    // o limite (a espinha de uma expressão muito longa) o nó é mantido como está
+    if (visit->height > OPTIMIZER_MAX_DEPTH) return;
+    simplify_node(node);
+}
+
+const Pass fold_pass = {
+    .name = "fold",
+    .requires = PASS_BIT(PASS_SEMA),
+    .optional = 1,
+    .post = fold_post,
+};
+
+static void fold_constants(ASTNode* node) {
+    const Pass* passes[] = { &fold_pass };
+    walk_passes(node, passes, 1);
+}
+
+// Avalia uma comparação entre dois valores numéricos, retornando 0 ou 1 (-1 se o operador não for relacional).
+static int evaluate_comparison(const char* op, double a, double b) {
+    if (strcmp(op, "==") == 0) return a == b;
+    if (strcmp(op, "!=") == 0) return a != b;
+    if (strcmp(op, "<") == 0) return a < b;
+    if (strcmp(op, ">") == 0) return a > b;
+    if (strcmp(op, "<=") == 0) return a <= b;
+    if (strcmp(op, ">=") == 0) return a >= b;
+    return -1;
+}
+
+// Operadores lógicos: avalia com curto-circuito quando o operando esquerdo é constante.
+static int fold_logical_op(ASTNode* node, int is_and) {
+    ASTNode* left = node->data.binary_op.left;
+    ASTNode* right = node->data.binary_op.right;
+    const char* op = node->data.binary_op.op;
+
+    if (is_constant(left)) {
+        int left_truth = is_truthy(left);
+        if (is_and != left_truth) {
+            // '0 && x' e '1 || x': o operando direito nunca é avaliado
+            report_info("Otimização: Expressão lógica '%s' na linha %d foi calculada como '%d' (curto-circuito).\n",
+                        op, node->pos.line, left_truth);
+            make_int_literal(node, left_truth);
+            return 1;
+        }
+        // '1 && x' e '0 || x': o resultado é o valor-verdade de x
+        if (is_constant(right)) {
+            int result = is_truthy(right);
+            report_info("Otimização: Expressão lógica '%s' na linha %d foi calculada como '%d'.\n",
+                        op, node->pos.line, result);
+            make_int_literal(node, result);
+            return 1;
+        }
+        report_info("Otimização: Operando constante removido da expressão lógica '%s' na linha %d.\n",
+                    op, node->pos.line);
+        free_ast(left);
+        node->data.binary_op.left = NULL;
+        make_truth_test(node, right);
+        return 1;
+    }
+
+    if (is_constant(right)) {
+        int right_truth = is_truthy(right);
+        if (is_and != right_truth) {
+            // 'x && 0' e 'x || 1': o resultado é fixo, mas x só pode ser descartado se não tiver efeitos
+            if (has_side_effects(left)) return 0;
+            report_info("Otimização: Expressão lógica '%s' na linha %d foi calculada como '%d'.\n",
+                        op, node->pos.line, right_truth);
+            make_int_literal(node, right_truth);
+            return 1;
+        }
+        report_info("Otimização: Operando constante removido da expressão lógica '%s' na linha %d.\n",
+                    op, node->pos.line);
+        free_ast(right);
+        node->data.binary_op.right = NULL;
+        make_truth_test(node, left);
+        return 1;
+    }
+    return 0;
+}
+
+static int fold_binary_op(ASTNode* node) {
+    ASTNode* left = node->data.binary_op.left;
+    ASTNode* right = node->data.binary_op.right;
+    const char* op = node->data.binary_op.op;
+
+    if (!left || !right) return 0;
+
+    if (strcmp(op, "&&") == 0 || strcmp(op, "||") == 0) {
+        return fold_logical_op(node, op[0] == '&');
+    }
+
+    if (!is_constant(left) || !is_constant(right)) return 0;
+
+    // Comparações sempre produzem um inteiro (0 ou 1), mesmo com operandos float
+    int comparison = evaluate_comparison(op, constant_value(left), constant_value(right));
+    if (comparison >= 0) {
+        report_info("Otimização: Comparação '%s' na linha %d foi calculada como '%d'.\n",
+                    op, node->pos.line, comparison);
+        make_int_literal(node, comparison);
+        return 1;
+    }
+
+    if (left->type == NODE_INT_LITERAL && right->type == NODE_INT_LITERAL) {
+        long long a = left->data.int_literal;
+        long long b = right->data.int_literal;
+        long long result;
+
+        if (strcmp(op, "+") == 0) result = a + b;
+        else if (strcmp(op, "-") == 0) result = a - b;
+        else if (strcmp(op, "*") == 0) result = a * b;
+        else if (strcmp(op, "/") == 0) {
+            if (b == 0) return 0; // Evita otimização de divisão por zero
+            result = a / b;
+        } else if (strcmp(op, "<<") == 0) {
+            if (b < 0 || b > 30) return 0; // Deslocamentos só surgem da redução de força de 'x * 2^k'
+            result = a * (1LL << b);
+        } else {
+            return 0; // Não otimiza outros operadores
+        }
+        if (result < INT_MIN || result > INT_MAX) return 0; // Preserva o comportamento do overflow em tempo de execução
+
+        report_info("Otimização: Expressão '%lld %s %lld' na linha %d foi calculada como '%lld'.\n",
+                    a, op, b, node->pos.line, result);
+        make_int_literal(node, (int)result);
+        return 1;
+    }
+
+    // Pelo menos um operando é float: a operação é feita em precisão dupla, como no
+    // Python. Um resultado infinito (ou NaN) fica para a execução, já que não tem literal.
+    double a = constant_value(left);
+    double b = constant_value(right);
+    double result;
+
+    if (strcmp(op, "+") == 0) result = a + b;
+    else if (strcmp(op, "-") == 0) result = a - b;
+    else if (strcmp(op, "*") == 0) result = a * b;
+    else if (strcmp(op, "/") == 0) {
+        if (b == 0.0) return 0;
+        result = a / b;
+    } else {
+        return 0;
+    }
+    if (!isfinite(result)) return 0;
+
+    report_info("Otimização: Expressão '%.17g %s %.17g' na linha %d foi calculada como '%.17g'.\n",
+                a, op, b, node->pos.line, result);
+    make_float_literal(node, result);
+    return 1;
+}
+
+static int fold_unary_op(ASTNode* node) {
+    ASTNode* operand = node->data.unary_op.operand;
+    const char* op = node->data.unary_op.op;
+
+    if (!is_constant(operand)) return 0;
+
+    if (strcmp(op, "!") == 0) {
+        int result = !is_truthy(operand);
+        report_info("Otimização: Expressão '!' na linha %d foi calculada como '%d'.\n", node->pos.line, result);
+        make_int_literal(node, result);
+        return 1;
+    }
+    if (strcmp(op, "-") != 0) return 0;
+    if (operand->type == NODE_INT_LITERAL) {
+        if (operand->data.int_literal == INT_MIN) return 0;
+        int result = -operand->data.int_literal;
+        report_info("Otimização: Expressão '-%d' na linha %d foi calculada como '%d'.\n",
+                    operand->data.int_literal, node->pos.line, result);
+        make_int_literal(node, result);
+    } else {
+        double result = -operand->data.float_literal;
+        report_info("Otimização: Expressão '-%.17g' na linha %d foi calculada como '%.17g'.\n",
+                    operand->data.float_literal, node->pos.line, result);
+        make_float_literal(node, result);
+    }
+    return 1;
+}
+
+// --- Simplificação Algébrica ---
+//
+// Cada regra se aplica a um operador e é composta por um teste ('matches') e
+// uma reescrita ('rewrite') feita in-place sobre o nó. Para acrescentar uma
+// regra, basta escrever as duas funções e incluí-la na tabela correspondente.
+// As regras de operadores comutativos podem supor a constante à direita, pois
+// a primeira regra de cada um deles move a constante para esse lado.
+
+typedef struct {
+    const char* op;          // Operador ao qual a regra se aplica
+    const char* description; // Descrição exibida quando a regra é aplicada
+    int (*matches)(ASTNode* node);
+    void (*rewrite)(ASTNode* node);
+} SimplificationRule;
+
+static int is_int_constant(ASTNode* node, int value) {
+    return node && node->type == NODE_INT_LITERAL && node->data.int_literal == value;
+}
+
+static int is_numeric_constant(ASTNode* node, double value) {
+    return is_constant(node) && constant_value(node) == value;
+}
+
+static int is_pure_int(ASTNode* node) {
+    return node->value_type == TYPE_INT && !has_side_effects(node);
+}
+
+// Retorna k se value == 2^k (com k >= 1), ou -1 caso contrário.
+static int power_of_two_exponent(int value) {
+    if (value < 2 || (value & (value - 1)) != 0) return -1;
+    int k = 0;
+    while ((1 << k) != value) k++;
+    return k;
+}
+
+// --- Testes das regras ---
+
+static int match_constant_on_left(ASTNode* node) {
+    return is_constant(node->data.binary_op.left) && !is_constant(node->data.binary_op.right);
+}
+
+// 'x' pode ficar no lugar de 'x + 0', 'x / 1' ou '-(-x)': o valor é certamente um int
+// (ou um float). Uma chamada anotada como int pode devolver um float (que 'x / 1' trunca)
+// ou um bool do Python (que 'x + 0' converte em 0 ou 1).
+static int keeps_operand_value(ASTNode* operand) {
+    return operand->value_type == TYPE_FLOAT || ast_is_integer(operand);
+}
+
+static int match_right_zero(ASTNode* node) {
+    return is_numeric_constant(node->data.binary_op.right, 0.0) && keeps_operand_value(node->data.binary_op.left);
+}
+
+static int match_right_one(ASTNode* node) {
+    return is_numeric_constant(node->data.binary_op.right, 1.0) && keeps_operand_value(node->data.binary_op.left);
+}
+
+static int match_times_zero(ASTNode* node) {
+    return is_int_constant(node->data.binary_op.right, 0) && is_pure_int(node->data.binary_op.left);
+}
+
+static int match_same_pure_int_operands(ASTNode* node) {
+    return is_pure_int(node->data.binary_op.left) &&
+           ast_equal(node->data.binary_op.left, node->data.binary_op.right);
+}
+
+static int match_zero_minus(ASTNode* node) {
+    return is_int_constant(node->data.binary_op.left, 0) && node->data.binary_op.right->value_type == TYPE_INT;
+}
+
+// (x + c1) + c2, (x - c1) + c2, (x + c1) - c2 e (x - c1) - c2, apenas com inteiros
+static int match_additive_chain(ASTNode* node) {
+    ASTNode* left = node->data.binary_op.left;
+    ASTNode* right = node->data.binary_op.right;
+    if (right->type != NODE_INT_LITERAL || left->type != NODE_BINARY_OP) return 0;
+    if (left->data.binary_op.left->value_type != TYPE_INT) return 0;
+    const char* inner = left->data.binary_op.op;
+    if (strcmp(inner, "+") != 0 && strcmp(inner, "-") != 0) return 0;
+    if (left->data.binary_op.right->type != NODE_INT_LITERAL) return 0;
+
+    long long c1 = left->data.binary_op.right->data.int_literal;
+    long long c2 = right->data.int_literal;
+    long long sum = (inner[0] == '+' ? c1 : -c1) + (node->data.binary_op.op[0] == '+' ? c2 : -c2);
+    return sum > INT_MIN && sum <= INT_MAX;
+}
+
+// (x * c1) * c2, apenas com inteiros
+static int match_multiplicative_chain(ASTNode* node) {
+    ASTNode* left = node->data.binary_op.left;
+    ASTNode* right = node->data.binary_op.right;
+    if (right->type != NODE_INT_LITERAL || left->type != NODE_BINARY_OP) return 0;
+    if (strcmp(left->data.binary_op.op, "*") != 0) return 0;
+    if (left->data.binary_op.left->value_type != TYPE_INT) return 0;
+    if (left->data.binary_op.right->type != NODE_INT_LITERAL) return 0;
+
+    long long product = (long long)left->data.binary_op.right->data.int_literal * right->data.int_literal;
+    return product >= INT_MIN && product <= INT_MAX;
+}
+
+static int match_times_power_of_two(ASTNode* node) {
+    ASTNode* right = node->data.binary_op.right;
+    return ast_is_integer(node->data.binary_op.left) &&
+           right->type == NODE_INT_LITERAL && power_of_two_exponent(right->data.int_literal) > 0;
+}
+
+static int match_double_negation(ASTNode* node) {
+    ASTNode* operand = node->data.unary_op.operand;
+    return operand->type == NODE_UNARY_OP && strcmp(operand->data.unary_op.op, "-") == 0 &&
+           keeps_operand_value(operand->data.unary_op.operand);
+}
+
+static const char* inverted_comparison(const char* op) {
+    if (strcmp(op, "<") == 0) return ">=";
+    if (strcmp(op, ">") == 0) return "<=";
+    if (strcmp(op, "<=") == 0) return ">";
+    if (strcmp(op, ">=") == 0) return "<";
+    if (strcmp(op, "==") == 0) return "!=";
+    if (strcmp(op, "!=") == 0) return "==";
+    return NULL;
+}
+
+// !(a < b) -> a >= b, apenas com operandos inteiros (com float, NaN impede a inversão)
+static int match_negated_comparison(ASTNode* node) {
+    ASTNode* operand = node->data.unary_op.operand;
+    return operand->type == NODE_BINARY_OP &&
+           inverted_comparison(operand->data.binary_op.op) != NULL &&
+           ast_is_integer(operand->data.binary_op.left) &&
+           ast_is_integer(operand->data.binary_op.right);
+}
+
+// --- Reescritas das regras ---
+
+static void rewrite_swap_operands(ASTNode* node) {
+    ASTNode* left = node->data.binary_op.left;
+    node->data.binary_op.left = node->data.binary_op.right;
+    node->data.binary_op.right = left;
+}
+
+static void rewrite_keep_left(ASTNode* node) {
+    replace_with_child(node, node->data.binary_op.left);
+}
+
+static void rewrite_zero(ASTNode* node) {
+    make_int_literal(node, 0);
+}
+
+static void rewrite_one(ASTNode* node) {
+    make_int_literal(node, 1);
+}
+
+static void rewrite_negation(ASTNode* node) {
+    ASTNode* operand = node->data.binary_op.right;
+    node->data.binary_op.right = NULL;
+    free_ast(node->data.binary_op.left);
+    free(node->data.binary_op.op);
+    node->type = NODE_UNARY_OP;
+    node->data.unary_op.op = strdup("-");
+    node->data.unary_op.operand = operand;
+}
+
+static void rewrite_additive_chain(ASTNode* node) {
+    ASTNode* inner = node->data.binary_op.left;
+    int c1 = inner->data.binary_op.right->data.int_literal;
+    int c2 = node->data.binary_op.right->data.int_literal;
+    long long sum = (inner->data.binary_op.op[0] == '+' ? c1 : -(long long)c1) +
+                    (node->data.binary_op.op[0] == '+' ? c2 : -(long long)c2);
+
+    node->data.binary_op.left = inner->data.binary_op.left;
+    inner->data.binary_op.left = NULL;
+    free_ast(inner);
+    free(node->data.binary_op.op);
+    node->data.binary_op.op = strdup(sum < 0 ? "-" : "+");
+    node->data.binary_op.right->data.int_literal = (int)(sum < 0 ? -sum : sum);
+}
+
+static void rewrite_multiplicative_chain(ASTNode* node) {
+    ASTNode* inner = node->data.binary_op.left;
+    int product = inner->data.binary_op.right->data.int_literal * node->data.binary_op.right->data.int_literal;
+
+    node->data.binary_op.left = inner->data.binary_op.left;
+    inner->data.binary_op.left = NULL;
+    free_ast(inner);
+    node->data.binary_op.right->data.int_literal = product;
+}
+
+// x * 2^k -> x << k (redução de força; em Python e em C o deslocamento equivale à multiplicação de inteiros)
+static void rewrite_shift(ASTNode* node) {
+    ASTNode* right = node->data.binary_op.right;
+    right->data.int_literal = power_of_two_exponent(right->data.int_literal);
+    free(node->data.binary_op.op);
+    node->data.binary_op.op = strdup("<<");
+}
+
+static void rewrite_double_negation(ASTNode* node) {
+    ASTNode* inner = node->data.unary_op.operand;
+    ASTNode* operand = inner->data.unary_op.operand;
+    inner->data.unary_op.operand = NULL;
+    node->data.unary_op.operand = NULL;
+    free_ast(inner);
+    replace_with_child(node, operand);
+}
+
+static void rewrite_negated_comparison(ASTNode* node) {
+    ASTNode* comparison = node->data.unary_op.operand;
+    const char* inverted = inverted_comparison(comparison->data.binary_op.op);
+    free(comparison->data.binary_op.op);
+    comparison->data.binary_op.op = strdup(inverted);
+    replace_with_child(node, comparison);
+}
+
+static const SimplificationRule binary_rules[] = {
+    { "+",  "c + x -> x + c",                 match_constant_on_left,       rewrite_swap_operands },
+    { "*",  "c * x -> x * c",                 match_constant_on_left,       rewrite_swap_operands },
+    { "==", "c == x -> x == c",               match_constant_on_left,       rewrite_swap_operands },
+    { "!=", "c != x -> x != c",               match_constant_on_left,       rewrite_swap_operands },
+    { "+",  "x + 0 -> x",                     match_right_zero,             rewrite_keep_left },
+    { "-",  "x - 0 -> x",                     match_right_zero,             rewrite_keep_left },
+    { "*",  "x * 1 -> x",                     match_right_one,              rewrite_keep_left },
+    { "/",  "x / 1 -> x",                     match_right_one,              rewrite_keep_left },
+    { "*",  "x * 0 -> 0",                     match_times_zero,             rewrite_zero },
+    { "-",  "x - x -> 0",                     match_same_pure_int_operands, rewrite_zero },
+    { "==", "x == x -> 1",                    match_same_pure_int_operands, rewrite_one },
+    { "!=", "x != x -> 0",                    match_same_pure_int_operands, rewrite_zero },
+    { "-",  "0 - x -> -x",                    match_zero_minus,             rewrite_negation },
+    { "+",  "(x + c1) + c2 -> x + (c1 + c2)", match_additive_chain,         rewrite_additive_chain },
+    { "-",  "(x + c1) - c2 -> x + (c1 - c2)", match_additive_chain,         rewrite_additive_chain },
+    { "*",  "(x * c1) * c2 -> x * (c1 * c2)", match_multiplicative_chain,   rewrite_multiplicative_chain },
+    { "*",  "x * 2^k -> x << k",              match_times_power_of_two,     rewrite_shift },
+};
+
+static const SimplificationRule unary_rules[] = {
+    { "-", "-(-x) -> x",           match_double_negation,    rewrite_double_negation },
+    { "!", "!(a < b) -> a >= b",   match_negated_comparison, rewrite_negated_comparison },
+};
+
+// Aplica a primeira regra da tabela que casar com o nó. Retorna 1 se alguma foi aplicada.
+static int apply_rules(ASTNode* node, const SimplificationRule* rules, size_t count) {
+    const char* op = node->type == NODE_BINARY_OP ? node->data.binary_op.op : node->data.unary_op.op;
+    for (size_t i = 0; i < count; i++) {
+        if (strcmp(rules[i].op, op) == 0 && rules[i].matches(node)) {
+            report_info("Otimização: Simplificação algébrica '%s' aplicada na linha %d.\n",
+                        rules[i].description, node->pos.line);
+            rules[i].rewrite(node);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Um passo de simplificação: dobra o nó ou, se não for possível, aplica a primeira regra
+// algébrica que casar com ele. Retorna 1 se o nó foi alterado.
+static int simplify_step(ASTNode* node) {
+    if (node->type == NODE_BINARY_OP) {
+        if (fold_binary_op(node)) return 1;
+        return node->data.binary_op.left && node->data.binary_op.right &&
+               apply_rules(node, binary_rules, sizeof(binary_rules) / sizeof(binary_rules[0]));
+    }
+    if (node->type == NODE_UNARY_OP) {
+        if (fold_unary_op(node)) return 1;
+        return node->data.unary_op.operand &&
+               apply_rules(node, unary_rules, sizeof(unary_rules) / sizeof(unary_rules[0]));
+    }
+    return 0;
+}
+
+// Dobra constantes e aplica as regras algébricas até que nenhuma delas case com o nó.
+static void simplify_node(ASTNode* node) {
+    while (simplify_step(node)) {
+    }
+}
+
+// --- Eliminação de Código Morto ---
+
+#define USAGE_TABLE_SIZE 211
+
+// Contagem de usos de um nome dentro de uma região (função, main ou programa inteiro).
+typedef struct NameUsage {
+    char* name;
+    int reads;          // Leituras do identificador
+    int pinned_writes;  // Escritas que não podem ser removidas (aninhadas ou com efeitos colaterais)
+    int decls;          // Declarações do nome na região
+    int writes;         // Todas as escritas (declarações e atribuições)
+    struct NameUsage* next;
+} NameUsage;
+
+typedef struct {
+    NameUsage* buckets[USAGE_TABLE_SIZE];
+} UsageTable;
+
+static unsigned long usage_hash(const char* str) {
+    unsigned long hash = 5381;
+    int c;
+    while ((c = *str++)) {
+        hash = ((hash << 5) + hash) + c;
+    }
+    return hash % USAGE_TABLE_SIZE;
+}
+
+static NameUsage* usage_lookup(UsageTable* table, const char* name, int create) {
+    unsigned long index = usage_hash(name);
+    for (NameUsage* u = table->buckets[index]; u; u = u->next) {
+        if (strcmp(u->name, name) == 0) return u;
+    }
+    if (!create) return NULL;
+    NameUsage* u = (NameUsage*)calloc(1, sizeof(NameUsage));
+    if (!u) {
+        report_error("Erro de Memória: falha ao alocar memória.\n");
+        fatal_error();
+    }
+    u->name = strdup(name); // Cópia própria: os nós podem ser liberados durante a remoção
+    u->next = table->buckets[index];
+    table->buckets[index] = u;
+    return u;
+}
+
+static void usage_clear(UsageTable* table) {
+    for (int i = 0; i < USAGE_TABLE_SIZE; i++) {
+        NameUsage* u = table->buckets[i];
+        while (u) {
+            NameUsage* next = u->next;
+            free(u->name);
+            free(u);
+            u = next;
+        }
+        table->buckets[i] = NULL;
+    }
+}
+
+static void free_statement_list(ASTNodeList* list) {
+    while (list) {
+        ASTNodeList* next = list->next;
+        free_ast(list->node);
+        free(list);
+        list = next;
+    }
+}
+
+static int is_empty_block(ASTNode* node) {
+    return !node || (node->type == NODE_BLOCK && node->data.block.statements == NULL);
+}
+
+// Um comando "sempre retorna" se nenhum caminho de execução chega ao comando seguinte.
+static int always_returns(ASTNode* node) {
+    if (!node) return 0;
+    switch (node->type) {
+        case NODE_RETURN:
+            return 1;
+        case NODE_BLOCK:
+            for (ASTNodeList* l = node->data.block.statements; l; l = l->next) {
+                if (always_returns(l->node)) return 1;
+            }
+            return 0;
+        case NODE_IF:
+            return node->data.if_stmt.else_body &&
+                   always_returns(node->data.if_stmt.if_body) &&
+                   always_returns(node->data.if_stmt.else_body);
+        default:
+            return 0;
+    }
+}
+
+// A poda é um passe do gerenciador ("prune"): cada comando é simplificado na pós-ordem,
+// quando os comandos aninhados (e, no percurso fundido, as condições) já foram tratados.
+
+// Remove do bloco os comandos podados por completo e os que vêm depois de um 'return'.
+// Retorna 1 se o bloco foi alterado.
+static int prune_block(ASTNode* block) {
+    int changed = 0;
+    ASTNodeList** link = &block->data.block.statements;
+    while (*link) {
+        ASTNodeList* cell = *link;
+        if (cell->node && cell->node->type == NODE_BLOCK && is_empty_block(cell->node)) {
+            free_ast(cell->node); // Bloco aninhado que ficou vazio
+            cell->node = NULL;
+        }
+        if (!cell->node) {
+            *link = cell->next;
+            free(cell);
+            changed = 1;
+            continue;
+        }
+        if (cell->next && always_returns(cell->node)) {
+            // No percurso fundido, os comandos seguintes já podados estão como NULL
+            ASTNodeList* dead = cell->next;
+            while (dead && !dead->node) dead = dead->next;
+            if (dead) {
+                report_info("Otimização: Código inalcançável após 'return' na linha %d foi removido.\n",
+                            dead->node->pos.line);
+            }
+            free_statement_list(cell->next);
+            cell->next = NULL;
+            changed = 1;
+        }
+        link = &cell->next;
+    }
+    return changed;
+}
+
+// Retorna o comando simplificado, ou NULL se ele puder ser removido por completo.
+// Os comandos aninhados já foram podados.
+static ASTNode* prune_statement(ASTNode* node) {
+    switch (node->type) {
+        case NODE_FOR: {
+            ASTNode* condition = node->data.for_stmt.condition;
+            if (!condition || !is_constant(condition) || is_truthy(condition)) return node;
+            // O corpo nunca executa: resta apenas a inicialização
+            report_info("Otimização: Laço 'for' com condição falsa na linha %d foi removido.\n", node->pos.line);
+            ASTNode* kept = node->data.for_stmt.init;
+            node->data.for_stmt.init = NULL;
+            free_ast(node);
+            return kept;
+        }
+        case NODE_WHILE:
+            if (is_constant(node->data.while_stmt.condition) && !is_truthy(node->data.while_stmt.condition)) {
+                report_info("Otimização: Laço 'while' com condição falsa na linha %d foi removido.\n", node->pos.line);
+                free_ast(node);
+                return NULL;
+            }
+            return node;
+        case NODE_IF: {
+            ASTNode* condition = node->data.if_stmt.condition;
+            ASTNode* kept;
+            if (is_constant(condition)) {
+                report_info("Otimização: Comando 'if' com condição constante na linha %d foi simplificado.\n", node->pos.line);
+                if (is_truthy(condition)) {
+                    kept = node->data.if_stmt.if_body;
+                    node->data.if_stmt.if_body = NULL;
+                } else {
+                    kept = node->data.if_stmt.else_body;
+                    node->data.if_stmt.else_body = NULL;
+                }
+            } else if (is_empty_block(node->data.if_stmt.if_body) && !node->data.if_stmt.else_body &&
+                       !has_side_effects(condition)) {
+                report_info("Otimização: Comando 'if' sem efeito na linha %d foi removido.\n", node->pos.line);
+                kept = NULL;
+            } else {
+                return node;
+            }
+            free_ast(node);
+            return kept;
+        }
+        case NODE_ASSIGN:
+            // 'x = x' (comum depois de simplificações como 'x + 0 -> x')
+            if (node->data.assign_expr.rvalue->type == NODE_IDENTIFIER &&
+                strcmp(node->data.assign_expr.rvalue->data.identifier_name,
+                       node->data.assign_expr.lvalue->data.identifier_name) == 0) {
+                report_info("Otimização: Atribuição sem efeito a '%s' na linha %d foi removida.\n",
+                            node->data.assign_expr.lvalue->data.identifier_name, node->pos.line);
+                free_ast(node);
+                return NULL;
+            }
+            return node;
+        default:
+            return node;
+    }
+}
+
+// O nó ocupa a posição de um comando: elemento de um bloco ou corpo de if, for ou while.
+static int is_statement_slot(ASTNode** slot, ASTNode* parent) {
+    if (!parent) return 0;
+    switch (parent->type) {
+        case NODE_BLOCK:
+            return 1;
+        case NODE_IF:
+            return slot == &parent->data.if_stmt.if_body || slot == &parent->data.if_stmt.else_body;
+        case NODE_FOR:
+            return slot == &parent->data.for_stmt.body;
+        case NODE_WHILE:
+            return slot == &parent->data.while_stmt.body;
+        default:
+            return 0;
+    }
+}
+
+// Só os comandos que podem conter outros comandos são percorridos pela poda.
+static int prune_pre(const PassVisit* visit) {
+    switch ((*visit->slot)->type) {
+        case NODE_PROGRAM:
+        case NODE_FUNC_DEF:
+        case NODE_MAIN_DEF:
+        case NODE_BLOCK:
+        case NODE_IF:
+        case NODE_FOR:
+        case NODE_WHILE:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+// Poda o nó guardado em 'slot', cujos comandos aninhados já foram podados. Retorna 1 se
+// algo mudou (o nó, ou o conteúdo de 'slot').
+static int prune_site(ASTNode** slot, ASTNode* parent) {
+    ASTNode* node = *slot;
+    int changed = 0;
+    switch (node->type) {
+        case NODE_BLOCK:
+            changed = prune_block(node);
+            break;
+        // Corpos podados por completo viram blocos vazios; um 'else' vazio é descartado
+        case NODE_FOR:
+            if (!node->data.for_stmt.body) {
+                node->data.for_stmt.body = create_node(NODE_BLOCK, node->pos);
+                changed = 1;
+            }
+            break;
+        case NODE_WHILE:
+            if (!node->data.while_stmt.body) {
+                node->data.while_stmt.body = create_node(NODE_BLOCK, node->pos);
+                changed = 1;
+            }
+            break;
+        case NODE_IF:
+            if (!node->data.if_stmt.if_body) {
+                node->data.if_stmt.if_body = create_node(NODE_BLOCK, node->pos);
+                changed = 1;
+            }
+            if (node->data.if_stmt.else_body && is_empty_block(node->data.if_stmt.else_body)) {
+                free_ast(node->data.if_stmt.else_body);
+                node->data.if_stmt.else_body = NULL;
+                changed = 1;
+            }
+            break;
+        default:
+            break;
+    }
+    if (is_statement_slot(slot, parent)) {
+        *slot = prune_statement(node);
+        if (*slot != node) changed = 1;
+    }
+    return changed;
+}
+
+static void prune_post(const PassVisit* visit) {
+    prune_site(visit->slot, visit->parent);
+}
+
+const Pass prune_pass = {
+    .name = "prune",
+    .requires = PASS_BIT(PASS_FOLD),
+    .optional = 1,
+    .pre = prune_pre,
+    .post = prune_post,
+};
+
+// --- Reescrita até o Ponto Fixo ---
+//
+// Depois da expansão inline e do desenrolamento, o dobramento, a simplificação e a poda
+// rodam no motor de reescrita (motor_reescrita.c): cada nó alterado volta para a lista de
+// trabalho junto com o pai, até que nenhuma regra se aplique.
+
+static int rewrite_expression(const RewriteSite* site) {
+    return simplify_step(*site->slot);
+}
+
+static int rewrite_statement(const RewriteSite* site) {
+    return prune_site(site->slot, site->parent);
+}
+
+static const RewriteRule rewrite_rules[] = {
+    { NODE_BINARY_OP, rewrite_expression },
+    { NODE_UNARY_OP,  rewrite_expression },
+    { NODE_BLOCK,     rewrite_statement },
+    { NODE_IF,        rewrite_statement },
+    { NODE_FOR,       rewrite_statement },
+    { NODE_WHILE,     rewrite_statement },
+    { NODE_ASSIGN,    rewrite_statement },
+};
+
+// Percorre a região contando leituras, declarações e escritas de cada nome.
+// 'statement_level' indica que o nó é um comando direto de um bloco.
+static void collect_usage(ASTNode* node, UsageTable* table, int statement_level) {
+    if (!node) return;
+    switch (node->type) {
+        case NODE_PROGRAM:
+            for (ASTNodeList* l = node->data.program.declarations; l; l = l->next) collect_usage(l->node, table, 1);
+            break;
+        case NODE_FUNC_DEF:
+            collect_usage(node->data.func_def.body, table, 0);
+            break;
+        case NODE_MAIN_DEF:
+            collect_usage(node->data.main_def.body, table, 0);
+            break;
+        case NODE_BLOCK:
+            for (ASTNodeList* l = node->data.block.statements; l; l = l->next) collect_usage(l->node, table, 1);
+            break;
+        case NODE_VAR_DECL: {
+            NameUsage* u = usage_lookup(table, node->data.var_decl.var_name, 1);
+            u->decls++;
+            u->writes++;
+            if (has_side_effects(node->data.var_decl.initial_value)) u->pinned_writes++;
+            collect_usage(node->data.var_decl.initial_value, table, 0);
+            break;
+        }
+        case NODE_ASSIGN: {
+            NameUsage* u = usage_lookup(table, node->data.assign_expr.lvalue->data.identifier_name, 1);
+            u->writes++;
+            if (!statement_level || has_side_effects(node->data.assign_expr.rvalue)) u->pinned_writes++;
+            collect_usage(node->data.assign_expr.rvalue, table, 0);
+            break;
+        }
+        case NODE_IDENTIFIER:
+            usage_lookup(table, node->data.identifier_name, 1)->reads++;
+            break;
+        case NODE_IF:
+            collect_usage(node->data.if_stmt.condition, table, 0);
+            collect_usage(node->data.if_stmt.if_body, table, 0);
+            collect_usage(node->data.if_stmt.else_body, table, 0);
+            break;
+        case NODE_FOR:
+            collect_usage(node->data.for_stmt.init, table, 0);
+            collect_usage(node->data.for_stmt.condition, table, 0);
+            collect_usage(node->data.for_stmt.increment, table, 0);
+            collect_usage(node->data.for_stmt.body, table, 0);
+            break;
+        case NODE_WHILE:
+            collect_usage(node->data.while_stmt.condition, table, 0);
+            collect_usage(node->data.while_stmt.body, table, 0);
+            break;
+        case NODE_RETURN:
+            collect_usage(node->data.return_stmt.return_value, table, 0);
+            break;
+        case NODE_BINARY_OP:
+            collect_usage(node->data.binary_op.left, table, 0);
+            collect_usage(node->data.binary_op.right, table, 0);
+            break;
+        case NODE_UNARY_OP:
+            collect_usage(node->data.unary_op.operand, table, 0);
+            break;
+        case NODE_FUNC_CALL:
+            for (ASTNodeList* l = node->data.func_call.args; l; l = l->next) collect_usage(l->node, table, 0);
+            break;
+        default:
+            break;
+    }
+}
+
+// Contexto da remoção: os nomes mortos são os candidatos sem leituras nem escritas fixas.
+typedef struct {
+    UsageTable* usage;
+    UsageTable* excluded; // Nomes que não pertencem à região (parâmetros e globais), pode ser NULL
+    UsageTable* only;     // Se não for NULL, apenas estes nomes são candidatos
+    RewriteEngine* engine; // Informado de cada comando removido
+} DeadNameQuery;
+
+static int is_dead_name(const DeadNameQuery* query, const char* name) {
+    if (query->excluded && usage_lookup(query->excluded, name, 0)) return 0;
+    if (query->only && !usage_lookup(query->only, name, 0)) return 0;
+    NameUsage* u = usage_lookup(query->usage, name, 0);
+    return u && u->decls > 0 && u->reads == 0 && u->pinned_writes == 0;
+}
+
+static int is_dead_statement(const DeadNameQuery* query, ASTNode* node) {
+    if (node->type == NODE_VAR_DECL) return is_dead_name(query, node->data.var_decl.var_name);
+    if (node->type == NODE_ASSIGN) return is_dead_name(query, node->data.assign_expr.lvalue->data.identifier_name);
+    return 0;
+}
+
+static int remove_dead_statements(ASTNode* node, const DeadNameQuery* query);
+
+static int remove_dead_from_list(ASTNodeList** link, const DeadNameQuery* query) {
+    int removed = 0;
+    while (*link) {
+        ASTNodeList* cell = *link;
+        if (is_dead_statement(query, cell->node)) {
+            if (cell->node->type == NODE_VAR_DECL) {
+                report_info("Otimização: Variável não utilizada '%s' na linha %d foi removida.\n",
+                            cell->node->data.var_decl.var_name, cell->node->pos.line);
+            } else {
+                report_info("Otimização: Atribuição a variável não utilizada '%s' na linha %d foi removida.\n",
+                            cell->node->data.assign_expr.lvalue->data.identifier_name, cell->node->pos.line);
+            }
+            *link = cell->next;
+            rewrite_engine_removed(query->engine, cell->node);
+            free_ast(cell->node);
+            free(cell);
+            removed++;
+            continue;
+        }
+        removed += remove_dead_statements(cell->node, query);
+        link = &cell->next;
+    }
+    return removed;
+}
+
+static int remove_dead_statements(ASTNode* node, const DeadNameQuery* query) {
+    if (!node) return 0;
+    switch (node->type) {
+        case NODE_PROGRAM:
+            return remove_dead_from_list(&node->data.program.declarations, query);
+        case NODE_BLOCK:
+            return remove_dead_from_list(&node->data.block.statements, query);
+        case NODE_FUNC_DEF:
+            return remove_dead_statements(node->data.func_def.body, query);
+        case NODE_MAIN_DEF:
+            return remove_dead_statements(node->data.main_def.body, query);
+        case NODE_IF:
+            return remove_dead_statements(node->data.if_stmt.if_body, query) +
+                   remove_dead_statements(node->data.if_stmt.else_body, query);
+        case NODE_FOR:
+            return remove_dead_statements(node->data.for_stmt.body, query);
+        case NODE_WHILE:
+            return remove_dead_statements(node->data.while_stmt.body, query);
+        default:
+            return 0;
+    }
+}
+
+// Remove variáveis locais não lidas de uma função (ou do main). Os parâmetros e
+// os nomes globais ficam de fora, de modo que toda referência a um candidato
+// dentro da região é a uma variável local.
+static int remove_unused_locals(ASTNode* region, ASTNodeList* params, UsageTable* globals, RewriteEngine* engine) {
+    UsageTable usage = {0};
+    UsageTable excluded = {0};
+    collect_usage(region, &usage, 0);
+    for (ASTNodeList* l = params; l; l = l->next) {
+        usage_lookup(&excluded, l->node->data.param.param_name, 1);
+    }
+    for (int i = 0; i < USAGE_TABLE_SIZE; i++) {
+        for (NameUsage* u = globals->buckets[i]; u; u = u->next) usage_lookup(&excluded, u->name, 1);
+    }
+    DeadNameQuery query = { &usage, &excluded, NULL, engine };
+    int removed = remove_dead_statements(region, &query);
+    usage_clear(&usage);
+    usage_clear(&excluded);
+    return removed;
+}
+
+// Remove variáveis globais que não são lidas em nenhum ponto do programa.
+static int remove_unused_globals(ASTNode* program, UsageTable* globals, RewriteEngine* engine) {
+    UsageTable usage = {0};
+    collect_usage(program, &usage, 0);
+    DeadNameQuery query = { &usage, NULL, globals, engine };
+    int removed = remove_dead_statements(program, &query);
+    usage_clear(&usage);
+    return removed;
+}
+
+// Remove as variáveis não lidas. As contagens de uso são da função inteira, então a remoção
+// é repetida enquanto remover algo (uma atribuição removida pode deixar outra variável sem
+// leituras), mas só nas funções alteradas na rodada anterior. O motor revisita apenas os
+// blocos de onde comandos foram removidos.
+static void remove_dead_variables(ASTNode* program, RewriteEngine* engine) {
+    int function_count = 0;
+    for (ASTNodeList* l = program->data.program.declarations; l; l = l->next) {
+        if (l->node->type == NODE_FUNC_DEF || l->node->type == NODE_MAIN_DEF) function_count++;
+    }
+    char* dirty = (char*)malloc(function_count > 0 ? function_count : 1);
+    if (!dirty) {
+        report_error("Erro de Memória: falha ao alocar a eliminação de código morto.\n");
+        fatal_error();
+    }
+    memset(dirty, 1, function_count);
+
+    int removed;
+    do {
+        UsageTable globals = {0};
+        int global_count = 0;
+        for (ASTNodeList* l = program->data.program.declarations; l; l = l->next) {
+            if (l->node->type == NODE_VAR_DECL) {
+                usage_lookup(&globals, l->node->data.var_decl.var_name, 1);
+                global_count++;
+            }
+        }
+
+        removed = 0;
+        int index = 0;
+        for (ASTNodeList* l = program->data.program.declarations; l; l = l->next) {
+            if (l->node->type != NODE_FUNC_DEF && l->node->type != NODE_MAIN_DEF) continue;
+            int is_function = l->node->type == NODE_FUNC_DEF;
+            ASTNode* body = is_function ? l->node->data.func_def.body : l->node->data.main_def.body;
+            ASTNodeList* params = is_function ? l->node->data.func_def.params : NULL;
+            int removed_here = dirty[index] ? remove_unused_locals(body, params, &globals, engine) : 0;
+            dirty[index++] = removed_here > 0;
+            removed += removed_here;
+        }
+        if (whole_program && global_count > 0) {
+            // Uma atribuição a uma global pode ser removida de qualquer função
+            int removed_globals = remove_unused_globals(program, &globals, engine);
+            if (removed_globals > 0) memset(dirty, 1, function_count);
+            removed += removed_globals;
+        }
+        usage_clear(&globals);
+        if (removed > 0) rewrite_engine_run(engine);
+    } while (removed > 0);
+    free(dirty);
+}
+
+// Dobramento, simplificação e poda até o ponto fixo, seguidos da remoção das variáveis
+// não lidas (apenas quando 'program' é o programa).
+static void eliminate_dead_code(ASTNode* program) {
+    RewriteEngine* engine = rewrite_engine_create(program, rewrite_rules, sizeof(rewrite_rules) / sizeof(rewrite_rules[0]));
+    rewrite_engine_run(engine);
+    if (program->type == NODE_PROGRAM) remove_dead_variables(program, engine);
+    rewrite_engine_free(engine);
+}
+
+// --- Expansão Inline de Funções ---
+
+#define INLINE_BUDGET 60 // Tamanho máximo (em nós da AST) do corpo de uma função expandida inline
+#define INLINE_HOT_BUDGET 240 // O mesmo, para as funções quentes no perfil de execução
+#define PROFILE_HOT_PERCENT 1 // Parcela mínima (%) das chamadas do perfil para uma função ser quente
+
+typedef struct FunctionEntry {
+    const char* name;
+    ASTNode* def;
+    int inlinable;
+    int inlined_calls;
+    struct FunctionEntry* next;
+} FunctionEntry;
+
+typedef struct {
+    FunctionEntry* buckets[USAGE_TABLE_SIZE];
+} FunctionTable;
+
+static FunctionEntry* function_lookup(FunctionTable* table, const char* name) {
+    for (FunctionEntry* f = table->buckets[usage_hash(name)]; f; f = f->next) {
+        if (strcmp(f->name, name) == 0) return f;
+    }
+    return NULL;
+}
+
+static FunctionEntry* function_add(FunctionTable* table, ASTNode* def) {
+    unsigned long index = usage_hash(def->data.func_def.func_name);
+    FunctionEntry* f = (FunctionEntry*)calloc(1, sizeof(FunctionEntry));
+    if (!f) {
+        report_error("Erro de Memória: falha ao alocar memória.\n");
+        fatal_error();
+    }
+    f->name = def->data.func_def.func_name;
+    f->def = def;
+    f->next = table->buckets[index];
+    table->buckets[index] = f;
+    return f;
+}
+
+static void function_table_clear(FunctionTable* table) {
+    for (int i = 0; i < USAGE_TABLE_SIZE; i++) {
+        FunctionEntry* f = table->buckets[i];
+        while (f) {
+            FunctionEntry* next = f->next;
+            free(f);
+            f = next;
+        }
+        table->buckets[i] = NULL;
+    }
+}
+
+static int ast_size(ASTNode* node) {
+    if (!node) return 0;
+    int size = 1;
+    switch (node->type) {
+        case NODE_BLOCK:
+            for (ASTNodeList* l = node->data.block.statements; l; l = l->next) size += ast_size(l->node);
+            break;
+        case NODE_VAR_DECL:
+            size += ast_size(node->data.var_decl.initial_value);
+            break;
+        case NODE_IF:
+            size += ast_size(node->data.if_stmt.condition) + ast_size(node->data.if_stmt.if_body) +
+                    ast_size(node->data.if_stmt.else_body);
+            break;
+        case NODE_FOR:
+            size += ast_size(node->data.for_stmt.init) + ast_size(node->data.for_stmt.condition) +
+                    ast_size(node->data.for_stmt.increment) + ast_size(node->data.for_stmt.body);
+            break;
+        case NODE_WHILE:
+            size += ast_size(node->data.while_stmt.condition) + ast_size(node->data.while_stmt.body);
+            break;
+        case NODE_RETURN:
+            size += ast_size(node->data.return_stmt.return_value);
+            break;
+        case NODE_ASSIGN:
+            size += ast_size(node->data.assign_expr.lvalue) + ast_size(node->data.assign_expr.rvalue);
+            break;
+        case NODE_BINARY_OP:
+            size += ast_size(node->data.binary_op.left) + ast_size(node->data.binary_op.right);
+            break;
+        case NODE_UNARY_OP:
+            size += ast_size(node->data.unary_op.operand);
+            break;
+        case NODE_FUNC_CALL:
+            for (ASTNodeList* l = node->data.func_call.args; l; l = l->next) size += ast_size(l->node);
+            break;
+        default:
+            break;
+    }
+    return size;
+}
+
+static int contains_return(ASTNode* node) {
+    if (!node) return 0;
+    switch (node->type) {
+        case NODE_RETURN:
+            return 1;
+        case NODE_BLOCK:
+            for (ASTNodeList* l = node->data.block.statements; l; l = l->next) {
+                if (contains_return(l->node)) return 1;
+            }
+            return 0;
+        case NODE_IF:
+            return contains_return(node->data.if_stmt.if_body) || contains_return(node->data.if_stmt.else_body);
+        case NODE_FOR:
+            return contains_return(node->data.for_stmt.body);
+        case NODE_WHILE:
+            return contains_return(node->data.while_stmt.body);
+        default:
+            return 0;
+    }
+}
+
+// Verifica se todo 'return' está em posição final: após ele, a execução sairia da função
+// de qualquer forma. Assim, ao expandir o corpo, basta trocar cada 'return' por uma atribuição.
+static int returns_only_in_tail(ASTNode* node, int is_tail) {
+    if (!node) return 1;
+    switch (node->type) {
+        case NODE_RETURN:
+            return is_tail;
+        case NODE_BLOCK:
+            for (ASTNodeList* l = node->data.block.statements; l; l = l->next) {
+                if (!returns_only_in_tail(l->node, is_tail && l->next == NULL)) return 0;
+            }
+            return 1;
+        case NODE_IF:
+            return returns_only_in_tail(node->data.if_stmt.if_body, is_tail) &&
+                   returns_only_in_tail(node->data.if_stmt.else_body, is_tail);
+        default:
+            return !contains_return(node);
+    }
+}
+
+// Percorre os nomes de funções chamadas na subárvore, indicando se 'target' é alcançável
+// a partir delas (diretamente ou por meio de outras funções do programa).
+static int calls_reach(ASTNode* node, const char* target, FunctionTable* functions, UsageTable* visited) {
+    if (!node) return 0;
+    switch (node->type) {
+        case NODE_FUNC_CALL: {
+            const char* name = node->data.func_call.func_name;
+            if (strcmp(name, target) == 0) return 1;
+            if (!usage_lookup(visited, name, 0)) {
+                usage_lookup(visited, name, 1);
+                FunctionEntry* callee = function_lookup(functions, name);
+                if (callee && calls_reach(callee->def->data.func_def.body, target, functions, visited)) return 1;
+            }
+            for (ASTNodeList* l = node->data.func_call.args; l; l = l->next) {
+                if (calls_reach(l->node, target, functions, visited)) return 1;
+            }
+            return 0;
+        }
+        case NODE_BLOCK:
+            for (ASTNodeList* l = node->data.block.statements; l; l = l->next) {
+                if (calls_reach(l->node, target, functions, visited)) return 1;
+            }
+            return 0;
+        case NODE_VAR_DECL:
+            return calls_reach(node->data.var_decl.initial_value, target, functions, visited);
+        case NODE_IF:
+            return calls_reach(node->data.if_stmt.condition, target, functions, visited) ||
+                   calls_reach(node->data.if_stmt.if_body, target, functions, visited) ||
+                   calls_reach(node->data.if_stmt.else_body, target, functions, visited);
+        case NODE_FOR:
+            return calls_reach(node->data.for_stmt.init, target, functions, visited) ||
+                   calls_reach(node->data.for_stmt.condition, target, functions, visited) ||
+                   calls_reach(node->data.for_stmt.increment, target, functions, visited) ||
+                   calls_reach(node->data.for_stmt.body, target, functions, visited);
+        case NODE_WHILE:
+            return calls_reach(node->data.while_stmt.condition, target, functions, visited) ||
+                   calls_reach(node->data.while_stmt.body, target, functions, visited);
+        case NODE_RETURN:
+            return calls_reach(node->data.return_stmt.return_value, target, functions, visited);
+        case NODE_ASSIGN:
+            return calls_reach(node->data.assign_expr.rvalue, target, functions, visited);
+        case NODE_BINARY_OP:
+            return calls_reach(node->data.binary_op.left, target, functions, visited) ||
+                   calls_reach(node->data.binary_op.right, target, functions, visited);
+        case NODE_UNARY_OP:
+            return calls_reach(node->data.unary_op.operand, target, functions, visited);
+        default:
+            return 0;
+    }
+}
+
+// Com um perfil, as funções nunca chamadas na execução medida não são expandidas (o
+// código delas não cresce à toa), e as que recebem uma parcela relevante das chamadas
+// podem ser maiores. Funções ausentes do perfil (já expandidas em toda parte quando ele
+// foi medido) mantêm o limite normal.
+static int inline_budget(ASTNode* def) {
+    long long calls;
+    if (!active_profile || !profile_function_calls(active_profile, def->data.func_def.func_name, &calls)) {
+        return INLINE_BUDGET;
+    }
+    if (calls == 0) return 0;
+    if (calls * 100 >= active_profile->total_calls * PROFILE_HOT_PERCENT) return INLINE_HOT_BUDGET;
+    return INLINE_BUDGET;
+}
+
+static int is_inlinable_function(ASTNode* def, FunctionTable* functions) {
+    ASTNode* body = def->data.func_def.body;
+    int size = ast_size(body);
+    int budget = inline_budget(def);
+    if (size > budget) {
+        if (budget == 0) {
+            report_info("Otimização: Função '%s' não é expandida inline (nunca chamada no perfil de execução).\n",
+                        def->data.func_def.func_name);
+        }
+        return 0;
+    }
+    if (!returns_only_in_tail(body, 1)) return 0;
+
+    UsageTable visited = {0};
+    int recursive = calls_reach(body, def->data.func_def.func_name, functions, &visited);
+    usage_clear(&visited);
+    if (!recursive && size > INLINE_BUDGET) {
+        report_info("Otimização: Função '%s' é quente no perfil de execução; limite de expansão inline ampliado.\n",
+                    def->data.func_def.func_name);
+    }
+    return !recursive;
+}
+
+// Ramo de um 'if' que o perfil mostra nunca ter sido executado. As chamadas dentro
+// dele não são expandidas inline e os laços não são desenrolados: o código frio fica
+// compacto, fora do caminho quente.
+static int is_cold_branch(ASTNode* if_stmt, int then_branch) {
+    long long taken, not_taken;
+    if (!active_profile || !profile_branch_counts(active_profile, if_stmt->pos, &taken, &not_taken)) return 0;
+    return (then_branch ? taken : not_taken) == 0;
+}
+
+// Nomes locais da função: parâmetros e todas as variáveis declaradas no corpo.
+static void collect_local_names(ASTNode* def, UsageTable* locals) {
+    for (ASTNodeList* l = def->data.func_def.params; l; l = l->next) {
+        usage_lookup(locals, l->node->data.param.param_name, 1)->decls++;
+    }
+    UsageTable usage = {0};
+    collect_usage(def->data.func_def.body, &usage, 0);
+    for (int i = 0; i < USAGE_TABLE_SIZE; i++) {
+        for (NameUsage* u = usage.buckets[i]; u; u = u->next) {
+            if (u->decls > 0) usage_lookup(locals, u->name, 1)->decls++;
+        }
+    }
+    usage_clear(&usage);
+}
+
+// A função expandida não pode ler ou escrever um nome global que o chamador declara
+// localmente, pois ele passaria a se referir à variável do chamador.
+static int free_names_conflict(ASTNode* callee, UsageTable* caller_locals) {
+    UsageTable callee_locals = {0};
+    UsageTable usage = {0};
+    collect_local_names(callee, &callee_locals);
+    collect_usage(callee->data.func_def.body, &usage, 0);
+
+    int conflict = 0;
+    for (int i = 0; i < USAGE_TABLE_SIZE && !conflict; i++) {
+        for (NameUsage* u = usage.buckets[i]; u && !conflict; u = u->next) {
+            if (!usage_lookup(&callee_locals, u->name, 0) && usage_lookup(caller_locals, u->name, 0)) conflict = 1;
+        }
+    }
+    usage_clear(&callee_locals);
+    usage_clear(&usage);
+    return conflict;
+}
+
+// Renomeia os nomes locais da cópia do corpo expandido e troca cada 'return' por uma
+// atribuição à variável de resultado. Sem variável de resultado (result_name NULL: o
+// valor da chamada não é usado), o valor devolvido só continua como comando se tiver
+// efeitos colaterais.
+static void rename_inlined_body(ASTNode* node, UsageTable* locals, const char* func_name, int id, const char* result_name) {
+    if (!node) return;
+    switch (node->type) {
+        case NODE_IDENTIFIER:
+            if (usage_lookup(locals, node->data.identifier_name, 0)) {
+                char buffer[256];
+                snprintf(buffer, sizeof(buffer), "__%s_%s_%d", func_name, node->data.identifier_name, id);
+                free(node->data.identifier_name);
+                node->data.identifier_name = strdup(buffer);
+            }
+            break;
+        case NODE_VAR_DECL:
+            if (usage_lookup(locals, node->data.var_decl.var_name, 0)) {
+                char buffer[256];
+                snprintf(buffer, sizeof(buffer), "__%s_%s_%d", func_name, node->data.var_decl.var_name, id);
+                free(node->data.var_decl.var_name);
+                node->data.var_decl.var_name = strdup(buffer);
+            }
+            rename_inlined_body(node->data.var_decl.initial_value, locals, func_name, id, result_name);
+            break;
+        case NODE_BLOCK:
+            for (ASTNodeList* l = node->data.block.statements; l; l = l->next) {
+                rename_inlined_body(l->node, locals, func_name, id, result_name);
+            }
+            break;
+        case NODE_IF:
+            rename_inlined_body(node->data.if_stmt.condition, locals, func_name, id, result_name);
+            rename_inlined_body(node->data.if_stmt.if_body, locals, func_name, id, result_name);
+            rename_inlined_body(node->data.if_stmt.else_body, locals, func_name, id, result_name);
+            break;
+        case NODE_FOR:
+            rename_inlined_body(node->data.for_stmt.init, locals, func_name, id, result_name);
+            rename_inlined_body(node->data.for_stmt.condition, locals, func_name, id, result_name);
+            rename_inlined_body(node->data.for_stmt.increment, locals, func_name, id, result_name);
+            rename_inlined_body(node->data.for_stmt.body, locals, func_name, id, result_name);
+            break;
+        case NODE_WHILE:
+            rename_inlined_body(node->data.while_stmt.condition, locals, func_name, id, result_name);
+            rename_inlined_body(node->data.while_stmt.body, locals, func_name, id, result_name);
+            break;
+        case NODE_RETURN: {
+            ASTNode* value = node->data.return_stmt.return_value;
+            rename_inlined_body(value, locals, func_name, id, result_name);
+            if (value && !result_name) {
+                node->type = NODE_BLOCK;
+                node->data.block.statements = NULL;
+                if (has_side_effects(value)) node->data.block.statements = create_node_list(value);
+                else free_ast(value);
+            } else if (value) {
+                ASTNode* target = create_node(NODE_IDENTIFIER, node->pos);
+                target->data.identifier_name = strdup(result_name);
+                target->value_type = TYPE_UNKNOWN;
+                node->type = NODE_ASSIGN;
+                node->value_type = TYPE_UNKNOWN;
+                node->data.assign_expr.lvalue = target;
+                node->data.assign_expr.rvalue = value;
+            } else {
+                node->type = NODE_BLOCK;
+                node->data.block.statements = NULL;
+            }
+            break;
+        }
+        case NODE_ASSIGN:
+            rename_inlined_body(node->data.assign_expr.lvalue, locals, func_name, id, result_name);
+            rename_inlined_body(node->data.assign_expr.rvalue, locals, func_name, id, result_name);
+            break;
+        case NODE_BINARY_OP:
+            rename_inlined_body(node->data.binary_op.left, locals, func_name, id, result_name);
+            rename_inlined_body(node->data.binary_op.right, locals, func_name, id, result_name);
+            break;
+        case NODE_UNARY_OP:
+            rename_inlined_body(node->data.unary_op.operand, locals, func_name, id, result_name);
+            break;
+        case NODE_FUNC_CALL:
+            for (ASTNodeList* l = node->data.func_call.args; l; l = l->next) {
+                rename_inlined_body(l->node, locals, func_name, id, result_name);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+// Expressão avaliada pelo comando (NULL se o comando não tiver uma).
+static ASTNode* statement_expression(ASTNode* stmt) {
+    switch (stmt->type) {
+        case NODE_VAR_DECL: return stmt->data.var_decl.initial_value;
+        case NODE_RETURN: return stmt->data.return_stmt.return_value;
+        case NODE_IF: return stmt->data.if_stmt.condition;
+        case NODE_BLOCK:
+        case NODE_FOR:
+        case NODE_WHILE:
+            return NULL;
+        default: return stmt;
+    }
+}
+
+// Procura a chamada expansível avaliada antes de qualquer outra coisa no comando. Só ela
+// pode ser movida para antes do comando sem alterar a ordem de avaliação.
+static ASTNode* find_inline_candidate(ASTNode* expr, FunctionTable* functions) {
+    while (expr) {
+        switch (expr->type) {
+            case NODE_FUNC_CALL: {
+                FunctionEntry* callee = function_lookup(functions, expr->data.func_call.func_name);
+                if (callee && callee->inlinable) return expr;
+                expr = expr->data.func_call.args ? expr->data.func_call.args->node : NULL;
+                break;
+            }
+            case NODE_BINARY_OP:
+                expr = expr->data.binary_op.left;
+                break;
+            case NODE_UNARY_OP:
+                expr = expr->data.unary_op.operand;
+                break;
+            case NODE_ASSIGN:
+                expr = expr->data.assign_expr.rvalue;
+                break;
+            default:
+                return NULL;
+        }
+    }
+    return NULL;
+}
+
+static ASTNode* new_var_decl(const char* type_name, const char* var_name, ASTNode* initial_value, Position pos) {
+    ASTNode* decl = create_node(NODE_VAR_DECL, pos);
+    decl->data.var_decl.type_name = strdup(type_name);
+    decl->data.var_decl.var_name = strdup(var_name);
+    decl->data.var_decl.initial_value = initial_value;
+    return decl;
+}
+
+// Insere 'node' em uma nova célula antes de 'cell', onde '*link' aponta para 'cell'.
+// Retorna o novo elo que aponta para 'cell'.
+static ASTNodeList** insert_before(ASTNodeList** link, ASTNode* node) {
+    ASTNodeList* cell = create_node_list(node);
+    cell->next = *link;
+    *link = cell;
+    return &cell->next;
+}
+
+// Tipo declarado da variável de resultado: float se todo 'return' com valor devolve um
+// float, int nos demais casos.
+static const char* inlined_result_type(ASTNode* def) {
+    int floats = 0, others = 0;
+    ASTStack stack = {0};
+    ast_stack_push(&stack, def->data.func_def.body);
+    while (stack.count > 0) {
+        ASTNode* node = stack.items[--stack.count];
+        if (node->type == NODE_RETURN && node->data.return_stmt.return_value) {
+            if (node->data.return_stmt.return_value->value_type == TYPE_FLOAT) floats++;
+            else others++;
+            continue;
+        }
+        ASTLayout layout = ast_layout(node);
+        for (int i = 0; i < layout.child_count; i++) {
+            if (*layout.child[i]) ast_stack_push(&stack, *layout.child[i]);
+        }
+        if (layout.list) {
+            for (ASTNodeList* l = *layout.list; l; l = l->next) ast_stack_push(&stack, l->node);
+        }
+    }
+    ast_stack_free(&stack);
+    return floats > 0 && others == 0 ? "float" : "int";
+}
+
+// Expande a chamada 'call' antes do comando apontado por '*link'. A chamada é
+// substituída in-place por um identificador com o resultado. Como a chamada, cujo tipo
+// a análise semântica não conhece (as funções não declaram o tipo de retorno), o
+// identificador fica com o tipo TYPE_UNKNOWN: nem as regras de inteiros nem o 'print'
+// com %d podem supor que ele é um int. Se a chamada é o próprio comando ('bare'), não
+// há variável de resultado e o comando é removido; o elo devolvido aponta para o
+// comando seguinte.
+static ASTNodeList** inline_call(ASTNodeList** link, ASTNode* call, FunctionEntry* callee, int bare) {
+    ASTNode* def = callee->def;
+    const char* func_name = def->data.func_def.func_name;
+    int id = ++inline_counter;
+    char result_name[256];
+    snprintf(result_name, sizeof(result_name), "__%s_ret_%d", func_name, id);
+
+    report_info("Otimização: Chamada a '%s' na linha %d foi expandida inline.\n", func_name, call->pos.line);
+
+    UsageTable locals = {0};
+    collect_local_names(def, &locals);
+
+    // Bloco com os parâmetros (inicializados com os argumentos) seguido do corpo copiado
+    ASTNode* block = create_node(NODE_BLOCK, call->pos);
+    ASTNodeList** tail = &block->data.block.statements;
+    ASTNodeList* args = call->data.func_call.args;
+    for (ASTNodeList* p = def->data.func_def.params; p; p = p->next) {
+        char param_name[256];
+        snprintf(param_name, sizeof(param_name), "__%s_%s_%d", func_name, p->node->data.param.param_name, id);
+        ASTNode* arg = NULL;
+        if (args) {
+            arg = args->node;
+            args->node = NULL;
+            args = args->next;
+        }
+        *tail = create_node_list(new_var_decl(p->node->data.param.type_name, param_name, arg, call->pos));
+        tail = &(*tail)->next;
+    }
+    ASTNode* body = clone_ast(def->data.func_def.body);
+    rename_inlined_body(body, &locals, func_name, id, bare ? NULL : result_name);
+    *tail = create_node_list(body);
+    usage_clear(&locals);
+
+    callee->inlined_calls++;
+    if (bare) {
+        link = insert_before(link, block);
+        ASTNodeList* cell = *link;
+        *link = cell->next;
+        free_ast(call);
+        free(cell);
+        return link;
+    }
+    link = insert_before(link, new_var_decl(inlined_result_type(def), result_name, NULL, call->pos));
+    link = insert_before(link, block);
+
+    // A chamada vira uma leitura da variável de resultado
+    for (ASTNodeList* l = call->data.func_call.args; l;) {
+        ASTNodeList* next = l->next;
+        free_ast(l->node);
+        free(l);
+        l = next;
+    }
+    free(call->data.func_call.func_name);
+    call->type = NODE_IDENTIFIER;
+    call->value_type = TYPE_UNKNOWN;
+    call->data.identifier_name = strdup(result_name);
+    return link;
+}
+
+// Garante que o corpo de um comando seja um bloco, para que comandos possam ser inseridos nele.
+static void ensure_block(ASTNode** slot) {
+    if (!*slot || (*slot)->type == NODE_BLOCK) return;
+    ASTNode* block = create_node(NODE_BLOCK, (*slot)->pos);
+    block->data.block.statements = create_node_list(*slot);
+    *slot = block;
+}
+
+static void inline_in_statement_list(ASTNodeList** link, FunctionTable* functions, UsageTable* caller_locals);
+
+static void inline_in_statement(ASTNode* stmt, FunctionTable* functions, UsageTable* caller_locals) {
+    switch (stmt->type) {
+        case NODE_BLOCK:
+            inline_in_statement_list(&stmt->data.block.statements, functions, caller_locals);
+            break;
+        case NODE_IF:
+            ensure_block(&stmt->data.if_stmt.if_body);
+            ensure_block(&stmt->data.if_stmt.else_body);
+            if (!is_cold_branch(stmt, 1)) inline_in_statement(stmt->data.if_stmt.if_body, functions, caller_locals);
+            if (stmt->data.if_stmt.else_body && !is_cold_branch(stmt, 0)) {
+                inline_in_statement(stmt->data.if_stmt.else_body, functions, caller_locals);
+            }
+            break;
+        case NODE_FOR:
+            ensure_block(&stmt->data.for_stmt.body);
+            inline_in_statement(stmt->data.for_stmt.body, functions, caller_locals);
+            break;
+        case NODE_WHILE:
+            ensure_block(&stmt->data.while_stmt.body);
+            inline_in_statement(stmt->data.while_stmt.body, functions, caller_locals);
+            break;
+        default:
+            break;
+    }
+}
+
+static void inline_in_statement_list(ASTNodeList** link, FunctionTable* functions, UsageTable* caller_locals) {
+    while (*link) {
+        ASTNode* stmt = (*link)->node;
+        inline_in_statement(stmt, functions, caller_locals);
+
+        ASTNode* call;
+        int removed = 0;
+        while (!removed && (call = find_inline_candidate(statement_expression(stmt), functions)) != NULL) {
+            FunctionEntry* callee = function_lookup(functions, call->data.func_call.func_name);
+            if (free_names_conflict(callee->def, caller_locals)) break;
+            removed = call == stmt; // Chamada como comando: o resultado não é usado
+            link = inline_call(link, call, callee, removed);
+        }
+        if (!removed) link = &(*link)->next;
+    }
+}
+
+static void inline_in_function(ASTNode* body, ASTNodeList* params, FunctionTable* functions) {
+    UsageTable caller_locals = {0};
+    UsageTable usage = {0};
+    for (ASTNodeList* l = params; l; l = l->next) usage_lookup(&caller_locals, l->node->data.param.param_name, 1);
+    collect_usage(body, &usage, 0);
+    for (int i = 0; i < USAGE_TABLE_SIZE; i++) {
+        for (NameUsage* u = usage.buckets[i]; u; u = u->next) {
+            if (u->decls > 0) usage_lookup(&caller_locals, u->name, 1);
+        }
+    }
+    usage_clear(&usage);
+
+    inline_in_statement(body, functions, &caller_locals);
+    usage_clear(&caller_locals);
+}
+
+static int count_calls_to(ASTNode* node, const char* name) {
+    if (!node) return 0;
+    int count = 0;
+    switch (node->type) {
+        case NODE_PROGRAM:
+            for (ASTNodeList* l = node->data.program.declarations; l; l = l->next) count += count_calls_to(l->node, name);
+            break;
+        case NODE_FUNC_DEF:
+            count += count_calls_to(node->data.func_def.body, name);
+            break;
+        case NODE_MAIN_DEF:
+            count += count_calls_to(node->data.main_def.body, name);
+            break;
+        case NODE_FUNC_CALL:
+            if (strcmp(node->data.func_call.func_name, name) == 0) count++;
+            for (ASTNodeList* l = node->data.func_call.args; l; l = l->next) count += count_calls_to(l->node, name);
+            break;
+        case NODE_BLOCK:
+            for (ASTNodeList* l = node->data.block.statements; l; l = l->next) count += count_calls_to(l->node, name);
+            break;
+        case NODE_VAR_DECL:
+            count += count_calls_to(node->data.var_decl.initial_value, name);
+            break;
+        case NODE_IF:
+            count += count_calls_to(node->data.if_stmt.condition, name) + count_calls_to(node->data.if_stmt.if_body, name) +
+                     count_calls_to(node->data.if_stmt.else_body, name);
+            break;
+        case NODE_FOR:
+            count += count_calls_to(node->data.for_stmt.init, name) + count_calls_to(node->data.for_stmt.condition, name) +
+                     count_calls_to(node->data.for_stmt.increment, name) + count_calls_to(node->data.for_stmt.body, name);
+            break;
+        case NODE_WHILE:
+            count += count_calls_to(node->data.while_stmt.condition, name) + count_calls_to(node->data.while_stmt.body, name);
+            break;
+        case NODE_RETURN:
+            count += count_calls_to(node->data.return_stmt.return_value, name);
+            break;
+        case NODE_ASSIGN:
+            count += count_calls_to(node->data.assign_expr.rvalue, name);
+            break;
+        case NODE_BINARY_OP:
+            count += count_calls_to(node->data.binary_op.left, name) + count_calls_to(node->data.binary_op.right, name);
+            break;
+        case NODE_UNARY_OP:
+            count += count_calls_to(node->data.unary_op.operand, name);
+            break;
+        default:
+            break;
+    }
+    return count;
+}
+
+// Expande inline as chamadas a funções pequenas e não recursivas. As funções são
+// processadas na ordem de declaração; como uma função só pode chamar as declaradas
+// antes dela, cada chamada já encontra o corpo final da função chamada.
+static void inline_functions(ASTNode* program) {
+    if (program->type != NODE_PROGRAM) return;
+
+    FunctionTable functions = {0};
+    for (ASTNodeList* l = program->data.program.declarations; l; l = l->next) {
+        ASTNode* decl = l->node;
+        if (decl->type == NODE_FUNC_DEF) {
+            inline_in_function(decl->data.func_def.body, decl->data.func_def.params, &functions);
+            FunctionEntry* entry = function_add(&functions, decl);
+            entry->inlinable = is_inlinable_function(decl, &functions);
+        } else if (decl->type == NODE_MAIN_DEF) {
+            inline_in_function(decl->data.main_def.body, NULL, &functions);
+        }
+    }
+
+    // Funções cujas chamadas foram todas expandidas deixam de ser necessárias (só é
+    // possível saber quando o programa inteiro está presente)
+    ASTNodeList** link = &program->data.program.declarations;
+    while (whole_program && *link) {
+        ASTNode* decl = (*link)->node;
+        if (decl->type == NODE_FUNC_DEF) {
+            FunctionEntry* entry = function_lookup(&functions, decl->data.func_def.func_name);
+            if (entry && entry->inlined_calls > 0 && count_calls_to(program, entry->name) == 0) {
+                report_info("Otimização: Função '%s' foi removida (todas as chamadas foram expandidas inline).\n", entry->name);
+                ASTNodeList* cell = *link;
+                *link = cell->next;
+                entry->def = NULL;
+                entry->name = "";
+                free_ast(decl);
+                free(cell);
+                continue;
+            }
+        }
+        link = &(*link)->next;
+    }
+    function_table_clear(&functions);
+}
+
+// --- Eliminação de Subexpressões Comuns (Numeração de Valores) ---
+//
+// Percorre cada bloco em ordem, mantendo uma tabela de expressões disponíveis:
+// expressões puras já avaliadas cujos operandos não foram modificados desde então.
+// Quando uma expressão se repete, a primeira ocorrência é movida para uma variável
+// temporária declarada logo antes do comando em que ela aparece, e todas as
+// ocorrências passam a ler a temporária. As expressões disponíveis antes de um
+// 'if' (inclusive as da condição) continuam disponíveis dentro dos seus ramos.
+
+#define CSE_MAX_ENTRIES 256 // Limite de expressões disponíveis rastreadas ao mesmo tempo
+
+typedef struct CSEEntry {
+    ASTNode* expr;           // Representante da expressão (primeira ocorrência ou inicialização da temporária)
+    unsigned long hash;
+    int generation;          // Valor de cse_generation quando o hash foi calculado
+    char* temp_name;         // NULL enquanto a expressão só apareceu uma vez
+    ASTNodeList** head;      // Lista de comandos onde está o comando da primeira ocorrência
+    ASTNode* stmt;           // Comando da primeira ocorrência
+    struct CSEEntry* next_allocated;
+} CSEEntry;
+
+typedef struct {
+    CSEEntry* items[CSE_MAX_ENTRIES];
+    int count;
+} CSETable;
+
+static CSEEntry* cse_allocated = NULL;
+static int cse_generation = 0; // Incrementado quando uma temporária altera representantes já registrados
+
+// Hash de um nó a partir dos hashes já calculados dos seus operandos
+static unsigned long combine_expression_hash(ASTNode* node, unsigned long left, unsigned long right) {
+    unsigned long hash = (unsigned long)node->type * 31u;
+    switch (node->type) {
+        case NODE_IDENTIFIER:
+            hash += usage_hash(node->data.identifier_name);
+            break;
+        case NODE_INT_LITERAL:
+            hash += (unsigned long)node->data.int_literal;
+            break;
+        case NODE_BINARY_OP:
+            hash = hash * 131u + usage_hash(node->data.binary_op.op);
+            hash = hash * 131u + left;
+            hash = hash * 131u + right;
+            break;
+        case NODE_UNARY_OP:
+            hash = hash * 131u + usage_hash(node->data.unary_op.op);
+            hash = hash * 131u + left;
+            break;
+        default:
+            break;
+    }
+    return hash;
+}
+
+static unsigned long expression_hash(ASTNode* node) {
+    if (!node) return 0;
+    switch (node->type) {
+        case NODE_BINARY_OP:
+            return combine_expression_hash(node, expression_hash(node->data.binary_op.left),
+                                           expression_hash(node->data.binary_op.right));
+        case NODE_UNARY_OP:
+            return combine_expression_hash(node, expression_hash(node->data.unary_op.operand), 0);
+        default:
+            return combine_expression_hash(node, 0, 0);
+    }
+}
+
+// Chamadas a 'print' não modificam variáveis; qualquer outra chamada pode modificar globais.
+static int has_user_calls(ASTNode* node) {
+    if (!node) return 0;
+    switch (node->type) {
+        case NODE_FUNC_CALL:
+            if (strcmp(node->data.func_call.func_name, "print") != 0) return 1;
+            for (ASTNodeList* l = node->data.func_call.args; l; l = l->next) {
+                if (has_user_calls(l->node)) return 1;
+            }
+            return 0;
+        case NODE_BLOCK:
+            for (ASTNodeList* l = node->data.block.statements; l; l = l->next) {
+                if (has_user_calls(l->node)) return 1;
+            }
+            return 0;
+        case NODE_VAR_DECL:
+            return has_user_calls(node->data.var_decl.initial_value);
+        case NODE_IF:
+            return has_user_calls(node->data.if_stmt.condition) || has_user_calls(node->data.if_stmt.if_body) ||
+                   has_user_calls(node->data.if_stmt.else_body);
+        case NODE_FOR:
+            return has_user_calls(node->data.for_stmt.init) || has_user_calls(node->data.for_stmt.condition) ||
+                   has_user_calls(node->data.for_stmt.increment) || has_user_calls(node->data.for_stmt.body);
+        case NODE_WHILE:
+            return has_user_calls(node->data.while_stmt.condition) || has_user_calls(node->data.while_stmt.body);
+        case NODE_RETURN:
+            return has_user_calls(node->data.return_stmt.return_value);
+        case NODE_ASSIGN:
+            return has_user_calls(node->data.assign_expr.rvalue);
+        case NODE_BINARY_OP:
+            return has_user_calls(node->data.binary_op.left) || has_user_calls(node->data.binary_op.right);
+        case NODE_UNARY_OP:
+            return has_user_calls(node->data.unary_op.operand);
+        default:
+            return 0;
+    }
+}
+
+// Expressão sem chamadas de função (nem 'print') e sem atribuições.
+static int is_pure_expression(ASTNode* node) {
+    if (!node) return 1;
+    switch (node->type) {
+        case NODE_FUNC_CALL:
+        case NODE_ASSIGN:
+            return 0;
+        case NODE_BINARY_OP:
+            return is_pure_expression(node->data.binary_op.left) && is_pure_expression(node->data.binary_op.right);
+        case NODE_UNARY_OP:
+            return is_pure_expression(node->data.unary_op.operand);
+        default:
+            return 1;
+    }
+}
+
+static int references_name(ASTNode* node, const char* name) {
+    if (!node) return 0;
+    switch (node->type) {
+        case NODE_IDENTIFIER:
+            return strcmp(node->data.identifier_name, name) == 0;
+        case NODE_BINARY_OP:
+            return references_name(node->data.binary_op.left, name) || references_name(node->data.binary_op.right, name);
+        case NODE_UNARY_OP:
+            return references_name(node->data.unary_op.operand, name);
+        default:
+            return 0;
+    }
+}
+
+static void cse_kill_name(CSETable* table, const char* name) {
+    int kept = 0;
+    for (int i = 0; i < table->count; i++) {
+        if (!references_name(table->items[i]->expr, name)) table->items[kept++] = table->items[i];
+    }
+    table->count = kept;
+}
+
+// Remove da tabela as expressões que leem variáveis escritas pelo comando.
+static void cse_kill_writes(CSETable* table, ASTNode* node) {
+    if (!node || table->count == 0) return;
+    switch (node->type) {
+        case NODE_VAR_DECL:
+            cse_kill_name(table, node->data.var_decl.var_name);
+            cse_kill_writes(table, node->data.var_decl.initial_value);
+            break;
+        case NODE_ASSIGN:
+            cse_kill_name(table, node->data.assign_expr.lvalue->data.identifier_name);
+            cse_kill_writes(table, node->data.assign_expr.rvalue);
+            break;
+        case NODE_BLOCK:
+            for (ASTNodeList* l = node->data.block.statements; l; l = l->next) cse_kill_writes(table, l->node);
+            break;
+        case NODE_IF:
+            cse_kill_writes(table, node->data.if_stmt.condition);
+            cse_kill_writes(table, node->data.if_stmt.if_body);
+            cse_kill_writes(table, node->data.if_stmt.else_body);
+            break;
+        case NODE_FOR:
+            cse_kill_writes(table, node->data.for_stmt.init);
+            cse_kill_writes(table, node->data.for_stmt.condition);
+            cse_kill_writes(table, node->data.for_stmt.increment);
+            cse_kill_writes(table, node->data.for_stmt.body);
+            break;
+        case NODE_WHILE:
+            cse_kill_writes(table, node->data.while_stmt.condition);
+            cse_kill_writes(table, node->data.while_stmt.body);
+            break;
+        case NODE_RETURN:
+            cse_kill_writes(table, node->data.return_stmt.return_value);
+            break;
+        case NODE_BINARY_OP:
+            cse_kill_writes(table, node->data.binary_op.left);
+            cse_kill_writes(table, node->data.binary_op.right);
+            break;
+        case NODE_UNARY_OP:
+            cse_kill_writes(table, node->data.unary_op.operand);
+            break;
+        case NODE_FUNC_CALL:
+            for (ASTNodeList* l = node->data.func_call.args; l; l = l->next) cse_kill_writes(table, l->node);
+            break;
+        default:
+            break;
+    }
+}
+
+static void cse_record(CSETable* table, ASTNode* expr, unsigned long hash, ASTNodeList** head, ASTNode* stmt) {
+    if (table->count == CSE_MAX_ENTRIES) {
+        // Descarta a expressão mais antiga
+        memmove(table->items, table->items + 1, (CSE_MAX_ENTRIES - 1) * sizeof(CSEEntry*));
+        table->count--;
+    }
+    CSEEntry* entry = (CSEEntry*)calloc(1, sizeof(CSEEntry));
+    if (!entry) {
+        report_error("Erro de Memória: falha ao alocar memória.\n");
+        fatal_error();
+    }
+    entry->expr = expr;
+    entry->hash = hash;
+    entry->generation = cse_generation;
+    entry->head = head;
+    entry->stmt = stmt;
+    entry->next_allocated = cse_allocated;
+    cse_allocated = entry;
+    table->items[table->count++] = entry;
+}
+
+// Tipo da leitura de uma temporária que guarda 'value': uma expressão anotada como int
+// que pode valer um float (ela lê o resultado de uma chamada) fica com TYPE_UNKNOWN.
+static DataType temp_value_type(ASTNode* value) {
+    return value->value_type == TYPE_INT && !ast_is_integer(value) ? TYPE_UNKNOWN : value->value_type;
+}
+
+// Move a primeira ocorrência para uma temporária declarada antes do seu comando.
+static void cse_create_temp(CSEEntry* entry) {
+    char name[64];
+    snprintf(name, sizeof(name), "__cse_%d", ++cse_counter);
+    entry->temp_name = strdup(name);
+
+    ASTNode* first = entry->expr;
+    ASTNode* moved = create_node(first->type, first->pos);
+    *moved = *first;
+    first->type = NODE_IDENTIFIER;
+    first->value_type = temp_value_type(moved);
+    first->data.identifier_name = strdup(name);
+    entry->expr = moved;
+    cse_generation++; // A primeira ocorrência pode estar dentro de outros representantes
+
+    report_info("Otimização: Subexpressão comum na linha %d foi armazenada em '%s'.\n", first->pos.line, name);
+
+    ASTNodeList** link = entry->head;
+    while (*link && (*link)->node != entry->stmt) link = &(*link)->next;
+    insert_before(link, new_var_decl(datatype_to_string(moved->value_type), name, moved, first->pos));
+}
+
+static unsigned long cse_lookup(ASTNode* node, unsigned long hash, CSETable* table, ASTNodeList** head,
+                                ASTNode* stmt, int may_record);
+
+// Processa a expressão em pós-ordem e devolve o hash dela já processada. Se
+// 'may_record' for falso (operando direito de '&&' e '||', que pode não ser avaliado),
+// apenas reaproveita expressões já disponíveis. O hash de cada nó é combinado a partir
+// dos hashes dos operandos: recalculá-lo a cada nível tornaria quadrática uma cadeia
+// 'a + a + ... + a'.
+static unsigned long cse_expression(ASTNode* node, CSETable* table, ASTNodeList** head, ASTNode* stmt,
+                                    int may_record) {
+    if (!node) return 0;
+    switch (node->type) {
+        case NODE_BINARY_OP: {
+            const char* op = node->data.binary_op.op;
+            int conditional_right = strcmp(op, "&&") == 0 || strcmp(op, "||") == 0;
+            unsigned long left = cse_expression(node->data.binary_op.left, table, head, stmt, may_record);
+            int generation = cse_generation;
+            unsigned long right = cse_expression(node->data.binary_op.right, table, head, stmt,
+                                                 may_record && !conditional_right);
+            // Uma temporária criada no operando direito pode ter substituído a primeira
+            // ocorrência de uma expressão dentro do operando esquerdo
+            if (cse_generation != generation) left = expression_hash(node->data.binary_op.left);
+            unsigned long hash = combine_expression_hash(node, left, right);
+            if (node->value_type != TYPE_INT && node->value_type != TYPE_FLOAT) return hash;
+            return cse_lookup(node, hash, table, head, stmt, may_record);
+        }
+        case NODE_UNARY_OP: {
+            unsigned long operand = cse_expression(node->data.unary_op.operand, table, head, stmt, may_record);
+            return combine_expression_hash(node, operand, 0);
+        }
+        case NODE_ASSIGN:
+            cse_expression(node->data.assign_expr.rvalue, table, head, stmt, may_record);
+            break;
+        case NODE_FUNC_CALL:
+            for (ASTNodeList* l = node->data.func_call.args; l; l = l->next) {
+                cse_expression(l->node, table, head, stmt, may_record);
+            }
+            break;
+        default:
+            break;
+    }
+    return combine_expression_hash(node, 0, 0);
+}
+
+// Reaproveita uma expressão disponível igual a 'node' (que passa a ler a temporária)
+// ou a registra como disponível; devolve o hash de 'node' após a substituição.
+static unsigned long cse_lookup(ASTNode* node, unsigned long hash, CSETable* table, ASTNodeList** head,
+                                ASTNode* stmt, int may_record) {
+    for (int i = table->count - 1; i >= 0; i--) {
+        CSEEntry* entry = table->items[i];
+        if (entry->generation != cse_generation) {
+            entry->hash = expression_hash(entry->expr);
+            entry->generation = cse_generation;
+        }
+        if (entry->hash != hash || !ast_equal(entry->expr, node)) continue;
+        if (!entry->temp_name) cse_create_temp(entry);
+        release_node_contents(node);
+        node->type = NODE_IDENTIFIER;
+        node->value_type = temp_value_type(entry->expr);
+        node->data.identifier_name = strdup(entry->temp_name);
+        return combine_expression_hash(node, 0, 0);
+    }
+    if (may_record) cse_record(table, node, hash, head, stmt);
+    return hash;
+}
+
+static void cse_block(ASTNode* block, CSETable* table);
+
+// Processa um ramo com uma cópia da tabela (ou com a tabela vazia, se 'table' for
+// NULL): o que é calculado dentro dele não fica disponível depois do comando que o
+// contém. A cópia fica no heap, já que cada nível de aninhamento teria a sua.
+static void cse_nested(ASTNode* node, CSETable* table) {
+    if (!node) return;
+    CSETable* copy = (CSETable*)malloc(sizeof(CSETable));
+    if (!copy) {
+        report_error("Erro de Memória: falha ao alocar memória.\n");
+        fatal_error();
+    }
+    if (table) *copy = *table;
+    else copy->count = 0;
+    cse_block(node, copy);
+    free(copy);
+}
+
+static void cse_block(ASTNode* block, CSETable* table) {
+    ASTNodeList** head = &block->data.block.statements;
+    for (ASTNodeList* cell = *head; cell; cell = cell->next) {
+        ASTNode* stmt = cell->node;
+
+        switch (stmt->type) {
+            case NODE_BLOCK:
+                cse_nested(stmt, table);
+                break;
+            case NODE_IF:
+                if (is_pure_expression(stmt->data.if_stmt.condition)) {
+                    cse_expression(stmt->data.if_stmt.condition, table, head, stmt, 1);
+                }
+                ensure_block(&stmt->data.if_stmt.if_body);
+                ensure_block(&stmt->data.if_stmt.else_body);
+                cse_nested(stmt->data.if_stmt.if_body, table);
+                cse_nested(stmt->data.if_stmt.else_body, table);
+                break;
+            case NODE_FOR:
+                // Laços são uma barreira: o corpo começa com a tabela vazia
+                ensure_block(&stmt->data.for_stmt.body);
+                cse_nested(stmt->data.for_stmt.body, NULL);
+                break;
+            case NODE_WHILE:
+                ensure_block(&stmt->data.while_stmt.body);
+                cse_nested(stmt->data.while_stmt.body, NULL);
+                break;
+            case NODE_VAR_DECL:
+                if (is_pure_expression(stmt->data.var_decl.initial_value)) {
+                    cse_expression(stmt->data.var_decl.initial_value, table, head, stmt, 1);
+                }
+                break;
+            case NODE_RETURN:
+                if (is_pure_expression(stmt->data.return_stmt.return_value)) {
+                    cse_expression(stmt->data.return_stmt.return_value, table, head, stmt, 1);
+                }
+                break;
+            case NODE_ASSIGN:
+                if (is_pure_expression(stmt->data.assign_expr.rvalue)) {
+                    cse_expression(stmt->data.assign_expr.rvalue, table, head, stmt, 1);
+                }
+                break;
+            case NODE_FUNC_CALL:
+                // 'print(a * b)': os argumentos são puros e a chamada não escreve variáveis
+                if (!has_user_calls(stmt)) {
+                    int pure_args = 1;
+                    for (ASTNodeList* l = stmt->data.func_call.args; l; l = l->next) {
+                        if (!is_pure_expression(l->node)) pure_args = 0;
+                    }
+                    if (pure_args) cse_expression(stmt, table, head, stmt, 1);
+                }
+                break;
+            default:
+                break;
+        }
+
+        if (has_user_calls(stmt)) {
+            table->count = 0;
+        } else {
+            cse_kill_writes(table, stmt);
+        }
+    }
+}
+
+static void eliminate_common_subexpressions(ASTNode* program) {
+    if (program->type != NODE_PROGRAM) return;
+    for (ASTNodeList* l = program->data.program.declarations; l; l = l->next) {
+        ASTNode* body = NULL;
+        if (l->node->type == NODE_FUNC_DEF) body = l->node->data.func_def.body;
+        else if (l->node->type == NODE_MAIN_DEF) body = l->node->data.main_def.body;
+        if (!body) continue;
+
+        CSETable table = {0};
+        cse_block(body, &table);
+    }
+
+    while (cse_allocated) {
+        CSEEntry* next = cse_allocated->next_allocated;
+        free(cse_allocated->temp_name);
+        free(cse_allocated);
+        cse_allocated = next;
+    }
+}
+
+// --- Movimentação de Código Invariante de Laço ---
+//
+// Uma expressão dentro de um laço é invariante quando nenhum dos nomes que ela lê é
+// escrito em parte alguma do laço. Ela é então calculada uma única vez, em uma
+// temporária declarada logo antes do laço. Só são movidas expressões puras, sem
+// divisões por algo que não seja uma constante não nula, e que o laço avalia em toda
+// iteração: uma expressão que o programa original nunca avaliaria (um ramo nunca
+// tomado, ou um laço que não executa nenhuma vez) poderia falhar, por exemplo com
+// uma variável ainda None. Por isso as temporárias ficam dentro de um teste de
+// entrada, 'if (cond) { temporárias; laço }', a menos que o laço certamente execute;
+// no 'for', o teste é a condição com o valor inicial no lugar da variável do 'init',
+// e o 'else' executa o 'init'.
+// Laços com chamadas a funções do usuário são ignorados, pois a chamada pode escrever
+// variáveis globais.
+
+#define LICM_MAX_HOISTED 64 // Limite de temporárias por laço
+
+typedef struct {
+    UsageTable* usage;      // Uso dos nomes dentro do laço (campo 'writes')
+    ASTNodeList** link;     // Elo que aponta para a célula do laço na lista de comandos
+    ASTNode* hoisted[LICM_MAX_HOISTED];
+    char* names[LICM_MAX_HOISTED];
+    int count;
+} LICMContext;
+
+static int is_loop_invariant(ASTNode* node, UsageTable* usage) {
+    if (!node) return 0;
+    switch (node->type) {
+        case NODE_IDENTIFIER: {
+            NameUsage* u = usage_lookup(usage, node->data.identifier_name, 0);
+            return !u || u->writes == 0;
+        }
+        case NODE_INT_LITERAL:
+        case NODE_FLOAT_LITERAL:
+            return 1;
+        case NODE_BINARY_OP:
+            if (may_divide_by_zero(node)) return 0;
+            return is_loop_invariant(node->data.binary_op.left, usage) &&
+                   is_loop_invariant(node->data.binary_op.right, usage);
+        case NODE_UNARY_OP:
+            return is_loop_invariant(node->data.unary_op.operand, usage);
+        default:
+            return 0;
+    }
+}
+
+static int reads_any_name(ASTNode* node) {
+    if (!node) return 0;
+    switch (node->type) {
+        case NODE_IDENTIFIER:
+            return 1;
+        case NODE_BINARY_OP:
+            return reads_any_name(node->data.binary_op.left) || reads_any_name(node->data.binary_op.right);
+        case NODE_UNARY_OP:
+            return reads_any_name(node->data.unary_op.operand);
+        default:
+            return 0;
+    }
+}
+
+// Substitui 'node' por uma leitura da temporária que guarda o seu valor, criando-a
+// antes do laço se esta for a primeira ocorrência. Retorna 0 se 'node' não é invariante.
+static int licm_try_hoist(ASTNode* node, LICMContext* ctx) {
+    if (node->value_type != TYPE_INT && node->value_type != TYPE_FLOAT) return 0;
+    if (!reads_any_name(node) || !is_loop_invariant(node, ctx->usage)) return 0;
+
+    const char* name = NULL;
+    ASTNode* value = NULL;
+    for (int i = 0; i < ctx->count && !name; i++) {
+        if (ast_equal(ctx->hoisted[i], node)) {
+            name = ctx->names[i];
+            value = ctx->hoisted[i];
+        }
+    }
+    if (!name) {
+        if (ctx->count == LICM_MAX_HOISTED) return 0;
+        char buffer[64];
+        snprintf(buffer, sizeof(buffer), "__licm_%d", ++licm_counter);
+        ASTNode* moved = create_node(node->type, node->pos);
+        *moved = *node;
+        ctx->hoisted[ctx->count] = value = moved;
+        ctx->names[ctx->count] = strdup(buffer);
+        name = ctx->names[ctx->count++];
+        ctx->link = insert_before(ctx->link, new_var_decl(datatype_to_string(moved->value_type), name, moved, node->pos));
+        report_info("Otimização: Expressão invariante na linha %d foi movida para fora do laço em '%s'.\n",
+                    node->pos.line, name);
+    } else {
+        release_node_contents(node);
+    }
+    node->type = NODE_IDENTIFIER;
+    node->value_type = temp_value_type(value);
+    node->data.identifier_name = strdup(name);
+    return 1;
+}
+
+// Percorre comandos e expressões do laço, movendo as maiores subexpressões invariantes.
+static void licm_visit(ASTNode* node, LICMContext* ctx) {
+    if (!node) return;
+    switch (node->type) {
+        case NODE_BINARY_OP:
+            if (licm_try_hoist(node, ctx)) return;
+            licm_visit(node->data.binary_op.left, ctx);
+            // O operando direito de '&&' e '||' pode não ser avaliado
+            if (strcmp(node->data.binary_op.op, "&&") != 0 && strcmp(node->data.binary_op.op, "||") != 0) {
+                licm_visit(node->data.binary_op.right, ctx);
+            }
+            break;
+        case NODE_UNARY_OP:
+            licm_visit(node->data.unary_op.operand, ctx);
+            break;
+        case NODE_ASSIGN:
+            licm_visit(node->data.assign_expr.rvalue, ctx);
+            break;
+        case NODE_FUNC_CALL:
+            for (ASTNodeList* l = node->data.func_call.args; l; l = l->next) licm_visit(l->node, ctx);
+            break;
+        case NODE_VAR_DECL:
+            licm_visit(node->data.var_decl.initial_value, ctx);
+            break;
+        case NODE_RETURN:
+            licm_visit(node->data.return_stmt.return_value, ctx);
+            break;
+        case NODE_BLOCK:
+            // Os comandos depois de um que pode retornar podem não executar
+            for (ASTNodeList* l = node->data.block.statements; l; l = l->next) {
+                licm_visit(l->node, ctx);
+                if (contains_return(l->node)) break;
+            }
+            break;
+        // Dos comandos internos, só a condição (e o 'init') executa sempre: os ramos de
+        // um 'if' e o corpo de um laço interno podem não executar
+        case NODE_IF:
+            licm_visit(node->data.if_stmt.condition, ctx);
+            break;
+        case NODE_FOR:
+            licm_visit(node->data.for_stmt.init, ctx);
+            licm_visit(node->data.for_stmt.condition, ctx);
+            break;
+        case NODE_WHILE:
+            licm_visit(node->data.while_stmt.condition, ctx);
+            break;
+        default:
+            break;
+    }
+}
 
-// --- Implementação ---
+// Teste de entrada do laço: verdadeiro se o corpo executa ao menos uma vez. Devolve
+// NULL se o laço certamente executa ('*always' recebe 1) ou se o teste não pode ser
+// avaliado antes dele, por ter efeitos colaterais ou por um 'init' que não é 'i = valor'.
+static ASTNode* loop_entry_test(ASTNode* loop, int* always) {
+    *always = 0;
+    ASTNode* condition = loop->type == NODE_FOR ? loop->data.for_stmt.condition : loop->data.while_stmt.condition;
+    if (!condition) {
+        *always = 1;
+        return NULL;
+    }
+    if (has_side_effects(condition)) return NULL;
+    ASTNode* test = clone_ast(condition);
+    ASTNode* init = loop->type == NODE_FOR ? loop->data.for_stmt.init : NULL;
+    if (init) {
+        const char* name = NULL;
+        ASTNode* start = NULL;
+        if (init->type == NODE_VAR_DECL) {
+            name = init->data.var_decl.var_name;
+            start = init->data.var_decl.initial_value;
+        } else if (init->type == NODE_ASSIGN && init->data.assign_expr.lvalue->type == NODE_IDENTIFIER) {
+            name = init->data.assign_expr.lvalue->data.identifier_name;
+            start = init->data.assign_expr.rvalue;
+        }
+        if (!start || has_side_effects(start)) {
+            free_ast(test);
+            return NULL;
+        }
+        substitute_name(test, name, start);
+    }
+    fold_constants(test);
+    if (is_constant(test)) {
+        // Um laço que nunca executa não tem o que mover; um que sempre executa, nada a testar
+        *always = is_truthy(test);
+        free_ast(test);
+        return NULL;
+    }
+    return test;
+}
 
-void optimize_ast(ASTNode* node) {
-    if (!node) {
-        return;
+// Move as expressões invariantes do laço apontado por '*link'. Retorna o elo que
+// aponta para a célula do laço depois das inserções.
+static ASTNodeList** hoist_loop_invariants(ASTNodeList** link) {
+    ASTNode* loop = (*link)->node;
+    if (has_user_calls(loop)) return link;
+    int always;
+    ASTNode* entry_test = loop_entry_test(loop, &always);
+    if (!entry_test && !always) return link;
+
+    UsageTable usage = {0};
+    collect_usage(loop, &usage, 1);
+
+    // Com teste de entrada, as temporárias vão para uma lista à parte, que fica
+    // dentro do 'if' junto com o laço
+    ASTNodeList* guarded = NULL;
+    LICMContext ctx;
+    ctx.usage = &usage;
+    ctx.link = always ? link : &guarded;
+    ctx.count = 0;
+    // O 'init' do for executa uma única vez e fica onde está. Toda iteração avalia a
+    // condição e o corpo até um 'return'; o incremento, só se o corpo não retornar.
+    if (loop->type == NODE_FOR) {
+        licm_visit(loop->data.for_stmt.condition, &ctx);
+        licm_visit(loop->data.for_stmt.body, &ctx);
+        if (!contains_return(loop->data.for_stmt.body)) licm_visit(loop->data.for_stmt.increment, &ctx);
+    } else {
+        licm_visit(loop->data.while_stmt.condition, &ctx);
+        licm_visit(loop->data.while_stmt.body, &ctx);
+    }
+
+    if (entry_test && guarded) {
+        *ctx.link = create_node_list(loop);
+        ASTNode* block = create_node(NODE_BLOCK, loop->pos);
+        block->data.block.statements = guarded;
+        ASTNode* guard = create_node(NODE_IF, loop->pos);
+        guard->data.if_stmt.condition = entry_test;
+        guard->data.if_stmt.if_body = block;
+        // Sem o teste, o 'init' do for ainda executa uma vez
+        if (loop->type == NODE_FOR && loop->data.for_stmt.init) {
+            ASTNode* init_block = create_node(NODE_BLOCK, loop->pos);
+            init_block->data.block.statements = create_node_list(clone_ast(loop->data.for_stmt.init));
+            guard->data.if_stmt.else_body = init_block;
+        }
+        (*link)->node = guard;
+        report_info("Otimização: Expressões invariantes do laço na linha %d ficam sob o teste de entrada do laço.\n",
+                    loop->pos.line);
+    } else if (entry_test) {
+        free_ast(entry_test);
+    }
+    if (!always) ctx.link = link;
+
+    for (int i = 0; i < ctx.count; i++) free(ctx.names[i]);
+    usage_clear(&usage);
+    return ctx.link;
+}
+
+static void licm_statement_list(ASTNodeList** link);
+
+static void licm_statement(ASTNode* stmt) {
+    switch (stmt->type) {
+        case NODE_BLOCK:
+            licm_statement_list(&stmt->data.block.statements);
+            break;
+        case NODE_IF:
+            ensure_block(&stmt->data.if_stmt.if_body);
+            ensure_block(&stmt->data.if_stmt.else_body);
+            licm_statement(stmt->data.if_stmt.if_body);
+            if (stmt->data.if_stmt.else_body) licm_statement(stmt->data.if_stmt.else_body);
+            break;
+        case NODE_FOR:
+            ensure_block(&stmt->data.for_stmt.body);
+            licm_statement(stmt->data.for_stmt.body);
+            break;
+        case NODE_WHILE:
+            ensure_block(&stmt->data.while_stmt.body);
+            licm_statement(stmt->data.while_stmt.body);
+            break;
+        default:
+            break;
+    }
+}
+
+// O laço externo é processado antes dos internos: uma expressão invariante em
+// todos eles sai direto para fora do laço mais externo.
+static void licm_statement_list(ASTNodeList** link) {
+    while (*link) {
+        ASTNode* stmt = (*link)->node;
+        if (stmt->type == NODE_FOR || stmt->type == NODE_WHILE) link = hoist_loop_invariants(link);
+        licm_statement(stmt);
+        link = &(*link)->next;
+    }
+}
+
+static void move_loop_invariants(ASTNode* program) {
+    if (program->type != NODE_PROGRAM) return;
+    for (ASTNodeList* l = program->data.program.declarations; l; l = l->next) {
+        if (l->node->type == NODE_FUNC_DEF) licm_statement(l->node->data.func_def.body);
+        else if (l->node->type == NODE_MAIN_DEF) licm_statement(l->node->data.main_def.body);
+    }
+}
+
+// --- Desenrolamento de Laços e Redução de Força de Variáveis de Indução ---
+//
+// Um laço 'for' é contado quando o incremento é 'i = i + s' (ou 'i - s') com 's'
+// constante e o corpo nunca escreve 'i'. Se além disso o valor inicial e o limite
+// da condição ('i < N', 'i <= N', 'i > N', 'i >= N' ou 'i != N') são constantes,
+// o número de iterações é conhecido e o laço pode ser desenrolado: por completo
+// quando é curto, ou por um fator UNROLL_FACTOR, com as iterações que sobram
+// copiadas depois do laço.
+
+#define UNROLL_FULL_MAX_TRIPS 16 // Máximo de iterações de um laço desenrolado por completo
+#define UNROLL_FACTOR 4          // Cópias do corpo por iteração no desenrolamento parcial
+#define UNROLL_BUDGET 240        // Tamanho máximo (em nós da AST) do código desenrolado
+
+typedef struct {
+    const char* var;        // Variável de indução
+    long long step;         // Passo somado a cada iteração
+    int declares_var;       // O 'init' é 'int i = ...' (a variável só existe dentro do laço)
+    int has_bounds;         // Valor inicial e limite são constantes
+    long long start;
+    long long limit;
+    const char* comparison;
+} CountedLoop;
+
+static int fits_int(long long value) {
+    return value >= INT_MIN && value <= INT_MAX;
+}
+
+// Reconhece o incremento 'i = i + s' ou 'i = i - s'.
+static int match_induction_step(ASTNode* inc, const char** var, long long* step) {
+    if (!inc || inc->type != NODE_ASSIGN) return 0;
+    ASTNode* rvalue = inc->data.assign_expr.rvalue;
+    const char* name = inc->data.assign_expr.lvalue->data.identifier_name;
+    if (rvalue->type != NODE_BINARY_OP || rvalue->value_type != TYPE_INT) return 0;
+    const char* op = rvalue->data.binary_op.op;
+    if (strcmp(op, "+") != 0 && strcmp(op, "-") != 0) return 0;
+    ASTNode* left = rvalue->data.binary_op.left;
+    ASTNode* right = rvalue->data.binary_op.right;
+    if (left->type != NODE_IDENTIFIER || strcmp(left->data.identifier_name, name) != 0) return 0;
+    if (right->type != NODE_INT_LITERAL || right->data.int_literal == 0) return 0;
+    *var = name;
+    *step = op[0] == '+' ? right->data.int_literal : -(long long)right->data.int_literal;
+    return 1;
+}
+
+static int analyze_counted_loop(ASTNode* loop, CountedLoop* info) {
+    memset(info, 0, sizeof(*info));
+    if (loop->type != NODE_FOR) return 0;
+    if (!match_induction_step(loop->data.for_stmt.increment, &info->var, &info->step)) return 0;
+    if (has_user_calls(loop->data.for_stmt.condition) || has_user_calls(loop->data.for_stmt.body)) return 0;
+
+    UsageTable usage = {0};
+    collect_usage(loop->data.for_stmt.body, &usage, 1);
+    collect_usage(loop->data.for_stmt.condition, &usage, 0);
+    NameUsage* u = usage_lookup(&usage, info->var, 0);
+    int written = u && u->writes > 0;
+    usage_clear(&usage);
+    if (written) return 0;
+
+    ASTNode* init = loop->data.for_stmt.init;
+    ASTNode* start = NULL;
+    if (init && init->type == NODE_VAR_DECL && strcmp(init->data.var_decl.var_name, info->var) == 0) {
+        info->declares_var = 1;
+        start = init->data.var_decl.initial_value;
+    } else if (init && init->type == NODE_ASSIGN &&
+               strcmp(init->data.assign_expr.lvalue->data.identifier_name, info->var) == 0) {
+        start = init->data.assign_expr.rvalue;
+    }
+
+    ASTNode* condition = loop->data.for_stmt.condition;
+    if (start && start->type == NODE_INT_LITERAL && condition && condition->type == NODE_BINARY_OP &&
+        evaluate_comparison(condition->data.binary_op.op, 0, 0) != -1 && strcmp(condition->data.binary_op.op, "==") != 0) {
+        ASTNode* left = condition->data.binary_op.left;
+        ASTNode* right = condition->data.binary_op.right;
+        if (left->type == NODE_IDENTIFIER && strcmp(left->data.identifier_name, info->var) == 0 &&
+            right->type == NODE_INT_LITERAL) {
+            info->has_bounds = 1;
+            info->start = start->data.int_literal;
+            info->limit = right->data.int_literal;
+            info->comparison = condition->data.binary_op.op;
+        }
     }
+    return 1;
+}
+
+// Calcula o número de iterações; retorna 0 se ele não puder ser determinado
+// (por exemplo, se a variável de indução se afastar do limite).
+static int loop_trip_count(const CountedLoop* loop, long long* trips) {
+    long long start = loop->start, limit = loop->limit, step = loop->step;
+    const char* cmp = loop->comparison;
+    if (!evaluate_comparison(cmp, (double)start, (double)limit)) {
+        *trips = 0;
+        return 1;
+    }
+    int inclusive = strcmp(cmp, "<=") == 0 || strcmp(cmp, ">=") == 0;
+    if (step > 0 && cmp[0] == '<') {
+        *trips = (limit - start + inclusive + step - 1) / step;
+        return 1;
+    }
+    if (step < 0 && cmp[0] == '>') {
+        *trips = (start - limit + inclusive - step - 1) / -step;
+        return 1;
+    }
+    if (strcmp(cmp, "!=") == 0 && (limit - start) % step == 0 && (limit - start) / step > 0) {
+        *trips = (limit - start) / step;
+        return 1;
+    }
+    return 0;
+}
 
-    // --- Passo 1: Otimizar os filhos primeiro (travessia em pós-ordem) ---
+// Troca, in-place, toda leitura de 'name' na subárvore por uma cópia de 'replacement'.
+static void substitute_name(ASTNode* node, const char* name, ASTNode* replacement) {
+    if (!node) return;
     switch (node->type) {
-        case NODE_PROGRAM:
-            for (ASTNodeList* l = node->data.program.declarations; l; l = l->next) optimize_ast(l->node);
+        case NODE_IDENTIFIER:
+            if (strcmp(node->data.identifier_name, name) == 0) {
+                ASTNode* copy = clone_ast(replacement);
+                free(node->data.identifier_name);
+                *node = *copy;
+                free(copy);
+            }
             break;
-        case NODE_MAIN_DEF:
-            optimize_ast(node->data.main_def.body);
+        case NODE_VAR_DECL:
+            substitute_name(node->data.var_decl.initial_value, name, replacement);
             break;
         case NODE_BLOCK:
-            for (ASTNodeList* l = node->data.block.statements; l; l = l->next) optimize_ast(l->node);
-            break;
-        case NODE_FUNC_DEF:
-            optimize_ast(node->data.func_def.body);
+            for (ASTNodeList* l = node->data.block.statements; l; l = l->next) substitute_name(l->node, name, replacement);
             break;
         case NODE_IF:
-            optimize_ast(node->data.if_stmt.condition);
-            optimize_ast(node->data.if_stmt.if_body);
-            if (node->data.if_stmt.else_body) optimize_ast(node->data.if_stmt.else_body);
+            substitute_name(node->data.if_stmt.condition, name, replacement);
+            substitute_name(node->data.if_stmt.if_body, name, replacement);
+            substitute_name(node->data.if_stmt.else_body, name, replacement);
             break;
         case NODE_FOR:
-            optimize_ast(node->data.for_stmt.init);
-            optimize_ast(node->data.for_stmt.condition);
-            optimize_ast(node->data.for_stmt.increment);
-            optimize_ast(node->data.for_stmt.body);
+            substitute_name(node->data.for_stmt.init, name, replacement);
+            substitute_name(node->data.for_stmt.condition, name, replacement);
+            substitute_name(node->data.for_stmt.increment, name, replacement);
+            substitute_name(node->data.for_stmt.body, name, replacement);
             break;
-        case NODE_ASSIGN:
-            optimize_ast(node->data.assign_expr.rvalue);
+        case NODE_WHILE:
+            substitute_name(node->data.while_stmt.condition, name, replacement);
+            substitute_name(node->data.while_stmt.body, name, replacement);
             break;
         case NODE_RETURN:
-            optimize_ast(node->data.return_stmt.return_value);
+            substitute_name(node->data.return_stmt.return_value, name, replacement);
+            break;
+        case NODE_ASSIGN:
+            substitute_name(node->data.assign_expr.rvalue, name, replacement);
+            break;
+        case NODE_BINARY_OP:
+            substitute_name(node->data.binary_op.left, name, replacement);
+            substitute_name(node->data.binary_op.right, name, replacement);
             break;
         case NODE_UNARY_OP:
-            optimize_ast(node->data.unary_op.operand);
+            substitute_name(node->data.unary_op.operand, name, replacement);
             break;
         case NODE_FUNC_CALL:
-            for (ASTNodeList* l = node->data.func_call.args; l; l = l->next) optimize_ast(l->node);
+            for (ASTNodeList* l = node->data.func_call.args; l; l = l->next) substitute_name(l->node, name, replacement);
+            break;
+        default:
             break;
+    }
+}
+
+static ASTNode* new_identifier(const char* name, DataType type, Position pos) {
+    ASTNode* node = create_node(NODE_IDENTIFIER, pos);
+    node->data.identifier_name = strdup(name);
+    node->value_type = type;
+    return node;
+}
+
+static ASTNode* new_binary_op(const char* op, ASTNode* left, ASTNode* right, Position pos) {
+    ASTNode* node = create_node(NODE_BINARY_OP, pos);
+    node->data.binary_op.op = strdup(op);
+    node->data.binary_op.left = left;
+    node->data.binary_op.right = right;
+    node->value_type = left->value_type;
+    return node;
+}
+
+static ASTNode* new_assign(const char* name, ASTNode* value, Position pos) {
+    ASTNode* node = create_node(NODE_ASSIGN, pos);
+    node->data.assign_expr.lvalue = new_identifier(name, TYPE_INT, pos);
+    node->data.assign_expr.rvalue = value;
+    node->value_type = TYPE_INT;
+    return node;
+}
+
+// Cópia do corpo com a variável de indução trocada pelo valor constante 'value'.
+static ASTNode* body_copy_with_constant(ASTNode* body, const char* var, long long value) {
+    ASTNode* copy = clone_ast(body);
+    ASTNode* literal = new_int_literal((int)value, body->pos);
+    substitute_name(copy, var, literal);
+    free_ast(literal);
+    return copy;
+}
+
+// Cópias das iterações 'first' até 'last - 1', com a variável de indução constante.
+static void append_constant_iterations(ASTNodeList** tail, ASTNode* loop, const CountedLoop* info,
+                                       long long first, long long last) {
+    for (long long k = first; k < last; k++) {
+        *tail = create_node_list(body_copy_with_constant(loop->data.for_stmt.body, info->var, info->start + k * info->step));
+        tail = &(*tail)->next;
+    }
+    if (!info->declares_var) {
+        // A variável existe fora do laço: fica com o valor final
+        *tail = create_node_list(new_assign(info->var, new_int_literal((int)(info->start + last * info->step), loop->pos), loop->pos));
+    }
+}
+
+// Desenrola o laço apontado por '*link', se possível. Retorna 1 se o laço foi alterado.
+static int unroll_loop(ASTNodeList** link) {
+    ASTNode* loop = (*link)->node;
+    CountedLoop info;
+    long long trips;
+    if (!analyze_counted_loop(loop, &info) || !info.has_bounds) return 0;
+    if (!loop_trip_count(&info, &trips)) return 0;
+    if (!fits_int(info.start + trips * info.step)) return 0;
+
+    ASTNode* body = loop->data.for_stmt.body;
+    if (contains_return(body)) return 0;
+    int body_size = ast_size(body);
+
+    if (trips <= UNROLL_FULL_MAX_TRIPS && trips * body_size <= UNROLL_BUDGET) {
+        report_info("Otimização: Laço 'for' na linha %d foi desenrolado por completo (%lld iterações).\n",
+                    loop->pos.line, trips);
+        ASTNode* block = create_node(NODE_BLOCK, loop->pos);
+        append_constant_iterations(&block->data.block.statements, loop, &info, 0, trips);
+        fold_constants(block);
+        (*link)->node = block;
+        free_ast(loop);
+        return 1;
+    }
+
+    if (trips < UNROLL_FACTOR * 2 || body_size * UNROLL_FACTOR > UNROLL_BUDGET) return 0;
+    long long main_trips = trips / UNROLL_FACTOR;
+    long long main_end = info.start + main_trips * UNROLL_FACTOR * info.step;
+    if (!fits_int(info.step * UNROLL_FACTOR) || !fits_int(main_end)) return 0;
+
+    report_info("Otimização: Laço 'for' na linha %d foi desenrolado por um fator de %d.\n", loop->pos.line, UNROLL_FACTOR);
+
+    // Iterações que sobram: copiadas (a partir do corpo original) depois do laço
+    ASTNode* rest_block = NULL;
+    if (trips % UNROLL_FACTOR != 0 || !info.declares_var) {
+        rest_block = create_node(NODE_BLOCK, loop->pos);
+        append_constant_iterations(&rest_block->data.block.statements, loop, &info, main_trips * UNROLL_FACTOR, trips);
+        fold_constants(rest_block);
+    }
+
+    // Corpo novo: UNROLL_FACTOR cópias, a k-ésima com 'i' trocado por 'i + k * passo'
+    ASTNode* unrolled = create_node(NODE_BLOCK, body->pos);
+    ASTNodeList** tail = &unrolled->data.block.statements;
+    for (int k = 0; k < UNROLL_FACTOR; k++) {
+        ASTNode* copy = clone_ast(body);
+        if (k > 0) {
+            ASTNode* shifted = new_binary_op("+", new_identifier(info.var, TYPE_INT, body->pos),
+                                             new_int_literal((int)(k * info.step), body->pos), body->pos);
+            substitute_name(copy, info.var, shifted);
+            free_ast(shifted);
+        }
+        *tail = create_node_list(copy);
+        tail = &(*tail)->next;
+    }
+    fold_constants(unrolled);
+    free_ast(body);
+    loop->data.for_stmt.body = unrolled;
+
+    // A condição passa a parar antes das iterações que sobram, e o passo é multiplicado
+    free_ast(loop->data.for_stmt.condition);
+    loop->data.for_stmt.condition = new_binary_op(info.step > 0 ? "<" : ">",
+                                                  new_identifier(info.var, TYPE_INT, loop->pos),
+                                                  new_int_literal((int)main_end, loop->pos), loop->pos);
+    loop->data.for_stmt.increment->data.assign_expr.rvalue->data.binary_op.right->data.int_literal *= UNROLL_FACTOR;
+
+    if (rest_block) {
+        ASTNodeList* cell = create_node_list(rest_block);
+        cell->next = (*link)->next;
+        (*link)->next = cell;
+    }
+    return 1;
+}
+
+static int unroll_statement_list(ASTNodeList** link);
+
+static int unroll_statement(ASTNode* stmt) {
+    switch (stmt->type) {
+        case NODE_BLOCK:
+            return unroll_statement_list(&stmt->data.block.statements);
+        case NODE_IF:
+            ensure_block(&stmt->data.if_stmt.if_body);
+            ensure_block(&stmt->data.if_stmt.else_body);
+            return (is_cold_branch(stmt, 1) ? 0 : unroll_statement(stmt->data.if_stmt.if_body)) +
+                   (stmt->data.if_stmt.else_body && !is_cold_branch(stmt, 0)
+                        ? unroll_statement(stmt->data.if_stmt.else_body) : 0);
+        case NODE_FOR:
+            ensure_block(&stmt->data.for_stmt.body);
+            return unroll_statement(stmt->data.for_stmt.body);
+        case NODE_WHILE:
+            ensure_block(&stmt->data.while_stmt.body);
+            return unroll_statement(stmt->data.while_stmt.body);
+        default:
+            return 0;
+    }
+}
+
+// Os laços internos são desenrolados primeiro. As cópias inseridas depois de um
+// laço desenrolado não são visitadas de novo.
+static int unroll_statement_list(ASTNodeList** link) {
+    int unrolled = 0;
+    while (*link) {
+        ASTNodeList* next = (*link)->next;
+        unrolled += unroll_statement((*link)->node);
+        if ((*link)->node->type == NODE_FOR) unrolled += unroll_loop(link);
+        while (*link != next) link = &(*link)->next;
+    }
+    return unrolled;
+}
+
+static int unroll_loops(ASTNode* program) {
+    if (program->type != NODE_PROGRAM) return 0;
+    int unrolled = 0;
+    for (ASTNodeList* l = program->data.program.declarations; l; l = l->next) {
+        if (l->node->type == NODE_FUNC_DEF) unrolled += unroll_statement(l->node->data.func_def.body);
+        else if (l->node->type == NODE_MAIN_DEF) unrolled += unroll_statement(l->node->data.main_def.body);
+    }
+    return unrolled;
+}
+
+// Redução de força: em um laço contado, 'e * k' (ou 'e << k') com 'e' igual a 'i',
+// 'i + c' ou 'i - c' cresce 'passo * k' (ou 'passo * 2^k') a cada iteração. O produto é calculado uma vez antes do laço, em
+// uma variável '__iv_N', que é atualizada com uma soma no fim do corpo.
+
+#define IV_MAX_PER_LOOP 16 // Limite de variáveis de indução derivadas por laço
+
+typedef struct {
+    const char* var;
+    long long step;
+    ASTNode* exprs[IV_MAX_PER_LOOP]; // Expressão original (movida para a inicialização)
+    char* names[IV_MAX_PER_LOOP];
+    long long deltas[IV_MAX_PER_LOOP];
+    int count;
+} InductionContext;
+
+static int is_affine_in(ASTNode* node, const char* var) {
+    if (node->type == NODE_IDENTIFIER) return strcmp(node->data.identifier_name, var) == 0;
+    if (node->type != NODE_BINARY_OP) return 0;
+    const char* op = node->data.binary_op.op;
+    return (strcmp(op, "+") == 0 || strcmp(op, "-") == 0) &&
+           node->data.binary_op.right->type == NODE_INT_LITERAL &&
+           is_affine_in(node->data.binary_op.left, var);
+}
+
+// 'e * k', ou 'e << k', em que o dobramento já transformou os produtos por potências
+// de dois ('i * 4' chega aqui como 'i << 2')
+static int match_induction_product(ASTNode* node, const char* var, long long* factor) {
+    if (node->type != NODE_BINARY_OP || node->value_type != TYPE_INT) return 0;
+    ASTNode* right = node->data.binary_op.right;
+    if (right->type != NODE_INT_LITERAL || !is_affine_in(node->data.binary_op.left, var)) return 0;
+    if (strcmp(node->data.binary_op.op, "*") == 0) {
+        *factor = right->data.int_literal;
+        return 1;
+    }
+    if (strcmp(node->data.binary_op.op, "<<") == 0 && right->data.int_literal >= 0 && right->data.int_literal < 31) {
+        *factor = 1LL << right->data.int_literal;
+        return 1;
+    }
+    return 0;
+}
+
+static void reduce_in_expression(ASTNode* node, InductionContext* ctx) {
+    if (!node) return;
+    long long factor;
+    switch (node->type) {
         case NODE_BINARY_OP:
-            optimize_ast(node->data.binary_op.left);
-            optimize_ast(node->data.binary_op.right);
+            if (match_induction_product(node, ctx->var, &factor)) {
+                const char* name = NULL;
+                for (int i = 0; i < ctx->count && !name; i++) {
+                    if (ast_equal(ctx->exprs[i], node)) name = ctx->names[i];
+                }
+                if (!name && ctx->count < IV_MAX_PER_LOOP && fits_int(ctx->step * factor)) {
+                    char buffer[64];
+                    snprintf(buffer, sizeof(buffer), "__iv_%d", ++iv_counter);
+                    ASTNode* moved = create_node(node->type, node->pos);
+                    *moved = *node;
+                    ctx->exprs[ctx->count] = moved;
+                    ctx->names[ctx->count] = strdup(buffer);
+                    ctx->deltas[ctx->count] = ctx->step * factor;
+                    name = ctx->names[ctx->count++];
+                    report_info("Otimização: Expressão de indução na linha %d foi reduzida a somas em '%s'.\n",
+                                node->pos.line, name);
+                } else if (name) {
+                    release_node_contents(node);
+                }
+                if (name) {
+                    node->type = NODE_IDENTIFIER;
+                    node->data.identifier_name = strdup(name);
+                    return;
+                }
+            }
+            reduce_in_expression(node->data.binary_op.left, ctx);
+            reduce_in_expression(node->data.binary_op.right, ctx);
+            break;
+        case NODE_UNARY_OP:
+            reduce_in_expression(node->data.unary_op.operand, ctx);
+            break;
+        case NODE_ASSIGN:
+            reduce_in_expression(node->data.assign_expr.rvalue, ctx);
+            break;
+        case NODE_FUNC_CALL:
+            for (ASTNodeList* l = node->data.func_call.args; l; l = l->next) reduce_in_expression(l->node, ctx);
             break;
         case NODE_VAR_DECL:
-            if (node->data.var_decl.initial_value) optimize_ast(node->data.var_decl.initial_value);
+            reduce_in_expression(node->data.var_decl.initial_value, ctx);
             break;
-        case NODE_PARAM:
-        case NODE_IDENTIFIER:
-        case NODE_INT_LITERAL:
-        case NODE_FLOAT_LITERAL:
-        case NODE_CHAR_LITERAL:
-        case NODE_STRING_LITERAL:
+        case NODE_RETURN:
+            reduce_in_expression(node->data.return_stmt.return_value, ctx);
+            break;
+        case NODE_BLOCK:
+            for (ASTNodeList* l = node->data.block.statements; l; l = l->next) reduce_in_expression(l->node, ctx);
+            break;
+        case NODE_IF:
+            reduce_in_expression(node->data.if_stmt.condition, ctx);
+            reduce_in_expression(node->data.if_stmt.if_body, ctx);
+            reduce_in_expression(node->data.if_stmt.else_body, ctx);
+            break;
+        case NODE_FOR:
+            reduce_in_expression(node->data.for_stmt.init, ctx);
+            reduce_in_expression(node->data.for_stmt.condition, ctx);
+            reduce_in_expression(node->data.for_stmt.increment, ctx);
+            reduce_in_expression(node->data.for_stmt.body, ctx);
+            break;
+        case NODE_WHILE:
+            reduce_in_expression(node->data.while_stmt.condition, ctx);
+            reduce_in_expression(node->data.while_stmt.body, ctx);
+            break;
+        default:
             break;
     }
+}
 
-    // --- Passo 2: Tentar otimizar o nó atual ---
-    if (node->type == NODE_BINARY_OP) {
-        ASTNode* left = node->data.binary_op.left;
-        ASTNode* right = node->data.binary_op.right;
+// Aplica a redução de força ao laço apontado por '*link'. O 'init' do laço sai para
+// antes dele, seguido das inicializações das variáveis derivadas.
+static ASTNodeList** reduce_loop_inductions(ASTNodeList** link) {
+    ASTNode* loop = (*link)->node;
+    CountedLoop info;
+    if (!analyze_counted_loop(loop, &info)) return link;
 
-        if (left && right && left->type == NODE_INT_LITERAL && right->type == NODE_INT_LITERAL) {
-            int result = 0;
-            const char* op = node->data.binary_op.op;
+    InductionContext ctx;
+    ctx.var = info.var;
+    ctx.step = info.step;
+    ctx.count = 0;
+    reduce_in_expression(loop->data.for_stmt.condition, &ctx);
+    reduce_in_expression(loop->data.for_stmt.body, &ctx);
+    if (ctx.count == 0) return link;
+
+    if (loop->data.for_stmt.init) {
+        link = insert_before(link, loop->data.for_stmt.init);
+        loop->data.for_stmt.init = NULL;
+    }
+    ensure_block(&loop->data.for_stmt.body);
+    ASTNodeList** tail = &loop->data.for_stmt.body->data.block.statements;
+    while (*tail) tail = &(*tail)->next;
+    for (int i = 0; i < ctx.count; i++) {
+        link = insert_before(link, new_var_decl("int", ctx.names[i], ctx.exprs[i], loop->pos));
+        long long delta = ctx.deltas[i];
+        ASTNode* update = new_binary_op(delta < 0 ? "-" : "+", new_identifier(ctx.names[i], TYPE_INT, loop->pos),
+                                        new_int_literal((int)(delta < 0 ? -delta : delta), loop->pos), loop->pos);
+        *tail = create_node_list(new_assign(ctx.names[i], update, loop->pos));
+        tail = &(*tail)->next;
+        free(ctx.names[i]);
+    }
+    return link;
+}
+
+static void reduce_statement_list(ASTNodeList** link);
+
+static void reduce_statement(ASTNode* stmt) {
+    switch (stmt->type) {
+        case NODE_BLOCK:
+            reduce_statement_list(&stmt->data.block.statements);
+            break;
+        case NODE_IF:
+            reduce_statement(stmt->data.if_stmt.if_body);
+            if (stmt->data.if_stmt.else_body) reduce_statement(stmt->data.if_stmt.else_body);
+            break;
+        case NODE_FOR:
+            reduce_statement(stmt->data.for_stmt.body);
+            break;
+        case NODE_WHILE:
+            reduce_statement(stmt->data.while_stmt.body);
+            break;
+        default:
+            break;
+    }
+}
+
+static void reduce_statement_list(ASTNodeList** link) {
+    for (; *link; link = &(*link)->next) {
+        reduce_statement((*link)->node);
+        if ((*link)->node->type == NODE_FOR) link = reduce_loop_inductions(link);
+    }
+}
+
+static void reduce_induction_variables(ASTNode* program) {
+    if (program->type != NODE_PROGRAM) return;
+    for (ASTNodeList* l = program->data.program.declarations; l; l = l->next) {
+        if (l->node->type == NODE_FUNC_DEF) reduce_statement(l->node->data.func_def.body);
+        else if (l->node->type == NODE_MAIN_DEF) reduce_statement(l->node->data.main_def.body);
+    }
+}
+
+// --- Eliminação de Chamadas de Cauda ---
+//
+// Uma função cujo último passo é 'return f(...)' para ela mesma é reescrita como um laço:
+// o corpo passa a ficar dentro de 'while (1)', e cada chamada de cauda vira a atribuição
+// dos argumentos aos parâmetros, seguida da volta ao início do laço. Os caminhos que
+// chegavam ao fim da função ganham um 'return;' explícito. Como a linguagem não tem
+// 'continue', só são convertidas as chamadas em posição de cauda do corpo (a última
+// instrução executada antes do fim da função); as que estão dentro de laços continuam
+// sendo chamadas recursivas.
+
+static int is_self_tail_call(ASTNode* stmt, ASTNode* def) {
+    if (stmt->type != NODE_RETURN) return 0;
+    ASTNode* call = stmt->data.return_stmt.return_value;
+    if (!call || call->type != NODE_FUNC_CALL || strcmp(call->data.func_call.func_name, def->data.func_def.func_name) != 0) {
+        return 0;
+    }
+    ASTNodeList* arg = call->data.func_call.args;
+    ASTNodeList* param = def->data.func_def.params;
+    for (; arg && param; arg = arg->next, param = param->next) {
+    }
+    return !arg && !param;
+}
+
+// O comando contém uma chamada de cauda fora de laços.
+static int contains_tail_call(ASTNode* node, ASTNode* def) {
+    if (!node) return 0;
+    switch (node->type) {
+        case NODE_RETURN:
+            return is_self_tail_call(node, def);
+        case NODE_BLOCK:
+            for (ASTNodeList* l = node->data.block.statements; l; l = l->next) {
+                if (contains_tail_call(l->node, def)) return 1;
+            }
+            return 0;
+        case NODE_IF:
+            return contains_tail_call(node->data.if_stmt.if_body, def) ||
+                   contains_tail_call(node->data.if_stmt.else_body, def);
+        default:
+            return 0;
+    }
+}
+
+static void append_statements(ASTNode* block, ASTNodeList* statements) {
+    ASTNodeList** tail = &block->data.block.statements;
+    while (*tail) tail = &(*tail)->next;
+    *tail = statements;
+}
+
+// Leva para a posição de cauda as chamadas que estão num 'if' seguido de outros comandos:
+// se um dos ramos sempre retorna, os comandos seguintes só executam pelo outro ramo e
+// podem ser movidos para dentro dele ('if (c) { return f(x); } resto' vira
+// 'if (c) { return f(x); } else { resto }').
+static void hoist_tail_branches(ASTNode* node, ASTNode* def) {
+    if (!node) return;
+    if (node->type == NODE_IF) {
+        hoist_tail_branches(node->data.if_stmt.if_body, def);
+        hoist_tail_branches(node->data.if_stmt.else_body, def);
+        return;
+    }
+    if (node->type != NODE_BLOCK || !node->data.block.statements) return;
+
+    ASTNodeList* cell = node->data.block.statements;
+    for (; cell->next; cell = cell->next) {
+        ASTNode* stmt = cell->node;
+        if (stmt->type != NODE_IF || !contains_tail_call(stmt, def)) continue;
+        ASTNode** target;
+        if (always_returns(stmt->data.if_stmt.if_body)) {
+            target = &stmt->data.if_stmt.else_body;
+        } else if (stmt->data.if_stmt.else_body && always_returns(stmt->data.if_stmt.else_body)) {
+            target = &stmt->data.if_stmt.if_body;
+        } else {
+            continue;
+        }
+        if (!*target) *target = create_node(NODE_BLOCK, stmt->pos);
+        ensure_block(target);
+        append_statements(*target, cell->next);
+        cell->next = NULL;
+        break;
+    }
+    hoist_tail_branches(cell->node, def);
+}
+
+// Conta as chamadas de cauda nas posições de cauda do comando.
+static int count_tail_calls(ASTNode* node, ASTNode* def) {
+    if (!node) return 0;
+    switch (node->type) {
+        case NODE_RETURN:
+            return is_self_tail_call(node, def);
+        case NODE_BLOCK: {
+            ASTNodeList* last = node->data.block.statements;
+            while (last && last->next) last = last->next;
+            return last ? count_tail_calls(last->node, def) : 0;
+        }
+        case NODE_IF:
+            return count_tail_calls(node->data.if_stmt.if_body, def) +
+                   count_tail_calls(node->data.if_stmt.else_body, def);
+        default:
+            return 0;
+    }
+}
+
+// Bloco que substitui 'return f(args)': os argumentos são atribuídos aos parâmetros. Se a
+// atribuição de um parâmetro puder alterar o valor de um argumento avaliado depois dele,
+// ou se algum argumento tiver efeitos colaterais, todos são calculados antes em
+// temporárias '__tc_N', na ordem original.
+static ASTNode* tail_call_assignments(ASTNode* ret, ASTNode* def) {
+    ASTNode* call = ret->data.return_stmt.return_value;
+    ASTNode* block = create_node(NODE_BLOCK, ret->pos);
+
+    int use_temps = 0;
+    ASTNodeList* arg = call->data.func_call.args;
+    for (ASTNodeList* param = def->data.func_def.params; param; param = param->next, arg = arg->next) {
+        if (has_side_effects(arg->node)) use_temps = 1;
+        for (ASTNodeList* later = arg->next; later; later = later->next) {
+            if (references_name(later->node, param->node->data.param.param_name)) use_temps = 1;
+        }
+    }
+
+    ASTNodeList** decls = &block->data.block.statements;
+    ASTNodeList* assigns = NULL;
+    ASTNodeList** assigns_tail = &assigns;
+    arg = call->data.func_call.args;
+    for (ASTNodeList* param = def->data.func_def.params; param; param = param->next, arg = arg->next) {
+        const char* name = param->node->data.param.param_name;
+        DataType type = string_to_datatype(param->node->data.param.type_name);
+        ASTNode* value = arg->node;
+        arg->node = NULL;
+        if (value->type == NODE_IDENTIFIER && strcmp(value->data.identifier_name, name) == 0) {
+            free_ast(value); // O parâmetro recebe o próprio valor
+            continue;
+        }
+        if (use_temps) {
+            char temp[32];
+            snprintf(temp, sizeof(temp), "__tc_%d", tail_counter++);
+            *decls = create_node_list(new_var_decl(param->node->data.param.type_name, temp, value, ret->pos));
+            decls = &(*decls)->next;
+            value = new_identifier(temp, type, ret->pos);
+        }
+        ASTNode* assign = new_assign(name, value, ret->pos);
+        assign->value_type = assign->data.assign_expr.lvalue->value_type = type;
+        *assigns_tail = create_node_list(assign);
+        assigns_tail = &(*assigns_tail)->next;
+    }
+    *decls = assigns;
+    return block;
+}
+
+static ASTNode* new_empty_return(Position pos) {
+    return create_node(NODE_RETURN, pos);
+}
 
-            if (strcmp(op, "+") == 0) result = left->data.int_literal + right->data.int_literal;
-            else if (strcmp(op, "-") == 0) result = left->data.int_literal - right->data.int_literal;
-            else if (strcmp(op, "*") == 0) result = left->data.int_literal * right->data.int_literal;
-            else if (strcmp(op, "/") == 0) {
-                if (right->data.int_literal == 0) return; // Evita otimização de divisão por zero
-                result = left->data.int_literal / right->data.int_literal;
+// Converte o comando em posição de cauda guardado em 'slot': chamadas de cauda viram
+// atribuições (e o laço recomeça), e o fim dos demais caminhos ganha um 'return;'.
+static void convert_tail_position(ASTNode** slot, ASTNode* def) {
+    ASTNode* node = *slot;
+    switch (node->type) {
+        case NODE_RETURN:
+            if (is_self_tail_call(node, def)) {
+                report_info("Otimização: Chamada de cauda de '%s' na linha %d foi convertida em laço.\n",
+                            def->data.func_def.func_name, node->pos.line);
+                *slot = tail_call_assignments(node, def);
+                free_ast(node);
+            }
+            return;
+        case NODE_BLOCK: {
+            ASTNodeList** last = &node->data.block.statements;
+            while (*last && (*last)->next) last = &(*last)->next;
+            if (!*last) {
+                *last = create_node_list(new_empty_return(node->pos));
             } else {
-                return; // Não otimiza outros operadores
+                convert_tail_position(&(*last)->node, def);
             }
-            
-            printf("Otimização: Expressão '%d %s %d' na linha %d foi calculada como '%d'.\n",
-                   left->data.int_literal, op, right->data.int_literal, node->pos.line, result);
+            return;
+        }
+        case NODE_IF:
+            ensure_block(&node->data.if_stmt.if_body);
+            convert_tail_position(&node->data.if_stmt.if_body, def);
+            if (!node->data.if_stmt.else_body) node->data.if_stmt.else_body = create_node(NODE_BLOCK, node->pos);
+            ensure_block(&node->data.if_stmt.else_body);
+            convert_tail_position(&node->data.if_stmt.else_body, def);
+            return;
+        default: {
+            // Qualquer outro comando deixa a execução seguir para o fim da função
+            ASTNode* block = create_node(NODE_BLOCK, node->pos);
+            block->data.block.statements = create_node_list(node);
+            block->data.block.statements->next = create_node_list(new_empty_return(node->pos));
+            *slot = block;
+            return;
+        }
+    }
+}
+
+static void eliminate_tail_calls(ASTNode* program) {
+    if (program->type != NODE_PROGRAM) return;
+    for (ASTNodeList* l = program->data.program.declarations; l; l = l->next) {
+        ASTNode* def = l->node;
+        if (def->type != NODE_FUNC_DEF || !contains_tail_call(def->data.func_def.body, def)) continue;
+        ensure_block(&def->data.func_def.body);
+        hoist_tail_branches(def->data.func_def.body, def);
+        if (count_tail_calls(def->data.func_def.body, def) == 0) continue;
+
+        ASTNode* body = def->data.func_def.body;
+        convert_tail_position(&body, def);
+        ASTNode* loop = create_node(NODE_WHILE, body->pos);
+        loop->data.while_stmt.condition = new_int_literal(1, body->pos);
+        loop->data.while_stmt.body = body;
+        def->data.func_def.body = create_node(NODE_BLOCK, body->pos);
+        def->data.func_def.body->data.block.statements = create_node_list(loop);
+    }
+}
+
+// --- Ordem dos Ramos Guiada pelo Perfil ---
+//
+// Um 'if' cujo ramo 'senão' foi o mais executado no perfil tem a condição negada e os
+// ramos trocados, para que o caminho quente seja o que segue sem desvio (no Python e no
+// JIT). Os contadores continuam presos à posição do 'if', então um perfil medido depois
+// da troca vem com os ramos trocados também.
 
-            free(node->data.binary_op.op);
-            free_ast(left);
-            free_ast(right);
+static void negate_condition(ASTNode* if_stmt) {
+    ASTNode* condition = if_stmt->data.if_stmt.condition;
+    if (condition->type == NODE_UNARY_OP && strcmp(condition->data.unary_op.op, "!") == 0) {
+        // Em um 'if', só o valor-verdade importa: !(!c) é c
+        replace_with_child(condition, condition->data.unary_op.operand);
+        return;
+    }
+    ASTNode* negation = create_node(NODE_UNARY_OP, condition->pos);
+    negation->value_type = TYPE_INT;
+    negation->data.unary_op.op = strdup("!");
+    negation->data.unary_op.operand = condition;
+    simplify_node(negation);
+    if_stmt->data.if_stmt.condition = negation;
+}
 
-            node->type = NODE_INT_LITERAL;
-            node->data.int_literal = result;
+static void order_branches_in(ASTNode* stmt) {
+    if (!stmt) return;
+    switch (stmt->type) {
+        case NODE_BLOCK:
+            for (ASTNodeList* l = stmt->data.block.statements; l; l = l->next) order_branches_in(l->node);
+            break;
+        case NODE_IF: {
+            long long taken, not_taken;
+            if (stmt->data.if_stmt.else_body &&
+                profile_branch_counts(active_profile, stmt->pos, &taken, &not_taken) && not_taken > taken) {
+                report_info("Otimização: Ramos do 'if' na linha %d trocados (o 'senão' é o mais executado no perfil).\n",
+                            stmt->pos.line);
+                negate_condition(stmt);
+                ASTNode* if_body = stmt->data.if_stmt.if_body;
+                stmt->data.if_stmt.if_body = stmt->data.if_stmt.else_body;
+                stmt->data.if_stmt.else_body = if_body;
+            }
+            order_branches_in(stmt->data.if_stmt.if_body);
+            order_branches_in(stmt->data.if_stmt.else_body);
+            break;
         }
+        case NODE_FOR:
+            order_branches_in(stmt->data.for_stmt.body);
+            break;
+        case NODE_WHILE:
+            order_branches_in(stmt->data.while_stmt.body);
+            break;
+        default:
+            break;
+    }
+}
+
+static void order_branches(ASTNode* program) {
+    if (!active_profile || program->type != NODE_PROGRAM) return;
+    for (ASTNodeList* l = program->data.program.declarations; l; l = l->next) {
+        if (l->node->type == NODE_FUNC_DEF) order_branches_in(l->node->data.func_def.body);
+        else if (l->node->type == NODE_MAIN_DEF) order_branches_in(l->node->data.main_def.body);
     }
 }
@@ -2,17 +2,81 @@
 #define OTIMIZADOR_H
 
 #include "ast.h" // <<< CORREÇÃO: Adicionada a inclusão de ast.h
+#include "gerenciador_passes.h"
+#include "perfil_execucao.h"
 
 /**
  * @brief Otimiza a Árvore Sintática Abstrata (AST) fornecida.
  *
  * A principal otimização realizada é o "Constant Folding", onde expressões
  * com valores constantes são calculadas em tempo de compilação e
- * substituídas pelo seu resultado. A otimização é feita in-place,
- * modificando a própria árvore.
+ * substituídas pelo seu resultado. São dobrados operadores aritméticos
+ * (int e float), unários ('-' e '!'), relacionais e lógicos ('&&' e '||',
+ * com curto-circuito quando o operando esquerdo é constante). A otimização
+ * é feita in-place, modificando a própria árvore.
+ *
+ * Junto ao dobramento é aplicada uma tabela de regras de simplificação
+ * algébrica (identidades como 'x * 1', reassociação de constantes e
+ * redução de força de 'x * 2^k' para 'x << k'), que usa os tipos anotados
+ * na AST pela análise semântica.
+ *
+ * Depois disso, chamadas a funções pequenas e não recursivas são expandidas
+ * inline (os parâmetros e variáveis locais do corpo copiado são renomeados e
+ * cada 'return' vira uma atribuição a uma variável de resultado), e o
+ * dobramento é refeito sobre o código expandido.
+ *
+ * Por fim é feita a eliminação de código morto: comandos 'if' com
+ * condição constante são reduzidos ao ramo escolhido, comandos após um
+ * 'return' e laços com condição falsa são removidos e variáveis nunca
+ * lidas (com inicialização e atribuições sem efeitos colaterais) são
+ * eliminadas.
+ *
+ * Laços 'for' contados com limites constantes são então desenrolados (por
+ * completo, ou por um fator fixo quando são longos), e nos demais laços
+ * contados os produtos 'i * k' da variável de indução viram somas.
+ *
+ * Em seguida, expressões invariantes de laços 'for' e 'while' (puras, sem
+ * divisões que possam falhar e cujos operandos não são escritos no laço) são
+ * calculadas uma única vez em temporárias declaradas antes do laço.
+ *
+ * A última etapa elimina subexpressões comuns: expressões puras repetidas em
+ * um bloco (ou em um 'if' e nos seus ramos) sem que seus operandos mudem são
+ * calculadas uma única vez em uma variável temporária.
+ *
+ * Com um perfil de execução (set_optimizer_profile), as decisões de expansão inline
+ * e de desenrolamento usam as contagens medidas, e os 'if' cujo ramo 'senão' foi o
+ * mais executado têm os ramos trocados.
  *
  * @param node O nó raiz da AST a ser otimizada.
  */
 void optimize_ast(ASTNode* node);
 
+/**
+ * @brief Define o perfil de execução (--profile-use) usado pelas próximas otimizações,
+ * ou nenhum com NULL. O perfil deve continuar válido enquanto estiver definido.
+ * Funções nunca chamadas na execução medida não são expandidas inline, e as que
+ * recebem ao menos 1% das chamadas podem ter um corpo maior; os ramos nunca executados
+ * ficam de fora da expansão inline e do desenrolamento de laços.
+ */
+void set_optimizer_profile(const ExecutionProfile* profile);
+
+/**
+ * @brief Otimiza um programa parcial (usado pela compilação incremental: uma
+ * declaração e as declarações de que ela depende). Aplica as mesmas etapas de
+ * optimize_ast, exceto as que dependem de ver o programa inteiro: a remoção de
+ * variáveis globais nunca lidas (e das atribuições a elas) e a remoção de
+ * funções cujas chamadas foram todas expandidas inline.
+ */
+void optimize_ast_partial(ASTNode* program);
+
+/**
+ * @brief As etapas de optimize_ast como passes do gerenciador. "fold" (dobramento e
+ * regras algébricas, na pós-ordem) e "prune" (poda de 'if' e laços com condição
+ * constante, de blocos vazios e de código após 'return') têm ganchos por nó e podem ser
+ * fundidos à análise semântica; "opt" executa as etapas que precisam do programa inteiro.
+ */
+extern const Pass fold_pass;
+extern const Pass prune_pass;
+extern const Pass optimize_pass;
+
 #endif // OTIMIZADOR_H
\ No newline at end of file
@@ -0,0 +1,63 @@
+# --- Código Gerado pelo Compilador ---
+
+import atexit as __atexit, io as __io, sys as __sys
+
+try:
+    __saida = __io.TextIOWrapper(__io.BufferedWriter(__io.FileIO(__sys.stdout.fileno(), "w", closefd=False), 1 << 16),
+                                 encoding="utf-8", newline="\n")
+    __atexit.register(__saida.flush)
+except (AttributeError, OSError, ValueError):
+    __saida = __sys.stdout
+__escreve = __saida.write
+
+import operator as __op
+
+def __divint(a, b):
+    return int(a / b)
+
+def __cadeia(valor, *resto):
+    for i in range(0, len(resto), 2):
+        operando = resto[i + 1]
+        valor = resto[i](valor, operando() if callable(operando) else operando)
+    return valor
+
+n = 0
+
+def sinal(x):
+    if (x < 0):
+        return -1
+    else:
+        return 1
+
+def main(__escreve=__escreve):
+    global n
+    __incg_ret_1 = None
+    __incg_k_1 = 2
+    n = (n + __incg_k_1)
+    __incg_ret_1 = n
+    __incg_ret_1
+    __incg_ret_2 = None
+    __incg_k_2 = 3
+    n = (n + __incg_k_2)
+    __incg_ret_2 = n
+    __incg_ret_2
+    __escreve("%d\n" % (n,))
+    __sinal_ret_3 = None
+    __sinal_x_3 = -5
+    if (__sinal_x_3 < 0):
+        __sinal_ret_3 = -1
+    else:
+        __sinal_ret_3 = 1
+    __escreve("%s\n" % ((__sinal_ret_3 + sinal(5)),))
+    y = None
+    y = 4
+    __escreve("%d\n" % (y,))
+    __talvez_ret_4 = None
+    __talvez_x_4 = -1
+    if (__talvez_x_4 > 0):
+        __talvez_ret_4 = __talvez_x_4
+    __escreve("%s\n" % (__talvez_ret_4,))
+
+
+if __name__ == "__main__":
+    main()
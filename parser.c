@@ -7,12 +7,28 @@
 #include "parser.h"
 #include "analisador.h"
 #include "ast.h"
+#include "diagnosticos.h"
 
 // --- Variáveis de estado do Parser ---
 static Token current_token;
 static const char* source_code_ptr;
 static int current_parser_index;
 static int main_block_found_flag;
+static int tokens_read;
+
+// Limite de aninhamento: cada comando aninhado, parêntese, operador unário, lado
+// direito de atribuição ou argumento conta um nível. Acima do limite o parser emite
+// um erro sintático em vez de esgotar a pilha de chamadas.
+static int max_nesting_depth = DEFAULT_MAX_NESTING_DEPTH;
+static int nesting_depth;
+
+// Alocações do parse_program em andamento. Se ele for interrompido por um erro
+// sintático com fatal_error, a árvore parcial deixa de ser alcançável e estas
+// alocações são liberadas por discard_partial_parse.
+static void** parse_allocations = NULL;
+static int parse_allocation_count = 0;
+static int parse_allocation_capacity = 0;
+static int tracking_allocations = 0;
 
 // --- Protótipos de Funções ---
 static void advance_and_skip_comments();
@@ -20,6 +36,9 @@ static int token_is(TokenType type, const char* lexeme);
 static void eat(TokenType type, const char* expected_lexeme);
 static void syntax_error(const char* message);
 static char* safe_strdup(const char* s);
+static void track_allocation(void* p);
+static void enter_nesting();
+static void leave_nesting();
 static ASTNode* parse_expression();
 static ASTNode* parse_primary_expression();
 static ASTNode* parse_top_level_declaration();
@@ -33,15 +52,11 @@ static ASTNode* parse_statement();
 static ASTNode* parse_expression_statement();
 static ASTNode* parse_if_statement();
 static ASTNode* parse_for_statement();
+static ASTNode* parse_while_statement();
 static ASTNode* parse_return_statement();
 static ASTNode* parse_block_statement();
 static ASTNode* parse_assignment_expression();
-static ASTNode* parse_logical_or_expression();
-static ASTNode* parse_logical_and_expression();
-static ASTNode* parse_equality_expression();
-static ASTNode* parse_relational_expression();
-static ASTNode* parse_additive_expression();
-static ASTNode* parse_multiplicative_expression();
+static ASTNode* parse_binary_expression(int min_precedence);
 static ASTNode* parse_unary_expression();
 static ASTNodeList* parse_argument_list();
 
@@ -49,21 +64,24 @@ static ASTNodeList* parse_argument_list();
 ASTNode* create_node(NodeType type, Position pos) {
     ASTNode* node = (ASTNode*)malloc(sizeof(ASTNode));
     if (!node) {
-        fprintf(stderr, "Falha ao alocar memória para o nó da AST\n");
-        exit(EXIT_FAILURE);
+        report_error("Falha ao alocar memória para o nó da AST\n");
+        fatal_error();
     }
+    track_allocation(node);
     memset(node, 0, sizeof(ASTNode));
     node->type = type;
     node->pos = pos;
+    node->value_type = TYPE_UNKNOWN;
     return node;
 }
 
 ASTNodeList* create_node_list(ASTNode* node) {
     ASTNodeList* list = (ASTNodeList*)malloc(sizeof(ASTNodeList));
     if (!list) {
-        fprintf(stderr, "Falha ao alocar memória para a lista de nós da AST\n");
-        exit(EXIT_FAILURE);
+        report_error("Falha ao alocar memória para a lista de nós da AST\n");
+        fatal_error();
     }
+    track_allocation(list);
     list->node = node;
     list->next = NULL;
     return list;
@@ -77,166 +95,377 @@ ASTNodeList* append_node_list(ASTNodeList* list, ASTNode* node) {
     return list;
 }
 
-void free_ast(ASTNode* node) {
-    if (!node) return;
+// --- Percursos Iterativos ---
+
+void ast_stack_push(ASTStack* stack, ASTNode* node) {
+    if (stack->count == stack->capacity) {
+        int capacity = stack->capacity ? stack->capacity * 2 : 64;
+        ASTNode** grown = (ASTNode**)realloc(stack->items, capacity * sizeof(ASTNode*));
+        if (!grown) {
+            report_error("Erro de Memória: falha ao alocar a pilha de percurso da AST.\n");
+            fatal_error();
+        }
+        stack->items = grown;
+        stack->capacity = capacity;
+    }
+    stack->items[stack->count++] = node;
+}
+
+void ast_stack_free(ASTStack* stack) {
+    free(stack->items);
+    stack->items = NULL;
+    stack->count = stack->capacity = 0;
+}
+
+ASTNode* ast_left_spine(ASTNode* node, ASTStack* spine) {
+    while (node && node->type == NODE_BINARY_OP) {
+        ast_stack_push(spine, node);
+        node = node->data.binary_op.left;
+    }
+    return node;
+}
+
+ASTLayout ast_layout(ASTNode* node) {
+    ASTLayout l;
+    memset(&l, 0, sizeof(l));
     switch (node->type) {
-        case NODE_PROGRAM: {
-            ASTNodeList* current = node->data.program.declarations;
-            while (current) {
-                ASTNodeList* next = current->next;
-                free_ast(current->node);
-                free(current);
-                current = next;
-            }
+        case NODE_PROGRAM:
+            l.list = &node->data.program.declarations;
             break;
-        }
         case NODE_VAR_DECL:
-            if(node->data.var_decl.type_name) free(node->data.var_decl.type_name);
-            if(node->data.var_decl.var_name) free(node->data.var_decl.var_name);
-            free_ast(node->data.var_decl.initial_value);
+            l.str[l.str_count++] = &node->data.var_decl.type_name;
+            l.str[l.str_count++] = &node->data.var_decl.var_name;
+            l.child[l.child_count++] = &node->data.var_decl.initial_value;
             break;
         case NODE_FUNC_DEF:
-            if(node->data.func_def.func_name) free(node->data.func_def.func_name);
-            ASTNodeList* params = node->data.func_def.params;
-            while (params) {
-                ASTNodeList* next = params->next;
-                free_ast(params->node);
-                free(params);
-                params = next;
-            }
-            free_ast(node->data.func_def.body);
+            l.str[l.str_count++] = &node->data.func_def.func_name;
+            l.list = &node->data.func_def.params;
+            l.child[l.child_count++] = &node->data.func_def.body;
             break;
         case NODE_MAIN_DEF:
-            free_ast(node->data.main_def.body);
+            l.child[l.child_count++] = &node->data.main_def.body;
             break;
         case NODE_PARAM:
-            if(node->data.param.type_name) free(node->data.param.type_name);
-            if(node->data.param.param_name) free(node->data.param.param_name);
+            l.str[l.str_count++] = &node->data.param.type_name;
+            l.str[l.str_count++] = &node->data.param.param_name;
             break;
-        case NODE_BLOCK: {
-            ASTNodeList* current = node->data.block.statements;
-            while (current) {
-                ASTNodeList* next = current->next;
-                free_ast(current->node);
-                free(current);
-                current = next;
-            }
+        case NODE_BLOCK:
+            l.list = &node->data.block.statements;
             break;
-        }
         case NODE_IF:
-            free_ast(node->data.if_stmt.condition);
-            free_ast(node->data.if_stmt.if_body);
-            free_ast(node->data.if_stmt.else_body);
+            l.child[l.child_count++] = &node->data.if_stmt.condition;
+            l.child[l.child_count++] = &node->data.if_stmt.if_body;
+            l.child[l.child_count++] = &node->data.if_stmt.else_body;
+            break;
+        case NODE_FOR:
+            l.child[l.child_count++] = &node->data.for_stmt.init;
+            l.child[l.child_count++] = &node->data.for_stmt.condition;
+            l.child[l.child_count++] = &node->data.for_stmt.increment;
+            l.child[l.child_count++] = &node->data.for_stmt.body;
+            break;
+        case NODE_WHILE:
+            l.child[l.child_count++] = &node->data.while_stmt.condition;
+            l.child[l.child_count++] = &node->data.while_stmt.body;
             break;
         case NODE_RETURN:
-            free_ast(node->data.return_stmt.return_value);
+            l.child[l.child_count++] = &node->data.return_stmt.return_value;
             break;
         case NODE_ASSIGN:
-            free_ast(node->data.assign_expr.lvalue);
-            free_ast(node->data.assign_expr.rvalue);
+            l.child[l.child_count++] = &node->data.assign_expr.lvalue;
+            l.child[l.child_count++] = &node->data.assign_expr.rvalue;
             break;
         case NODE_BINARY_OP:
-            if(node->data.binary_op.op) free(node->data.binary_op.op);
-            free_ast(node->data.binary_op.left);
-            free_ast(node->data.binary_op.right);
+            l.str[l.str_count++] = &node->data.binary_op.op;
+            l.child[l.child_count++] = &node->data.binary_op.left;
+            l.child[l.child_count++] = &node->data.binary_op.right;
             break;
         case NODE_UNARY_OP:
-            if(node->data.unary_op.op) free(node->data.unary_op.op);
-            free_ast(node->data.unary_op.operand);
+            l.str[l.str_count++] = &node->data.unary_op.op;
+            l.child[l.child_count++] = &node->data.unary_op.operand;
             break;
         case NODE_FUNC_CALL:
-            if(node->data.func_call.func_name) free(node->data.func_call.func_name);
-            ASTNodeList* args = node->data.func_call.args;
-            while (args) {
-                ASTNodeList* next = args->next;
-                free_ast(args->node);
-                free(args);
-                args = next;
-            }
+            l.str[l.str_count++] = &node->data.func_call.func_name;
+            l.list = &node->data.func_call.args;
             break;
         case NODE_IDENTIFIER:
-            if(node->data.identifier_name) free(node->data.identifier_name);
+            l.str[l.str_count++] = &node->data.identifier_name;
             break;
         case NODE_STRING_LITERAL:
-            if (node->data.string_literal) free(node->data.string_literal);
+            l.str[l.str_count++] = &node->data.string_literal;
             break;
         case NODE_INT_LITERAL:
         case NODE_FLOAT_LITERAL:
         case NODE_CHAR_LITERAL:
-        case NODE_FOR:
             break;
     }
-    free(node);
+    return l;
 }
 
-void print_ast(ASTNode* node, int indent) {
+// Empilha os filhos não nulos de 'node' para que sejam desempilhados na ordem da
+// sintaxe: primeiro a lista (os parâmetros de FuncDef), depois os filhos diretos.
+static void push_children(ASTStack* stack, ASTNode* node) {
+    ASTLayout layout = ast_layout(node);
+    for (int i = layout.child_count - 1; i >= 0; i--) {
+        if (*layout.child[i]) ast_stack_push(stack, *layout.child[i]);
+    }
+    if (layout.list) {
+        int first = stack->count;
+        for (ASTNodeList* l = *layout.list; l; l = l->next) {
+            if (l->node) ast_stack_push(stack, l->node);
+        }
+        for (int i = first, j = stack->count - 1; i < j; i++, j--) {
+            ASTNode* tmp = stack->items[i];
+            stack->items[i] = stack->items[j];
+            stack->items[j] = tmp;
+        }
+    }
+}
+
+void free_ast(ASTNode* node) {
     if (!node) return;
-    for (int i = 0; i < indent; ++i) printf("  ");
+    ASTStack pending = {0};
+    ast_stack_push(&pending, node);
+    while (pending.count > 0) {
+        node = pending.items[--pending.count];
+        ASTLayout layout = ast_layout(node);
+        for (int i = 0; i < layout.child_count; i++) {
+            if (*layout.child[i]) ast_stack_push(&pending, *layout.child[i]);
+        }
+        if (layout.list) {
+            ASTNodeList* current = *layout.list;
+            while (current) {
+                ASTNodeList* next = current->next;
+                if (current->node) ast_stack_push(&pending, current->node);
+                free(current);
+                current = next;
+            }
+        }
+        for (int i = 0; i < layout.str_count; i++) free(*layout.str[i]);
+        free(node);
+    }
+    ast_stack_free(&pending);
+}
+
+// Cria uma cópia profunda da subárvore (nós, listas e strings). A pilha guarda pares
+// (original, cópia): cada cópia é criada vazia e preenchida quando o par é desempilhado.
+ASTNode* clone_ast(ASTNode* node) {
+    if (!node) return NULL;
+    ASTNode* root = create_node(node->type, node->pos);
+    ASTStack pending = {0};
+    ast_stack_push(&pending, node);
+    ast_stack_push(&pending, root);
+    while (pending.count > 0) {
+        ASTNode* copy = pending.items[--pending.count];
+        ASTNode* source = pending.items[--pending.count];
+        copy->value_type = source->value_type;
+        if (source->type == NODE_INT_LITERAL || source->type == NODE_FLOAT_LITERAL ||
+            source->type == NODE_CHAR_LITERAL) {
+            copy->data = source->data;
+            continue;
+        }
+
+        ASTLayout from = ast_layout(source);
+        ASTLayout to = ast_layout(copy);
+        for (int i = 0; i < from.str_count; i++) *to.str[i] = safe_strdup(*from.str[i]);
+        for (int i = 0; i < from.child_count; i++) {
+            ASTNode* child = *from.child[i];
+            if (!child) continue;
+            *to.child[i] = create_node(child->type, child->pos);
+            ast_stack_push(&pending, child);
+            ast_stack_push(&pending, *to.child[i]);
+        }
+        if (from.list) {
+            ASTNodeList** tail = to.list;
+            for (ASTNodeList* l = *from.list; l; l = l->next) {
+                *tail = create_node_list(l->node ? create_node(l->node->type, l->node->pos) : NULL);
+                if (l->node) {
+                    ast_stack_push(&pending, l->node);
+                    ast_stack_push(&pending, (*tail)->node);
+                }
+                tail = &(*tail)->next;
+            }
+        }
+    }
+    ast_stack_free(&pending);
+    return root;
+}
+
+// Compara duas expressões estruturalmente (mesma forma, operadores, nomes e valores).
+// Segue a espinha esquerda em laço; só os operandos direitos, cuja profundidade é
+// limitada pelo aninhamento aceito pelo parser, são comparados recursivamente.
+int ast_equal(ASTNode* a, ASTNode* b) {
+    for (;;) {
+        if (a == b) return 1;
+        if (!a || !b || a->type != b->type) return 0;
+        switch (a->type) {
+            case NODE_IDENTIFIER:
+                return strcmp(a->data.identifier_name, b->data.identifier_name) == 0;
+            case NODE_INT_LITERAL:
+                return a->data.int_literal == b->data.int_literal;
+            case NODE_FLOAT_LITERAL:
+                return a->data.float_literal == b->data.float_literal;
+            case NODE_CHAR_LITERAL:
+                return a->data.char_literal == b->data.char_literal;
+            case NODE_STRING_LITERAL:
+                return strcmp(a->data.string_literal, b->data.string_literal) == 0;
+            case NODE_BINARY_OP:
+                if (strcmp(a->data.binary_op.op, b->data.binary_op.op) != 0 ||
+                    !ast_equal(a->data.binary_op.right, b->data.binary_op.right)) {
+                    return 0;
+                }
+                a = a->data.binary_op.left;
+                b = b->data.binary_op.left;
+                break;
+            case NODE_UNARY_OP:
+                if (strcmp(a->data.unary_op.op, b->data.unary_op.op) != 0) return 0;
+                a = a->data.unary_op.operand;
+                b = b->data.unary_op.operand;
+                break;
+            case NODE_ASSIGN:
+                if (!ast_equal(a->data.assign_expr.lvalue, b->data.assign_expr.lvalue)) return 0;
+                a = a->data.assign_expr.rvalue;
+                b = b->data.assign_expr.rvalue;
+                break;
+            case NODE_FUNC_CALL: {
+                if (strcmp(a->data.func_call.func_name, b->data.func_call.func_name) != 0) return 0;
+                ASTNodeList* la = a->data.func_call.args;
+                ASTNodeList* lb = b->data.func_call.args;
+                for (; la && lb; la = la->next, lb = lb->next) {
+                    if (!ast_equal(la->node, lb->node)) return 0;
+                }
+                return la == NULL && lb == NULL;
+            }
+            default:
+                return 0; // Comandos não são comparados
+        }
+    }
+}
+
+// Conta os nós da subárvore (usado pelo relatório de estatísticas).
+int count_ast_nodes(ASTNode* node) {
+    if (!node) return 0;
+    int count = 0;
+    ASTStack pending = {0};
+    ast_stack_push(&pending, node);
+    while (pending.count > 0) {
+        node = pending.items[--pending.count];
+        count++;
+        push_children(&pending, node);
+    }
+    ast_stack_free(&pending);
+    return count;
+}
+
+// Nos percursos com nível, um NULL empilhado depois de um nó marca o fim dos seus
+// filhos (os filhos nulos nunca são empilhados).
+int ast_depth(ASTNode* node) {
+    if (!node) return 0;
+    int depth = 0, max_depth = 0;
+    ASTStack pending = {0};
+    ast_stack_push(&pending, node);
+    while (pending.count > 0) {
+        node = pending.items[--pending.count];
+        if (!node) {
+            depth--;
+            continue;
+        }
+        if (++depth > max_depth) max_depth = depth;
+        ast_stack_push(&pending, NULL);
+        push_children(&pending, node);
+    }
+    ast_stack_free(&pending);
+    return max_depth;
+}
+
+int ast_is_integer(ASTNode* node) {
+    int integer = 1;
+    ASTStack pending = {0};
+    ast_stack_push(&pending, node);
+    while (integer && pending.count > 0) {
+        node = pending.items[--pending.count];
+        switch (node->type) {
+            case NODE_INT_LITERAL:
+                break;
+            case NODE_IDENTIFIER:
+                integer = node->value_type == TYPE_INT;
+                break;
+            case NODE_UNARY_OP:
+                if (strcmp(node->data.unary_op.op, "!") != 0) ast_stack_push(&pending, node->data.unary_op.operand);
+                break;
+            case NODE_BINARY_OP: {
+                const char* op = node->data.binary_op.op;
+                if (node->value_type != TYPE_INT) {
+                    integer = 0;
+                } else if (strcmp(op, "<<") == 0) {
+                    ast_stack_push(&pending, node->data.binary_op.left);
+                } else if (strcmp(op, "+") == 0 || strcmp(op, "-") == 0 || strcmp(op, "*") == 0 || strcmp(op, "%") == 0) {
+                    ast_stack_push(&pending, node->data.binary_op.left);
+                    ast_stack_push(&pending, node->data.binary_op.right);
+                }
+                // Comparações e operadores lógicos valem 0 ou 1, e a divisão inteira é
+                // emitida como int(a / b)
+                break;
+            }
+            default:
+                integer = 0;
+                break;
+        }
+    }
+    ast_stack_free(&pending);
+    return integer;
+}
+
+// A partir deste nível, a indentação deixa de crescer e o nível é impresso por extenso:
+// a saída de uma espinha com um milhão de nós continua linear no tamanho da árvore.
+#define PRINT_AST_MAX_INDENT 40
+
+static void print_ast_line(ASTNode* node, int indent) {
+    int spaces = indent < PRINT_AST_MAX_INDENT ? indent : PRINT_AST_MAX_INDENT;
+    printf("%*s", 2 * spaces, "");
+    if (indent > PRINT_AST_MAX_INDENT) printf("[nível %d] ", indent);
 
     switch (node->type) {
         case NODE_PROGRAM:
             printf("Program\n");
-            for (ASTNodeList* l = node->data.program.declarations; l; l = l->next) {
-                print_ast(l->node, indent + 1);
-            }
             break;
         case NODE_VAR_DECL:
             printf("VarDecl: %s %s\n", node->data.var_decl.type_name, node->data.var_decl.var_name);
-            if (node->data.var_decl.initial_value) {
-                print_ast(node->data.var_decl.initial_value, indent + 1);
-            }
             break;
         case NODE_FUNC_DEF:
             printf("FuncDef: fun %s\n", node->data.func_def.func_name);
-            for (ASTNodeList* l = node->data.func_def.params; l; l = l->next) {
-                print_ast(l->node, indent + 1);
-            }
-            print_ast(node->data.func_def.body, indent + 1);
             break;
         case NODE_MAIN_DEF:
             printf("MainDef\n");
-            print_ast(node->data.main_def.body, indent + 1);
             break;
         case NODE_PARAM:
             printf("Param: %s %s\n", node->data.param.type_name, node->data.param.param_name);
             break;
         case NODE_BLOCK:
             printf("Block\n");
-            for (ASTNodeList* l = node->data.block.statements; l; l = l->next) {
-                print_ast(l->node, indent + 1);
-            }
             break;
         case NODE_IF:
             printf("If\n");
-            print_ast(node->data.if_stmt.condition, indent + 1);
-            print_ast(node->data.if_stmt.if_body, indent + 1);
-            if (node->data.if_stmt.else_body) {
-                print_ast(node->data.if_stmt.else_body, indent + 1);
-            }
+            break;
+        case NODE_FOR:
+            printf("For\n");
+            break;
+        case NODE_WHILE:
+            printf("While\n");
             break;
         case NODE_RETURN:
             printf("Return\n");
-            print_ast(node->data.return_stmt.return_value, indent + 1);
             break;
         case NODE_ASSIGN:
             printf("Assign\n");
-            print_ast(node->data.assign_expr.lvalue, indent + 1);
-            print_ast(node->data.assign_expr.rvalue, indent + 1);
             break;
         case NODE_BINARY_OP:
             printf("BinaryOp: %s\n", node->data.binary_op.op);
-            print_ast(node->data.binary_op.left, indent + 1);
-            print_ast(node->data.binary_op.right, indent + 1);
             break;
         case NODE_UNARY_OP:
             printf("UnaryOp: %s\n", node->data.unary_op.op);
-            print_ast(node->data.unary_op.operand, indent + 1);
             break;
         case NODE_FUNC_CALL:
             printf("FuncCall: %s\n", node->data.func_call.func_name);
-            for (ASTNodeList* l = node->data.func_call.args; l; l = l->next) {
-                print_ast(l->node, indent + 1);
-            }
             break;
         case NODE_IDENTIFIER:
             printf("Identifier: %s\n", node->data.identifier_name);
@@ -244,6 +473,9 @@ void print_ast(ASTNode* node, int indent) {
         case NODE_INT_LITERAL:
             printf("Int: %d\n", node->data.int_literal);
             break;
+        case NODE_FLOAT_LITERAL:
+            printf("Float: %f\n", node->data.float_literal);
+            break;
         case NODE_STRING_LITERAL:
              printf("String: %s\n", node->data.string_literal);
              break;
@@ -253,11 +485,29 @@ void print_ast(ASTNode* node, int indent) {
     }
 }
 
+void print_ast(ASTNode* node, int indent) {
+    if (!node) return;
+    ASTStack pending = {0};
+    ast_stack_push(&pending, node);
+    while (pending.count > 0) {
+        node = pending.items[--pending.count];
+        if (!node) {
+            indent--;
+            continue;
+        }
+        print_ast_line(node, indent++);
+        ast_stack_push(&pending, NULL);
+        push_children(&pending, node);
+    }
+    ast_stack_free(&pending);
+}
+
 
 // --- Funções de Controlo do Parser ---
 static void advance_and_skip_comments() {
     do {
         current_token = next_token(source_code_ptr, &current_parser_index);
+        tokens_read++;
     } while (current_token.type == TOKEN_COMMENT);
 }
 
@@ -293,21 +543,62 @@ static void eat(TokenType type, const char* expected_lexeme) {
 }
 
 static void syntax_error(const char* message) {
-    fprintf(stderr, "\nErro Sintático (Linha %d, Coluna %d): %s\n",
-            current_token.line, current_token.column, message);
-    exit(EXIT_FAILURE);
+    report_error("\nErro Sintático (Linha %d, Coluna %d): %s\n",
+                 current_token.line, current_token.column, message);
+    fatal_error();
+}
+
+static void enter_nesting() {
+    if (++nesting_depth > max_nesting_depth) {
+        char error_msg[128];
+        sprintf(error_msg, "Aninhamento excede o limite de %d níveis.", max_nesting_depth);
+        syntax_error(error_msg);
+    }
+}
+
+static void leave_nesting() {
+    nesting_depth--;
+}
+
+void set_max_nesting_depth(int depth) {
+    max_nesting_depth = depth > 0 ? depth : DEFAULT_MAX_NESTING_DEPTH;
 }
 
 static char* safe_strdup(const char* s) {
     if (!s) return NULL;
     char* new_s = strdup(s);
     if (!new_s) {
-        fprintf(stderr, "Erro de Memória: falha ao alocar memória.\n");
-        exit(EXIT_FAILURE);
+        report_error("Erro de Memória: falha ao alocar memória.\n");
+        fatal_error();
     }
+    track_allocation(new_s);
     return new_s;
 }
 
+static void track_allocation(void* p) {
+    if (!tracking_allocations) return;
+    if (parse_allocation_count == parse_allocation_capacity) {
+        int capacity = parse_allocation_capacity ? parse_allocation_capacity * 2 : 1024;
+        void** grown = realloc(parse_allocations, capacity * sizeof(void*));
+        if (!grown) {
+            tracking_allocations = 0; // Sem espaço para registrar: a árvore parcial vaza
+            report_error("Erro de Memória: falha ao alocar memória.\n");
+            fatal_error();
+        }
+        parse_allocations = grown;
+        parse_allocation_capacity = capacity;
+    }
+    parse_allocations[parse_allocation_count++] = p;
+}
+
+void discard_partial_parse() {
+    for (int i = 0; i < parse_allocation_count; i++) free(parse_allocations[i]);
+    free(parse_allocations);
+    parse_allocations = NULL;
+    parse_allocation_count = parse_allocation_capacity = 0;
+    tracking_allocations = 0;
+}
+
 // --- Implementação das Funções de Parsing ---
 
 ASTNode* parse_program(const char* source) {
@@ -316,26 +607,31 @@ ASTNode* parse_program(const char* source) {
     current_pos.line = 1;
     current_pos.column = 1;
     main_block_found_flag = 0;
+    tokens_read = 0;
+    nesting_depth = 0;
+    parse_allocation_count = 0;
+    tracking_allocations = 1;
 
     advance_and_skip_comments();
 
     ASTNode* program_node = create_node(NODE_PROGRAM, (Position){1, 1});
     program_node->data.program.declarations = NULL;
+    ASTNodeList** tail = &program_node->data.program.declarations;
 
     while (!token_is(TOKEN_EOF, NULL)) {
         if (token_is(TOKEN_KEYWORD, "main")) {
             if (main_block_found_flag) {
                 syntax_error("Múltiplos blocos 'main' definidos.");
             }
-            ASTNode* main_node = parse_main_function_definition();
-            program_node->data.program.declarations = append_node_list(program_node->data.program.declarations, main_node);
+            *tail = create_node_list(parse_main_function_definition());
+            tail = &(*tail)->next;
             main_block_found_flag = 1;
         } else if (is_type_specifier(current_token) || token_is(TOKEN_KEYWORD, "fun")) {
             if (main_block_found_flag) {
                 syntax_error("Declaração encontrada após o bloco 'main'.");
             }
-            ASTNode* top_level_decl = parse_top_level_declaration();
-            program_node->data.program.declarations = append_node_list(program_node->data.program.declarations, top_level_decl);
+            *tail = create_node_list(parse_top_level_declaration());
+            tail = &(*tail)->next;
         } else {
             syntax_error("Token inesperado no nível superior. Esperava uma declaração ou o bloco 'main'.");
         }
@@ -344,10 +640,17 @@ ASTNode* parse_program(const char* source) {
     if (!main_block_found_flag) {
         syntax_error("Bloco 'main' obrigatório não encontrado.");
     }
-    
+
+    // A árvore está completa: as alocações passam a pertencer a ela
+    tracking_allocations = 0;
+    parse_allocation_count = 0;
     return program_node;
 }
 
+int get_token_count() {
+    return tokens_read;
+}
+
 static ASTNode* parse_top_level_declaration() {
     if (token_is(TOKEN_KEYWORD, "fun")) {
         return parse_standard_function_definition();
@@ -364,7 +667,6 @@ static ASTNode* parse_variable_declaration() {
     eat(TOKEN_KEYWORD, NULL);
 
     if (current_token.type != TOKEN_IDENTIFIER) {
-        free(type_name);
         syntax_error("Esperava um identificador na declaração de variável.");
     }
     char* var_name = safe_strdup(current_token.lexeme);
@@ -408,9 +710,10 @@ static ASTNode* parse_standard_function_definition() {
 
 static ASTNodeList* parse_parameter_list() {
     ASTNodeList* list = create_node_list(parse_parameter());
+    ASTNodeList* last = list;
     while (token_is(TOKEN_DELIMITER, ",")) {
         eat(TOKEN_DELIMITER, ",");
-        list = append_node_list(list, parse_parameter());
+        last = last->next = create_node_list(parse_parameter());
     }
     return list;
 }
@@ -451,19 +754,26 @@ static ASTNode* parse_block_statement() {
 
 static ASTNodeList* parse_statement_list() {
     ASTNodeList* list = NULL;
+    ASTNodeList** tail = &list;
     while (!token_is(TOKEN_DELIMITER, "}") && !token_is(TOKEN_EOF, NULL)) {
-        list = append_node_list(list, parse_statement());
+        *tail = create_node_list(parse_statement());
+        tail = &(*tail)->next;
     }
     return list;
 }
 
 static ASTNode* parse_statement() {
-    if (is_type_specifier(current_token)) return parse_variable_declaration();
-    if (token_is(TOKEN_KEYWORD, "if")) return parse_if_statement();
-    if (token_is(TOKEN_KEYWORD, "for")) return parse_for_statement();
-    if (token_is(TOKEN_KEYWORD, "return")) return parse_return_statement();
-    if (token_is(TOKEN_DELIMITER, "{")) return parse_block_statement();
-    return parse_expression_statement();
+    ASTNode* node;
+    enter_nesting();
+    if (is_type_specifier(current_token)) node = parse_variable_declaration();
+    else if (token_is(TOKEN_KEYWORD, "if")) node = parse_if_statement();
+    else if (token_is(TOKEN_KEYWORD, "for")) node = parse_for_statement();
+    else if (token_is(TOKEN_KEYWORD, "while")) node = parse_while_statement();
+    else if (token_is(TOKEN_KEYWORD, "return")) node = parse_return_statement();
+    else if (token_is(TOKEN_DELIMITER, "{")) node = parse_block_statement();
+    else node = parse_expression_statement();
+    leave_nesting();
+    return node;
 }
 
 static ASTNode* parse_expression_statement() {
@@ -504,120 +814,102 @@ static ASTNode* parse_return_statement() {
     return node;
 }
 
-static ASTNode* parse_for_statement() { 
-    syntax_error("O parsing do comando 'for' ainda não foi implementado.");
-    return NULL; 
-}
-
-static ASTNode* parse_expression() {
-    return parse_assignment_expression();
-}
+// for (init; cond; inc) corpo — cada uma das três partes pode ser omitida.
+// O init pode ser uma declaração de variável ou uma expressão.
+static ASTNode* parse_for_statement() {
+    Position pos = { .line = current_token.line, .column = current_token.column };
+    eat(TOKEN_KEYWORD, "for");
+    eat(TOKEN_DELIMITER, "(");
 
-static ASTNode* parse_assignment_expression() {
-    ASTNode* left = parse_logical_or_expression();
-    if (token_is(TOKEN_OPERATOR, "=")) {
-        Position pos = { .line = current_token.line, .column = current_token.column };
-        eat(TOKEN_OPERATOR, "=");
-        ASTNode* right = parse_assignment_expression();
-        if (left->type != NODE_IDENTIFIER) {
-            syntax_error("O lado esquerdo de uma atribuição deve ser um identificador.");
-        }
-        ASTNode* node = create_node(NODE_ASSIGN, pos);
-        node->data.assign_expr.lvalue = left;
-        node->data.assign_expr.rvalue = right;
-        return node;
+    ASTNode* init = NULL;
+    if (is_type_specifier(current_token)) {
+        init = parse_variable_declaration(); // Já consome o ';'
+    } else if (!token_is(TOKEN_DELIMITER, ";")) {
+        init = parse_expression_statement();
+    } else {
+        eat(TOKEN_DELIMITER, ";");
     }
-    return left;
-}
 
-static ASTNode* parse_logical_or_expression() {
-    ASTNode* node = parse_logical_and_expression();
-    while (token_is(TOKEN_OPERATOR, "||")) {
-        Position pos = { .line = current_token.line, .column = current_token.column };
-        char* op = safe_strdup(current_token.lexeme);
-        eat(TOKEN_OPERATOR, "||");
-        ASTNode* right = parse_logical_and_expression();
-        ASTNode* new_node = create_node(NODE_BINARY_OP, pos);
-        new_node->data.binary_op.op = op;
-        new_node->data.binary_op.left = node;
-        new_node->data.binary_op.right = right;
-        node = new_node;
+    ASTNode* condition = NULL;
+    if (!token_is(TOKEN_DELIMITER, ";")) {
+        condition = parse_expression();
     }
-    return node;
-}
+    eat(TOKEN_DELIMITER, ";");
 
-static ASTNode* parse_logical_and_expression() {
-    ASTNode* node = parse_equality_expression();
-    while (token_is(TOKEN_OPERATOR, "&&")) {
-        Position pos = { .line = current_token.line, .column = current_token.column };
-        char* op = safe_strdup(current_token.lexeme);
-        eat(TOKEN_OPERATOR, "&&");
-        ASTNode* right = parse_equality_expression();
-        ASTNode* new_node = create_node(NODE_BINARY_OP, pos);
-        new_node->data.binary_op.op = op;
-        new_node->data.binary_op.left = node;
-        new_node->data.binary_op.right = right;
-        node = new_node;
+    ASTNode* increment = NULL;
+    if (!token_is(TOKEN_DELIMITER, ")")) {
+        increment = parse_expression();
     }
+    eat(TOKEN_DELIMITER, ")");
+
+    ASTNode* node = create_node(NODE_FOR, pos);
+    node->data.for_stmt.init = init;
+    node->data.for_stmt.condition = condition;
+    node->data.for_stmt.increment = increment;
+    node->data.for_stmt.body = parse_statement();
     return node;
 }
 
-static ASTNode* parse_equality_expression() {
-    ASTNode* node = parse_relational_expression();
-    while (token_is(TOKEN_OPERATOR, "==") || token_is(TOKEN_OPERATOR, "!=")) {
-        Position pos = { .line = current_token.line, .column = current_token.column };
-        char* op = safe_strdup(current_token.lexeme);
-        eat(TOKEN_OPERATOR, NULL);
-        ASTNode* right = parse_relational_expression();
-        ASTNode* new_node = create_node(NODE_BINARY_OP, pos);
-        new_node->data.binary_op.op = op;
-        new_node->data.binary_op.left = node;
-        new_node->data.binary_op.right = right;
-        node = new_node;
-    }
+static ASTNode* parse_while_statement() {
+    Position pos = { .line = current_token.line, .column = current_token.column };
+    eat(TOKEN_KEYWORD, "while");
+    eat(TOKEN_DELIMITER, "(");
+    ASTNode* condition = parse_expression();
+    eat(TOKEN_DELIMITER, ")");
+    ASTNode* node = create_node(NODE_WHILE, pos);
+    node->data.while_stmt.condition = condition;
+    node->data.while_stmt.body = parse_statement();
     return node;
 }
 
-static ASTNode* parse_relational_expression() {
-    ASTNode* node = parse_additive_expression();
-    while (token_is(TOKEN_OPERATOR, "<") || token_is(TOKEN_OPERATOR, ">") ||
-           token_is(TOKEN_OPERATOR, "<=") || token_is(TOKEN_OPERATOR, ">=")) {
-        Position pos = { .line = current_token.line, .column = current_token.column };
-        char* op = safe_strdup(current_token.lexeme);
-        eat(TOKEN_OPERATOR, NULL);
-        ASTNode* right = parse_additive_expression();
-        ASTNode* new_node = create_node(NODE_BINARY_OP, pos);
-        new_node->data.binary_op.op = op;
-        new_node->data.binary_op.left = node;
-        new_node->data.binary_op.right = right;
-        node = new_node;
-    }
+static ASTNode* parse_expression() {
+    enter_nesting();
+    ASTNode* node = parse_assignment_expression();
+    leave_nesting();
     return node;
 }
 
-static ASTNode* parse_additive_expression() {
-    ASTNode* node = parse_multiplicative_expression();
-    while (token_is(TOKEN_OPERATOR, "+") || token_is(TOKEN_OPERATOR, "-")) {
+static ASTNode* parse_assignment_expression() {
+    ASTNode* left = parse_binary_expression(1);
+    if (current_token.op == OP_ASSIGN) {
         Position pos = { .line = current_token.line, .column = current_token.column };
-        char* op = safe_strdup(current_token.lexeme);
         eat(TOKEN_OPERATOR, NULL);
-        ASTNode* right = parse_multiplicative_expression();
-        ASTNode* new_node = create_node(NODE_BINARY_OP, pos);
-        new_node->data.binary_op.op = op;
-        new_node->data.binary_op.left = node;
-        new_node->data.binary_op.right = right;
-        node = new_node;
+        enter_nesting();
+        ASTNode* right = parse_assignment_expression();
+        leave_nesting();
+        if (left->type != NODE_IDENTIFIER) {
+            syntax_error("O lado esquerdo de uma atribuição deve ser um identificador.");
+        }
+        ASTNode* node = create_node(NODE_ASSIGN, pos);
+        node->data.assign_expr.lvalue = left;
+        node->data.assign_expr.rvalue = right;
+        return node;
     }
-    return node;
+    return left;
 }
 
-static ASTNode* parse_multiplicative_expression() {
+// Precedência dos operadores binários, indexada pelo subtipo do token (0: não é um
+// operador binário). Todos os níveis são associativos à esquerda.
+static const int binary_precedence[OP_KIND_COUNT] = {
+    [OP_OR] = 1,
+    [OP_AND] = 2,
+    [OP_EQUAL] = 3, [OP_NOT_EQUAL] = 3,
+    [OP_LESS] = 4, [OP_GREATER] = 4, [OP_LESS_EQUAL] = 4, [OP_GREATER_EQUAL] = 4,
+    [OP_PLUS] = 5, [OP_MINUS] = 5,
+    [OP_STAR] = 6, [OP_SLASH] = 6,
+};
+
+// Precedence climbing: consome os operadores com precedência >= min_precedence.
+// O operando direito só aceita operadores de precedência maior, o que mantém a
+// associatividade à esquerda.
+static ASTNode* parse_binary_expression(int min_precedence) {
     ASTNode* node = parse_unary_expression();
-    while (token_is(TOKEN_OPERATOR, "*") || token_is(TOKEN_OPERATOR, "/")) {
+    int precedence;
+    while ((precedence = binary_precedence[current_token.op]) >= min_precedence) {
         Position pos = { .line = current_token.line, .column = current_token.column };
         char* op = safe_strdup(current_token.lexeme);
         eat(TOKEN_OPERATOR, NULL);
-        ASTNode* right = parse_unary_expression();
+        ASTNode* right = parse_binary_expression(precedence + 1);
         ASTNode* new_node = create_node(NODE_BINARY_OP, pos);
         new_node->data.binary_op.op = op;
         new_node->data.binary_op.left = node;
@@ -628,11 +920,13 @@ static ASTNode* parse_multiplicative_expression() {
 }
 
 static ASTNode* parse_unary_expression() {
-    if (token_is(TOKEN_OPERATOR, "-") || token_is(TOKEN_OPERATOR, "!")) {
+    if (current_token.op == OP_MINUS || current_token.op == OP_NOT) {
         Position pos = { .line = current_token.line, .column = current_token.column };
         char* op = safe_strdup(current_token.lexeme);
         eat(TOKEN_OPERATOR, NULL);
+        enter_nesting();
         ASTNode* operand = parse_unary_expression();
+        leave_nesting();
         ASTNode* node = create_node(NODE_UNARY_OP, pos);
         node->data.unary_op.op = op;
         node->data.unary_op.operand = operand;
@@ -662,6 +956,11 @@ static ASTNode* parse_primary_expression() {
         int len = strlen(current_token.lexeme);
         if (len > 1) {
             char* str_content = (char*)malloc(len - 1);
+            if (!str_content) {
+                report_error("Erro de Memória: falha ao alocar memória.\n");
+                fatal_error();
+            }
+            track_allocation(str_content);
             strncpy(str_content, current_token.lexeme + 1, len - 2);
             str_content[len - 2] = '\0';
             node->data.string_literal = str_content;
@@ -704,9 +1003,10 @@ static ASTNode* parse_primary_expression() {
 
 static ASTNodeList* parse_argument_list() {
     ASTNodeList* list = create_node_list(parse_expression());
+    ASTNodeList* last = list;
     while (token_is(TOKEN_DELIMITER, ",")) {
         eat(TOKEN_DELIMITER, ",");
-        list = append_node_list(list, parse_expression());
+        last = last->next = create_node_list(parse_expression());
     }
     return list;
 }
@@ -4,6 +4,20 @@
 #include "analisador.h"
 #include "ast.h"
 
+// Limite padrão de níveis de aninhamento aceitos pelo parser
+#define DEFAULT_MAX_NESTING_DEPTH 10000
+
 ASTNode* parse_program(const char* source_code);
 
+// Define o limite de aninhamento das próximas análises (<= 0 volta ao padrão).
+// Um programa mais aninhado é rejeitado com um erro sintático.
+void set_max_nesting_depth(int depth);
+
+// Número de tokens lidos pelo último parse_program (inclui o EOF)
+int get_token_count();
+
+// Libera a árvore parcial de um parse_program interrompido por fatal_error
+// (ver diagnosticos.h); não faz nada se a última análise terminou normalmente.
+void discard_partial_parse();
+
 #endif // PARSER_H
\ No newline at end of file
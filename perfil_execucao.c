@@ -0,0 +1,143 @@
+// Define _DEFAULT_SOURCE para habilitar getline
+#define _DEFAULT_SOURCE
+
+#include "perfil_execucao.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "diagnosticos.h"
+
+#define FNV_OFFSET 1469598103934665603ULL
+#define FNV_PRIME 1099511628211ULL
+
+static unsigned long long fnv_update(unsigned long long hash, const char* data, long length) {
+    for (long i = 0; i < length; i++) hash = (hash ^ (unsigned char)data[i]) * FNV_PRIME;
+    return hash;
+}
+
+unsigned long long profile_source_hash(const char* source, long length) {
+    unsigned long long hash = fnv_update(FNV_OFFSET, source, length);
+    return hash ? hash : 1;
+}
+
+static unsigned long key_bucket(const char* key) {
+    unsigned long hash = 5381;
+    for (const char* c = key; *c; c++) hash = ((hash << 5) + hash) + (unsigned char)*c;
+    return hash % PROFILE_BUCKETS;
+}
+
+static ProfileEntry* find_entry(const ExecutionProfile* profile, const char* key) {
+    for (ProfileEntry* e = profile->buckets[key_bucket(key)]; e; e = e->next) {
+        if (strcmp(e->key, key) == 0) return e;
+    }
+    return NULL;
+}
+
+// Soma a contagem à do local (criado se ainda não existe). Devolve 1 se o local é novo.
+static int add_count(ExecutionProfile* profile, const char* key, long long count) {
+    ProfileEntry* entry = find_entry(profile, key);
+    if (entry) {
+        entry->count += count;
+        return 0;
+    }
+    entry = (ProfileEntry*)malloc(sizeof(ProfileEntry));
+    char* copy = strdup(key);
+    if (!entry || !copy) {
+        report_error("Erro de Memória: falha ao alocar memória para o perfil.\n");
+        fatal_error();
+    }
+    unsigned long bucket = key_bucket(key);
+    entry->key = copy;
+    entry->count = count;
+    entry->next = profile->buckets[bucket];
+    profile->buckets[bucket] = entry;
+    return 1;
+}
+
+// Interpreta uma linha do perfil. Devolve 0 se ela não está no formato.
+static int parse_line(ExecutionProfile* profile, const char* line) {
+    char kind[16], name[1024], key[1100];
+    long long count;
+    int line_number, column, end = 0;
+    if (line[0] == '\0' || line[0] == '#') return 1;
+    if (sscanf(line, "fonte %llx %n", &profile->source_hash, &end) == 1 && line[end] == '\0') return 1;
+    if (sscanf(line, PROFILE_CALLS " %1023s %lld %n", name, &count, &end) == 2 && line[end] == '\0' && count >= 0) {
+        snprintf(key, sizeof(key), PROFILE_CALLS " %s", name);
+        profile->functions += add_count(profile, key, count);
+        profile->total_calls += count;
+        return 1;
+    }
+    if (sscanf(line, "%15s %d %d %lld %n", kind, &line_number, &column, &count, &end) == 4 && line[end] == '\0' &&
+        count >= 0 && (strcmp(kind, PROFILE_THEN) == 0 || strcmp(kind, PROFILE_ELSE) == 0)) {
+        snprintf(key, sizeof(key), "%s %d %d", kind, line_number, column);
+        int added = add_count(profile, key, count);
+        if (strcmp(kind, PROFILE_THEN) == 0) profile->branches += added;
+        return 1;
+    }
+    return 0;
+}
+
+int profile_load(const char* filename, ExecutionProfile* profile) {
+    memset(profile, 0, sizeof(*profile));
+    FILE* file = fopen(filename, "r");
+    if (!file) {
+        report_error("Não foi possível abrir o perfil '%s': %s\n", filename, strerror(errno));
+        return 0;
+    }
+    char* line = NULL;
+    size_t capacity = 0;
+    ssize_t length;
+    int line_number = 0;
+    unsigned long long hash = FNV_OFFSET;
+    while ((length = getline(&line, &capacity, file)) >= 0) {
+        line_number++;
+        hash = fnv_update(hash, line, (long)length);
+        while (length > 0 && (line[length - 1] == '\n' || line[length - 1] == '\r')) line[--length] = '\0';
+        if (!parse_line(profile, line)) {
+            report_error("Perfil '%s', linha %d: linha inválida.\n", filename, line_number);
+            free(line);
+            fclose(file);
+            profile_free(profile);
+            return 0;
+        }
+    }
+    free(line);
+    fclose(file);
+    profile->content_hash = hash;
+    return 1;
+}
+
+void profile_free(ExecutionProfile* profile) {
+    for (int i = 0; i < PROFILE_BUCKETS; i++) {
+        ProfileEntry* e = profile->buckets[i];
+        while (e) {
+            ProfileEntry* next = e->next;
+            free(e->key);
+            free(e);
+            e = next;
+        }
+        profile->buckets[i] = NULL;
+    }
+}
+
+int profile_function_calls(const ExecutionProfile* profile, const char* name, long long* calls) {
+    char key[1100];
+    snprintf(key, sizeof(key), PROFILE_CALLS " %s", name);
+    ProfileEntry* entry = find_entry(profile, key);
+    if (!entry) return 0;
+    *calls = entry->count;
+    return 1;
+}
+
+int profile_branch_counts(const ExecutionProfile* profile, Position pos, long long* taken, long long* not_taken) {
+    char key[64];
+    snprintf(key, sizeof(key), PROFILE_THEN " %d %d", pos.line, pos.column);
+    ProfileEntry* then_entry = find_entry(profile, key);
+    snprintf(key, sizeof(key), PROFILE_ELSE " %d %d", pos.line, pos.column);
+    ProfileEntry* else_entry = find_entry(profile, key);
+    if (!then_entry || !else_entry) return 0;
+    *taken = then_entry->count;
+    *not_taken = else_entry->count;
+    return 1;
+}
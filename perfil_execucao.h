@@ -0,0 +1,77 @@
+#ifndef PERFIL_EXECUCAO_H
+#define PERFIL_EXECUCAO_H
+
+#include "ast.h"
+
+// --- Perfil de Execução ---
+//
+// Um programa compilado com --instrument conta, durante a execução, as chamadas a cada
+// função e quantas vezes cada 'if' seguiu por cada ramo, e grava as contagens ao
+// terminar (inclusive por erro) em um arquivo de texto, uma contagem por linha:
+//
+//     # perfil de execução
+//     fonte 0123456789abcdef
+//     chamadas <função> <n>
+//     entao <linha> <coluna> <n>
+//     senao <linha> <coluna> <n>
+//
+// Os 'if' são identificados pela posição no código-fonte, que as cópias feitas pelo
+// otimizador (expansão inline, desenrolamento) preservam; linhas repetidas são somadas.
+// A linha 'fonte' é o hash do código-fonte, para que o perfil de outra versão do
+// programa não seja aplicado. Um local ausente do perfil não tem informação (por
+// exemplo, uma função cujas chamadas foram todas expandidas inline); um local com
+// contagem zero nunca foi executado.
+
+#define PROFILE_DEFAULT_FILE "perfil.txt"
+#define PROFILE_HEADER "# perfil de execução"
+#define PROFILE_CALLS "chamadas"
+#define PROFILE_THEN "entao"
+#define PROFILE_ELSE "senao"
+
+#define PROFILE_BUCKETS 211
+
+typedef struct ProfileEntry {
+    char* key;  // "chamadas f", "entao 12 5" ou "senao 12 5"
+    long long count;
+    struct ProfileEntry* next;
+} ProfileEntry;
+
+typedef struct {
+    ProfileEntry* buckets[PROFILE_BUCKETS];
+    unsigned long long source_hash;  // 0 se desconhecido
+    unsigned long long content_hash; // Hash das contagens (entra na chave do cache)
+    long long total_calls;           // Soma das chamadas de todas as funções
+    int functions;
+    int branches;                    // Número de 'if' distintos
+} ExecutionProfile;
+
+/**
+ * @brief Hash (FNV-1a de 64 bits) do código-fonte, gravado no perfil pelo código
+ * instrumentado e conferido ao usar o perfil. Nunca devolve 0 (reservado para
+ * "desconhecido", como na compilação a partir de uma AST binária).
+ */
+unsigned long long profile_source_hash(const char* source, long length);
+
+/**
+ * @brief Lê um perfil gravado pelo código instrumentado.
+ * @return 1 se o arquivo foi lido; 0 (após mostrar o erro) se não existe ou tem uma
+ * linha inválida.
+ */
+int profile_load(const char* filename, ExecutionProfile* profile);
+
+void profile_free(ExecutionProfile* profile);
+
+/**
+ * @brief Chamadas à função na execução medida.
+ * @return 0 se a função não aparece no perfil.
+ */
+int profile_function_calls(const ExecutionProfile* profile, const char* name, long long* calls);
+
+/**
+ * @brief Quantas vezes o 'if' na posição dada seguiu pelo ramo 'então' e pelo 'senão'
+ * (que conta também as vezes em que um 'if' sem 'else' não executou nada).
+ * @return 0 se o 'if' não aparece no perfil.
+ */
+int profile_branch_counts(const ExecutionProfile* profile, Position pos, long long* taken, long long* not_taken);
+
+#endif // PERFIL_EXECUCAO_H
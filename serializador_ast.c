@@ -0,0 +1,522 @@
+// Define _DEFAULT_SOURCE para habilitar mmap
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "serializador_ast.h"
+
+// Garante espaço para 'needed' itens, dobrando a capacidade
+static void* grow(void* array, uint32_t* capacity, uint32_t needed, size_t item_size) {
+    if (needed <= *capacity) return array;
+    uint32_t new_capacity = *capacity ? *capacity : 64;
+    while (new_capacity < needed) new_capacity *= 2;
+    void* grown = realloc(array, new_capacity * item_size);
+    if (!grown) {
+        fprintf(stderr, "Erro de Memória: falha ao serializar a AST.\n");
+        exit(EXIT_FAILURE);
+    }
+    *capacity = new_capacity;
+    return grown;
+}
+
+// --- Hash Estrutural ---
+
+#define FNV_PRIME 1099511628211ULL
+
+static unsigned long long hash_bytes(unsigned long long hash, const void* data, size_t size) {
+    const unsigned char* bytes = data;
+    for (size_t i = 0; i < size; i++) hash = (hash ^ bytes[i]) * FNV_PRIME;
+    return hash;
+}
+
+// Percorre a árvore em pré-ordem com uma pilha de itens: um nó (NULL marca um filho
+// ausente) ou, depois dos elementos de uma lista, a contagem da lista.
+typedef struct {
+    ASTNode* node;
+    int is_count;
+    unsigned int count;
+} HashItem;
+
+static unsigned long long hash_node(unsigned long long hash, ASTNode* root) {
+    HashItem* items = NULL;
+    uint32_t count = 0, capacity = 0;
+    items = grow(items, &capacity, 1, sizeof(HashItem));
+    items[count++] = (HashItem){root, 0, 0};
+    while (count > 0) {
+        HashItem item = items[--count];
+        if (item.is_count) {
+            hash = hash_bytes(hash, &item.count, sizeof(item.count));
+            continue;
+        }
+        ASTNode* node = item.node;
+        if (!node) {
+            hash = (hash ^ 0xFE) * FNV_PRIME; // Marca de filho ausente
+            continue;
+        }
+        unsigned char type = (unsigned char)node->type;
+        hash = hash_bytes(hash, &type, 1);
+        switch (node->type) {
+            case NODE_INT_LITERAL: hash = hash_bytes(hash, &node->data.int_literal, sizeof(int)); break;
+            case NODE_FLOAT_LITERAL: hash = hash_bytes(hash, &node->data.float_literal, sizeof(double)); break;
+            case NODE_CHAR_LITERAL: hash = hash_bytes(hash, &node->data.char_literal, 1); break;
+            default: break;
+        }
+
+        ASTLayout layout = ast_layout(node);
+        for (int i = 0; i < layout.str_count; i++) {
+            const char* str = *layout.str[i];
+            hash = str ? hash_bytes(hash, str, strlen(str) + 1) : (hash ^ 0xFE) * FNV_PRIME;
+        }
+        // Empilhados em ordem inversa à do hash: contagem, elementos da lista, filhos diretos
+        if (layout.list) {
+            unsigned int total = 0;
+            for (ASTNodeList* l = *layout.list; l; l = l->next) total++;
+            items = grow(items, &capacity, count + total + 1, sizeof(HashItem));
+            items[count++] = (HashItem){NULL, 1, total};
+            count += total;
+            uint32_t k = count;
+            for (ASTNodeList* l = *layout.list; l; l = l->next) items[--k] = (HashItem){l->node, 0, 0};
+        }
+        items = grow(items, &capacity, count + layout.child_count, sizeof(HashItem));
+        for (int i = layout.child_count - 1; i >= 0; i--) items[count++] = (HashItem){*layout.child[i], 0, 0};
+    }
+    free(items);
+    return hash;
+}
+
+unsigned long long ast_fingerprint(ASTNode* node) {
+    return hash_node(14695981039346656037ULL, node);
+}
+
+// --- Gravação ---
+
+typedef struct {
+    AstBinaryNode* nodes;
+    uint32_t node_count, node_capacity;
+    uint32_t* lists;
+    uint32_t list_count, list_capacity;
+    char* strings;
+    uint32_t string_bytes, string_capacity;
+    uint32_t* interned;  // Tabela hash de offsets já gravados (AST_BINARY_NONE = vazio)
+    uint32_t interned_capacity, interned_count;
+} AstWriter;
+
+static uint32_t hash_string(const char* s) {
+    uint32_t hash = 2166136261u; // FNV-1a de 32 bits
+    for (; *s; s++) hash = (hash ^ (unsigned char)*s) * 16777619u;
+    return hash;
+}
+
+static void rehash_strings(AstWriter* w) {
+    uint32_t capacity = w->interned_capacity ? w->interned_capacity * 2 : 256;
+    uint32_t* table = malloc(capacity * sizeof(uint32_t));
+    if (!table) {
+        fprintf(stderr, "Erro de Memória: falha ao serializar a AST.\n");
+        exit(EXIT_FAILURE);
+    }
+    memset(table, 0xFF, capacity * sizeof(uint32_t));
+    for (uint32_t i = 0; i < w->interned_capacity; i++) {
+        uint32_t offset = w->interned[i];
+        if (offset == AST_BINARY_NONE) continue;
+        uint32_t slot = hash_string(w->strings + offset) & (capacity - 1);
+        while (table[slot] != AST_BINARY_NONE) slot = (slot + 1) & (capacity - 1);
+        table[slot] = offset;
+    }
+    free(w->interned);
+    w->interned = table;
+    w->interned_capacity = capacity;
+}
+
+// Devolve o offset da string na tabela, gravando-a apenas na primeira ocorrência
+static uint32_t intern_string(AstWriter* w, const char* s) {
+    if (!s) return AST_BINARY_NONE;
+    if ((w->interned_count + 1) * 2 > w->interned_capacity) rehash_strings(w);
+    uint32_t slot = hash_string(s) & (w->interned_capacity - 1);
+    while (w->interned[slot] != AST_BINARY_NONE) {
+        if (strcmp(w->strings + w->interned[slot], s) == 0) return w->interned[slot];
+        slot = (slot + 1) & (w->interned_capacity - 1);
+    }
+    uint32_t length = (uint32_t)strlen(s) + 1;
+    w->strings = grow(w->strings, &w->string_capacity, w->string_bytes + length, 1);
+    uint32_t offset = w->string_bytes;
+    memcpy(w->strings + offset, s, length);
+    w->string_bytes += length;
+    w->interned[slot] = offset;
+    w->interned_count++;
+    return offset;
+}
+
+// Item da pilha de gravação: um nó a gravar no campo 'slot' do registro 'parent'
+// ou, com 'finish', o fechamento da lista de 'parent', cujos 'count' elementos já
+// gravados estão no topo da pilha de índices.
+#define SLOT_LIST 4
+#define SLOT_ROOT 5
+
+typedef struct {
+    ASTNode* node;
+    uint32_t parent;
+    int slot;
+    int finish;
+    uint32_t count;
+} WriteItem;
+
+// Grava a árvore em pré-ordem: cada nó recebe seu índice antes dos filhos, e a lista
+// de filhos só ocupa seu intervalo contíguo da tabela de listas depois que todos os
+// elementos (e as listas deles) foram gravados.
+static uint32_t serialize_tree(AstWriter* w, ASTNode* root) {
+    WriteItem* items = NULL;
+    uint32_t count = 0, capacity = 0;
+    uint32_t* elements = NULL;
+    uint32_t element_count = 0, element_capacity = 0;
+    uint32_t root_index = AST_BINARY_NONE;
+
+    items = grow(items, &capacity, 1, sizeof(WriteItem));
+    items[count++] = (WriteItem){root, 0, SLOT_ROOT, 0, 0};
+    while (count > 0) {
+        WriteItem item = items[--count];
+        if (item.finish) {
+            w->lists = grow(w->lists, &w->list_capacity, w->list_count + item.count, sizeof(uint32_t));
+            w->nodes[item.parent].list_start = w->list_count;
+            w->nodes[item.parent].list_count = item.count;
+            element_count -= item.count;
+            memcpy(w->lists + w->list_count, elements + element_count, item.count * sizeof(uint32_t));
+            w->list_count += item.count;
+            continue;
+        }
+
+        ASTNode* node = item.node;
+        uint32_t index = AST_BINARY_NONE;
+        if (node) {
+            w->nodes = grow(w->nodes, &w->node_capacity, w->node_count + 1, sizeof(AstBinaryNode));
+            index = w->node_count++;
+            AstBinaryNode* record = &w->nodes[index];
+            memset(record, 0, sizeof(*record));
+            record->type = (uint8_t)node->type;
+            record->value_type = (uint8_t)node->value_type;
+            record->line = node->pos.line;
+            record->column = node->pos.column;
+            for (int i = 0; i < 4; i++) record->child[i] = AST_BINARY_NONE;
+            record->str[0] = record->str[1] = AST_BINARY_NONE;
+
+            switch (node->type) {
+                case NODE_INT_LITERAL: record->scalar.int_value = node->data.int_literal; break;
+                case NODE_FLOAT_LITERAL: memcpy(record->scalar.float_bits, &node->data.float_literal, sizeof(double)); break;
+                case NODE_CHAR_LITERAL: record->scalar.char_value = node->data.char_literal; break;
+                default: break;
+            }
+
+            ASTLayout layout = ast_layout(node);
+            for (int i = 0; i < layout.str_count; i++) {
+                w->nodes[index].str[i] = intern_string(w, *layout.str[i]);
+            }
+            // Empilhados em ordem inversa à da gravação: fechamento da lista, elementos, filhos
+            if (layout.list) {
+                uint32_t total = 0;
+                for (ASTNodeList* l = *layout.list; l; l = l->next) total++;
+                items = grow(items, &capacity, count + total + 1, sizeof(WriteItem));
+                items[count++] = (WriteItem){NULL, index, 0, 1, total};
+                count += total;
+                uint32_t k = count;
+                for (ASTNodeList* l = *layout.list; l; l = l->next) {
+                    items[--k] = (WriteItem){l->node, index, SLOT_LIST, 0, 0};
+                }
+            }
+            items = grow(items, &capacity, count + layout.child_count, sizeof(WriteItem));
+            for (int i = layout.child_count - 1; i >= 0; i--) {
+                if (*layout.child[i]) items[count++] = (WriteItem){*layout.child[i], index, i, 0, 0};
+            }
+        }
+
+        if (item.slot == SLOT_ROOT) {
+            root_index = index;
+        } else if (item.slot == SLOT_LIST) {
+            elements = grow(elements, &element_capacity, element_count + 1, sizeof(uint32_t));
+            elements[element_count++] = index;
+        } else {
+            w->nodes[item.parent].child[item.slot] = index;
+        }
+    }
+    free(items);
+    free(elements);
+    return root_index;
+}
+
+int write_ast_binary(ASTNode* root, AstStage stage, const char* path) {
+    AstWriter w;
+    memset(&w, 0, sizeof(w));
+    uint32_t root_index = serialize_tree(&w, root);
+
+    static const char padding[4] = {0};
+    uint32_t padded_strings = (w.string_bytes + 3) & ~3u;
+    AstBinaryHeader header;
+    memcpy(header.magic, AST_BINARY_MAGIC, 4);
+    header.version = AST_BINARY_VERSION;
+    header.stage = stage;
+    header.node_count = w.node_count;
+    header.list_entries = w.list_count;
+    header.string_bytes = padded_strings;
+    header.root = root_index;
+
+    int ok = 0;
+    FILE* out = fopen(path, "wb");
+    if (out) {
+        ok = fwrite(&header, sizeof(header), 1, out) == 1 &&
+             fwrite(w.nodes, sizeof(AstBinaryNode), w.node_count, out) == w.node_count &&
+             fwrite(w.lists, sizeof(uint32_t), w.list_count, out) == w.list_count &&
+             fwrite(w.strings, 1, w.string_bytes, out) == w.string_bytes &&
+             fwrite(padding, 1, padded_strings - w.string_bytes, out) == padded_strings - w.string_bytes;
+        if (fclose(out) != 0) ok = 0;
+    }
+    if (!ok) perror("Não foi possível gravar a AST binária");
+
+    free(w.nodes);
+    free(w.lists);
+    free(w.strings);
+    free(w.interned);
+    return ok;
+}
+
+// --- Leitura ---
+
+// O que cada posição de filho aceita. As expressões vão de NODE_ASSIGN a
+// NODE_CHAR_LITERAL; um comando é uma declaração, um comando composto ou uma expressão.
+typedef enum {
+    KIND_EXPRESSION,
+    KIND_STATEMENT,
+    KIND_FOR_INIT,    // Declaração ou expressão
+    KIND_BLOCK,
+    KIND_IDENTIFIER,
+    KIND_DECLARATION, // Declaração global, função ou main
+    KIND_PARAM
+} NodeKind;
+
+// Esquema de cada tipo de nó, nas posições do ast_layout: o tipo dos filhos diretos
+// e dos elementos da lista, e quais filhos diretos são obrigatórios (bit i = filho i).
+// Todas as strings do ast_layout são obrigatórias.
+typedef struct {
+    uint8_t child[4];
+    uint8_t list;
+    uint8_t required;
+} NodeSchema;
+
+static const NodeSchema node_schema[NODE_CHAR_LITERAL + 1] = {
+    [NODE_PROGRAM]        = {{0}, KIND_DECLARATION, 0},
+    [NODE_VAR_DECL]       = {{KIND_EXPRESSION}, 0, 0},
+    [NODE_FUNC_DEF]       = {{KIND_BLOCK}, KIND_PARAM, 1},
+    [NODE_MAIN_DEF]       = {{KIND_BLOCK}, 0, 1},
+    [NODE_BLOCK]          = {{0}, KIND_STATEMENT, 0},
+    [NODE_IF]             = {{KIND_EXPRESSION, KIND_STATEMENT, KIND_STATEMENT}, 0, 3},
+    [NODE_FOR]            = {{KIND_FOR_INIT, KIND_EXPRESSION, KIND_EXPRESSION, KIND_STATEMENT}, 0, 8},
+    [NODE_WHILE]          = {{KIND_EXPRESSION, KIND_STATEMENT}, 0, 3},
+    [NODE_RETURN]         = {{KIND_EXPRESSION}, 0, 0},
+    [NODE_ASSIGN]         = {{KIND_IDENTIFIER, KIND_EXPRESSION}, 0, 3},
+    [NODE_BINARY_OP]      = {{KIND_EXPRESSION, KIND_EXPRESSION}, 0, 3},
+    [NODE_UNARY_OP]       = {{KIND_EXPRESSION}, 0, 1},
+    [NODE_FUNC_CALL]      = {{0}, KIND_EXPRESSION, 0},
+};
+
+static int node_has_kind(uint8_t type, NodeKind kind) {
+    int expression = type >= NODE_ASSIGN && type <= NODE_CHAR_LITERAL;
+    switch (kind) {
+        case KIND_EXPRESSION: return expression;
+        case KIND_STATEMENT:
+            return expression || type == NODE_VAR_DECL || (type >= NODE_BLOCK && type <= NODE_RETURN);
+        case KIND_FOR_INIT: return expression || type == NODE_VAR_DECL;
+        case KIND_BLOCK: return type == NODE_BLOCK;
+        case KIND_IDENTIFIER: return type == NODE_IDENTIFIER;
+        case KIND_DECLARATION: return type == NODE_VAR_DECL || type == NODE_FUNC_DEF || type == NODE_MAIN_DEF;
+        case KIND_PARAM: return type == NODE_PARAM;
+    }
+    return 0;
+}
+
+// Filho 'child' do registro 'parent': vem depois do pai (o que garante que a
+// reconstrução termina), tem o tipo esperado e ainda não foi referenciado.
+static int valid_child(const AstImage* image, uint8_t* referenced, uint32_t child, uint32_t parent, NodeKind kind) {
+    if (child <= parent || child >= image->header->node_count || referenced[child]) return 0;
+    referenced[child] = 1;
+    return node_has_kind(image->nodes[child].type, kind);
+}
+
+static int valid_string(const AstImage* image, uint32_t offset) {
+    return offset < image->header->string_bytes;
+}
+
+// Confere cada registro com o esquema do seu tipo. Como todo filho vem depois do pai
+// e nenhum nó é referenciado duas vezes, a imagem é uma única árvore com raiz no
+// registro 0, que deve ser o NODE_PROGRAM.
+static int validate_record(const AstImage* image, uint8_t* referenced, uint32_t i) {
+    const AstBinaryHeader* h = image->header;
+    const AstBinaryNode* n = &image->nodes[i];
+    if (n->type > NODE_CHAR_LITERAL || n->value_type > TYPE_UNKNOWN) return 0;
+    if ((n->type == NODE_PROGRAM) != (i == 0)) return 0;
+
+    ASTNode shape;
+    memset(&shape, 0, sizeof(shape));
+    shape.type = (NodeType)n->type;
+    ASTLayout layout = ast_layout(&shape);
+    const NodeSchema* schema = &node_schema[n->type];
+
+    for (int c = 0; c < 4; c++) {
+        if (n->child[c] == AST_BINARY_NONE) {
+            if (c < layout.child_count && (schema->required & (1u << c))) return 0;
+        } else if (c >= layout.child_count ||
+                   !valid_child(image, referenced, n->child[c], i, (NodeKind)schema->child[c])) {
+            return 0;
+        }
+    }
+    if (n->list_count > 0 && !layout.list) return 0;
+    if (n->list_count > h->list_entries || n->list_start > h->list_entries - n->list_count) return 0;
+    for (uint32_t k = 0; k < n->list_count; k++) {
+        uint32_t child = image->lists[n->list_start + k];
+        if (!valid_child(image, referenced, child, i, (NodeKind)schema->list)) return 0;
+    }
+    for (int s = 0; s < 2; s++) {
+        if (s < layout.str_count ? !valid_string(image, n->str[s]) : n->str[s] != AST_BINARY_NONE) return 0;
+    }
+    return 1;
+}
+
+static int validate_image(const AstImage* image) {
+    const AstBinaryHeader* h = image->header;
+    if (h->stage > AST_STAGE_OPTIMIZED) return 0;
+    if (h->node_count == 0 || h->root != 0) return 0;
+    // A tabela de strings deve terminar em '\0' para que nenhum nome ultrapasse o arquivo
+    if (h->string_bytes > 0 && image->strings[h->string_bytes - 1] != '\0') return 0;
+    uint8_t* referenced = calloc(h->node_count, 1);
+    if (!referenced) return 0;
+    int ok = 1;
+    for (uint32_t i = 0; ok && i < h->node_count; i++) ok = validate_record(image, referenced, i);
+    // Um registro que ninguém referencia seria uma segunda raiz
+    for (uint32_t i = 1; ok && i < h->node_count; i++) ok = referenced[i];
+    free(referenced);
+    return ok;
+}
+
+int ast_image_open(const char* path, AstImage* image) {
+    memset(image, 0, sizeof(*image));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror("Erro ao abrir a AST binária");
+        return 0;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(AstBinaryHeader)) {
+        fprintf(stderr, "Erro: '%s' não é uma AST binária válida.\n", path);
+        close(fd);
+        return 0;
+    }
+    void* mapping = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        perror("Erro ao mapear a AST binária");
+        return 0;
+    }
+    image->mapping = mapping;
+    image->mapping_size = st.st_size;
+    image->header = mapping;
+
+    const AstBinaryHeader* h = image->header;
+    if (memcmp(h->magic, AST_BINARY_MAGIC, 4) != 0 || h->version != AST_BINARY_VERSION) {
+        fprintf(stderr, "Erro: '%s' não é uma AST binária na versão %d.\n", path, AST_BINARY_VERSION);
+        ast_image_close(image);
+        return 0;
+    }
+    unsigned long long expected = sizeof(AstBinaryHeader) +
+                                  (unsigned long long)h->node_count * sizeof(AstBinaryNode) +
+                                  (unsigned long long)h->list_entries * sizeof(uint32_t) + h->string_bytes;
+    if (expected != image->mapping_size) {
+        fprintf(stderr, "Erro: '%s' está truncado ou corrompido.\n", path);
+        ast_image_close(image);
+        return 0;
+    }
+    const char* base = mapping;
+    image->nodes = (const AstBinaryNode*)(base + sizeof(AstBinaryHeader));
+    image->lists = (const uint32_t*)(image->nodes + h->node_count);
+    image->strings = (const char*)(image->lists + h->list_entries);
+    if (!validate_image(image)) {
+        fprintf(stderr, "Erro: '%s' contém nós ou referências inválidos.\n", path);
+        ast_image_close(image);
+        return 0;
+    }
+    return 1;
+}
+
+void ast_image_close(AstImage* image) {
+    if (image->mapping) munmap(image->mapping, image->mapping_size);
+    memset(image, 0, sizeof(*image));
+}
+
+const char* ast_image_string(const AstImage* image, uint32_t offset) {
+    return offset == AST_BINARY_NONE ? NULL : image->strings + offset;
+}
+
+static char* copy_string(const AstImage* image, uint32_t offset) {
+    const char* s = ast_image_string(image, offset);
+    if (!s) return NULL;
+    char* copy = strdup(s);
+    if (!copy) {
+        fprintf(stderr, "Erro de Memória: falha ao alocar memória.\n");
+        exit(EXIT_FAILURE);
+    }
+    return copy;
+}
+
+// Item da pilha de reconstrução: o registro 'index' e o campo que recebe o nó criado
+typedef struct {
+    uint32_t index;
+    ASTNode** slot;
+} BuildItem;
+
+static ASTNode* build_tree(const AstImage* image, uint32_t root_index) {
+    ASTNode* root = NULL;
+    BuildItem* items = NULL;
+    uint32_t count = 0, capacity = 0;
+    items = grow(items, &capacity, 1, sizeof(BuildItem));
+    items[count++] = (BuildItem){root_index, &root};
+    while (count > 0) {
+        BuildItem item = items[--count];
+        if (item.index == AST_BINARY_NONE) {
+            *item.slot = NULL;
+            continue;
+        }
+        const AstBinaryNode* record = &image->nodes[item.index];
+        ASTNode* node = create_node((NodeType)record->type, (Position){record->line, record->column});
+        node->value_type = (DataType)record->value_type;
+        *item.slot = node;
+        switch (node->type) {
+            case NODE_INT_LITERAL: node->data.int_literal = record->scalar.int_value; break;
+            case NODE_FLOAT_LITERAL: memcpy(&node->data.float_literal, record->scalar.float_bits, sizeof(double)); break;
+            case NODE_CHAR_LITERAL: node->data.char_literal = (char)record->scalar.char_value; break;
+            default: break;
+        }
+
+        ASTLayout layout = ast_layout(node);
+        for (int i = 0; i < layout.str_count; i++) {
+            *layout.str[i] = copy_string(image, record->str[i]);
+        }
+        items = grow(items, &capacity, count + layout.child_count + record->list_count, sizeof(BuildItem));
+        for (int i = 0; i < layout.child_count; i++) {
+            items[count++] = (BuildItem){record->child[i], layout.child[i]};
+        }
+        if (layout.list) {
+            ASTNodeList** tail = layout.list;
+            for (uint32_t k = 0; k < record->list_count; k++) {
+                *tail = create_node_list(NULL);
+                items[count++] = (BuildItem){image->lists[record->list_start + k], &(*tail)->node};
+                tail = &(*tail)->next;
+            }
+        }
+    }
+    free(items);
+    return root;
+}
+
+ASTNode* ast_image_to_tree(const AstImage* image) {
+    return build_tree(image, image->header->root);
+}
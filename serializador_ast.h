@@ -0,0 +1,101 @@
+#ifndef SERIALIZADOR_AST_H
+#define SERIALIZADOR_AST_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ast.h"
+
+// Formato binário da AST (versão 2, na ordem de bytes da máquina):
+//
+//   [AstBinaryHeader][AstBinaryNode x node_count][uint32_t x list_entries][strings]
+//
+// Os nós são gravados em pré-ordem, de modo que todo filho tem índice maior que o
+// do pai. Os filhos em lista (declarações, parâmetros, comandos e argumentos)
+// ocupam um intervalo contíguo da tabela de listas, e os nomes ficam em uma tabela
+// de strings terminadas em '\0', sem repetições. Todas as seções são alinhadas a
+// 4 bytes, então o arquivo pode ser mapeado com mmap e validado e percorrido no
+// próprio mapeamento, sem ser copiado para um buffer.
+
+#define AST_BINARY_MAGIC "ASTB"
+#define AST_BINARY_VERSION 2
+#define AST_BINARY_NONE 0xFFFFFFFFu // Filho ou string ausente (NULL)
+
+// Última fase aplicada à árvore gravada: quem a carrega continua a partir da seguinte
+typedef enum {
+    AST_STAGE_PARSED,   // Saída do parser
+    AST_STAGE_ANALYZED, // Tipos anotados pela análise semântica
+    AST_STAGE_OPTIMIZED // Saída do otimizador (entrada do gerador de código)
+} AstStage;
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t stage;      // AstStage
+    uint32_t node_count;
+    uint32_t list_entries;
+    uint32_t string_bytes;
+    uint32_t root;
+} AstBinaryHeader;
+
+typedef struct {
+    uint8_t type;        // NodeType
+    uint8_t value_type;  // DataType
+    uint16_t reserved;
+    int32_t line;
+    int32_t column;
+    uint32_t child[4];   // Filhos diretos, na ordem dos campos do nó (ex.: init, cond, inc, corpo do for)
+    uint32_t list_start; // Filhos em lista: índices list_start .. list_start + list_count - 1
+    uint32_t list_count;
+    uint32_t str[2];     // Offsets na tabela de strings (ex.: tipo e nome de uma declaração)
+    union {
+        int32_t int_value;
+        uint32_t float_bits[2]; // double copiado com memcpy: o registro só é alinhado a 4 bytes
+        int32_t char_value;
+    } scalar;
+} AstBinaryNode;
+
+// Imagem de uma AST binária mapeada em memória (somente leitura)
+typedef struct {
+    const AstBinaryHeader* header;
+    const AstBinaryNode* nodes;
+    const uint32_t* lists;
+    const char* strings;
+    void* mapping;
+    size_t mapping_size;
+} AstImage;
+
+/**
+ * @brief Grava a AST no formato binário.
+ * @return 1 em caso de sucesso, 0 se o arquivo não pôde ser escrito.
+ */
+int write_ast_binary(ASTNode* root, AstStage stage, const char* path);
+
+/**
+ * @brief Mapeia um arquivo de AST binária em memória. O cabeçalho e cada registro
+ * são validados uma única vez (índices, filhos e strings exigidos pelo tipo do nó,
+ * e uma única árvore com raiz NODE_PROGRAM), de modo que ast_image_string e
+ * ast_image_to_tree não precisam conferir nada. Todas as fases trabalham sobre
+ * ASTNode, então o driver (--from-ast) reconstrói a árvore com ast_image_to_tree e
+ * fecha a imagem em seguida.
+ * @return 1 em caso de sucesso, 0 se o arquivo não existe ou é inválido.
+ */
+int ast_image_open(const char* path, AstImage* image);
+void ast_image_close(AstImage* image);
+
+// String da tabela de strings (NULL para AST_BINARY_NONE)
+const char* ast_image_string(const AstImage* image, uint32_t offset);
+
+/**
+ * @brief Reconstrói uma árvore ASTNode mutável a partir da imagem, em um único
+ * percurso sobre os registros. A árvore retornada é independente do mapeamento.
+ */
+ASTNode* ast_image_to_tree(const AstImage* image);
+
+/**
+ * @brief Hash estrutural (FNV-1a de 64 bits) da subárvore: tipos de nó, nomes,
+ * operadores e valores. Posições e tipos anotados são ignorados, de modo que mover
+ * uma declaração no arquivo não muda o seu hash.
+ */
+unsigned long long ast_fingerprint(ASTNode* node);
+
+#endif // SERIALIZADOR_AST_H
@@ -0,0 +1,590 @@
+// Define _DEFAULT_SOURCE para habilitar sockets Unix, sigaction, mkstemp e fdopen
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <sys/select.h>
+#include <sys/time.h>
+#include "servidor_compilacao.h"
+#include "parser.h"
+#include "analisador_semantico.h"
+#include "otimizador.h"
+#include "gerador_codigo.h"
+#include "cache_compilacao.h"
+
+#define SERVER_MAX_LINE 512
+#define SERVER_MAX_NAME 256
+#define SERVER_RESULT_BUCKETS 1024
+#define SERVER_TEMP_TEMPLATE "/tmp/compilador-XXXXXX"
+// As conexões são atendidas uma de cada vez: uma leitura ou escrita parada por mais que
+// isto encerra a conexão, para que um cliente ocioso não segure os que esperam
+#define SERVER_IO_TIMEOUT_SECONDS 5
+
+// Um pedido de compilação de um lote
+typedef struct {
+    char name[SERVER_MAX_NAME];
+    char* source;
+    long length;
+    unsigned long long key;
+    pid_t pid;
+    char code_path[32];
+    char diag_path[32];
+    int done;
+} Job;
+
+// Resultado guardado no cache em memória do servidor
+typedef struct ResultEntry {
+    unsigned long long key;
+    long source_length;
+    int status;
+    char* code;
+    long code_length;
+    char* diagnostics;
+    long diag_length;
+    unsigned long long last_use;
+    struct ResultEntry* next;
+} ResultEntry;
+
+static ResultEntry* results[SERVER_RESULT_BUCKETS];
+static long long results_bytes = 0;
+static long long results_max_bytes = 0;
+static unsigned long long use_clock = 0;
+static int max_workers = 1;
+static long long max_batch_bytes = SERVER_DEFAULT_MAX_BYTES;
+static volatile sig_atomic_t stop_requested = 0;
+static sigset_t original_mask; // Máscara de sinais fora da espera por conexões
+static unsigned long compilations = 0;
+static unsigned long cache_hits = 0;
+
+// Só o cliente encerra o processo quando falta memória; no servidor, uma alocação que
+// falha afeta apenas o pedido ou a conexão em que aconteceu.
+static void* checked_malloc(size_t size) {
+    void* p = malloc(size);
+    if (!p) {
+        fprintf(stderr, "Erro de Memória: falha no cliente de compilação.\n");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+// Lê o arquivo inteiro para a memória (terminado em '\0'); devolve NULL em caso de erro
+static char* read_file(const char* path, long* length) {
+    FILE* file = fopen(path, "rb");
+    if (!file) return NULL;
+    fseek(file, 0, SEEK_END);
+    *length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char* data = *length >= 0 ? malloc(*length + 1) : NULL;
+    if (!data) {
+        fclose(file);
+        return NULL;
+    }
+    if ((long)fread(data, 1, *length, file) != *length) {
+        free(data);
+        fclose(file);
+        return NULL;
+    }
+    data[*length] = '\0';
+    fclose(file);
+    return data;
+}
+
+// --- Cache de Resultados em Memória ---
+
+static ResultEntry* result_lookup(unsigned long long key, long source_length) {
+    for (ResultEntry* e = results[key % SERVER_RESULT_BUCKETS]; e; e = e->next) {
+        if (e->key == key && e->source_length == source_length) {
+            e->last_use = ++use_clock;
+            return e;
+        }
+    }
+    return NULL;
+}
+
+static long long entry_bytes(const ResultEntry* e) {
+    return (long long)sizeof(ResultEntry) + e->code_length + e->diag_length;
+}
+
+// Remove as entradas usadas há mais tempo até o total caber no limite
+static void evict_results() {
+    while (results_bytes > results_max_bytes) {
+        ResultEntry** oldest = NULL;
+        for (int b = 0; b < SERVER_RESULT_BUCKETS; b++) {
+            for (ResultEntry** link = &results[b]; *link; link = &(*link)->next) {
+                if (!oldest || (*link)->last_use < (*oldest)->last_use) oldest = link;
+            }
+        }
+        if (!oldest) return;
+        ResultEntry* victim = *oldest;
+        *oldest = victim->next;
+        results_bytes -= entry_bytes(victim);
+        free(victim->code);
+        free(victim->diagnostics);
+        free(victim);
+    }
+}
+
+// Guarda o resultado (o cache passa a ser dono de code e diagnostics). Sem memória
+// para a entrada, o resultado só não fica no cache.
+static void result_store(const Job* job, int status, char* code, long code_length,
+                         char* diagnostics, long diag_length) {
+    ResultEntry* e = malloc(sizeof(ResultEntry));
+    if (!e) {
+        free(code);
+        free(diagnostics);
+        return;
+    }
+    e->key = job->key;
+    e->source_length = job->length;
+    e->status = status;
+    e->code = code;
+    e->code_length = code_length;
+    e->diagnostics = diagnostics;
+    e->diag_length = diag_length;
+    e->last_use = ++use_clock;
+    e->next = results[job->key % SERVER_RESULT_BUCKETS];
+    results[job->key % SERVER_RESULT_BUCKETS] = e;
+    results_bytes += entry_bytes(e);
+    evict_results();
+}
+
+// --- Execução de um Lote ---
+
+static void send_result(FILE* out, const char* name, int status, const char* code, long code_length,
+                        const char* diagnostics, long diag_length) {
+    fprintf(out, "RESULTADO %s %d %ld %ld\n", name, status, code_length, diag_length);
+    fwrite(code, 1, code_length, out);
+    fwrite(diagnostics, 1, diag_length, out);
+    fflush(out);
+}
+
+// Corpo do processo filho: o pipeline completo, com os diagnósticos em diag_path.
+// Os erros das fases terminam o processo com exit(EXIT_FAILURE), como no driver.
+static void compile_job(const Job* job) {
+    int diag_fd = open(job->diag_path, O_WRONLY | O_TRUNC);
+    int null_fd = open("/dev/null", O_WRONLY);
+    if (diag_fd < 0 || null_fd < 0) _exit(2);
+    dup2(diag_fd, STDERR_FILENO);
+    dup2(null_fd, STDOUT_FILENO); // Mensagens de progresso das fases
+    close(diag_fd);
+    close(null_fd);
+
+    ASTNode* ast_root = parse_program(job->source);
+    analyze_semantics(ast_root);
+    int error_count = get_semantic_error_count();
+    if (error_count > 0) {
+        fprintf(stderr, "\nCompilação falhou com %d erro(s) semântico(s).\n", error_count);
+        free_ast(ast_root);
+        exit(EXIT_FAILURE);
+    }
+    optimize_ast(ast_root);
+    generate_code(ast_root, job->code_path);
+    free_ast(ast_root);
+    exit(EXIT_SUCCESS);
+}
+
+static int make_temp_file(char* path, size_t size) {
+    snprintf(path, size, "%s", SERVER_TEMP_TEMPLATE);
+    int fd = mkstemp(path);
+    if (fd < 0) return 0;
+    close(fd);
+    return 1;
+}
+
+static int start_job(Job* job) {
+    if (!make_temp_file(job->code_path, sizeof(job->code_path))) return 0;
+    if (!make_temp_file(job->diag_path, sizeof(job->diag_path))) {
+        unlink(job->code_path);
+        return 0;
+    }
+    fflush(NULL); // O filho não pode reenviar dados pendentes nos buffers do servidor
+    job->pid = fork();
+    if (job->pid < 0) {
+        unlink(job->code_path);
+        unlink(job->diag_path);
+        return 0;
+    }
+    if (job->pid == 0) {
+        sigprocmask(SIG_SETMASK, &original_mask, NULL);
+        compile_job(job);
+    }
+    compilations++;
+    return 1;
+}
+
+// Recolhe o resultado do filho que terminou, guarda-o no cache e o envia ao cliente
+static void finish_job(Job* job, int wait_status, FILE* out) {
+    int status;
+    if (WIFEXITED(wait_status)) status = WEXITSTATUS(wait_status) == 0 ? 0 : 1;
+    else status = 2;
+
+    long code_length = 0, diag_length = 0;
+    char* code = status == 0 ? read_file(job->code_path, &code_length) : NULL;
+    char* diagnostics = read_file(job->diag_path, &diag_length);
+    unlink(job->code_path);
+    unlink(job->diag_path);
+    if (!code) {
+        code_length = 0;
+        if (status == 0) status = 2;
+    }
+    if (!diagnostics) diag_length = 0;
+    if (status == 2) {
+        char note[128];
+        int n = WIFSIGNALED(wait_status)
+            ? snprintf(note, sizeof(note), "Processo de compilação terminou com o sinal %d.\n", WTERMSIG(wait_status))
+            : snprintf(note, sizeof(note), "Processo de compilação não produziu o código gerado.\n");
+        char* grown = realloc(diagnostics, diag_length + n + 1);
+        if (grown) {
+            diagnostics = grown;
+            memcpy(diagnostics + diag_length, note, n + 1);
+            diag_length += n;
+        }
+    }
+
+    send_result(out, job->name, status, code ? code : "", code_length, diagnostics ? diagnostics : "", diag_length);
+    // Términos anormais não são guardados: podem ter sido causados pelo ambiente, assim
+    // como um resultado que não pôde ser lido inteiro por falta de memória
+    if (status != 2 && code && diagnostics) {
+        result_store(job, status, code, code_length, diagnostics, diag_length);
+    } else {
+        free(code);
+        free(diagnostics);
+    }
+    job->done = 1;
+}
+
+static void run_batch(Job* jobs, int count, FILE* out) {
+    int pending = 0;
+    for (int i = 0; i < count; i++) {
+        jobs[i].key = cache_key(jobs[i].source, jobs[i].length, "alvo=python");
+        ResultEntry* hit = result_lookup(jobs[i].key, jobs[i].length);
+        if (hit) {
+            send_result(out, jobs[i].name, hit->status, hit->code, hit->code_length,
+                        hit->diagnostics, hit->diag_length);
+            jobs[i].done = 1;
+            cache_hits++;
+        } else {
+            pending++;
+        }
+    }
+
+    int next = 0, running = 0;
+    while (pending > 0) {
+        while (running < max_workers && next < count) {
+            Job* job = &jobs[next++];
+            if (job->done) continue;
+            if (start_job(job)) {
+                running++;
+            } else {
+                const char* message = "Não foi possível iniciar o processo de compilação.\n";
+                send_result(out, job->name, 2, "", 0, message, (long)strlen(message));
+                job->done = 1;
+                pending--;
+            }
+        }
+        if (running == 0) break;
+
+        int wait_status;
+        pid_t pid = waitpid(-1, &wait_status, 0);
+        if (pid < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        for (int i = 0; i < count; i++) {
+            if (!jobs[i].done && jobs[i].pid == pid) {
+                finish_job(&jobs[i], wait_status, out);
+                running--;
+                pending--;
+                break;
+            }
+        }
+    }
+}
+
+static void free_batch(Job* jobs, int count) {
+    for (int i = 0; i < count; i++) free(jobs[i].source);
+    free(jobs);
+}
+
+// Responde com um erro que encerra a conexão
+static void send_error(FILE* out, const char* message) {
+    fprintf(out, "ERRO %s\n", message);
+    fflush(out);
+}
+
+// Atende os lotes de uma conexão até o fim da entrada ou um erro de protocolo. Um erro
+// (pedido inválido, lote maior que o limite, falta de memória) encerra só esta conexão.
+static void serve_connection(FILE* in, FILE* out) {
+    char line[SERVER_MAX_LINE];
+    Job* jobs = NULL;
+    int count = 0, capacity = 0;
+    long long batch_bytes = 0;
+
+    while (fgets(line, sizeof(line), in)) {
+        if (strcmp(line, "FIM\n") == 0) {
+            run_batch(jobs, count, out);
+            fprintf(out, "FIM\n");
+            fflush(out);
+            free_batch(jobs, count);
+            jobs = NULL;
+            count = capacity = 0;
+            batch_bytes = 0;
+            continue;
+        }
+
+        char name[SERVER_MAX_NAME];
+        char digits[32];
+        int end = 0;
+        if (sscanf(line, "COMPILAR %255s %31[0-9]%n", name, digits, &end) != 2 || line[end] != '\n') {
+            send_error(out, "pedido inválido");
+            break;
+        }
+        // O tamanho vem do cliente: é conferido antes de qualquer alocação
+        errno = 0;
+        long long length = strtoll(digits, NULL, 10);
+        if (errno == ERANGE || length > max_batch_bytes - batch_bytes) {
+            send_error(out, "tamanho");
+            break;
+        }
+        if (count == capacity) {
+            int grown_capacity = capacity ? capacity * 2 : 16;
+            Job* grown = realloc(jobs, grown_capacity * sizeof(Job));
+            if (!grown) {
+                send_error(out, "memória");
+                break;
+            }
+            jobs = grown;
+            capacity = grown_capacity;
+        }
+        Job* job = &jobs[count];
+        memset(job, 0, sizeof(Job));
+        snprintf(job->name, sizeof(job->name), "%s", name);
+        job->length = (long)length;
+        job->source = malloc(length + 1);
+        if (!job->source) {
+            send_error(out, "memória");
+            break;
+        }
+        batch_bytes += length;
+        if ((long)fread(job->source, 1, length, in) != length) {
+            free(job->source);
+            break;
+        }
+        job->source[length] = '\0';
+        count++;
+    }
+    free_batch(jobs, count);
+}
+
+// --- Servidor ---
+
+static void handle_stop(int signal_number) {
+    (void)signal_number;
+    stop_requested = 1;
+}
+
+static int fill_address(struct sockaddr_un* address, const char* socket_path) {
+    memset(address, 0, sizeof(*address));
+    address->sun_family = AF_UNIX;
+    if (strlen(socket_path) >= sizeof(address->sun_path)) {
+        fprintf(stderr, "Caminho de socket longo demais: %s\n", socket_path);
+        return 0;
+    }
+    strcpy(address->sun_path, socket_path);
+    return 1;
+}
+
+int run_compile_server(const char* socket_path, int workers, long long cache_max_bytes, long long batch_max_bytes) {
+    max_workers = workers > 0 ? workers : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (max_workers < 1) max_workers = 1;
+    results_max_bytes = cache_max_bytes;
+    max_batch_bytes = batch_max_bytes;
+    signal(SIGPIPE, SIG_IGN); // Um cliente que desconecta não derruba o servidor
+
+    if (strcmp(socket_path, "-") == 0) {
+        serve_connection(stdin, stdout);
+        return 0;
+    }
+
+    struct sockaddr_un address;
+    if (!fill_address(&address, socket_path)) return 1;
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        perror("Erro ao criar o socket");
+        return 1;
+    }
+    unlink(socket_path);
+    if (bind(listener, (struct sockaddr*)&address, sizeof(address)) < 0 || listen(listener, 16) < 0) {
+        perror("Erro ao abrir o socket do servidor");
+        close(listener);
+        return 1;
+    }
+
+    // SIGINT e SIGTERM ficam bloqueados e só são entregues dentro de pselect, para
+    // que um sinal recebido entre o teste de stop_requested e a espera não se perca
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = handle_stop;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    sigset_t blocked;
+    sigemptyset(&blocked);
+    sigaddset(&blocked, SIGINT);
+    sigaddset(&blocked, SIGTERM);
+    sigprocmask(SIG_BLOCK, &blocked, &original_mask);
+
+    printf("Servidor de compilação aguardando em '%s' (até %d compilações simultâneas).\n",
+           socket_path, max_workers);
+    fflush(stdout);
+    while (!stop_requested) {
+        fd_set ready;
+        FD_ZERO(&ready);
+        FD_SET(listener, &ready);
+        if (pselect(listener + 1, &ready, NULL, NULL, NULL, &original_mask) < 0) {
+            if (errno == EINTR) continue;
+            perror("Erro ao aguardar conexões");
+            break;
+        }
+        int connection = accept(listener, NULL, NULL);
+        if (connection < 0) {
+            if (errno == EINTR || errno == EAGAIN) continue;
+            perror("Erro ao aceitar conexão");
+            break;
+        }
+        struct timeval timeout = { SERVER_IO_TIMEOUT_SECONDS, 0 };
+        setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(connection, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        FILE* in = fdopen(connection, "r");
+        FILE* out = fdopen(dup(connection), "w");
+        if (in && out) serve_connection(in, out);
+        if (in) fclose(in);
+        else close(connection);
+        if (out) fclose(out);
+    }
+
+    close(listener);
+    unlink(socket_path);
+    printf("Servidor encerrado: %lu compilações, %lu resultados reaproveitados do cache.\n",
+           compilations, cache_hits);
+    return 0;
+}
+
+// --- Cliente ---
+
+// <arquivo sem extensão>.py
+static void output_path_for(const char* name, char* path, size_t size) {
+    snprintf(path, size, "%s", name);
+    char* dot = strrchr(path, '.');
+    char* slash = strrchr(path, '/');
+    if (dot && (!slash || dot > slash)) *dot = '\0';
+    strncat(path, ".py", size - strlen(path) - 1);
+}
+
+int run_compile_client(const char* socket_path, char** files, int file_count) {
+    struct sockaddr_un address;
+    if (!fill_address(&address, socket_path)) return 1;
+    int connection = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (connection < 0 || connect(connection, (struct sockaddr*)&address, sizeof(address)) < 0) {
+        perror("Erro ao conectar ao servidor de compilação");
+        if (connection >= 0) close(connection);
+        return 1;
+    }
+    FILE* in = fdopen(connection, "r");
+    FILE* out = fdopen(dup(connection), "w");
+
+    int failed = 0;
+    // 1 para os arquivos enviados ainda sem resultado: só eles podem ser gravados
+    char* awaiting = checked_malloc(file_count > 0 ? file_count : 1);
+    memset(awaiting, 0, file_count);
+    for (int i = 0; i < file_count; i++) {
+        long length;
+        char* source = strchr(files[i], ' ') || strlen(files[i]) >= SERVER_MAX_NAME ? NULL : read_file(files[i], &length);
+        if (!source) {
+            fprintf(stderr, "Erro ao ler '%s' (nomes de arquivo não podem conter espaços nem passar de %d bytes).\n",
+                    files[i], SERVER_MAX_NAME - 1);
+            failed = 1;
+            continue;
+        }
+        awaiting[i] = 1;
+        fprintf(out, "COMPILAR %s %ld\n", files[i], length);
+        fwrite(source, 1, length, out);
+        free(source);
+    }
+    fprintf(out, "FIM\n");
+    fflush(out);
+
+    char line[SERVER_MAX_LINE];
+    int finished = 0;
+    while (fgets(line, sizeof(line), in)) {
+        if (strcmp(line, "FIM\n") == 0) {
+            finished = 1;
+            break;
+        }
+        if (strncmp(line, "ERRO ", 5) == 0) {
+            fprintf(stderr, "O servidor de compilação recusou o lote: %s", line + 5);
+            break;
+        }
+        char name[SERVER_MAX_NAME];
+        int status;
+        long code_length, diag_length;
+        if (sscanf(line, "RESULTADO %255s %d %ld %ld", name, &status, &code_length, &diag_length) != 4) {
+            fprintf(stderr, "Resposta inválida do servidor: %s", line);
+            break;
+        }
+        // O destino vem do nome que o próprio cliente enviou, nunca do que o servidor
+        // respondeu: um servidor não pode fazer o cliente gravar fora dos arquivos pedidos
+        int file = -1;
+        for (int i = 0; i < file_count && file < 0; i++) {
+            if (awaiting[i] && strcmp(files[i], name) == 0) file = i;
+        }
+        if (file < 0 || code_length < 0 || diag_length < 0) {
+            fprintf(stderr, "Resposta inválida do servidor: %s", line);
+            break;
+        }
+        awaiting[file] = 0;
+        char* code = checked_malloc(code_length + 1);
+        char* diagnostics = checked_malloc(diag_length + 1);
+        if ((long)fread(code, 1, code_length, in) != code_length ||
+            (long)fread(diagnostics, 1, diag_length, in) != diag_length) {
+            free(code);
+            free(diagnostics);
+            break;
+        }
+        fwrite(diagnostics, 1, diag_length, stderr);
+        if (status == 0) {
+            char path[SERVER_MAX_NAME + 4];
+            output_path_for(files[file], path, sizeof(path));
+            FILE* target = fopen(path, "w");
+            if (target) {
+                fwrite(code, 1, code_length, target);
+                fclose(target);
+                printf("%s -> %s\n", name, path);
+            } else {
+                perror(path);
+                failed = 1;
+            }
+        } else {
+            fprintf(stderr, "%s: compilação falhou.\n", name);
+            failed = 1;
+        }
+        free(code);
+        free(diagnostics);
+    }
+    if (!finished) {
+        fprintf(stderr, "Conexão com o servidor de compilação encerrada antes do fim do lote.\n");
+        failed = 1;
+    }
+    free(awaiting);
+    fclose(in);
+    fclose(out);
+    return failed;
+}
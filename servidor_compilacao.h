@@ -0,0 +1,60 @@
+#ifndef SERVIDOR_COMPILACAO_H
+#define SERVIDOR_COMPILACAO_H
+
+// --- Protocolo do Servidor de Compilação ---
+//
+// Um lote é uma sequência de pedidos terminada por "FIM":
+//
+//     COMPILAR <nome> <bytes>\n<código-fonte>
+//     ...
+//     FIM\n
+//
+// Para cada pedido o servidor devolve, na ordem em que as compilações terminam:
+//
+//     RESULTADO <nome> <status> <bytes do código> <bytes dos diagnósticos>\n<código><diagnósticos>
+//
+// e, depois do último, "FIM\n". O status é 0 (sucesso), 1 (erros léxicos, sintáticos
+// ou semânticos) ou 2 (o processo de compilação terminou de forma anormal). Uma mesma
+// conexão pode enviar vários lotes; <nome> não pode conter espaços.
+//
+// Um pedido mal formado recebe "ERRO pedido inválido\n"; um pedido que levaria a soma
+// dos códigos-fonte do lote além do limite do servidor, "ERRO tamanho\n"; e a falta de
+// memória para guardá-lo, "ERRO memória\n". Depois de um erro a conexão é encerrada (os
+// pedidos anteriores do lote são descartados), e o servidor continua atendendo as demais.
+//
+// As conexões são atendidas uma de cada vez. Uma conexão que fica 5 segundos sem enviar
+// nada enquanto o servidor espera um pedido (ou sem ler as respostas) é encerrada sem
+// resposta, para que um cliente ocioso não bloqueie os demais.
+
+#define SERVER_DEFAULT_MAX_BYTES (64LL * 1024 * 1024)
+
+/**
+ * @brief Executa o servidor de compilação até receber SIGINT ou SIGTERM.
+ *
+ * Cada código-fonte é compilado em um processo filho criado com fork a partir do
+ * servidor, sem carregar o executável de novo: o estado global das fases e as saídas
+ * com exit() em erros ficam isolados por compilação. Até 'workers' compilações de um
+ * lote rodam em paralelo. Os resultados ficam em um cache em memória, indexado pelo
+ * hash do código-fonte, que dura enquanto o servidor estiver no ar.
+ *
+ * @param socket_path Caminho do socket Unix, ou "-" para atender um único cliente
+ * pela entrada e saída padrão (até o fim da entrada).
+ * @param workers Número máximo de compilações simultâneas (0: número de processadores).
+ * @param cache_max_bytes Limite do cache de resultados em memória.
+ * @param batch_max_bytes Limite da soma dos códigos-fonte de um lote (e, portanto, de
+ * cada pedido); pedidos acima dele são recusados antes de qualquer alocação.
+ * @return 0 em caso de encerramento normal, 1 se o socket não pôde ser criado.
+ */
+int run_compile_server(const char* socket_path, int workers, long long cache_max_bytes, long long batch_max_bytes);
+
+/**
+ * @brief Envia os arquivos como um lote ao servidor e grava o código gerado para
+ * cada um ao lado dele, com a última extensão trocada por .py (prog.txt -> prog.py);
+ * os diagnósticos vão para stderr. Nomes com espaços são recusados sem ser enviados.
+ * Só são gravados os resultados de arquivos enviados nesta chamada, no caminho
+ * derivado do nome dado pelo chamador; uma resposta com outro nome encerra o lote.
+ * @return 0 se todos compilaram com sucesso, 1 caso contrário.
+ */
+int run_compile_client(const char* socket_path, char** files, int file_count);
+
+#endif // SERVIDOR_COMPILACAO_H
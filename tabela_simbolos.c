@@ -3,10 +3,13 @@
 #include <stdlib.h>
 #include <string.h>
 #include "tabela_simbolos.h"
+#include "diagnosticos.h"
 
 #define TABLE_SIZE 101
 static Symbol* symbol_table[TABLE_SIZE];
 static int current_scope_level = 0;
+static int buckets_used = 0;
+static SymbolTableStats stats;
 
 static void populate_builtins();
 
@@ -23,27 +26,38 @@ static char* safe_strdup(const char* s) {
     if (!s) return NULL;
     char* new_s = strdup(s);
     if (!new_s) {
-        fprintf(stderr, "Erro de Memória: falha ao alocar memória.\n");
-        exit(EXIT_FAILURE);
+        report_error("Erro de Memória: falha ao alocar memória.\n");
+        fatal_error();
     }
     return new_s;
 }
 
 void init_symbol_table() {
+    // Libera o que restou de uma análise anterior (os símbolos nativos do escopo 0)
     for (int i = 0; i < TABLE_SIZE; i++) {
+        Symbol* current = symbol_table[i];
+        while (current != NULL) {
+            Symbol* next = current->next;
+            free(current->name);
+            free(current);
+            current = next;
+        }
         symbol_table[i] = NULL;
     }
     current_scope_level = 0;
+    buckets_used = 0;
+    memset(&stats, 0, sizeof(stats));
+    stats.table_size = TABLE_SIZE;
     populate_builtins();
 }
 
 void enter_scope() {
     current_scope_level++;
-    printf("INFO (Tabela de Símbolos): Entrando no escopo, nível %d\n", current_scope_level);
+    report_info("INFO (Tabela de Símbolos): Entrando no escopo, nível %d\n", current_scope_level);
 }
 
 void exit_scope() {
-    printf("INFO (Tabela de Símbolos): Saindo do escopo, voltando para o nível %d\n", current_scope_level - 1);
+    report_info("INFO (Tabela de Símbolos): Saindo do escopo, voltando para o nível %d\n", current_scope_level - 1);
     if (current_scope_level <= 0) return;
 
     for (int i = 0; i < TABLE_SIZE; i++) {
@@ -52,7 +66,7 @@ void exit_scope() {
         while (current != NULL) {
             if (current->scope_level == current_scope_level) {
                 Symbol* to_free = current;
-                printf("INFO (Tabela de Símbolos): Removendo símbolo '%s' do escopo %d\n", to_free->name, current_scope_level);
+                report_info("INFO (Tabela de Símbolos): Removendo símbolo '%s' do escopo %d\n", to_free->name, current_scope_level);
                 if (prev == NULL) {
                     symbol_table[i] = current->next;
                 } else {
@@ -61,6 +75,7 @@ void exit_scope() {
                 current = current->next;
                 if(to_free->name) free(to_free->name);
                 free(to_free);
+                if (symbol_table[i] == NULL) buckets_used--;
             } else {
                 prev = current;
                 current = current->next;
@@ -74,13 +89,13 @@ void add_symbol(const char* name, DataType type, ASTNode* node) {
     // <<< CORREÇÃO: A verificação de erro foi movida para o analisador semântico >>>
     // Apenas adiciona o símbolo
     
-    printf("INFO (Tabela de Símbolos): Adicionando símbolo '%s' (tipo: %s) ao escopo %d\n", name, datatype_to_string(type), current_scope_level);
+    report_info("INFO (Tabela de Símbolos): Adicionando símbolo '%s' (tipo: %s) ao escopo %d\n", name, datatype_to_string(type), current_scope_level);
 
     unsigned long index = hash_function(name);
     Symbol* new_symbol = (Symbol*)malloc(sizeof(Symbol));
     if(!new_symbol){
-        fprintf(stderr, "Erro de Memória: falha ao alocar memória para novo símbolo.\n");
-        exit(EXIT_FAILURE);
+        report_error("Erro de Memória: falha ao alocar memória para novo símbolo.\n");
+        fatal_error();
     }
 
     new_symbol->name = safe_strdup(name);
@@ -89,6 +104,13 @@ void add_symbol(const char* name, DataType type, ASTNode* node) {
     new_symbol->node = node;
     new_symbol->next = symbol_table[index];
     symbol_table[index] = new_symbol;
+
+    if (new_symbol->next == NULL) buckets_used++;
+    int chain_length = 0;
+    for (Symbol* s = new_symbol; s; s = s->next) chain_length++;
+    stats.symbols_added++;
+    if (buckets_used > stats.peak_buckets_used) stats.peak_buckets_used = buckets_used;
+    if (chain_length > stats.max_chain_length) stats.max_chain_length = chain_length;
 }
 
 Symbol* lookup_symbol(const char* name) {
@@ -134,6 +156,10 @@ const char* datatype_to_string(DataType type) {
     }
 }
 
+SymbolTableStats get_symbol_table_stats() {
+    return stats;
+}
+
 static void populate_builtins() {
     add_symbol("print", TYPE_FUNCTION, NULL);
 }
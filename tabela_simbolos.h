@@ -3,10 +3,7 @@
 
 #include "ast.h"
 
-// <<< MODIFICAÇÃO: Adicionado TYPE_STRING >>>
-typedef enum {
-    TYPE_INT, TYPE_FLOAT, TYPE_CHAR, TYPE_STRING, TYPE_VOID, TYPE_FUNCTION, TYPE_UNKNOWN
-} DataType;
+// O enum DataType é definido em ast.h, pois também é usado para anotar a AST.
 
 typedef struct Symbol {
     char* name;
@@ -16,6 +13,14 @@ typedef struct Symbol {
     struct Symbol* next;
 } Symbol;
 
+// Estatísticas de ocupação da tabela hash (picos desde o último init_symbol_table)
+typedef struct {
+    int table_size;
+    int symbols_added;
+    int peak_buckets_used;
+    int max_chain_length;
+} SymbolTableStats;
+
 void init_symbol_table();
 void enter_scope();
 void exit_scope();
@@ -24,5 +29,6 @@ Symbol* lookup_symbol(const char* name);
 Symbol* lookup_symbol_in_current_scope(const char* name);
 DataType string_to_datatype(const char* type_str);
 const char* datatype_to_string(DataType type);
+SymbolTableStats get_symbol_table_stats();
 
 #endif // TABELA_SIMBOLOS_H
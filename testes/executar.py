@@ -0,0 +1,336 @@
+#!/usr/bin/env python3
+"""Testes do compilador.
+
+Cada programa em testes/programas/*.txt é compilado duas vezes, com as otimizações
+(padrão) e sem elas (--disable-pass=fold,opt), e os dois output.py são executados: a
+saída e o código de saída precisam ser iguais. Comentários no programa acrescentam
+verificações:
+
+    // saida: <linha>             uma linha da saída esperada (todas, em ordem)
+    // gerado-contem: <texto>     o output.py otimizado contém o texto
+    // gerado-nao-contem: <texto> o output.py otimizado não contém o texto
+
+Os demais testes exercitam opções do compilador que não produzem um programa.
+
+Uso: executar.py [--compilador ./compilador] [--filtro nome]
+"""
+
+import argparse
+import glob
+import os
+import socket
+import struct
+import subprocess
+import sys
+import tempfile
+import time
+
+DIRETORIO = os.path.dirname(os.path.abspath(__file__))
+SEM_OTIMIZACAO = ["--disable-pass=fold,opt"]
+
+
+class Falha(Exception):
+    pass
+
+
+def compilar(compilador, fonte, diretorio, opcoes=()):
+    """Compila 'fonte' em 'diretorio' e devolve o output.py gerado."""
+    resultado = subprocess.run([compilador, *opcoes, fonte], cwd=diretorio,
+                               stdout=subprocess.PIPE, stderr=subprocess.PIPE, text=True)
+    if resultado.returncode != 0:
+        raise Falha(f"o compilador falhou ({' '.join(opcoes) or 'padrão'}):\n{resultado.stdout}{resultado.stderr}")
+    with open(os.path.join(diretorio, "output.py")) as arquivo:
+        return arquivo.read()
+
+
+def executar_python(diretorio):
+    resultado = subprocess.run([sys.executable, "output.py"], cwd=diretorio,
+                               stdout=subprocess.PIPE, stderr=subprocess.PIPE, text=True, timeout=60)
+    # A última linha do traceback basta para comparar erros (o resto cita linhas do output.py)
+    erro = resultado.stderr.strip().splitlines()[-1:] if resultado.returncode != 0 else []
+    return resultado.returncode, resultado.stdout, erro
+
+
+def diretivas(fonte, nome):
+    prefixo = f"// {nome}:"
+    with open(fonte) as arquivo:
+        return [linha.strip()[len(prefixo):].strip() for linha in arquivo if linha.strip().startswith(prefixo)]
+
+
+def testar_programa(compilador, fonte):
+    with tempfile.TemporaryDirectory() as diretorio:
+        gerado = compilar(compilador, fonte, diretorio)
+        otimizado = executar_python(diretorio)
+        compilar(compilador, fonte, diretorio, SEM_OTIMIZACAO)
+        original = executar_python(diretorio)
+    if otimizado != original:
+        raise Falha(f"a otimização mudou o resultado:\n  otimizado: {otimizado}\n  sem otimizar: {original}")
+    esperada = diretivas(fonte, "saida")
+    if esperada and otimizado[1].splitlines() != esperada:
+        raise Falha(f"saída inesperada:\n  obtida: {otimizado[1].splitlines()}\n  esperada: {esperada}")
+    for texto in diretivas(fonte, "gerado-contem"):
+        if texto not in gerado:
+            raise Falha(f"o output.py otimizado não contém '{texto}'")
+    for texto in diretivas(fonte, "gerado-nao-contem"):
+        if texto in gerado:
+            raise Falha(f"o output.py otimizado contém '{texto}'")
+
+
+def pedir_ao_servidor(caminho, pedido):
+    """Envia 'pedido' (bytes) por uma conexão nova e devolve tudo o que o servidor responder."""
+    with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as conexao:
+        conexao.settimeout(30)
+        conexao.connect(caminho)
+        conexao.sendall(pedido)
+        conexao.shutdown(socket.SHUT_WR)
+        resposta = b""
+        while True:
+            parte = conexao.recv(65536)
+            if not parte:
+                return resposta
+            resposta += parte
+
+
+def testar_servidor_tamanho(compilador):
+    """Um pedido com tamanho acima do limite é recusado sem derrubar o servidor."""
+    with tempfile.TemporaryDirectory() as diretorio:
+        caminho = os.path.join(diretorio, "servidor.sock")
+        servidor = subprocess.Popen([compilador, f"--servidor={caminho}", "--servidor-max-bytes=1000"],
+                                    stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+        try:
+            for _ in range(100):
+                if os.path.exists(caminho):
+                    break
+                time.sleep(0.05)
+            fonte = b"main { print(1 + 2); }\n"
+            for tamanho in (b"9000000000000000000", b"99999999999999999999999", b"1001"):
+                resposta = pedir_ao_servidor(caminho, b"COMPILAR a.txt " + tamanho + b"\n")
+                if resposta != b"ERRO tamanho\n":
+                    raise Falha(f"tamanho {tamanho.decode()}: resposta {resposta!r}")
+            resposta = pedir_ao_servidor(caminho, b"COMPILAR a.txt -1\n")
+            if resposta != "ERRO pedido inválido\n".encode():
+                raise Falha(f"tamanho negativo: resposta {resposta!r}")
+            if servidor.poll() is not None:
+                raise Falha("o servidor terminou depois de um pedido recusado")
+            pedido = b"COMPILAR a.txt %d\n" % len(fonte) + fonte + b"FIM\n"
+            resposta = pedir_ao_servidor(caminho, pedido)
+            if not resposta.startswith(b"RESULTADO a.txt 0 ") or not resposta.endswith(b"FIM\n"):
+                raise Falha(f"o servidor não compilou depois dos pedidos recusados: {resposta[:200]!r}")
+        finally:
+            servidor.terminate()
+            servidor.wait(timeout=30)
+
+
+def testar_servidor_cliente_ocioso(compilador):
+    """Uma conexão aberta que não envia nada não impede o servidor de atender os demais."""
+    with tempfile.TemporaryDirectory() as diretorio:
+        caminho = os.path.join(diretorio, "servidor.sock")
+        fonte = os.path.join(diretorio, "prog.txt")
+        with open(fonte, "w") as arquivo:
+            arquivo.write("main { print(1 + 2); }\n")
+        servidor = subprocess.Popen([compilador, f"--servidor={caminho}"],
+                                    stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+        try:
+            for _ in range(100):
+                if os.path.exists(caminho):
+                    break
+                time.sleep(0.05)
+            with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as ociosa:
+                ociosa.connect(caminho)
+                ociosa.sendall(b"COMPILAR a.txt 100\n")
+                try:
+                    resultado = subprocess.run([compilador, f"--conectar={caminho}", fonte], cwd=diretorio,
+                                               stdout=subprocess.PIPE, stderr=subprocess.PIPE, text=True,
+                                               timeout=30)
+                except subprocess.TimeoutExpired:
+                    raise Falha("o cliente esperou a conexão ociosa por mais de 30 segundos")
+            if resultado.returncode != 0 or not os.path.exists(os.path.join(diretorio, "prog.py")):
+                raise Falha(f"o cliente falhou:\n{resultado.stderr}")
+        finally:
+            servidor.terminate()
+            servidor.wait(timeout=30)
+
+
+def testar_cliente_nome_do_servidor(compilador):
+    """O cliente não grava arquivos com nomes que não enviou, mesmo que o servidor os
+    devolva em um RESULTADO."""
+    with tempfile.TemporaryDirectory() as diretorio:
+        pedidos = os.path.join(diretorio, "pedidos")
+        os.mkdir(pedidos)
+        fonte = os.path.join(pedidos, "prog.txt")
+        with open(fonte, "w") as arquivo:
+            arquivo.write("main { print(1); }\n")
+        caminho = os.path.join(diretorio, "falso.sock")
+        with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as falso:
+            falso.bind(caminho)
+            falso.listen(1)
+            cliente = subprocess.Popen([compilador, f"--conectar={caminho}", fonte], cwd=pedidos,
+                                       stdout=subprocess.PIPE, stderr=subprocess.PIPE, text=True)
+            conexao, _ = falso.accept()
+            with conexao:
+                conexao.settimeout(30)
+                recebido = b""
+                while not recebido.endswith(b"FIM\n"):
+                    parte = conexao.recv(65536)
+                    if not parte:
+                        break
+                    recebido += parte
+                codigo = b"print(1)\n"
+                for nome in (b"../fora.txt", fonte.encode()):
+                    conexao.sendall(b"RESULTADO %s 0 %d 0\n" % (nome, len(codigo)) + codigo)
+                conexao.sendall(b"FIM\n")
+            cliente.communicate(timeout=30)
+        if os.path.exists(os.path.join(diretorio, "fora.py")):
+            raise Falha("o cliente gravou fora.py com o nome enviado pelo servidor")
+        if cliente.returncode == 0:
+            raise Falha("o cliente aceitou um resultado que não pediu")
+
+
+def testar_cache_aninhamento(compilador):
+    """O limite de aninhamento faz parte da chave do cache: um programa aceito com o
+    limite padrão não é reaproveitado quando um limite menor o rejeitaria."""
+    fonte = "main { int x = " + "(" * 30 + "1" + ")" * 30 + "; print(x); }\n"
+    with tempfile.TemporaryDirectory() as diretorio:
+        caminho = os.path.join(diretorio, "prog.txt")
+        with open(caminho, "w") as arquivo:
+            arquivo.write(fonte)
+        compilar(compilador, caminho, diretorio, ["--cache=cache"])
+        resultado = subprocess.run([compilador, "--cache=cache", "--max-nesting=10", caminho], cwd=diretorio,
+                                   stdout=subprocess.PIPE, stderr=subprocess.PIPE, text=True)
+        if resultado.returncode == 0:
+            raise Falha("com --max-nesting=10 o programa veio do cache em vez de ser rejeitado")
+
+
+def testar_aviso_sem_otimizacao(compilador):
+    """Uma função funda demais para o otimizador é gerada sem otimização, com um aviso
+    na saída de erro; as demais continuam otimizadas, e o programa executa."""
+    fonte = "fun um() { return 1; }\n" \
+            "fun funda(int a) { return " + " - ".join(["a"] + ["um()"] * 12000) + "; }\n" \
+            "main { int x = um() + 4; print(x); print(funda(1)); }\n"
+    with tempfile.TemporaryDirectory() as diretorio:
+        caminho = os.path.join(diretorio, "prog.txt")
+        with open(caminho, "w") as arquivo:
+            arquivo.write(fonte)
+        resultado = subprocess.run([compilador, caminho], cwd=diretorio,
+                                   stdout=subprocess.PIPE, stderr=subprocess.PIPE, text=True)
+        if resultado.returncode != 0:
+            raise Falha(f"o compilador falhou:\n{resultado.stderr}")
+        if "Aviso: 'funda'" not in resultado.stderr or "sem otimização" not in resultado.stderr:
+            raise Falha(f"nenhum aviso na saída de erro: {resultado.stderr!r}")
+        with open(os.path.join(diretorio, "output.py")) as arquivo:
+            if "__um_ret" not in arquivo.read():
+                raise Falha("a chamada em main não foi expandida inline")
+        execucao = subprocess.run([sys.executable, "output.py"], cwd=diretorio,
+                                  stdout=subprocess.PIPE, stderr=subprocess.PIPE, text=True)
+        if execucao.stdout != "5\n-11999\n":
+            raise Falha(f"saída inesperada: {execucao.stdout!r} {execucao.stderr[-300:]!r}")
+
+
+# Layout da AST binária (serializador_ast.h): cabeçalho de 7 uint32 e registros de 52 bytes
+AST_CABECALHO = 28
+AST_REGISTRO = 52
+AST_NENHUM = 0xFFFFFFFF
+AST_TIPOS = 19  # NODE_PROGRAM .. NODE_CHAR_LITERAL
+NODE_BLOCK = 5
+NODE_BINARY_OP = 11
+NODE_IDENTIFIER = 14
+
+
+def testar_ast_corrompida(compilador):
+    """Imagens com o tipo de um nó trocado, um nó referenciado duas vezes ou uma raiz que
+    não é o programa são recusadas (ou compiladas), mas nunca derrubam o compilador."""
+    fonte = "int g = 3;\nfun soma(int a, int b) { return a + b * g; }\n" \
+            "main { int x = soma(1, 2); if (x > 2) { print(x); } }\n"
+    with tempfile.TemporaryDirectory() as diretorio:
+        caminho_fonte = os.path.join(diretorio, "prog.txt")
+        with open(caminho_fonte, "w") as arquivo:
+            arquivo.write(fonte)
+        imagem = os.path.join(diretorio, "prog.ast")
+        subprocess.run([compilador, "--stop-after=opt", f"--emit-ast={imagem}", caminho_fonte], cwd=diretorio,
+                       stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL, check=True)
+        with open(imagem, "rb") as arquivo:
+            original = arquivo.read()
+        total = struct.unpack_from("=I", original, 12)[0]
+
+        def carregar(dados):
+            with open(imagem, "wb") as arquivo:
+                arquivo.write(dados)
+            return subprocess.run([compilador, "--from-ast", imagem], cwd=diretorio,
+                                  stdout=subprocess.PIPE, stderr=subprocess.PIPE, text=True, timeout=30)
+
+        def deve_recusar(descricao, dados):
+            resultado = carregar(dados)
+            if resultado.returncode == 0 or "inválidos" not in resultado.stderr:
+                raise Falha(f"{descricao}: imagem aceita (código {resultado.returncode})")
+
+        def registro(indice):
+            return AST_CABECALHO + indice * AST_REGISTRO
+
+        if carregar(original).returncode != 0:
+            raise Falha("a imagem intacta foi recusada")
+        for indice in range(total):
+            tipo = original[registro(indice)]
+            for novo in range(AST_TIPOS):
+                if novo == tipo:
+                    continue
+                dados = bytearray(original)
+                dados[registro(indice)] = novo
+                resultado = carregar(bytes(dados))
+                if resultado.returncode < 0:
+                    raise Falha(f"registro {indice} com tipo {novo}: o compilador terminou com o sinal {-resultado.returncode}")
+
+        identificador = next(i for i in range(total) if original[registro(i)] == NODE_IDENTIFIER)
+        dados = bytearray(original)
+        dados[registro(identificador)] = NODE_BINARY_OP
+        deve_recusar("identificador trocado por operação binária", bytes(dados))
+
+        dados = bytearray(original)
+        dados[registro(0)] = NODE_BLOCK
+        deve_recusar("raiz que não é o programa", bytes(dados))
+
+        # Dois filhos diretos que apontam para o mesmo nó
+        binaria = next(i for i in range(total) if original[registro(i)] == NODE_BINARY_OP)
+        esquerdo = struct.unpack_from("=I", original, registro(binaria) + 12)[0]
+        dados = bytearray(original)
+        struct.pack_into("=I", dados, registro(binaria) + 16, esquerdo)
+        deve_recusar("nó referenciado duas vezes", bytes(dados))
+
+
+# Testes que não são programas: nome -> função(compilador)
+TESTES_ESPECIAIS = {
+    "servidor: tamanho do pedido": testar_servidor_tamanho,
+    "servidor: cliente ocioso": testar_servidor_cliente_ocioso,
+    "servidor: nome devolvido ao cliente": testar_cliente_nome_do_servidor,
+    "ast binária corrompida": testar_ast_corrompida,
+    "cache: limite de aninhamento": testar_cache_aninhamento,
+    "otimizador: aviso de AST funda": testar_aviso_sem_otimizacao,
+}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--compilador", default="./compilador")
+    parser.add_argument("--filtro", default="", help="executa só os testes cujo nome contém o texto")
+    args = parser.parse_args()
+    compilador = os.path.abspath(args.compilador)
+
+    testes = [(os.path.basename(fonte), lambda fonte=fonte: testar_programa(compilador, fonte))
+              for fonte in sorted(glob.glob(os.path.join(DIRETORIO, "programas", "*.txt")))]
+    testes += [(nome, lambda funcao=funcao: funcao(compilador)) for nome, funcao in TESTES_ESPECIAIS.items()]
+
+    falhas = 0
+    for nome, teste in testes:
+        if args.filtro not in nome:
+            continue
+        try:
+            teste()
+            print(f"ok     {nome}")
+        except (Falha, subprocess.TimeoutExpired, OSError) as erro:
+            falhas += 1
+            print(f"FALHOU {nome}: {erro}")
+    print(f"\n{falhas} falha(s)" if falhas else "\nTodos os testes passaram.")
+    return 1 if falhas else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())